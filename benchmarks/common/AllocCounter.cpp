@@ -0,0 +1,22 @@
+#include "AllocCounter.hpp"
+#include "AllocationTracker.hpp"
+
+#ifndef HSITHO_TRACK_ALLOCATIONS
+  #error "AllocCounter.cpp reads the allocation tracker, build the benchmark with CONFIG+=hsitho_alloc"
+#endif
+
+namespace hsitho
+{
+  namespace bench
+  {
+    AllocCount allocations()
+    {
+      // Counts are reset by AllocationTracker::beginCompile, which the benchmarks never call
+      AllocationTracker::StageStats total = AllocationTracker::total();
+      AllocCount c;
+      c.m_count = total.m_count;
+      c.m_bytes = total.m_bytes;
+      return c;
+    }
+  }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+/// \file AllocCounter.hpp
+/// \brief Heap allocation counts of a benchmark executable, read from the AllocationTracker totals.
+///        Targets linking AllocCounter.cpp have to be built with CONFIG+=hsitho_alloc
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace bench
+  {
+    struct AllocCount
+    {
+      size_t m_count = 0;
+      size_t m_bytes = 0;
+    };
+
+    ///
+    /// \brief allocations Allocations made by the process so far, from every thread
+    ///
+    AllocCount allocations();
+  }
+}
@@ -0,0 +1,44 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "BenchReport.hpp"
+
+namespace hsitho
+{
+  namespace bench
+  {
+    namespace
+    {
+      double percentile(const std::vector<double> &_sorted, double _p)
+      {
+        size_t rank = static_cast<size_t>(std::ceil(_p * _sorted.size()));
+        return _sorted[std::max<size_t>(rank, 1) - 1];
+      }
+    }
+
+    Distribution summarise(std::vector<double> _samples)
+    {
+      Distribution d;
+      if(_samples.empty())
+        return d;
+
+      std::sort(_samples.begin(), _samples.end());
+      d.m_count = _samples.size();
+      d.m_min = _samples.front();
+      d.m_max = _samples.back();
+      d.m_mean = std::accumulate(_samples.begin(), _samples.end(), 0.0) / _samples.size();
+      d.m_median = percentile(_samples, 0.5);
+      d.m_p95 = percentile(_samples, 0.95);
+      d.m_p99 = percentile(_samples, 0.99);
+      return d;
+    }
+
+    void writeJson(std::ostream &_out, const Distribution &_d)
+    {
+      _out << "{ \"count\": " << _d.m_count << ", \"min\": " << _d.m_min << ", \"median\": " << _d.m_median
+           << ", \"mean\": " << _d.m_mean << ", \"p95\": " << _d.m_p95 << ", \"p99\": " << _d.m_p99
+           << ", \"max\": " << _d.m_max << " }";
+    }
+  }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+/// \file BenchReport.hpp
+/// \brief Summary statistics shared by the benchmarks, the results are written as JSON so runs can be compared by scripts
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace bench
+  {
+    struct Distribution
+    {
+      double m_min = 0.0;
+      double m_median = 0.0;
+      double m_mean = 0.0;
+      double m_p95 = 0.0;
+      double m_p99 = 0.0;
+      double m_max = 0.0;
+      size_t m_count = 0;
+    };
+
+    ///
+    /// \brief summarise Computes the distribution of a set of samples, percentiles use the nearest rank
+    /// \param _samples Samples in any order
+    /// \return Zeroed distribution if there are no samples
+    ///
+    Distribution summarise(std::vector<double> _samples);
+    ///
+    /// \brief writeJson Writes a distribution as a JSON object
+    /// \param _out Stream to write to, should use the classic locale
+    /// \param _d Distribution to write
+    ///
+    void writeJson(std::ostream &_out, const Distribution &_d);
+  }
+}
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <functional>
+
+#include "nodes/CollapsedNodeDataModel.hpp"
+#include "GraphGenerator.hpp"
+
+namespace hsitho
+{
+  namespace bench
+  {
+    GraphGenerator::GraphGenerator(FlowScene &_scene, const GraphOptions &_options) :
+      m_scene(_scene),
+      m_builder(_scene),
+      m_options(_options),
+      m_rng(_options.m_seed)
+    {
+    }
+
+    bool GraphGenerator::chance(float _p)
+    {
+      return std::uniform_real_distribution<float>(0.f, 1.f)(m_rng) < _p;
+    }
+
+    std::shared_ptr<Node> GraphGenerator::leaf()
+    {
+      static const char *primitives[] = {"Sphere", "Torus", "Cube", "Cylinder", "Capsule", "Cone", "TriPrism", "HexPrism"};
+      std::uniform_int_distribution<int> model(0, 7);
+      std::uniform_real_distribution<float> offset(-10.f, 10.f);
+      return m_builder.translate(m_builder.node(primitives[model(m_rng)]), glm::vec3(offset(m_rng), offset(m_rng), offset(m_rng)));
+    }
+
+    std::shared_ptr<Node> GraphGenerator::tree(unsigned int _level)
+    {
+      if(_level == 0 || m_builder.nodeCount() >= m_options.m_nodes)
+        return leaf();
+
+      std::vector<std::shared_ptr<Node>> children;
+      for(unsigned int i = 0; i < std::max(m_options.m_fanIn, 1u); ++i)
+        children.push_back(tree(_level - 1));
+
+      static const char *operations[] = {"Union", "Union", "Blend", "Subtraction", "Intersection"};
+      QString op = operations[std::uniform_int_distribution<int>(0, 4)(m_rng)];
+      std::shared_ptr<Node> root = m_builder.combine(op, children, op == "Blend" ? QVariantMap{{"blend", "0.3"}} : QVariantMap());
+
+      if(chance(m_options.m_copyRatio))
+      {
+        auto copy = m_builder.node("Copy", QVariantMap{{"num_copies", QString::number(std::uniform_int_distribution<int>(2, 4)(m_rng))}});
+        m_builder.connect(root, copy, 0);
+        root = copy;
+      }
+      if(chance(m_options.m_collapsedRatio))
+        root = collapse(root);
+      return root;
+    }
+
+    std::shared_ptr<Node> GraphGenerator::collapse(std::shared_ptr<Node> _root)
+    {
+      // Same selection the editor makes when collapsing from an output node: the output and everything upstream of it
+      auto output = m_builder.node("Output");
+      m_builder.connect(_root, output, 0);
+
+      std::vector<std::shared_ptr<Node>> nodes{output};
+      std::function<void(std::shared_ptr<Node>)> upstream = [&](std::shared_ptr<Node> _node)
+      {
+        for(auto &connection : _node->nodeState().connection(PortType::In))
+        {
+          if(connection.get() && connection->getNode(PortType::Out).lock())
+          {
+            std::shared_ptr<Node> n = connection->getNode(PortType::Out).lock();
+            nodes.push_back(n);
+            upstream(n);
+          }
+        }
+      };
+      upstream(output);
+
+      return m_builder.add(std::make_unique<CollapsedNodeDataModel>(nodes, &m_scene));
+    }
+
+    void GraphGenerator::generate(std::shared_ptr<Node> _output)
+    {
+      std::vector<std::shared_ptr<Node>> roots;
+      do
+        roots.push_back(tree(m_options.m_depth));
+      while(m_builder.nodeCount() < m_options.m_nodes);
+
+      // Reduce the trees pairwise so the depth of the graph stays logarithmic in their number
+      while(roots.size() > 1)
+      {
+        std::vector<std::shared_ptr<Node>> next;
+        for(size_t i = 0; i + 1 < roots.size(); i += 2)
+          next.push_back(m_builder.combine("Union", {roots[i], roots[i + 1]}));
+        if(roots.size() % 2)
+          next.push_back(roots.back());
+        roots.swap(next);
+      }
+      m_builder.connect(roots[0], _output, 0);
+    }
+
+    bool buildScene(const std::string &_name, size_t _nodes, FlowScene &_scene, std::shared_ptr<Node> _output)
+    {
+      if(_nodes == 0)
+        return buildReferenceScene(_name, _scene, _output);
+      GraphOptions options;
+      options.m_nodes = _nodes;
+      GraphGenerator generator(_scene, options);
+      generator.generate(_output);
+      return true;
+    }
+  }
+}
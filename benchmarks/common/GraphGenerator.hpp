@@ -0,0 +1,85 @@
+#pragma once
+
+#include <memory>
+#include <random>
+
+#include "ReferenceScenes.hpp"
+
+/// \file GraphGenerator.hpp
+/// \brief Builds large random but valid node graphs for stress testing the editor and the compiler. The graph is a forest of
+///        operation trees over translated primitives, reduced into a single root, the same seed always gives the same graph
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace bench
+  {
+    struct GraphOptions
+    {
+      ///
+      /// \brief m_nodes Approximate number of nodes to create, the generator stops growing trees once it's reached
+      ///
+      size_t m_nodes = 1000;
+      ///
+      /// \brief m_depth Levels of operations in each tree
+      ///
+      unsigned int m_depth = 6;
+      ///
+      /// \brief m_fanIn Subtrees combined by each level
+      ///
+      unsigned int m_fanIn = 2;
+      ///
+      /// \brief m_copyRatio Probability of a subtree being wrapped into a Copy node
+      ///
+      float m_copyRatio = 0.05f;
+      ///
+      /// \brief m_collapsedRatio Probability of a subtree being collapsed into a collapsed node
+      ///
+      float m_collapsedRatio = 0.0f;
+      unsigned int m_seed = 1;
+    };
+
+    class GraphGenerator
+    {
+    public:
+      ///
+      /// \brief GraphGenerator Default ctor
+      /// \param _scene Scene to build the graph in, the node models have to be registered
+      /// \param _options Shape of the graph
+      ///
+      GraphGenerator(FlowScene &_scene, const GraphOptions &_options);
+
+      ///
+      /// \brief generate Builds the graph and connects its root to the distance node
+      /// \param _output Distance node of the scene
+      ///
+      void generate(std::shared_ptr<Node> _output);
+
+      unsigned int nodeCount() const { return m_builder.nodeCount(); }
+      unsigned int connectionCount() const { return m_builder.connectionCount(); }
+
+    private:
+      std::shared_ptr<Node> tree(unsigned int _level);
+      std::shared_ptr<Node> leaf();
+      std::shared_ptr<Node> collapse(std::shared_ptr<Node> _root);
+      bool chance(float _p);
+
+      FlowScene &m_scene;
+      SceneBuilder m_builder;
+      GraphOptions m_options;
+      std::mt19937 m_rng;
+    };
+
+    ///
+    /// \brief buildScene Fills a scene that isn't loaded from a file, a reference scene or a generated graph
+    /// \param _name Name of the reference scene, used if _nodes is 0
+    /// \param _nodes Node count of the generated graph, 0 for the reference scene
+    /// \param _scene Scene to add the nodes to
+    /// \param _output Distance node of the scene
+    /// \return False if there is no reference scene with the name
+    ///
+    bool buildScene(const std::string &_name, size_t _nodes, FlowScene &_scene, std::shared_ptr<Node> _output);
+  }
+}
@@ -0,0 +1,59 @@
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+#include "Microbench.hpp"
+
+namespace hsitho
+{
+  namespace bench
+  {
+    Series &Microbench::series(const std::string &_name)
+    {
+      for(auto &s : m_series)
+        if(s.m_name == _name)
+          return s;
+      m_series.push_back(Series());
+      m_series.back().m_name = _name;
+      return m_series.back();
+    }
+
+    void Microbench::report(const std::string &_name, const Measurement &_m) const
+    {
+      std::cerr << std::left << std::setw(32) << _name << std::right
+                << " n=" << std::setw(6) << _m.m_size
+                << std::setw(14) << std::fixed << std::setprecision(1) << _m.m_nsPerOp << " ns/op"
+                << std::setw(12) << _m.m_allocsPerOp << " allocs/op"
+                << std::setw(14) << _m.m_bytesPerOp << " B/op\n";
+    }
+
+    void Microbench::writeJson(std::ostream &_out) const
+    {
+      _out << "{\n  \"benchmarks\": [";
+      for(size_t i = 0; i < m_series.size(); ++i)
+      {
+        const Series &s = m_series[i];
+        _out << (i ? ",\n" : "\n") << "    {\n      \"name\": \"" << s.m_name << "\",\n      \"points\": [";
+        for(size_t p = 0; p < s.m_points.size(); ++p)
+        {
+          const Measurement &m = s.m_points[p];
+          _out << (p ? ",\n" : "\n") << "        { \"size\": " << m.m_size << ", \"iterations\": " << m.m_iterations
+               << ", \"ns_per_op\": " << m.m_nsPerOp << ", \"allocs_per_op\": " << m.m_allocsPerOp
+               << ", \"bytes_per_op\": " << m.m_bytesPerOp << " }";
+        }
+        _out << "\n      ],\n      \"scaling\": [";
+        for(size_t p = 1; p < s.m_points.size(); ++p)
+        {
+          const Measurement &a = s.m_points[p - 1];
+          const Measurement &b = s.m_points[p];
+          double exponent = 0.0;
+          if(a.m_size > 0 && b.m_size > a.m_size && a.m_nsPerOp > 0.0)
+            exponent = std::log(b.m_nsPerOp / a.m_nsPerOp) / std::log(static_cast<double>(b.m_size) / a.m_size);
+          _out << (p > 1 ? ", " : "") << exponent;
+        }
+        _out << "]\n    }";
+      }
+      _out << "\n  ]\n}\n";
+    }
+  }
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <QElapsedTimer>
+
+#include "AllocCounter.hpp"
+
+/// \file Microbench.hpp
+/// \brief Minimal microbenchmark runner, repeats an operation until it has run long enough to time reliably and
+///        reports the time and the allocations per operation for each input size, plus how the time scales with the size
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace bench
+  {
+    struct Measurement
+    {
+      size_t m_size = 0;
+      size_t m_iterations = 0;
+      double m_nsPerOp = 0.0;
+      double m_allocsPerOp = 0.0;
+      double m_bytesPerOp = 0.0;
+    };
+
+    struct Series
+    {
+      std::string m_name;
+      std::vector<Measurement> m_points;
+    };
+
+    class Microbench
+    {
+    public:
+      ///
+      /// \brief Microbench Default ctor
+      /// \param _minTimeMs How long each size is run for at least
+      ///
+      Microbench(double _minTimeMs = 200.0) : m_minTimeMs(_minTimeMs) {}
+
+      ///
+      /// \brief setFilter Only runs the benchmarks whose name contains the text
+      /// \param _filter Text to look for, empty runs everything
+      ///
+      void setFilter(const std::string &_filter) { m_filter = _filter; }
+
+      ///
+      /// \brief run Times an operation, the first call is a warm up and isn't measured
+      /// \param _name Name of the benchmark, sizes of the same name are reported as one series
+      /// \param _size Input size the operation was set up with
+      /// \param _op Operation to time
+      ///
+      template<typename Op>
+      void run(const std::string &_name, size_t _size, Op &&_op)
+      {
+        if(_name.find(m_filter) == std::string::npos)
+          return;
+        _op();
+
+        // Double the iterations until a batch takes long enough, then measure one more batch of that size
+        size_t iterations = 1;
+        QElapsedTimer timer;
+        for(;;)
+        {
+          timer.start();
+          for(size_t i = 0; i < iterations; ++i)
+            _op();
+          if(timer.nsecsElapsed() / 1e6 >= m_minTimeMs / 4.0 || iterations >= (size_t(1) << 30))
+            break;
+          iterations *= 2;
+        }
+        iterations *= 4;
+
+        AllocCount before = allocations();
+        timer.start();
+        for(size_t i = 0; i < iterations; ++i)
+          _op();
+        double ns = static_cast<double>(timer.nsecsElapsed());
+        AllocCount after = allocations();
+
+        Measurement m;
+        m.m_size = _size;
+        m.m_iterations = iterations;
+        m.m_nsPerOp = ns / iterations;
+        m.m_allocsPerOp = static_cast<double>(after.m_count - before.m_count) / iterations;
+        m.m_bytesPerOp = static_cast<double>(after.m_bytes - before.m_bytes) / iterations;
+        series(_name).m_points.push_back(m);
+        report(_name, m);
+      }
+
+      ///
+      /// \brief writeJson Writes every series with the scaling exponent between consecutive sizes,
+      ///        an exponent around 1 is linear, around 2 quadratic
+      /// \param _out Stream to write to, should use the classic locale
+      ///
+      void writeJson(std::ostream &_out) const;
+
+    private:
+      Series &series(const std::string &_name);
+      void report(const std::string &_name, const Measurement &_m) const;
+
+      double m_minTimeMs;
+      std::string m_filter;
+      std::vector<Series> m_series;
+    };
+  }
+}
@@ -0,0 +1,175 @@
+#include <cmath>
+#include <stdexcept>
+
+#include "nodeEditor/DataModelRegistry.hpp"
+#include "nodeEditor/NodeGraphicsObject.hpp"
+#include "ReferenceScenes.hpp"
+
+namespace hsitho
+{
+  namespace bench
+  {
+    SceneBuilder::SceneBuilder(FlowScene &_scene) :
+      m_scene(_scene),
+      m_created(0),
+      m_connected(0)
+    {
+    }
+
+    std::shared_ptr<Node> SceneBuilder::node(const QString &_model, const QVariantMap &_values)
+    {
+      for(auto const &category : DataModelRegistry::registeredModels())
+      {
+        auto it = category.second.find(_model);
+        if(it == category.second.end())
+          continue;
+
+        auto dataModel = it->second->create();
+        dataModel->setScene(&m_scene);
+        if(!_values.isEmpty())
+        {
+          Properties p;
+          for(auto v = _values.begin(); v != _values.end(); ++v)
+            p.put(v.key(), v.value());
+          dataModel->restore(p);
+        }
+
+        return add(std::move(dataModel));
+      }
+      throw std::logic_error(std::string("No registered model with name ") + _model.toStdString());
+    }
+
+    std::shared_ptr<Node> SceneBuilder::add(std::unique_ptr<NodeDataModel> &&_model)
+    {
+      auto n = m_scene.createNode(std::move(_model));
+      // Lay the nodes out on a grid so the scene is readable if it's saved and opened in the editor
+      n->nodeGraphicsObject()->setPos(200.0 * (m_created % 12), 120.0 * (m_created / 12));
+      ++m_created;
+      return n;
+    }
+
+    void SceneBuilder::connect(std::shared_ptr<Node> _from, std::shared_ptr<Node> _to, PortIndex _port)
+    {
+      m_scene.createConnection(_to, _port, _from, 0);
+      ++m_connected;
+    }
+
+    std::shared_ptr<Node> SceneBuilder::vector(const glm::vec3 &_v)
+    {
+      return node("Vector", QVariantMap{{"m_x", QString::number(_v.x, 'f', 4)},
+                                        {"m_y", QString::number(_v.y, 'f', 4)},
+                                        {"m_z", QString::number(_v.z, 'f', 4)}});
+    }
+
+    std::shared_ptr<Node> SceneBuilder::translate(std::shared_ptr<Node> _shape, const glm::vec3 &_offset)
+    {
+      auto t = node("Translate");
+      connect(_shape, t, 0);
+      connect(vector(_offset), t, 1);
+      return t;
+    }
+
+    std::shared_ptr<Node> SceneBuilder::combine(const QString &_model, const std::vector<std::shared_ptr<Node>> &_shapes, const QVariantMap &_values)
+    {
+      std::shared_ptr<Node> result = _shapes.at(0);
+      for(size_t i = 1; i < _shapes.size(); ++i)
+      {
+        auto op = node(_model, _values);
+        connect(result, op, 0);
+        connect(_shapes[i], op, 1);
+        result = op;
+      }
+      return result;
+    }
+
+    namespace
+    {
+      /// A handful of different primitives next to each other, the cheapest scene
+      std::shared_ptr<Node> primitives(SceneBuilder &_b)
+      {
+        const char *models[] = {"Sphere", "Torus", "Cube", "Cylinder", "Cone"};
+        std::vector<std::shared_ptr<Node>> shapes;
+        for(int i = 0; i < 5; ++i)
+          shapes.push_back(_b.translate(_b.node(models[i]), glm::vec3(3.f * (i - 2), 0.f, 0.f)));
+        return _b.combine("Union", shapes);
+      }
+
+      /// Spheres on a ring melted together with smooth blends
+      std::shared_ptr<Node> blend(SceneBuilder &_b)
+      {
+        std::vector<std::shared_ptr<Node>> shapes;
+        for(int i = 0; i < 8; ++i)
+        {
+          float a = 2.f * static_cast<float>(M_PI) * i / 8.f;
+          shapes.push_back(_b.translate(_b.node("Sphere"), glm::vec3(2.5f * std::cos(a), 0.f, 2.5f * std::sin(a))));
+        }
+        return _b.combine("Blend", shapes, QVariantMap{{"blend", "0.5"}});
+      }
+
+      /// A large union, stresses the cost of a single map evaluation
+      std::shared_ptr<Node> grid(SceneBuilder &_b)
+      {
+        std::vector<std::shared_ptr<Node>> shapes;
+        for(int z = 0; z < 8; ++z)
+          for(int x = 0; x < 8; ++x)
+            shapes.push_back(_b.translate(_b.node("Sphere"), glm::vec3(1.5f * (x - 3.5f), 0.f, 1.5f * (z - 3.5f))));
+        return _b.combine("Union", shapes);
+      }
+
+      /// Copy node repeating a subtree, stresses the generated loops
+      std::shared_ptr<Node> copies(SceneBuilder &_b)
+      {
+        auto copy = _b.node("Copy", QVariantMap{{"num_copies", "16"}});
+        _b.connect(_b.translate(_b.node("Torus"), glm::vec3(0.f, 1.f, 0.f)), copy, 0);
+        return _b.combine("Union", {copy, _b.translate(_b.node("Plane"), glm::vec3(0.f, -1.f, 0.f))});
+      }
+
+      /// The primitives lit by several shadow casting lights, stresses the shading
+      std::shared_ptr<Node> lights(SceneBuilder &_b)
+      {
+        auto shape = primitives(_b);
+        const glm::vec3 positions[] = {glm::vec3(4.f, 5.f, 4.f), glm::vec3(-4.f, 3.f, 2.f), glm::vec3(0.f, 6.f, -5.f)};
+        for(auto &pos : positions)
+        {
+          auto light = _b.node("Light", QVariantMap{{"intensity", "1.0"}, {"enabled", true}, {"shadow", true}});
+          _b.connect(_b.vector(pos), light, 0);
+        }
+        return shape;
+      }
+
+      typedef std::shared_ptr<Node> (*SceneFunction)(SceneBuilder &);
+      const std::vector<std::pair<std::string, SceneFunction>> &scenes()
+      {
+        static const std::vector<std::pair<std::string, SceneFunction>> s = {
+          {"primitives", primitives},
+          {"blend", blend},
+          {"grid", grid},
+          {"copies", copies},
+          {"lights", lights}
+        };
+        return s;
+      }
+    }
+
+    std::vector<std::string> referenceSceneNames()
+    {
+      std::vector<std::string> names;
+      for(auto &s : scenes())
+        names.push_back(s.first);
+      return names;
+    }
+
+    bool buildReferenceScene(const std::string &_name, FlowScene &_scene, std::shared_ptr<Node> _output)
+    {
+      for(auto &s : scenes())
+      {
+        if(s.first != _name)
+          continue;
+        SceneBuilder builder(_scene);
+        builder.connect(s.second(builder), _output, 0);
+        return true;
+      }
+      return false;
+    }
+  }
+}
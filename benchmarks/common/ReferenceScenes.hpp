@@ -0,0 +1,97 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QVariantMap>
+
+#include <glm/glm.hpp>
+
+#include "nodeEditor/FlowScene.hpp"
+#include "nodeEditor/Node.hpp"
+#include "nodeEditor/NodeDataModel.hpp"
+
+/// \file ReferenceScenes.hpp
+/// \brief Fixed set of scenes the benchmarks run on. They are built from the registered node models in code rather than
+///        kept as .flow files, which are binary and would go stale whenever a model changes what it saves
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace bench
+  {
+    class SceneBuilder
+    {
+    public:
+      ///
+      /// \brief SceneBuilder Default ctor
+      /// \param _scene Scene the nodes are created in
+      ///
+      SceneBuilder(FlowScene &_scene);
+
+      ///
+      /// \brief node Creates a node from the registry, the models have to be registered
+      /// \param _model Name of the model
+      /// \param _values Values passed to the model's restore, has to contain every key the model reads
+      /// \return The node, throws if the model isn't registered
+      ///
+      std::shared_ptr<Node> node(const QString &_model, const QVariantMap &_values = QVariantMap());
+      ///
+      /// \brief add Adds a node for a model that can't be created from the registry, e.g. a collapsed node
+      /// \param _model Model of the node
+      /// \return The node
+      ///
+      std::shared_ptr<Node> add(std::unique_ptr<NodeDataModel> &&_model);
+      ///
+      /// \brief connect Connects the first output of a node to an input of another
+      /// \param _from Node providing the data
+      /// \param _to Node receiving the data
+      /// \param _port Input port of _to
+      ///
+      void connect(std::shared_ptr<Node> _from, std::shared_ptr<Node> _to, PortIndex _port);
+      ///
+      /// \brief vector Creates a vector node with constant values
+      ///
+      std::shared_ptr<Node> vector(const glm::vec3 &_v);
+      ///
+      /// \brief translate Wraps a shape into a translate node
+      /// \param _shape Distance field to move
+      /// \param _offset Translation
+      /// \return The translate node
+      ///
+      std::shared_ptr<Node> translate(std::shared_ptr<Node> _shape, const glm::vec3 &_offset);
+      ///
+      /// \brief combine Combines shapes with a chain of two input operations, the same way they are usually wired in the editor
+      /// \param _model Name of the operation, e.g. Union or Blend
+      /// \param _shapes Shapes to combine, at least one
+      /// \param _values Values passed to every operation node
+      /// \return Last node of the chain
+      ///
+      std::shared_ptr<Node> combine(const QString &_model, const std::vector<std::shared_ptr<Node>> &_shapes, const QVariantMap &_values = QVariantMap());
+
+      unsigned int nodeCount() const { return m_created; }
+      unsigned int connectionCount() const { return m_connected; }
+
+    private:
+      FlowScene &m_scene;
+      unsigned int m_created;
+      unsigned int m_connected;
+    };
+
+    ///
+    /// \brief referenceSceneNames Names of the built in scenes, in the order they are benchmarked
+    ///
+    std::vector<std::string> referenceSceneNames();
+    ///
+    /// \brief buildReferenceScene Builds one of the reference scenes
+    /// \param _name Name of the scene
+    /// \param _scene Scene to add the nodes to
+    /// \param _output Distance node of the scene
+    /// \return False if there is no scene with the name
+    ///
+    bool buildReferenceScene(const std::string &_name, FlowScene &_scene, std::shared_ptr<Node> _output);
+  }
+}
@@ -0,0 +1,21 @@
+# Microbenchmarks of the CPU side of compiling a scene: expression evaluation, the symbolic matrices,
+# shader generation, unknown replacement and saving and loading .flow files
+TARGET = compile_bench
+DESTDIR = $$PWD/../..
+CONFIG += console thread hsitho_alloc
+CONFIG -= app_bundle
+
+include(../../hsitho.pri)
+
+INCLUDEPATH += ../common
+
+SOURCES += main.cpp \
+           ../common/AllocCounter.cpp \
+           ../common/Microbench.cpp \
+           ../common/ReferenceScenes.cpp
+HEADERS += ../common/AllocCounter.hpp \
+           ../common/Microbench.hpp \
+           ../common/ReferenceScenes.hpp
+
+OBJECTS_DIR = ./obj
+MOC_DIR = ./moc
@@ -0,0 +1,331 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <locale>
+#include <sstream>
+
+#include <boost/lexical_cast.hpp>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include "nodes/DistanceFieldData.hpp"
+#include "nodes/DistanceFieldOutputDataModel.hpp"
+#include "CompileArena.hpp"
+#include "ExpressionEvaluator.hpp"
+#include "Microbench.hpp"
+#include "NodeModels.hpp"
+#include "Numeric.hpp"
+#include "ReferenceScenes.hpp"
+#include "ShaderGenerator.hpp"
+
+/// \file main.cpp
+/// \brief Compile pipeline microbenchmarks. Every stage is run on synthetic inputs of growing size, deep transform chains,
+///        wide unions, many copies and long expressions, and optionally on saved scenes given on the command line
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace
+{
+  using namespace hsitho;
+
+  struct GraphScene
+  {
+    std::unique_ptr<FlowScene> m_scene;
+    std::shared_ptr<Node> m_output;
+  };
+
+  GraphScene emptyScene()
+  {
+    GraphScene s;
+    s.m_scene.reset(new FlowScene(nullptr));
+    s.m_output = s.m_scene->createNode(std::make_unique<DistanceFieldOutputDataModel>(), false, QUuid("ffffffff-ffff-ffff-ffff-ffffffffffff"));
+    return s;
+  }
+
+  /// Sphere under _depth translate nodes
+  GraphScene transformChain(size_t _depth)
+  {
+    GraphScene s = emptyScene();
+    bench::SceneBuilder b(*s.m_scene);
+    auto node = b.node("Sphere");
+    for(size_t i = 0; i < _depth; ++i)
+      node = b.translate(node, glm::vec3(0.1f, 0.f, 0.f));
+    b.connect(node, s.m_output, 0);
+    return s;
+  }
+
+  /// _width translated spheres in a union chain
+  GraphScene wideUnion(size_t _width)
+  {
+    GraphScene s = emptyScene();
+    bench::SceneBuilder b(*s.m_scene);
+    std::vector<std::shared_ptr<Node>> shapes;
+    for(size_t i = 0; i < _width; ++i)
+      shapes.push_back(b.translate(b.node("Sphere"), glm::vec3(1.5f * i, 0.f, 0.f)));
+    b.connect(b.combine("Union", shapes), s.m_output, 0);
+    return s;
+  }
+
+  /// Copy node repeating a translated torus _copies times
+  GraphScene copies(size_t _copies)
+  {
+    GraphScene s = emptyScene();
+    bench::SceneBuilder b(*s.m_scene);
+    auto copy = b.node("Copy", QVariantMap{{"num_copies", QString::number(_copies)}});
+    b.connect(b.translate(b.node("Torus"), glm::vec3(0.f, 1.f, 0.f)), copy, 0);
+    b.connect(copy, s.m_output, 0);
+    return s;
+  }
+
+  /// Sum of _terms products, with every other term referring to the time when _symbolic is set
+  std::string expression(size_t _terms, bool _symbolic)
+  {
+    std::ostringstream ss;
+    ss.imbue(std::locale::classic());
+    for(size_t i = 0; i < _terms; ++i)
+    {
+      ss << (i ? " + " : "") << "( " << (i + 1) * 0.5f << " * ";
+      if(_symbolic && i % 2)
+        ss << "u_GlobalTime";
+      else
+        ss << "2.0";
+      ss << " )";
+    }
+    return ss.str();
+  }
+
+  Mat4f translation(const std::string &_x)
+  {
+    return Mat4f("1.0", "0.0", "0.0", "0.0",
+                 "0.0", "1.0", "0.0", "0.0",
+                 "0.0", "0.0", "1.0", "0.0",
+                 _x, "0.5", "0.0", "1.0");
+  }
+
+  void benchExpressions(bench::Microbench &_bench, const std::vector<size_t> &_sizes)
+  {
+    for(size_t n : _sizes)
+    {
+      std::string numeric = expression(n, false);
+      _bench.run("evaluate/numeric", n, [&]() { Expressions::evaluate(numeric); });
+    }
+    for(size_t n : _sizes)
+    {
+      std::string symbolic = expression(n, true);
+      _bench.run("evaluate/symbolic", n, [&]() { Expressions::evaluate(symbolic); });
+    }
+  }
+
+  /// The evaluator used to tell numbers from variables with lexical_cast and a catch and to format with a stream,
+  /// both are kept here to compare against the from_chars and to_chars versions
+  void benchNumeric(bench::Microbench &_bench, const std::vector<size_t> &_sizes)
+  {
+    const std::string mix[] = {"1.2500", "u_GlobalTime", "-0.5000", "*", "a", "3.0000", "(", "copyNum"};
+    volatile size_t sink = 0;
+    for(size_t n : _sizes)
+    {
+      std::vector<std::string> tokens;
+      for(size_t i = 0; i < n; ++i)
+        tokens.push_back(mix[i % 8]);
+      _bench.run("numeric/parse_lexical_cast", n, [&]() {
+        size_t numbers = 0;
+        for(auto &t : tokens)
+        {
+          try {
+            boost::lexical_cast<float>(t);
+            ++numbers;
+          } catch(const boost::bad_lexical_cast &) {}
+        }
+        sink = numbers;
+      });
+      _bench.run("numeric/parse_from_chars", n, [&]() {
+        size_t numbers = 0;
+        for(auto &t : tokens)
+        {
+          if(Numeric::isNumber(t))
+            ++numbers;
+        }
+        sink = numbers;
+      });
+      _bench.run("numeric/format_ostringstream", n, [&]() {
+        size_t length = 0;
+        for(size_t i = 0; i < n; ++i)
+        {
+          std::ostringstream ss;
+          ss << std::fixed << std::setprecision(4) << i * 0.37f;
+          length += ss.str().size();
+        }
+        sink = length;
+      });
+      _bench.run("numeric/format_to_chars", n, [&]() {
+        size_t length = 0;
+        for(size_t i = 0; i < n; ++i)
+          length += Numeric::toFixed(i * 0.37f).size();
+        sink = length;
+      });
+    }
+  }
+
+  void benchMatrices(bench::Microbench &_bench, const std::vector<size_t> &_sizes)
+  {
+    // Same accumulation recurseNodeTree does down a chain of transforms
+    for(size_t n : _sizes)
+    {
+      Mat4f m = translation("0.1");
+      _bench.run("mat4f/chain_numeric", n, [&]() {
+        Mat4f t;
+        for(size_t i = 0; i < n; ++i)
+          t = t * m;
+      });
+    }
+    for(size_t n : _sizes)
+    {
+      Mat4f m = translation("u_GlobalTime");
+      _bench.run("mat4f/chain_symbolic", n, [&]() {
+        Mat4f t;
+        for(size_t i = 0; i < n; ++i)
+          t = t * m;
+      });
+    }
+  }
+
+  void benchGenerate(bench::Microbench &_bench, ShaderGenerator &_generator, const std::string &_name, GraphScene (*_build)(size_t), const std::vector<size_t> &_sizes)
+  {
+    for(size_t n : _sizes)
+    {
+      GraphScene s = _build(n);
+      auto nodes = s.m_scene->getNodes();
+      // One arena per compile, as in the editor
+      _bench.run("generate/" + _name, n, [&]() { CompileArena arena; _generator.generate(nodes); });
+    }
+  }
+
+  void benchReplaceUnknowns(bench::Microbench &_bench, const std::vector<size_t> &_sizes)
+  {
+    for(size_t n : _sizes)
+    {
+      // n unknowns, each appearing in one line of code
+      Expressions::flushUnknowns();
+      std::string code;
+      for(size_t i = 0; i < n; ++i)
+      {
+        std::string var = "u_Var" + std::to_string(i);
+        Expressions::setUnknowns(var + " * 2.0");
+        code += "  d = min(d, sdSphere(p - vec3(" + var + ", 0.0, 0.0), 1.0));\n";
+      }
+      _bench.run("replaceUnknowns", n, [&]() { Expressions::replaceUnknowns(code); });
+    }
+    Expressions::flushUnknowns();
+  }
+
+  void benchSaveLoad(bench::Microbench &_bench, const QString &_dir, const std::string &_name, size_t _size, FlowScene &_scene)
+  {
+    QString path = _dir + "/" + QString::fromStdString(_name) + ".flow";
+    _bench.run("save/" + _name, _size, [&]() { _scene.save(path); });
+    _bench.run("load/" + _name, _size, [&]() {
+      GraphScene s = emptyScene();
+      s.m_scene->load(path);
+    });
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  // The node models create their widgets even though they're never shown
+  if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  QApplication app(argc, argv);
+  QApplication::setApplicationName("compile_bench");
+  std::locale::global(std::locale::classic());
+
+  hsitho::registerNodeModels();
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Times the CPU side of compiling scenes and reports time and allocations per operation as JSON.");
+  parser.addHelpOption();
+  parser.addPositionalArgument("scenes", "Saved .flow files to benchmark in addition to the synthetic inputs.", "[scene.flow...]");
+  parser.addOption(QCommandLineOption(QStringList() << "o" << "output", "Write the results to a file instead of stdout.", "file"));
+  parser.addOption(QCommandLineOption("shaders", "Directory containing shader.begin and shader.end.", "dir", "shaders"));
+  parser.addOption(QCommandLineOption("max-size", "Largest synthetic input size, sizes grow by 4x from 1.", "n", "256"));
+  parser.addOption(QCommandLineOption("min-time", "Minimum time each measurement runs for.", "ms", "200"));
+  parser.addOption(QCommandLineOption("filter", "Only run benchmarks whose name contains the text.", "text"));
+  parser.process(app);
+
+  bool sizeOk, timeOk;
+  size_t maxSize = parser.value("max-size").toUInt(&sizeOk);
+  double minTime = parser.value("min-time").toDouble(&timeOk);
+  if(!sizeOk || maxSize < 1 || !timeOk || minTime <= 0.0)
+  {
+    std::cerr << "Invalid --max-size or --min-time\n";
+    return EXIT_FAILURE;
+  }
+  std::vector<size_t> sizes;
+  for(size_t n = 1; n <= maxSize; n *= 4)
+    sizes.push_back(n);
+
+  hsitho::ThreadPool pool;
+  hsitho::ShaderGenerator generator(pool, parser.value("shaders").toStdString());
+  if(!generator.isValid())
+  {
+    std::cerr << "Couldn't read shader.begin and shader.end from " << parser.value("shaders").toStdString() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  QTemporaryDir dir;
+  if(!dir.isValid())
+  {
+    std::cerr << "Couldn't create a temporary directory\n";
+    return EXIT_FAILURE;
+  }
+
+  hsitho::bench::Microbench bench(minTime);
+  bench.setFilter(parser.value("filter").toStdString());
+  benchNumeric(bench, sizes);
+  benchExpressions(bench, sizes);
+  benchMatrices(bench, sizes);
+  benchGenerate(bench, generator, "transform_chain", transformChain, sizes);
+  benchGenerate(bench, generator, "union", wideUnion, sizes);
+  benchGenerate(bench, generator, "copies", copies, sizes);
+  benchReplaceUnknowns(bench, sizes);
+  for(size_t n : sizes)
+  {
+    GraphScene s = wideUnion(n);
+    benchSaveLoad(bench, dir.path(), "union", n, *s.m_scene);
+  }
+
+  // Recorded scenes, the size is their node count
+  for(auto &flow : parser.positionalArguments())
+  {
+    GraphScene s = emptyScene();
+    if(!s.m_scene->load(flow))
+    {
+      std::cerr << "Couldn't load " << flow.toStdString() << "\n";
+      return EXIT_FAILURE;
+    }
+    std::string name = QFileInfo(flow).completeBaseName().toStdString();
+    auto nodes = s.m_scene->getNodes();
+    bench.run("generate/" + name, nodes.size(), [&]() { hsitho::CompileArena arena; generator.generate(nodes); });
+    benchSaveLoad(bench, dir.path(), name, nodes.size(), *s.m_scene);
+  }
+
+  if(parser.isSet("output"))
+  {
+    std::ofstream file(parser.value("output").toStdString());
+    file.imbue(std::locale::classic());
+    bench.writeJson(file);
+    if(!file.good())
+    {
+      std::cerr << "Couldn't write " << parser.value("output").toStdString() << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  else
+    bench.writeJson(std::cout);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,19 @@
+# End to end scaling benchmark on generated graphs of thousands of nodes, every size runs in its own process
+# so the peak memory reported for it isn't inflated by the previous sizes
+TARGET = graph_bench
+DESTDIR = $$PWD/../..
+CONFIG += console thread
+CONFIG -= app_bundle
+
+include(../../hsitho.pri)
+
+INCLUDEPATH += ../common
+
+SOURCES += main.cpp \
+           ../common/GraphGenerator.cpp \
+           ../common/ReferenceScenes.cpp
+HEADERS += ../common/GraphGenerator.hpp \
+           ../common/ReferenceScenes.hpp
+
+OBJECTS_DIR = ./obj
+MOC_DIR = ./moc
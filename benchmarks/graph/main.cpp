@@ -0,0 +1,256 @@
+#include <fstream>
+#include <iostream>
+#include <locale>
+#include <sstream>
+
+#include <sys/resource.h>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QProcess>
+#include <QTemporaryDir>
+
+#include "nodeEditor/FlowView.hpp"
+#include "nodes/DistanceFieldOutputDataModel.hpp"
+#include "GraphGenerator.hpp"
+#include "NodeModels.hpp"
+#include "OffscreenRenderer.hpp"
+#include "ShaderGenerator.hpp"
+
+/// \file main.cpp
+/// \brief Large graph benchmark. Generates a graph of each requested size and times creating it, propagating its data,
+///        generating and optionally compiling its shader, saving, loading and repainting the node editor view
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace
+{
+  using namespace hsitho;
+
+  ///
+  /// \brief peakRss Peak resident set size of the process so far in kilobytes
+  ///
+  long peakRss()
+  {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+  }
+
+  class Phases
+  {
+  public:
+    Phases(std::ostream &_out) : m_out(_out), m_first(true) {}
+
+    template<typename Op>
+    void time(const std::string &_name, Op &&_op)
+    {
+      QElapsedTimer timer;
+      timer.start();
+      _op();
+      double ms = timer.nsecsElapsed() / 1e6;
+      value(_name + "_ms", ms);
+      value(_name + "_peak_rss_kb", peakRss());
+      std::cerr << "  " << _name << ": " << ms << " ms\n";
+    }
+
+    template<typename T>
+    void value(const std::string &_name, const T &_value)
+    {
+      m_out << (m_first ? "" : ", ") << "\"" << _name << "\": " << _value;
+      m_first = false;
+    }
+
+  private:
+    std::ostream &m_out;
+    bool m_first;
+  };
+
+  std::shared_ptr<Node> addOutput(FlowScene &_scene)
+  {
+    return _scene.createNode(std::make_unique<DistanceFieldOutputDataModel>(), false, QUuid("ffffffff-ffff-ffff-ffff-ffffffffffff"));
+  }
+
+  ///
+  /// \brief runSize Runs every phase on a graph of one size and writes the results as a single line JSON object
+  ///
+  bool runSize(const QCommandLineParser &_parser, const bench::GraphOptions &_options, std::ostream &_out)
+  {
+    QTemporaryDir dir;
+    QString path = dir.path() + "/graph.flow";
+
+    std::ostringstream json;
+    json.imbue(std::locale::classic());
+    Phases phases(json);
+    phases.value("nodes_requested", _options.m_nodes);
+
+    FlowScene scene(nullptr);
+    auto output = addOutput(scene);
+    bench::GraphGenerator generator(scene, _options);
+    phases.time("creation", [&]() { generator.generate(output); });
+    phases.value("nodes", generator.nodeCount());
+    phases.value("connections", generator.connectionCount());
+
+    // Push the data of every source node through the whole graph again
+    auto nodes = scene.getNodes();
+    phases.time("propagation", [&]() {
+      for(auto &n : nodes)
+      {
+        bool source = true;
+        for(auto &c : n.second->nodeState().connection(PortType::In))
+          source = source && !c;
+        if(!source)
+          continue;
+        for(unsigned int i = 0; i < n.second->nodeDataModel()->nPorts(PortType::Out); ++i)
+          n.second->onDataUpdated(i);
+      }
+    });
+
+    ThreadPool pool;
+    ShaderGenerator shaderGenerator(pool, _parser.value("shaders").toStdString());
+    if(!shaderGenerator.isValid())
+    {
+      std::cerr << "Couldn't read shader.begin and shader.end from " << _parser.value("shaders").toStdString() << "\n";
+      return false;
+    }
+    std::string source;
+    phases.time("generate", [&]() { source = shaderGenerator.generate(nodes); });
+    phases.value("source_bytes", source.size());
+
+    if(_parser.isSet("gl"))
+    {
+      OffscreenRenderer renderer(_parser.value("shaders").toStdString());
+      std::string error, log;
+      if(!renderer.initialise(error))
+      {
+        std::cerr << error << "\n";
+        return false;
+      }
+      bool compiled = false;
+      phases.time("gl_compile", [&]() { compiled = renderer.setFragmentShader(source, log); });
+      phases.value("gl_compiled", compiled ? "true" : "false");
+    }
+
+    bool saved = false;
+    phases.time("save", [&]() { saved = scene.save(path); });
+    if(!saved)
+    {
+      std::cerr << "Couldn't write " << path.toStdString() << "\n";
+      return false;
+    }
+    phases.value("file_bytes", QFileInfo(path).size());
+
+    {
+      FlowScene loaded(nullptr);
+      addOutput(loaded);
+      bool ok = false;
+      phases.time("load", [&]() { ok = loaded.load(path); });
+      if(!ok)
+      {
+        std::cerr << "Couldn't load " << path.toStdString() << "\n";
+        return false;
+      }
+    }
+
+    FlowView view(&scene);
+    view.resize(1600, 1000);
+    phases.time("repaint", [&]() { view.grab(); });
+    view.fitInView(scene.itemsBoundingRect(), Qt::KeepAspectRatio);
+    phases.time("repaint_all", [&]() { view.grab(); });
+
+    _out << "{ " << json.str() << " }\n";
+    return true;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  QApplication app(argc, argv);
+  QApplication::setApplicationName("graph_bench");
+  std::locale::global(std::locale::classic());
+
+  hsitho::registerNodeModels();
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Generates large node graphs and times the editor and the compiler on them.");
+  parser.addHelpOption();
+  parser.addOption(QCommandLineOption(QStringList() << "o" << "output", "Write the results to a file instead of stdout.", "file"));
+  parser.addOption(QCommandLineOption("sizes", "Comma separated node counts.", "n,...", "1000,10000,100000"));
+  parser.addOption(QCommandLineOption("depth", "Levels of operations in each generated tree.", "levels", "6"));
+  parser.addOption(QCommandLineOption("fan-in", "Subtrees combined by each operation level.", "n", "2"));
+  parser.addOption(QCommandLineOption("copy-ratio", "Probability of a subtree being copied.", "p", "0.05"));
+  parser.addOption(QCommandLineOption("collapsed-ratio", "Probability of a subtree being collapsed.", "p", "0.02"));
+  parser.addOption(QCommandLineOption("seed", "Seed of the generator.", "n", "1"));
+  parser.addOption(QCommandLineOption("shaders", "Directory containing shader.begin, shader.end and screenQuad.vert.", "dir", "shaders"));
+  parser.addOption(QCommandLineOption("gl", "Also compile the generated shader, needs an OpenGL 4.1 context."));
+  parser.addOption(QCommandLineOption("size", "Run a single size in this process, used for the child processes.", "n"));
+  parser.process(app);
+
+  hsitho::bench::GraphOptions options;
+  bool ok[5];
+  options.m_depth = parser.value("depth").toUInt(&ok[0]);
+  options.m_fanIn = parser.value("fan-in").toUInt(&ok[1]);
+  options.m_copyRatio = parser.value("copy-ratio").toFloat(&ok[2]);
+  options.m_collapsedRatio = parser.value("collapsed-ratio").toFloat(&ok[3]);
+  options.m_seed = parser.value("seed").toUInt(&ok[4]);
+  if(!ok[0] || !ok[1] || !ok[2] || !ok[3] || !ok[4] || options.m_fanIn < 1)
+  {
+    std::cerr << "Invalid graph options\n";
+    return EXIT_FAILURE;
+  }
+
+  if(parser.isSet("size"))
+  {
+    options.m_nodes = parser.value("size").toUInt();
+    return runSize(parser, options, std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  // Every size runs in a fresh process, getrusage only reports the peak of the whole process
+  std::vector<std::string> results;
+  for(auto &size : parser.value("sizes").split(',', QString::SkipEmptyParts))
+  {
+    std::cerr << "Running " << size.trimmed().toStdString() << " nodes\n";
+    QStringList args = app.arguments().mid(1);
+    args << "--size" << size.trimmed();
+
+    QProcess child;
+    child.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    child.start(QApplication::applicationFilePath(), args);
+    if(!child.waitForFinished(-1) || child.exitStatus() != QProcess::NormalExit || child.exitCode() != 0)
+    {
+      std::cerr << "Run of " << size.toStdString() << " nodes failed\n";
+      return EXIT_FAILURE;
+    }
+    results.push_back(QString(child.readAllStandardOutput()).trimmed().toStdString());
+  }
+
+  std::ostringstream json;
+  json.imbue(std::locale::classic());
+  json << "{\n  \"depth\": " << options.m_depth << ",\n  \"fan_in\": " << options.m_fanIn
+       << ",\n  \"copy_ratio\": " << options.m_copyRatio << ",\n  \"collapsed_ratio\": " << options.m_collapsedRatio
+       << ",\n  \"seed\": " << options.m_seed << ",\n  \"runs\": [";
+  for(size_t i = 0; i < results.size(); ++i)
+    json << (i ? ",\n    " : "\n    ") << results[i];
+  json << "\n  ]\n}\n";
+
+  if(parser.isSet("output"))
+  {
+    std::ofstream file(parser.value("output").toStdString());
+    file << json.str();
+    if(!file.good())
+    {
+      std::cerr << "Couldn't write " << parser.value("output").toStdString() << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  else
+    std::cout << json.str();
+
+  return EXIT_SUCCESS;
+}
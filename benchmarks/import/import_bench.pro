@@ -0,0 +1,17 @@
+# Mesh import benchmark, reads a large mesh, builds its triangle hierarchy and bakes it into a distance volume at a few
+# resolutions and reports the time of every step as JSON. CPU only
+TARGET = import_bench
+DESTDIR = $$PWD/../..
+CONFIG += console thread
+CONFIG -= app_bundle
+
+include(../../hsitho.pri)
+
+INCLUDEPATH += ../common
+
+SOURCES += main.cpp \
+           ../common/BenchReport.cpp
+HEADERS += ../common/BenchReport.hpp
+
+OBJECTS_DIR = ./obj
+MOC_DIR = ./moc
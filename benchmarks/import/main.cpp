@@ -0,0 +1,247 @@
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <locale>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+
+#include <glm/gtc/constants.hpp>
+
+#include "sdf/MeshBaker.hpp"
+#include "sdf/TriangleBvh.hpp"
+#include "BenchReport.hpp"
+#include "MeshReader.hpp"
+#include "MeshWriter.hpp"
+#include "ThreadPool.hpp"
+
+/// \file main.cpp
+/// \brief Mesh import benchmark. A generated torus of about a million triangles, or the meshes given as arguments, goes
+///        through the steps of the Mesh Import node: reading the file, building the triangle hierarchy and baking the
+///        distance volume at each resolution. Reports the times of the steps and how many grid points needed a closest
+///        point query and a winding number, the rest were interpolated
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace
+{
+  using namespace hsitho;
+
+  struct Settings
+  {
+    std::vector<uint32_t> m_resolutions;
+    int m_repeats = 3;
+    unsigned int m_threads = 0;
+  };
+
+  struct Bake
+  {
+    uint32_t m_resolution = 0;
+    bench::Distribution m_time;
+    size_t m_points = 0;
+    size_t m_exactEvaluations = 0;
+    size_t m_windingQueries = 0;
+  };
+
+  struct MeshResult
+  {
+    std::string m_name;
+    size_t m_triangles = 0;
+    size_t m_points = 0;
+    double m_readMs = 0.0;
+    double m_bvhMs = 0.0;
+    std::vector<Bake> m_bakes;
+  };
+
+  ///
+  /// \brief torus Closed torus of radii 2 and 0.75 with about the given number of triangles, two per quad
+  ///
+  void torus(size_t _triangles, sdf::Mesh &_mesh)
+  {
+    uint32_t minor = std::max(3u, static_cast<uint32_t>(std::sqrt(_triangles / 8.0)));
+    uint32_t major = std::max(3u, static_cast<uint32_t>(_triangles / (2 * minor)));
+    const float tau = 2.f * glm::pi<float>();
+    _mesh.m_positions.reserve(static_cast<size_t>(major) * minor);
+    for(uint32_t i = 0; i < major; ++i)
+      for(uint32_t j = 0; j < minor; ++j)
+      {
+        float u = tau * i / major, v = tau * j / minor;
+        float r = 2.f + 0.75f * std::cos(v);
+        _mesh.m_positions.emplace_back(r * std::cos(u), 0.75f * std::sin(v), r * std::sin(u));
+      }
+    _mesh.m_indices.reserve(static_cast<size_t>(major) * minor * 6);
+    for(uint32_t i = 0; i < major; ++i)
+      for(uint32_t j = 0; j < minor; ++j)
+      {
+        uint32_t a = i * minor + j;
+        uint32_t b = (i + 1) % major * minor + j;
+        uint32_t c = (i + 1) % major * minor + (j + 1) % minor;
+        uint32_t d = i * minor + (j + 1) % minor;
+        uint32_t quad[6] = {a, d, c, a, c, b};
+        _mesh.m_indices.insert(_mesh.m_indices.end(), quad, quad + 6);
+      }
+  }
+
+  bool runMesh(const std::string &_name, const std::string &_path, const Settings &_settings, ThreadPool &_pool, MeshResult &_result, std::string &_error)
+  {
+    _result.m_name = _name;
+    sdf::Mesh mesh;
+    std::vector<glm::vec3> normals;
+    QElapsedTimer timer;
+    timer.start();
+    if(!readMesh(_path, mesh, normals, _error))
+      return false;
+    _result.m_readMs = timer.nsecsElapsed() / 1e6;
+    _result.m_triangles = mesh.m_indices.size() / 3;
+    _result.m_points = mesh.m_positions.size();
+
+    timer.restart();
+    sdf::TriangleBvh bvh(mesh);
+    _result.m_bvhMs = timer.nsecsElapsed() / 1e6;
+    std::cerr << "  read " << _result.m_readMs << " ms, hierarchy " << _result.m_bvhMs << " ms\n";
+
+    sdf::MeshBaker baker(_pool);
+    for(uint32_t resolution : _settings.m_resolutions)
+    {
+      Bake bake;
+      bake.m_resolution = resolution;
+      sdf::MeshBaker::Settings settings;
+      settings.m_resolution = resolution;
+      std::vector<double> times;
+      for(int i = 0; i < _settings.m_repeats; ++i)
+      {
+        sdf::DistanceVolume volume;
+        timer.restart();
+        if(!baker.bake(bvh, normals, settings, volume, _error))
+          return false;
+        times.push_back(timer.nsecsElapsed() / 1e6);
+        bake.m_points = volume.m_values.size();
+      }
+      bake.m_time = bench::summarise(times);
+      bake.m_exactEvaluations = baker.exactEvaluations();
+      bake.m_windingQueries = baker.windingQueries();
+      std::cerr << "  " << resolution << "^3: " << bake.m_time.m_median << " ms, " << bake.m_exactEvaluations << " of "
+                << bake.m_points << " points exact\n";
+      _result.m_bakes.push_back(bake);
+    }
+    return true;
+  }
+
+  void writeResults(std::ostream &_out, const Settings &_settings, unsigned int _threads, const std::vector<MeshResult> &_results)
+  {
+    _out << "{\n  \"threads\": " << _threads << ",\n  \"repeats\": " << _settings.m_repeats << ",\n  \"meshes\": [";
+    for(size_t i = 0; i < _results.size(); ++i)
+    {
+      const MeshResult &r = _results[i];
+      _out << (i ? ",\n" : "\n") << "    {\n      \"name\": \"" << r.m_name << "\",\n"
+           << "      \"triangles\": " << r.m_triangles << ",\n      \"points\": " << r.m_points << ",\n"
+           << "      \"read_ms\": " << r.m_readMs << ",\n      \"bvh_ms\": " << r.m_bvhMs << ",\n      \"bakes\": [";
+      for(size_t j = 0; j < r.m_bakes.size(); ++j)
+      {
+        const Bake &b = r.m_bakes[j];
+        _out << (j ? ",\n" : "\n") << "        {\"resolution\": " << b.m_resolution << ", \"bake_ms\": ";
+        bench::writeJson(_out, b.m_time);
+        _out << ", \"grid_points\": " << b.m_points << ", \"exact_evaluations\": " << b.m_exactEvaluations
+             << ", \"winding_queries\": " << b.m_windingQueries << "}";
+      }
+      _out << "\n      ]\n    }";
+    }
+    _out << "\n  ]\n}\n";
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("import_bench");
+  std::locale::global(std::locale::classic());
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Reads meshes and bakes them into distance volumes the way the Mesh Import node does.");
+  parser.addHelpOption();
+  parser.addPositionalArgument("meshes", "Additional .obj or .ply files to benchmark.", "[mesh.ply...]");
+  parser.addOption(QCommandLineOption(QStringList() << "o" << "output", "Write the results to a file instead of stdout.", "file"));
+  parser.addOption(QCommandLineOption("triangles", "Triangles of the generated torus, 0 to skip it.", "count", "1000000"));
+  parser.addOption(QCommandLineOption("resolutions", "Comma separated resolutions of the volume.", "n,...", "128,256"));
+  parser.addOption(QCommandLineOption("repeats", "Times each bake is run.", "count", "3"));
+  parser.addOption(QCommandLineOption("threads", "Threads, 0 for one per core.", "count", "0"));
+  parser.process(app);
+
+  Settings settings;
+  bool ok[3];
+  size_t triangles = parser.value("triangles").toULongLong(&ok[0]);
+  settings.m_repeats = parser.value("repeats").toInt(&ok[1]);
+  settings.m_threads = parser.value("threads").toUInt(&ok[2]);
+  if(!ok[0] || !ok[1] || !ok[2] || settings.m_repeats < 1)
+  {
+    std::cerr << "Invalid triangles, repeats or threads\n";
+    return EXIT_FAILURE;
+  }
+  for(auto &r : parser.value("resolutions").split(',', QString::SkipEmptyParts))
+  {
+    uint32_t resolution = r.toUInt(&ok[0]);
+    if(!ok[0] || resolution < 16 || resolution > 1024)
+    {
+      std::cerr << "Invalid resolution " << r.toStdString() << "\n";
+      return EXIT_FAILURE;
+    }
+    settings.m_resolutions.push_back(resolution);
+  }
+
+  hsitho::ThreadPool pool(settings.m_threads);
+  std::vector<MeshResult> results;
+  std::string error;
+  auto run = [&](const std::string &_name, const std::string &_path)
+  {
+    std::cerr << "Running " << _name << "\n";
+    MeshResult result;
+    if(!runMesh(_name, _path, settings, pool, result, error))
+    {
+      std::cerr << error << "\n";
+      return false;
+    }
+    results.push_back(result);
+    return true;
+  };
+
+  // The torus goes through a binary PLY file so reading is timed as well
+  if(triangles > 0)
+  {
+    hsitho::sdf::Mesh mesh;
+    torus(triangles, mesh);
+    std::string path = QDir::temp().filePath("import_bench_torus.ply").toStdString();
+    if(!hsitho::writeMesh(path, mesh, error))
+    {
+      std::cerr << error << "\n";
+      return EXIT_FAILURE;
+    }
+    bool ran = run("torus_" + std::to_string(mesh.m_indices.size() / 3), path);
+    QFile::remove(QString::fromStdString(path));
+    if(!ran)
+      return EXIT_FAILURE;
+  }
+  for(auto &file : parser.positionalArguments())
+    if(!run(QFileInfo(file).completeBaseName().toStdString(), file.toStdString()))
+      return EXIT_FAILURE;
+
+  if(parser.isSet("output"))
+  {
+    std::ofstream file(parser.value("output").toStdString());
+    file.imbue(std::locale::classic());
+    writeResults(file, settings, pool.size(), results);
+    if(!file.good())
+    {
+      std::cerr << "Couldn't write " << parser.value("output").toStdString() << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  else
+    writeResults(std::cout, settings, pool.size(), results);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,17 @@
+# Instancing benchmark, evaluates the distance to growing numbers of copies of a subtree and reports the time per sample
+# as JSON. CPU only
+TARGET = instance_bench
+DESTDIR = $$PWD/../..
+CONFIG += console thread
+CONFIG -= app_bundle
+
+include(../../hsitho.pri)
+
+INCLUDEPATH += ../common
+
+SOURCES += main.cpp \
+           ../common/BenchReport.cpp
+HEADERS += ../common/BenchReport.hpp
+
+OBJECTS_DIR = ./obj
+MOC_DIR = ./moc
@@ -0,0 +1,186 @@
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <locale>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+#include "sdf/Evaluator.hpp"
+#include "sdf/SceneCompiler.hpp"
+#include "BenchReport.hpp"
+#include "InstanceSources.hpp"
+
+/// \file main.cpp
+/// \brief Instancing benchmark. Copies of a small subtree are placed at random in a cube that grows with their number,
+///        so every count has the same number of copies per unit of volume, and the distance to all of them is
+///        evaluated at random points of the cube, in batches the way the mesher and the queries do and one point at a
+///        time. With the copies filed in a grid the time per sample should barely change from a hundred copies to a
+///        hundred thousand, the shader looks the copies up from the same grid
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace
+{
+  using namespace hsitho;
+
+  struct Settings
+  {
+    std::vector<unsigned int> m_counts;
+    size_t m_samples = 100000;
+    float m_spacing = 1.f;
+    int m_repeats = 5;
+  };
+
+  struct Run
+  {
+    unsigned int m_copies = 0;
+    glm::uvec3 m_cells = glm::uvec3(0);
+    float m_cellSize = 0.f;
+    double m_buildMs = 0.0;
+    bench::Distribution m_batchNs;
+    bench::Distribution m_singleNs;
+  };
+
+  const char *c_instance = "sdBox(_position, vec3(0.2, 0.2, 0.2), vec3(1.0, 1.0, 1.0))";
+
+  bool run(unsigned int _count, const Settings &_settings, Run &_run, std::string &_error)
+  {
+    _run.m_copies = _count;
+    float extent = 0.5f * std::cbrt(static_cast<float>(_count)) * _settings.m_spacing;
+    std::vector<glm::mat4> transforms;
+    randomInstances(_count, extent, 1, transforms);
+
+    QElapsedTimer timer;
+    timer.start();
+    std::shared_ptr<const sdf::InstanceSet> set = makeInstances(c_instance, {}, {}, transforms, 0.35f, _error);
+    if(!set)
+      return false;
+    _run.m_buildMs = timer.nsecsElapsed() / 1e6;
+    _run.m_cells = set->cells();
+    _run.m_cellSize = set->cellSize();
+
+    std::shared_ptr<const sdf::Program> program = sdf::SceneCompiler::compileMap(
+          "vec4 map(vec3 _position)\n{\n  return instances0(_position, vec3(1.0, 1.0, 1.0));\n}\n", _error, false, {}, {set});
+    if(!program)
+      return false;
+    sdf::Evaluator evaluator(program);
+
+    std::vector<float> x(_settings.m_samples), y(_settings.m_samples), z(_settings.m_samples), distance(_settings.m_samples);
+    for(size_t i = 0; i < _settings.m_samples; ++i)
+    {
+      x[i] = (2.f * randomUnit(2, i * 3) - 1.f) * extent;
+      y[i] = (2.f * randomUnit(2, i * 3 + 1) - 1.f) * extent;
+      z[i] = (2.f * randomUnit(2, i * 3 + 2) - 1.f) * extent;
+    }
+
+    std::vector<double> batch, single;
+    double sum = 0.0;
+    for(int r = 0; r < _settings.m_repeats; ++r)
+    {
+      timer.restart();
+      evaluator.evaluate(x.data(), y.data(), z.data(), _settings.m_samples, distance.data());
+      batch.push_back(static_cast<double>(timer.nsecsElapsed()) / _settings.m_samples);
+
+      timer.restart();
+      for(size_t i = 0; i < _settings.m_samples; ++i)
+        sum += evaluator.evaluate(glm::vec3(x[i], y[i], z[i])).x;
+      single.push_back(static_cast<double>(timer.nsecsElapsed()) / _settings.m_samples);
+    }
+    // Keeps the single point loop from being optimised away
+    if(std::isnan(sum))
+      std::cerr << "NaN distance\n";
+    _run.m_batchNs = bench::summarise(batch);
+    _run.m_singleNs = bench::summarise(single);
+    return true;
+  }
+
+  void writeResults(std::ostream &_out, const Settings &_settings, const std::vector<Run> &_runs)
+  {
+    _out << "{\n  \"samples\": " << _settings.m_samples << ",\n  \"spacing\": " << _settings.m_spacing
+         << ",\n  \"repeats\": " << _settings.m_repeats << ",\n  \"runs\": [";
+    for(size_t i = 0; i < _runs.size(); ++i)
+    {
+      const Run &r = _runs[i];
+      _out << (i ? ",\n" : "\n") << "    {\"copies\": " << r.m_copies << ", \"cells\": [" << r.m_cells.x << ", " << r.m_cells.y << ", "
+           << r.m_cells.z << "], \"cell_size\": " << r.m_cellSize << ", \"build_ms\": " << r.m_buildMs << ",\n     \"batch_ns\": ";
+      bench::writeJson(_out, r.m_batchNs);
+      _out << ",\n     \"single_ns\": ";
+      bench::writeJson(_out, r.m_singleNs);
+      _out << "}";
+    }
+    _out << "\n  ]\n}\n";
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("instance_bench");
+  std::locale::global(std::locale::classic());
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Evaluates the distance to growing numbers of copies of a subtree the way the Scatter node places them.");
+  parser.addHelpOption();
+  parser.addOption(QCommandLineOption(QStringList() << "o" << "output", "Write the results to a file instead of stdout.", "file"));
+  parser.addOption(QCommandLineOption("counts", "Comma separated numbers of copies.", "n,...", "100,1000,10000,100000"));
+  parser.addOption(QCommandLineOption("samples", "Points evaluated per repeat.", "count", "100000"));
+  parser.addOption(QCommandLineOption("spacing", "Average distance between neighbouring copies.", "distance", "1.0"));
+  parser.addOption(QCommandLineOption("repeats", "Times the points are evaluated.", "count", "5"));
+  parser.process(app);
+
+  Settings settings;
+  bool ok[3];
+  settings.m_samples = parser.value("samples").toULongLong(&ok[0]);
+  settings.m_spacing = parser.value("spacing").toFloat(&ok[1]);
+  settings.m_repeats = parser.value("repeats").toInt(&ok[2]);
+  if(!ok[0] || !ok[1] || !ok[2] || settings.m_samples < 1 || !(settings.m_spacing > 0.f) || settings.m_repeats < 1)
+  {
+    std::cerr << "Invalid samples, spacing or repeats\n";
+    return EXIT_FAILURE;
+  }
+  for(auto &c : parser.value("counts").split(',', QString::SkipEmptyParts))
+  {
+    unsigned int count = c.toUInt(&ok[0]);
+    if(!ok[0] || count < 1)
+    {
+      std::cerr << "Invalid count " << c.toStdString() << "\n";
+      return EXIT_FAILURE;
+    }
+    settings.m_counts.push_back(count);
+  }
+
+  std::vector<Run> runs;
+  std::string error;
+  for(unsigned int count : settings.m_counts)
+  {
+    std::cerr << "Running " << count << " copies\n";
+    Run r;
+    if(!run(count, settings, r, error))
+    {
+      std::cerr << error << "\n";
+      return EXIT_FAILURE;
+    }
+    std::cerr << "  " << r.m_cells.x << "x" << r.m_cells.y << "x" << r.m_cells.z << " cells, batches " << r.m_batchNs.m_median
+              << " ns, single points " << r.m_singleNs.m_median << " ns per sample\n";
+    runs.push_back(r);
+  }
+
+  if(parser.isSet("output"))
+  {
+    std::ofstream file(parser.value("output").toStdString());
+    file.imbue(std::locale::classic());
+    writeResults(file, settings, runs);
+    if(!file.good())
+    {
+      std::cerr << "Couldn't write " << parser.value("output").toStdString() << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  else
+    writeResults(std::cout, settings, runs);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,241 @@
+#include <fstream>
+#include <iostream>
+#include <locale>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+
+#include "sdf/Mesher.hpp"
+#include "BenchReport.hpp"
+#include "CliScene.hpp"
+#include "GraphGenerator.hpp"
+#include "NodeModels.hpp"
+#include "ReferenceScenes.hpp"
+#include "ThreadPool.hpp"
+
+/// \file main.cpp
+/// \brief Octree traversal benchmark. Every scene is compiled for the CPU and the octree of the mesher is refined over the
+///        bounds at each depth, once dropping cells by the distance at their centre and once by the interval bounds of
+///        the distance over them. Reports the traversal times and how many cells each pruning keeps per level, fewer
+///        cells at the finest level means less work for everything that follows
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace
+{
+  using namespace hsitho;
+
+  struct Settings
+  {
+    sdf::Mesher::Settings m_mesher;
+    std::vector<unsigned int> m_depths;
+    int m_repeats = 5;
+    unsigned int m_threads = 0;
+    std::string m_shaderDir = "shaders";
+  };
+
+  struct Run
+  {
+    unsigned int m_depth = 0;
+    std::string m_pruning;
+    bench::Distribution m_traversal;
+    std::vector<size_t> m_cells;
+    size_t m_evaluations = 0;
+    size_t m_triangles = 0;
+  };
+
+  struct SceneResult
+  {
+    std::string m_name;
+    size_t m_instructions = 0;
+    std::vector<Run> m_runs;
+  };
+
+  bool runScene(const std::string &_name, const std::string &_flow, size_t _nodes, const Settings &_settings, ThreadPool &_pool, SceneResult &_result, std::string &_error)
+  {
+    cli::CommonOptions options;
+    options.m_scene = _flow;
+    options.m_shaderDir = _settings.m_shaderDir;
+    options.m_cpu = true;
+    cli::Scene scene(options);
+    if(_flow.empty())
+    {
+      bench::buildScene(_name, _nodes, scene.flowScene(), scene.outputNode());
+      if(!scene.compile(_error))
+        return false;
+    }
+    else if(!scene.load(_error))
+      return false;
+
+    _result.m_name = _name;
+    _result.m_instructions = scene.program()->m_code.size();
+    sdf::Mesher mesher(scene.program(), _pool);
+    const std::pair<sdf::Mesher::Pruning, const char *> prunings[] = {
+      {sdf::Mesher::Pruning::DISTANCE, "distance"},
+      {sdf::Mesher::Pruning::INTERVAL, "interval"}
+    };
+
+    for(unsigned int depth : _settings.m_depths)
+    {
+      for(auto &pruning : prunings)
+      {
+        sdf::Mesher::Settings settings = _settings.m_mesher;
+        settings.m_depth = depth;
+        settings.m_pruning = pruning.first;
+        Run run;
+        run.m_depth = depth;
+        run.m_pruning = pruning.second;
+        std::vector<double> times;
+        for(int i = 0; i < _settings.m_repeats; ++i)
+        {
+          sdf::Mesh mesh;
+          if(!mesher.extract(settings, mesh, _error))
+            return false;
+          times.push_back(mesher.traversalTime());
+          run.m_triangles = mesh.m_indices.size() / 3;
+        }
+        run.m_traversal = bench::summarise(times);
+        run.m_cells = mesher.cellsPerLevel();
+        run.m_evaluations = mesher.evaluations();
+        std::cerr << "  depth " << depth << " " << pruning.second << ": " << run.m_traversal.m_median << " ms, "
+                  << run.m_cells.back() << " surface cells\n";
+        _result.m_runs.push_back(run);
+      }
+    }
+    return true;
+  }
+
+  void writeResults(std::ostream &_out, const Settings &_settings, unsigned int _threads, const std::vector<SceneResult> &_results)
+  {
+    const sdf::Mesher::Settings &m = _settings.m_mesher;
+    _out << "{\n  \"threads\": " << _threads << ",\n  \"repeats\": " << _settings.m_repeats << ",\n"
+         << "  \"min\": [" << m.m_min.x << ", " << m.m_min.y << ", " << m.m_min.z << "],\n"
+         << "  \"max\": [" << m.m_max.x << ", " << m.m_max.y << ", " << m.m_max.z << "],\n"
+         << "  \"scenes\": [";
+    for(size_t i = 0; i < _results.size(); ++i)
+    {
+      const SceneResult &r = _results[i];
+      _out << (i ? ",\n" : "\n") << "    {\n      \"name\": \"" << r.m_name << "\",\n"
+           << "      \"instructions\": " << r.m_instructions << ",\n      \"runs\": [";
+      for(size_t j = 0; j < r.m_runs.size(); ++j)
+      {
+        const Run &run = r.m_runs[j];
+        _out << (j ? ",\n" : "\n") << "        {\"depth\": " << run.m_depth << ", \"pruning\": \"" << run.m_pruning << "\", \"traversal_ms\": ";
+        bench::writeJson(_out, run.m_traversal);
+        _out << ", \"cells_per_level\": [";
+        for(size_t c = 0; c < run.m_cells.size(); ++c)
+          _out << (c ? ", " : "") << run.m_cells[c];
+        _out << "], \"evaluations\": " << run.m_evaluations << ", \"triangles\": " << run.m_triangles << "}";
+      }
+      _out << "\n      ]\n    }";
+    }
+    _out << "\n  ]\n}\n";
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  QApplication app(argc, argv);
+  QApplication::setApplicationName("octree_bench");
+  std::locale::global(std::locale::classic());
+
+  hsitho::registerNodeModels();
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Refines the octree of the mesher over the reference scenes and generated graphs with both prunings.");
+  parser.addHelpOption();
+  parser.addPositionalArgument("scenes", "Additional .flow files to benchmark.", "[scene.flow...]");
+  parser.addOption(QCommandLineOption(QStringList() << "o" << "output", "Write the results to a file instead of stdout.", "file"));
+  parser.addOption(QCommandLineOption("reference", "Run the reference scenes, all or none.", "all|none", "all"));
+  parser.addOption(QCommandLineOption("generated", "Comma separated node counts of generated graphs to run.", "n,...", "1000,10000"));
+  parser.addOption(QCommandLineOption("shaders", "Directory containing shader.begin, shader.end and screenQuad.vert.", "dir", "shaders"));
+  parser.addOption(QCommandLineOption("depths", "Comma separated octree depths.", "n,...", "6,8,10"));
+  parser.addOption(QCommandLineOption("min", "Lower corner of the bounds.", "x,y,z", "-10,-10,-10"));
+  parser.addOption(QCommandLineOption("max", "Upper corner of the bounds.", "x,y,z", "10,10,10"));
+  parser.addOption(QCommandLineOption("repeats", "Times each traversal is run.", "count", "5"));
+  parser.addOption(QCommandLineOption("threads", "Threads, 0 for one per core.", "count", "0"));
+  parser.process(app);
+
+  Settings settings;
+  settings.m_shaderDir = parser.value("shaders").toStdString();
+  bool ok[2];
+  settings.m_repeats = parser.value("repeats").toInt(&ok[0]);
+  settings.m_threads = parser.value("threads").toUInt(&ok[1]);
+  if(!ok[0] || !ok[1] || settings.m_repeats < 1 ||
+     !hsitho::cli::parseVec3(parser.value("min"), settings.m_mesher.m_min) || !hsitho::cli::parseVec3(parser.value("max"), settings.m_mesher.m_max))
+  {
+    std::cerr << "Invalid repeats, threads or bounds\n";
+    return EXIT_FAILURE;
+  }
+  for(auto &d : parser.value("depths").split(',', QString::SkipEmptyParts))
+  {
+    unsigned int depth = d.toUInt(&ok[0]);
+    if(!ok[0] || depth < 1 || depth > hsitho::sdf::Mesher::c_maxDepth)
+    {
+      std::cerr << "Invalid depth " << d.toStdString() << "\n";
+      return EXIT_FAILURE;
+    }
+    settings.m_depths.push_back(depth);
+  }
+  std::vector<size_t> generated;
+  for(auto &n : parser.value("generated").split(',', QString::SkipEmptyParts))
+  {
+    size_t nodes = n.toUInt(&ok[0]);
+    if(!ok[0] || nodes == 0)
+    {
+      std::cerr << "Invalid generated graph size " << n.toStdString() << "\n";
+      return EXIT_FAILURE;
+    }
+    generated.push_back(nodes);
+  }
+
+  hsitho::ThreadPool pool(settings.m_threads);
+  std::vector<SceneResult> results;
+  std::string error;
+  auto run = [&](const std::string &_name, const std::string &_flow, size_t _nodes)
+  {
+    std::cerr << "Running " << _name << "\n";
+    SceneResult result;
+    if(!runScene(_name, _flow, _nodes, settings, pool, result, error))
+    {
+      std::cerr << error << "\n";
+      return false;
+    }
+    results.push_back(result);
+    return true;
+  };
+
+  if(parser.value("reference") != "none")
+  {
+    for(auto &name : hsitho::bench::referenceSceneNames())
+      if(!run(name, "", 0))
+        return EXIT_FAILURE;
+  }
+  for(size_t nodes : generated)
+    if(!run("generated_" + std::to_string(nodes), "", nodes))
+      return EXIT_FAILURE;
+  for(auto &flow : parser.positionalArguments())
+    if(!run(QFileInfo(flow).completeBaseName().toStdString(), flow.toStdString(), 0))
+      return EXIT_FAILURE;
+
+  if(parser.isSet("output"))
+  {
+    std::ofstream file(parser.value("output").toStdString());
+    file.imbue(std::locale::classic());
+    writeResults(file, settings, pool.size(), results);
+    if(!file.good())
+    {
+      std::cerr << "Couldn't write " << parser.value("output").toStdString() << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  else
+    writeResults(std::cout, settings, pool.size(), results);
+
+  return EXIT_SUCCESS;
+}
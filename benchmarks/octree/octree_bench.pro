@@ -0,0 +1,24 @@
+# Octree traversal benchmark, refines the octree of the mesher over the reference scenes and large generated graphs
+# with the distance and the interval pruning and reports the time and the cells kept per level as JSON. CPU only
+TARGET = octree_bench
+DESTDIR = $$PWD/../..
+CONFIG += console thread
+CONFIG -= app_bundle
+
+include(../../hsitho.pri)
+
+INCLUDEPATH += ../common \
+               ../../tools/hsitho_cli
+
+SOURCES += main.cpp \
+           ../common/BenchReport.cpp \
+           ../common/GraphGenerator.cpp \
+           ../common/ReferenceScenes.cpp \
+           ../../tools/hsitho_cli/CliScene.cpp
+HEADERS += ../common/BenchReport.hpp \
+           ../common/GraphGenerator.hpp \
+           ../common/ReferenceScenes.hpp \
+           ../../tools/hsitho_cli/CliScene.hpp
+
+OBJECTS_DIR = ./obj
+MOC_DIR = ./moc
@@ -0,0 +1,255 @@
+#include <fstream>
+#include <iostream>
+#include <locale>
+#include <random>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFileInfo>
+
+#include "sdf/Picker.hpp"
+#include "sdf/SceneCompiler.hpp"
+#include "BenchReport.hpp"
+#include "CliScene.hpp"
+#include "GraphGenerator.hpp"
+#include "NodeModels.hpp"
+#include "ReferenceScenes.hpp"
+
+/// \file main.cpp
+/// \brief Picking benchmark. Every scene is compiled with primitive ids and single rays are traced through random pixels
+///        of the default camera, first with a fresh octree (cold, every pick refines the cells along its ray), then the
+///        same pixels again (warm, the cells are there) and finally with the whole program at every step, which is what
+///        picking would cost without the octree. The ids of the octree and the whole program are compared as well
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace
+{
+  using namespace hsitho;
+
+  struct Settings
+  {
+    sdf::Picker::Settings m_picker;
+    int m_width = 1280;
+    int m_height = 720;
+    int m_picks = 1000;
+    unsigned int m_seed = 1;
+    std::string m_shaderDir = "shaders";
+  };
+
+  struct SceneResult
+  {
+    std::string m_name;
+    size_t m_primitives = 0;
+    size_t m_instructions = 0;
+    double m_compileMs = 0.0;
+    bench::Distribution m_cold;
+    bench::Distribution m_warm;
+    bench::Distribution m_whole;
+    size_t m_cells = 0;
+    double m_steps = 0.0;
+    double m_instructionsPerPick = 0.0;
+    size_t m_hits = 0;
+    size_t m_mismatches = 0;
+  };
+
+  bool runScene(const std::string &_name, const std::string &_flow, size_t _nodes, const Settings &_settings, SceneResult &_result, std::string &_error)
+  {
+    cli::CommonOptions options;
+    options.m_scene = _flow;
+    options.m_shaderDir = _settings.m_shaderDir;
+    options.m_cpu = true;
+    cli::Scene scene(options);
+    if(_flow.empty())
+    {
+      bench::buildScene(_name, _nodes, scene.flowScene(), scene.outputNode());
+      if(!scene.compile(_error))
+        return false;
+    }
+    else if(!scene.load(_error))
+      return false;
+
+    QElapsedTimer timer;
+    timer.start();
+    std::shared_ptr<sdf::Program> program = sdf::SceneCompiler::compile(scene.generator(), scene.flowScene().getNodes(), _error, true);
+    if(!program)
+      return false;
+    _result.m_name = _name;
+    _result.m_compileMs = timer.nsecsElapsed() / 1e6;
+    _result.m_primitives = scene.generator().primitives().size();
+    _result.m_instructions = program->m_code.size();
+
+    std::mt19937 rng(_settings.m_seed);
+    std::uniform_real_distribution<float> x(0.f, static_cast<float>(_settings.m_width));
+    std::uniform_real_distribution<float> y(0.f, static_cast<float>(_settings.m_height));
+    std::vector<glm::vec3> rays;
+    for(int i = 0; i < _settings.m_picks; ++i)
+      rays.push_back(sdf::Picker::cameraRay(options.m_eye, options.m_up, x(rng), y(rng), _settings.m_width, _settings.m_height));
+
+    // A depth of 0 leaves only the root, which is the whole program over the bounds
+    sdf::Picker::Settings whole = _settings.m_picker;
+    whole.m_depth = 0;
+    sdf::Picker picker(program, _settings.m_picker);
+    sdf::Picker reference(program, whole);
+    picker.setTime(options.m_time);
+    reference.setTime(options.m_time);
+
+    std::vector<double> cold, warm, brute;
+    std::vector<uint32_t> ids;
+    for(auto &ray : rays)
+    {
+      timer.restart();
+      sdf::Picker::Hit hit = picker.pick(options.m_eye, ray);
+      cold.push_back(timer.nsecsElapsed() / 1e6);
+      ids.push_back(hit.m_primitive);
+      _result.m_hits += hit.m_hit;
+    }
+    for(auto &ray : rays)
+    {
+      timer.restart();
+      picker.pick(options.m_eye, ray);
+      warm.push_back(timer.nsecsElapsed() / 1e6);
+      _result.m_steps += picker.steps();
+      _result.m_instructionsPerPick += picker.instructions();
+    }
+    for(size_t i = 0; i < rays.size(); ++i)
+    {
+      timer.restart();
+      sdf::Picker::Hit hit = reference.pick(options.m_eye, rays[i]);
+      brute.push_back(timer.nsecsElapsed() / 1e6);
+      // Primitives touching each other can both be within the precision of the same hit
+      _result.m_mismatches += hit.m_primitive != ids[i];
+    }
+
+    _result.m_cold = bench::summarise(cold);
+    _result.m_warm = bench::summarise(warm);
+    _result.m_whole = bench::summarise(brute);
+    _result.m_cells = picker.cellCount();
+    _result.m_steps /= rays.size();
+    _result.m_instructionsPerPick /= rays.size();
+    std::cerr << "  " << _result.m_primitives << " primitives, cold " << _result.m_cold.m_median << " ms, warm " << _result.m_warm.m_median
+              << " ms, whole program " << _result.m_whole.m_median << " ms (medians)\n";
+    return true;
+  }
+
+  void writeResults(std::ostream &_out, const Settings &_settings, const std::vector<SceneResult> &_results)
+  {
+    _out << "{\n  \"width\": " << _settings.m_width << ",\n  \"height\": " << _settings.m_height << ",\n"
+         << "  \"picks\": " << _settings.m_picks << ",\n  \"depth\": " << _settings.m_picker.m_depth << ",\n"
+         << "  \"scenes\": [";
+    for(size_t i = 0; i < _results.size(); ++i)
+    {
+      const SceneResult &r = _results[i];
+      _out << (i ? ",\n" : "\n") << "    {\n      \"name\": \"" << r.m_name << "\",\n"
+           << "      \"primitives\": " << r.m_primitives << ",\n      \"instructions\": " << r.m_instructions << ",\n"
+           << "      \"compile_ms\": " << r.m_compileMs << ",\n      \"cold_ms\": ";
+      bench::writeJson(_out, r.m_cold);
+      _out << ",\n      \"warm_ms\": ";
+      bench::writeJson(_out, r.m_warm);
+      _out << ",\n      \"whole_program_ms\": ";
+      bench::writeJson(_out, r.m_whole);
+      _out << ",\n      \"cells\": " << r.m_cells << ",\n      \"steps_mean\": " << r.m_steps
+           << ",\n      \"instructions_mean\": " << r.m_instructionsPerPick << ",\n      \"hits\": " << r.m_hits
+           << ",\n      \"mismatches\": " << r.m_mismatches << "\n    }";
+    }
+    _out << "\n  ]\n}\n";
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  QApplication app(argc, argv);
+  QApplication::setApplicationName("pick_bench");
+  std::locale::global(std::locale::classic());
+
+  hsitho::registerNodeModels();
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Times picking single rays through random pixels of the reference scenes and generated graphs.");
+  parser.addHelpOption();
+  parser.addPositionalArgument("scenes", "Additional .flow files to benchmark.", "[scene.flow...]");
+  parser.addOption(QCommandLineOption(QStringList() << "o" << "output", "Write the results to a file instead of stdout.", "file"));
+  parser.addOption(QCommandLineOption("reference", "Run the reference scenes, all or none.", "all|none", "all"));
+  parser.addOption(QCommandLineOption("generated", "Comma separated node counts of generated graphs to run.", "n,...", "1000,10000"));
+  parser.addOption(QCommandLineOption("shaders", "Directory containing shader.begin, shader.end and screenQuad.vert.", "dir", "shaders"));
+  parser.addOption(QCommandLineOption("width", "Width of the image the pixels are picked from.", "pixels", "1280"));
+  parser.addOption(QCommandLineOption("height", "Height of the image the pixels are picked from.", "pixels", "720"));
+  parser.addOption(QCommandLineOption("picks", "Random pixels picked per scene.", "count", "1000"));
+  parser.addOption(QCommandLineOption("depth", "Deepest level of the octree.", "n", "7"));
+  parser.addOption(QCommandLineOption("seed", "Seed of the random pixels.", "n", "1"));
+  parser.process(app);
+
+  Settings settings;
+  settings.m_shaderDir = parser.value("shaders").toStdString();
+  bool ok[5];
+  settings.m_width = parser.value("width").toInt(&ok[0]);
+  settings.m_height = parser.value("height").toInt(&ok[1]);
+  settings.m_picks = parser.value("picks").toInt(&ok[2]);
+  settings.m_picker.m_depth = parser.value("depth").toUInt(&ok[3]);
+  settings.m_seed = parser.value("seed").toUInt(&ok[4]);
+  if(!ok[0] || !ok[1] || !ok[2] || !ok[3] || !ok[4] || settings.m_width < 1 || settings.m_height < 1 || settings.m_picks < 1 || settings.m_picker.m_depth > 16)
+  {
+    std::cerr << "Invalid size, picks, depth or seed\n";
+    return EXIT_FAILURE;
+  }
+  std::vector<size_t> generated;
+  for(auto &n : parser.value("generated").split(',', QString::SkipEmptyParts))
+  {
+    size_t nodes = n.toUInt(&ok[0]);
+    if(!ok[0] || nodes == 0)
+    {
+      std::cerr << "Invalid generated graph size " << n.toStdString() << "\n";
+      return EXIT_FAILURE;
+    }
+    generated.push_back(nodes);
+  }
+
+  std::vector<SceneResult> results;
+  std::string error;
+  auto run = [&](const std::string &_name, const std::string &_flow, size_t _nodes)
+  {
+    std::cerr << "Running " << _name << "\n";
+    SceneResult result;
+    if(!runScene(_name, _flow, _nodes, settings, result, error))
+    {
+      std::cerr << error << "\n";
+      return false;
+    }
+    results.push_back(result);
+    return true;
+  };
+
+  if(parser.value("reference") != "none")
+  {
+    for(auto &name : hsitho::bench::referenceSceneNames())
+      if(!run(name, "", 0))
+        return EXIT_FAILURE;
+  }
+  for(size_t nodes : generated)
+    if(!run("generated_" + std::to_string(nodes), "", nodes))
+      return EXIT_FAILURE;
+  for(auto &flow : parser.positionalArguments())
+    if(!run(QFileInfo(flow).completeBaseName().toStdString(), flow.toStdString(), 0))
+      return EXIT_FAILURE;
+
+  if(parser.isSet("output"))
+  {
+    std::ofstream file(parser.value("output").toStdString());
+    file.imbue(std::locale::classic());
+    writeResults(file, settings, results);
+    if(!file.good())
+    {
+      std::cerr << "Couldn't write " << parser.value("output").toStdString() << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  else
+    writeResults(std::cout, settings, results);
+
+  return EXIT_SUCCESS;
+}
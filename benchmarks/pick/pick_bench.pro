@@ -0,0 +1,24 @@
+# Picking benchmark, traces single rays through random pixels of the reference scenes and large generated graphs with
+# the octree of shortened programs and with the whole program and reports the times as JSON. CPU only
+TARGET = pick_bench
+DESTDIR = $$PWD/../..
+CONFIG += console thread
+CONFIG -= app_bundle
+
+include(../../hsitho.pri)
+
+INCLUDEPATH += ../common \
+               ../../tools/hsitho_cli
+
+SOURCES += main.cpp \
+           ../common/BenchReport.cpp \
+           ../common/GraphGenerator.cpp \
+           ../common/ReferenceScenes.cpp \
+           ../../tools/hsitho_cli/CliScene.cpp
+HEADERS += ../common/BenchReport.hpp \
+           ../common/GraphGenerator.hpp \
+           ../common/ReferenceScenes.hpp \
+           ../../tools/hsitho_cli/CliScene.hpp
+
+OBJECTS_DIR = ./obj
+MOC_DIR = ./moc
@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <locale>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+
+#include "BenchReport.hpp"
+#include "CliScene.hpp"
+#include "GpuTimer.hpp"
+#include "NodeModels.hpp"
+#include "ReferenceScenes.hpp"
+
+/// \file main.cpp
+/// \brief Render benchmark. Every scene is compiled a few times and then rendered along an orbit and a zoom camera path,
+///        the frame times are measured with timer queries and written out as percentiles. The paths only depend on the
+///        frame index so runs on different machines and commits render exactly the same frames
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace
+{
+  using namespace hsitho;
+
+  struct Settings
+  {
+    int m_width = 640;
+    int m_height = 360;
+    int m_frames = 120;
+    int m_warmup = 10;
+    int m_compiles = 5;
+    std::string m_shaderDir = "shaders";
+  };
+
+  // Same distance and elevation as the default camera of the scene view
+  const glm::vec3 c_defaultDir(0.f, 0.132164f, 0.991228f);
+  const float c_defaultDistance = 15.f;
+
+  ///
+  /// \brief orbitCamera Camera circling the origin once over the path at the default distance and height
+  ///
+  glm::vec3 orbitCamera(int _frame, int _frames)
+  {
+    float angle = 2.f * static_cast<float>(M_PI) * _frame / _frames;
+    float r = c_defaultDistance * c_defaultDir.z;
+    return glm::vec3(r * std::sin(angle), c_defaultDistance * c_defaultDir.y, r * std::cos(angle));
+  }
+
+  ///
+  /// \brief zoomCamera Camera moving from far away to close up along the default view direction,
+  ///        close ups are the expensive case since most rays hit something
+  ///
+  glm::vec3 zoomCamera(int _frame, int _frames)
+  {
+    float t = _frames > 1 ? static_cast<float>(_frame) / (_frames - 1) : 0.f;
+    return c_defaultDir * (30.f + (4.f - 30.f) * t);
+  }
+
+  typedef glm::vec3 (*CameraPath)(int, int);
+
+  struct PathResult
+  {
+    std::string m_name;
+    bench::Distribution m_gpu;
+    bench::Distribution m_wall;
+  };
+
+  struct SceneResult
+  {
+    std::string m_name;
+    std::string m_renderer;
+    size_t m_sourceSize = 0;
+    bench::Distribution m_generate;
+    bench::Distribution m_compile;
+    std::vector<PathResult> m_paths;
+  };
+
+  bool runPath(cli::Scene &_scene, const Settings &_settings, const std::string &_name, CameraPath _path, PathResult &_result)
+  {
+    OffscreenRenderer &renderer = _scene.renderer();
+    GpuTimer timer(8);
+    timer.init();
+
+    for(int i = 0; i < _settings.m_warmup; ++i)
+    {
+      renderer.setCamera(_path(0, _settings.m_frames), glm::vec3(0.f, 1.f, 0.f));
+      if(!renderer.renderFrame(_settings.m_width, _settings.m_height))
+        return false;
+    }
+
+    std::vector<double> gpu, wall;
+    QElapsedTimer clock;
+    for(int i = 0; i < _settings.m_frames; ++i)
+    {
+      renderer.setCamera(_path(i, _settings.m_frames), glm::vec3(0.f, 1.f, 0.f));
+      clock.start();
+      if(!renderer.renderFrame(_settings.m_width, _settings.m_height, &timer))
+        return false;
+      wall.push_back(clock.nsecsElapsed() / 1e6);
+
+      // renderFrame waits for the GPU, so the query of this frame is already available
+      float ms;
+      while(timer.poll(ms))
+        gpu.push_back(ms);
+    }
+
+    _result.m_name = _name;
+    _result.m_gpu = bench::summarise(gpu);
+    _result.m_wall = bench::summarise(wall);
+    return true;
+  }
+
+  bool runScene(const std::string &_name, const std::string &_flow, const Settings &_settings, SceneResult &_result, std::string &_error)
+  {
+    cli::CommonOptions options;
+    options.m_scene = _flow;
+    options.m_shaderDir = _settings.m_shaderDir;
+    cli::Scene scene(options);
+
+    if(_flow.empty())
+    {
+      bench::buildReferenceScene(_name, scene.flowScene(), scene.outputNode());
+      if(!scene.compile(_error))
+        return false;
+    }
+    else if(!scene.load(_error))
+      return false;
+
+    std::vector<double> generate{scene.generateTime()}, compile{scene.compileTime()};
+    for(int i = 1; i < _settings.m_compiles; ++i)
+    {
+      if(!scene.compile(_error))
+        return false;
+      generate.push_back(scene.generateTime());
+      compile.push_back(scene.compileTime());
+    }
+
+    _result.m_name = _name;
+    _result.m_renderer = reinterpret_cast<const char *>(QOpenGLContext::currentContext()->functions()->glGetString(GL_RENDERER));
+    _result.m_sourceSize = scene.fragmentShader().size();
+    _result.m_generate = bench::summarise(generate);
+    _result.m_compile = bench::summarise(compile);
+
+    if(_settings.m_width > scene.renderer().maxSize() || _settings.m_height > scene.renderer().maxSize())
+    {
+      _error = "Frame larger than the largest supported framebuffer";
+      return false;
+    }
+
+    _result.m_paths.resize(2);
+    if(!runPath(scene, _settings, "orbit", orbitCamera, _result.m_paths[0]) ||
+       !runPath(scene, _settings, "zoom", zoomCamera, _result.m_paths[1]))
+    {
+      _error = "Couldn't render " + _name;
+      return false;
+    }
+    return true;
+  }
+
+  void writeResults(std::ostream &_out, const Settings &_settings, const std::vector<SceneResult> &_results)
+  {
+    // Every scene gets its own context, they all come from the same driver
+    _out << "{\n  \"renderer\": \"" << (_results.empty() ? std::string() : _results[0].m_renderer) << "\",\n"
+         << "  \"width\": " << _settings.m_width << ",\n"
+         << "  \"height\": " << _settings.m_height << ",\n"
+         << "  \"frames\": " << _settings.m_frames << ",\n"
+         << "  \"scenes\": [";
+    for(size_t i = 0; i < _results.size(); ++i)
+    {
+      const SceneResult &r = _results[i];
+      _out << (i ? ",\n" : "\n") << "    {\n      \"name\": \"" << r.m_name << "\",\n"
+           << "      \"source_bytes\": " << r.m_sourceSize << ",\n      \"generate_ms\": ";
+      bench::writeJson(_out, r.m_generate);
+      _out << ",\n      \"compile_ms\": ";
+      bench::writeJson(_out, r.m_compile);
+      _out << ",\n      \"paths\": {";
+      for(size_t p = 0; p < r.m_paths.size(); ++p)
+      {
+        _out << (p ? ",\n" : "\n") << "        \"" << r.m_paths[p].m_name << "\": {\n          \"gpu_ms\": ";
+        bench::writeJson(_out, r.m_paths[p].m_gpu);
+        _out << ",\n          \"wall_ms\": ";
+        bench::writeJson(_out, r.m_paths[p].m_wall);
+        _out << "\n        }";
+      }
+      _out << "\n      }\n    }";
+    }
+    _out << "\n  ]\n}\n";
+  }
+
+  bool readInt(const QCommandLineParser &_parser, const QString &_name, int _min, int &_value)
+  {
+    bool ok;
+    _value = _parser.value(_name).toInt(&ok);
+    if(!ok || _value < _min)
+    {
+      std::cerr << "Invalid --" << _name.toStdString() << "\n";
+      return false;
+    }
+    return true;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  // Mesa would otherwise serve every compile after the first from its disk cache
+  if(qgetenv("MESA_SHADER_CACHE_DISABLE").isEmpty())
+    qputenv("MESA_SHADER_CACHE_DISABLE", "true");
+
+  QApplication app(argc, argv);
+  QApplication::setApplicationName("render_bench");
+  std::locale::global(std::locale::classic());
+
+  hsitho::registerNodeModels();
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Renders the reference scenes along fixed camera paths and reports the frame times.");
+  parser.addHelpOption();
+  parser.addPositionalArgument("scenes", "Additional .flow files to benchmark.", "[scene.flow...]");
+  parser.addOption(QCommandLineOption(QStringList() << "o" << "output", "Write the results to a file instead of stdout.", "file"));
+  parser.addOption(QCommandLineOption("reference", "Comma separated reference scenes to run, or none.", "names", "all"));
+  parser.addOption(QCommandLineOption("shaders", "Directory containing shader.begin, shader.end and screenQuad.vert.", "dir", "shaders"));
+  parser.addOption(QCommandLineOption("width", "Width of the frames.", "pixels", "640"));
+  parser.addOption(QCommandLineOption("height", "Height of the frames.", "pixels", "360"));
+  parser.addOption(QCommandLineOption("frames", "Frames measured per camera path.", "count", "120"));
+  parser.addOption(QCommandLineOption("warmup", "Frames rendered before measuring each path.", "count", "10"));
+  parser.addOption(QCommandLineOption("compiles", "Times each scene is compiled.", "count", "5"));
+  parser.addOption(QCommandLineOption("write-scenes", "Save the reference scenes as .flow files into a directory and exit.", "dir"));
+  parser.process(app);
+
+  Settings settings;
+  settings.m_shaderDir = parser.value("shaders").toStdString();
+  if(!readInt(parser, "width", 1, settings.m_width) || !readInt(parser, "height", 1, settings.m_height) ||
+     !readInt(parser, "frames", 1, settings.m_frames) || !readInt(parser, "warmup", 0, settings.m_warmup) ||
+     !readInt(parser, "compiles", 1, settings.m_compiles))
+    return EXIT_FAILURE;
+
+  std::vector<std::string> reference;
+  QString names = parser.value("reference");
+  if(names == "all")
+    reference = hsitho::bench::referenceSceneNames();
+  else if(names != "none")
+  {
+    std::vector<std::string> known = hsitho::bench::referenceSceneNames();
+    for(auto &n : names.split(',', QString::SkipEmptyParts))
+    {
+      if(std::find(known.begin(), known.end(), n.toStdString()) == known.end())
+      {
+        std::cerr << "Unknown reference scene " << n.toStdString() << "\n";
+        return EXIT_FAILURE;
+      }
+      reference.push_back(n.toStdString());
+    }
+  }
+
+  if(parser.isSet("write-scenes"))
+  {
+    QDir dir(parser.value("write-scenes"));
+    dir.mkpath(".");
+    for(auto &name : reference)
+    {
+      hsitho::cli::Scene scene(hsitho::cli::CommonOptions{});
+      hsitho::bench::buildReferenceScene(name, scene.flowScene(), scene.outputNode());
+      QString path = dir.filePath(QString::fromStdString(name) + ".flow");
+      if(!scene.flowScene().save(path))
+      {
+        std::cerr << "Couldn't write " << path.toStdString() << "\n";
+        return EXIT_FAILURE;
+      }
+    }
+    return EXIT_SUCCESS;
+  }
+
+  std::vector<SceneResult> results;
+  std::string error;
+  auto run = [&](const std::string &_name, const std::string &_flow)
+  {
+    std::cerr << "Running " << _name << "\n";
+    SceneResult result;
+    if(!runScene(_name, _flow, settings, result, error))
+      return false;
+    results.push_back(result);
+    return true;
+  };
+
+  for(auto &name : reference)
+    if(!run(name, ""))
+    {
+      std::cerr << error << "\n";
+      return EXIT_FAILURE;
+    }
+  for(auto &flow : parser.positionalArguments())
+    if(!run(QFileInfo(flow).completeBaseName().toStdString(), flow.toStdString()))
+    {
+      std::cerr << error << "\n";
+      return EXIT_FAILURE;
+    }
+
+  if(parser.isSet("output"))
+  {
+    std::ofstream file(parser.value("output").toStdString());
+    file.imbue(std::locale::classic());
+    writeResults(file, settings, results);
+    if(!file.good())
+    {
+      std::cerr << "Couldn't write " << parser.value("output").toStdString() << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  else
+    writeResults(std::cout, settings, results);
+
+  return EXIT_SUCCESS;
+}
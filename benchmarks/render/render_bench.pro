@@ -0,0 +1,22 @@
+# Render benchmark, plays fixed camera paths over the reference scenes and reports GPU frame times as JSON
+# Runs headless, e.g. on Mesa llvmpipe: QT_QPA_PLATFORM=offscreen ./render_bench -o render.json
+TARGET = render_bench
+DESTDIR = $$PWD/../..
+CONFIG += console thread
+CONFIG -= app_bundle
+
+include(../../hsitho.pri)
+
+INCLUDEPATH += ../common \
+               ../../tools/hsitho_cli
+
+SOURCES += main.cpp \
+           ../common/BenchReport.cpp \
+           ../common/ReferenceScenes.cpp \
+           ../../tools/hsitho_cli/CliScene.cpp
+HEADERS += ../common/BenchReport.hpp \
+           ../common/ReferenceScenes.hpp \
+           ../../tools/hsitho_cli/CliScene.hpp
+
+OBJECTS_DIR = ./obj
+MOC_DIR = ./moc
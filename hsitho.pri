@@ -0,0 +1,36 @@
+# Everything but the entry point of the editor, shared with the headless tools
+CONFIG += c++1z
+
+# QT Specific
+QT += gui
+QT += widgets
+QT += opengl
+QT += core
+
+# Project specific files
+SOURCES += $$files($$PWD/src/*.cpp) \
+           $$files($$PWD/src/nodes/*.cpp) \
+           $$files($$PWD/src/sdf/*.cpp) \
+           $$files($$PWD/nodeEditor/*.cpp)
+SOURCES -= $$PWD/src/main.cpp
+HEADERS += $$files($$PWD/include/*.hpp) \
+           $$files($$PWD/include/nodes/*.hpp) \
+           $$files($$PWD/include/sdf/*.hpp) \
+           $$files($$PWD/nodeEditor/*.hpp)
+
+FORMS += $$PWD/ui/mainwindow.ui
+
+INCLUDEPATH += $$PWD $$PWD/include \
+               $$PWD/include/nodes \
+               $$PWD/nodeEditor \
+               /usr/local/include
+
+DEFINES += NODE_EDITOR_SHARED
+
+QMAKE_CXXFLAGS_WARN_ON += -Wno-unused-parameter \
+                          -Wno-unused-function
+
+# qmake CONFIG+=hsitho_profile compiles in the profiler zones, see include/Profiler.hpp
+hsitho_profile: DEFINES += HSITHO_PROFILE
+# qmake CONFIG+=hsitho_alloc counts the allocations of every compile by stage, see include/AllocationTracker.hpp
+hsitho_alloc: DEFINES += HSITHO_TRACK_ALLOCATIONS
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/// \file AllocationTracker.hpp
+/// \brief Opt-in accounting of heap allocations by pipeline stage. When the project is built with HSITHO_TRACK_ALLOCATIONS
+///        defined (qmake CONFIG+=hsitho_alloc) the global operator new and delete are replaced and every allocation is tagged
+///        with the stage active on its thread, the innermost HSITHO_ALLOC_STAGE scope. Frees are attributed to the stage that
+///        made the allocation, so the live and peak live bytes of a stage are the memory it is holding on to.
+///        Without the define the scopes compile to nothing and nothing is counted
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  enum class AllocationStage : unsigned int
+  {
+    OTHER,
+    EVALUATE,
+    MATRIX,
+    CODEGEN,
+    UNKNOWNS,
+    SERIALISATION,
+    COUNT
+  };
+
+  class AllocationTracker
+  {
+  public:
+    struct StageStats
+    {
+      size_t m_count = 0;
+      size_t m_bytes = 0;
+      size_t m_frees = 0;
+      ///
+      /// \brief m_live Bytes allocated by the stage and not freed yet
+      ///
+      int64_t m_live = 0;
+      ///
+      /// \brief m_peakLive Highest m_live since the last beginCompile
+      ///
+      int64_t m_peakLive = 0;
+    };
+
+    static constexpr bool compiledIn()
+    {
+#ifdef HSITHO_TRACK_ALLOCATIONS
+      return true;
+#else
+      return false;
+#endif
+    }
+
+    ///
+    /// \brief stage Stage of the calling thread
+    ///
+    static AllocationStage stage();
+    ///
+    /// \brief setStage Sets the stage of the calling thread, use HSITHO_ALLOC_STAGE instead
+    ///
+    static void setStage(AllocationStage _stage);
+    ///
+    /// \brief stageName Name of a stage for the reports
+    ///
+    static const char *stageName(AllocationStage _stage);
+
+    ///
+    /// \brief beginCompile Resets the counts and the peaks, the live bytes carry over
+    ///
+    static void beginCompile();
+    ///
+    /// \brief snapshot Statistics of every stage, indexed by AllocationStage, plus the total as the last entry
+    ///
+    static std::vector<StageStats> snapshot();
+    ///
+    /// \brief total Statistics of all the stages together, unlike snapshot it doesn't allocate
+    ///
+    static StageStats total();
+    ///
+    /// \brief report Writes the statistics since the last beginCompile as a table
+    /// \param _out Stream to write to
+    ///
+    static void report(std::ostream &_out);
+
+    ///
+    /// \brief recordAllocation Called by the replaced operator new
+    ///
+    static void recordAllocation(AllocationStage _stage, size_t _bytes);
+    ///
+    /// \brief recordFree Called by the replaced operator delete
+    ///
+    static void recordFree(AllocationStage _stage, size_t _bytes);
+  };
+
+  ///
+  /// \brief The AllocationStageScope class tags the allocations of the calling thread with a stage while it's alive
+  ///
+  class AllocationStageScope
+  {
+  public:
+    AllocationStageScope(AllocationStage _stage) :
+      m_previous(AllocationTracker::stage())
+    {
+      AllocationTracker::setStage(_stage);
+    }
+    ~AllocationStageScope() { AllocationTracker::setStage(m_previous); }
+
+  private:
+    AllocationStage m_previous;
+  };
+}
+
+#define HSITHO_ALLOC_CONCAT_(a, b) a##b
+#define HSITHO_ALLOC_CONCAT(a, b) HSITHO_ALLOC_CONCAT_(a, b)
+
+#ifdef HSITHO_TRACK_ALLOCATIONS
+  #define HSITHO_ALLOC_STAGE(stage) hsitho::AllocationStageScope HSITHO_ALLOC_CONCAT(allocStage_, __LINE__)(hsitho::AllocationStage::stage)
+#else
+  #define HSITHO_ALLOC_STAGE(stage) do {} while(0)
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+/// \file CompileArena.hpp
+/// \brief Monotonic arena for the temporaries of a single compile pass. While a CompileArena is alive on a thread the
+///        expression terms, code fragments and matrix rows built during the pass are carved out of one growing buffer
+///        instead of going to the heap one by one, and all of it is dropped at once when the compile ends.
+///        Nothing allocated from the arena may outlive it, so only containers local to the pass use it, results are
+///        still returned as std::string
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  template <typename T>
+  using ArenaVector = std::pmr::vector<T>;
+  using ArenaString = std::pmr::string;
+
+  class CompileArena
+  {
+  public:
+    ///
+    /// \brief CompileArena Makes this the arena of the calling thread until it's destroyed
+    /// \param _initialSize Size of the first block, later blocks grow geometrically from the heap
+    ///
+    explicit CompileArena(size_t _initialSize = 64 * 1024);
+    ///
+    /// \brief ~CompileArena Releases everything allocated from the arena and restores the previous one of the thread
+    ///
+    ~CompileArena();
+
+    CompileArena(const CompileArena &_rhs) = delete;
+    CompileArena& operator=(const CompileArena &_rhs) = delete;
+
+    ///
+    /// \brief resource Memory resource of the innermost arena of the calling thread, the default resource
+    ///        (plain new and delete) when no compile is running
+    ///
+    static std::pmr::memory_resource *resource();
+    ///
+    /// \brief active Whether a compile arena is alive on the calling thread
+    ///
+    static bool active();
+
+  private:
+    ///
+    /// \brief m_buffer First block of the arena, allocated once up front
+    ///
+    std::unique_ptr<std::byte[]> m_buffer;
+    ///
+    /// \brief m_resource Bump allocator over m_buffer, frees nothing until it's destroyed
+    ///
+    std::pmr::monotonic_buffer_resource m_resource;
+    ///
+    /// \brief m_previous Arena that was active on the thread before this one, if any
+    ///
+    std::pmr::memory_resource *m_previous;
+  };
+}
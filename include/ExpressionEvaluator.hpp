@@ -1,10 +1,15 @@
 #pragma once
 
-#include <boost/lexical_cast.hpp>
+#include <memory>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
+#include "CompileArena.hpp"
+
 /// \file ExpressionEvaluator.hpp
 /// \brief Very simple and buggy set of utility functions to perform expression evaluation (with variables) on the CPU
 ///        Used to simplify the matrices before passing them to the shader. Also keeps track of the unknowns, e.g. variables
@@ -118,13 +123,13 @@ namespace hsitho {
     /// \param _gen Which iteration of the evaluation is going on, only get the unknowns from the last one
     /// \return The parsed/evaluated expression
     ///
-		std::string evaluate(const std::string &_expression, const std::string &_prev = "", const int &_copyNum = -1, const unsigned int &_gen = 0);
+		std::string evaluate(std::string_view _expression, const std::string &_prev = "", const int &_copyNum = -1, const unsigned int &_gen = 0);
     ///
     /// \brief evaluatePostFix Evaluates the post fix notation generated by the evaluate function
     /// \param outputQueue Output queue holding the expression elements in post fix order
     /// \return Evaluated post fix notation
     ///
-		std::string evaluatePostFix(std::vector<std::string> outputQueue);
+		std::string evaluatePostFix(const ArenaVector<std::string> &outputQueue);
     ///
     /// \brief getUnknowns Gets the unknowns in a format that can be used by the shader
     /// \return String containing the unknowns in a shader-readable format
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <QOpenGLTimerQuery>
+
+/// \file GpuTimer.hpp
+/// \brief Ring of GL_TIME_ELAPSED queries used to time a render pass on the GPU without stalling the pipeline,
+///        results are only read back once the driver reports them as available, a few frames after they were issued
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  class GpuTimer
+  {
+  public:
+    ///
+    /// \brief GpuTimer Default ctor, the queries are created in init once there's a current context
+    /// \param _ringSize Number of queries in flight, should be larger than the number of frames the driver buffers
+    ///
+    GpuTimer(unsigned int _ringSize = 4);
+    ///
+    /// \brief ~GpuTimer Default dtor, the queries should already have been destroyed with the context current
+    ///
+    ~GpuTimer();
+
+    ///
+    /// \brief init Creates the queries, has to be called with a current context
+    /// \return False if timer queries aren't supported, in which case begin and end do nothing
+    ///
+    bool init();
+    ///
+    /// \brief destroy Deletes the queries, has to be called with the context they were created in current
+    ///
+    void destroy();
+    ///
+    /// \brief begin Starts timing, if all the queries are still in flight this frame is skipped
+    ///
+    void begin();
+    ///
+    /// \brief end Stops timing
+    ///
+    void end();
+    ///
+    /// \brief poll Reads back the oldest finished query, never waits for the GPU
+    /// \param _ms Elapsed time of the pass in milliseconds
+    /// \return True if a result was read
+    ///
+    bool poll(float &_ms);
+    ///
+    /// \brief isSupported Whether the queries could be created
+    ///
+    bool isSupported() const { return m_supported; }
+
+  private:
+    std::vector<QOpenGLTimerQuery *> m_queries;
+    ///
+    /// \brief m_head Next query to be issued
+    ///
+    unsigned int m_head;
+    ///
+    /// \brief m_tail Oldest query that hasn't been read back yet
+    ///
+    unsigned int m_tail;
+    ///
+    /// \brief m_pending Number of queries issued but not read back
+    ///
+    unsigned int m_pending;
+    bool m_supported;
+    bool m_active;
+  };
+}
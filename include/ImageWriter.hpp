@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// \file ImageWriter.hpp
+/// \brief Writing of the rendered images. Whole images can go through QImage, EXR and PPM are written by scanline writers
+///        that put every row at a fixed offset, so rows can be streamed to disk without keeping the whole image in memory
+///        and a partially written file can be resumed
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  class ScanlineWriter
+  {
+  public:
+    ScanlineWriter() : m_file(nullptr), m_width(0), m_height(0), m_headerSize(0) {}
+    virtual ~ScanlineWriter() { close(); }
+
+    ///
+    /// \brief open Creates the file and writes the header
+    /// \param _path Path of the file
+    /// \param _w Width of the image
+    /// \param _h Height of the image
+    /// \param _resume Keep the rows of an existing file with the same header instead of starting over
+    /// \param _rowsDone Number of complete rows at the top of the file that can be skipped, 0 unless resuming
+    /// \return False if the file couldn't be created, or when resuming, if it belongs to a different image
+    ///
+    bool open(const std::string &_path, int _w, int _h, bool _resume, int &_rowsDone);
+    ///
+    /// \brief writeRows Writes rows of RGBA pixels, the rows can be written in any order
+    /// \param _y First row, 0 is the top of the image
+    /// \param _count Number of rows
+    /// \param _rgba Pixels as display referred RGBA floats, top row first
+    /// \return False if the rows couldn't be written
+    ///
+    bool writeRows(int _y, int _count, const float *_rgba);
+    ///
+    /// \brief close Flushes and closes the file
+    /// \return False if the file couldn't be flushed
+    ///
+    bool close();
+
+    ///
+    /// \brief rowOffset Byte offset of a row in the file
+    ///
+    long long rowOffset(int _y) const { return m_headerSize + static_cast<long long>(_y) * rowSize(); }
+
+  protected:
+    ///
+    /// \brief header Returns the header of the file, everything before the first row
+    ///
+    virtual std::vector<char> header() const = 0;
+    ///
+    /// \brief rowSize Size of a row in the file
+    ///
+    virtual long long rowSize() const = 0;
+    ///
+    /// \brief encodeRow Converts a row of pixels into the bytes stored in the file
+    /// \param _y Row number, 0 is the top of the image
+    /// \param _rgba Pixels of the row as RGBA floats
+    /// \param _out Bytes of the row, rowSize long
+    ///
+    virtual void encodeRow(int _y, const float *_rgba, std::vector<char> &_out) const = 0;
+
+    std::FILE *m_file;
+    int m_width;
+    int m_height;
+    long long m_headerSize;
+    std::vector<char> m_row;
+  };
+
+  ///
+  /// \brief ExrScanlineWriter Uncompressed scanline OpenEXR with 32-bit float RGBA, the pixels are converted back to linear
+  ///
+  class ExrScanlineWriter : public ScanlineWriter
+  {
+  protected:
+    std::vector<char> header() const override;
+    long long rowSize() const override { return 8 + static_cast<long long>(m_width) * 4 * 4; }
+    void encodeRow(int _y, const float *_rgba, std::vector<char> &_out) const override;
+  };
+
+  ///
+  /// \brief PpmScanlineWriter Binary 8-bit PPM, the alpha is dropped
+  ///
+  class PpmScanlineWriter : public ScanlineWriter
+  {
+  protected:
+    std::vector<char> header() const override;
+    long long rowSize() const override { return static_cast<long long>(m_width) * 3; }
+    void encodeRow(int _y, const float *_rgba, std::vector<char> &_out) const override;
+  };
+
+  ///
+  /// \brief createScanlineWriter Creates a scanline writer for the extension of the path
+  /// \param _path Path of the image
+  /// \return The writer, null if the format can't be streamed
+  ///
+  std::unique_ptr<ScanlineWriter> createScanlineWriter(const std::string &_path);
+  ///
+  /// \brief writeImage Writes a whole image, the format is picked from the extension. The pixels are display referred as they come
+  ///        out of the shader, EXR files get them converted back to linear
+  /// \param _path Path of the image, .exr and .ppm go through the scanline writers and anything else through QImage
+  /// \param _w Width of the image
+  /// \param _h Height of the image
+  /// \param _rgba Pixels as RGBA floats, top row first
+  /// \param _error Reason of the failure
+  /// \return False if the image couldn't be written
+  ///
+  bool writeImage(const std::string &_path, int _w, int _h, const std::vector<float> &_rgba, std::string &_error);
+  ///
+  /// \brief isExr Whether the path has an .exr extension
+  ///
+  bool isExr(const std::string &_path);
+  ///
+  /// \brief toLinear Undoes the gamma correction done at the end of the shader
+  ///
+  float toLinear(float _c);
+}
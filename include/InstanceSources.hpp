@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "sdf/DistanceVolume.hpp"
+#include "sdf/InstanceSet.hpp"
+
+/// \file InstanceSources.hpp
+/// \brief Where the transforms of the copies of the Scatter node come from when it isn't scattering them over a surface:
+///        a CSV file, a grid or random points in a cube. The copies are built the same way whatever their source
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  ///
+  /// \brief readInstances Reads one transform per line of a CSV file. A line holds the position, the position and a scale,
+  ///        the position, rotations about x, y and z in degrees and a scale, or the three rows of a 3x4 matrix: 3, 4, 7 or
+  ///        12 values. Empty lines, lines starting with # and a first line that isn't numbers are skipped
+  /// \param _path Path of the file
+  /// \param _transforms The transforms, from the space of the copy to the world
+  /// \param _error Reason of the failure
+  /// \return False if the file couldn't be read or a line has another number of values or something that isn't one
+  ///
+  bool readInstances(const std::string &_path, std::vector<glm::mat4> &_transforms, std::string &_error);
+  ///
+  /// \brief gridInstances Copies on a cubic grid centred on the origin, filled a row at a time
+  /// \param _count Number of copies
+  /// \param _spacing Distance between neighbouring copies
+  /// \param _transforms The transforms
+  ///
+  void gridInstances(unsigned int _count, float _spacing, std::vector<glm::mat4> &_transforms);
+  ///
+  /// \brief randomInstances Copies at uniformly random points in a cube around the origin, turned by random rotations
+  /// \param _count Number of copies
+  /// \param _extent Half the side of the cube
+  /// \param _seed Seed, the same seed gives the same copies
+  /// \param _transforms The transforms
+  ///
+  void randomInstances(unsigned int _count, float _extent, uint32_t _seed, std::vector<glm::mat4> &_transforms);
+  ///
+  /// \brief randomUnit Random number in [0, 1) hashed from a seed and an index, so the numbers don't depend on the order
+  ///        they are drawn in
+  ///
+  float randomUnit(uint32_t _seed, uint64_t _index);
+
+  ///
+  /// \brief makeInstances Compiles a field for the CPU and places a copy of it at every transform
+  /// \param _instance GLSL expression of the field that is copied
+  /// \param _volumes Volumes the expression samples, see ShaderGenerator::volumes
+  /// \param _sets Instance sets the expression calls, see ShaderGenerator::instanceSets
+  /// \param _transforms Transform of every copy
+  /// \param _radius Radius around its origin the field fits in
+  /// \param _error Reason of the failure
+  /// \return The copies, null if the expression couldn't be compiled
+  ///
+  std::shared_ptr<const sdf::InstanceSet> makeInstances(const std::string &_instance,
+                                                        const std::vector<std::shared_ptr<const sdf::DistanceVolume>> &_volumes,
+                                                        const std::vector<std::shared_ptr<const sdf::InstanceSet>> &_sets,
+                                                        const std::vector<glm::mat4> &_transforms, float _radius, std::string &_error);
+}
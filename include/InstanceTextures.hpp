@@ -0,0 +1,77 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <QOpenGLFunctions_4_1_Core>
+#include <QOpenGLShaderProgram>
+
+#include "sdf/InstanceSet.hpp"
+
+/// \file InstanceTextures.hpp
+/// \brief Buffer textures of the transforms of the instance sets, uploaded once per set as RGBA32F texels and bound to
+///        u_Instances0 to u_Instances3 of shader.begin on the texture units after the volumes, in the order the
+///        ShaderGenerator assigned them
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  class InstanceTextures
+  {
+  public:
+    ///
+    /// \brief InstanceTextures Default ctor, nothing is created before update
+    ///
+    InstanceTextures() = default;
+    ///
+    /// \brief ~InstanceTextures Default dtor, the owner should call clear before with the context current
+    ///
+    ~InstanceTextures();
+    InstanceTextures(const InstanceTextures &) = delete;
+    InstanceTextures &operator=(const InstanceTextures &) = delete;
+
+    ///
+    /// \brief update Uploads the sets that don't have a texture yet and releases the ones no longer used, has to be
+    ///        called with the context current
+    /// \param _sets Instance sets of the scene, see ShaderGenerator::instanceSets
+    ///
+    void update(const std::vector<std::shared_ptr<const sdf::InstanceSet>> &_sets);
+    ///
+    /// \brief bind Binds the textures to the units after the volumes and points the samplers of the program at them
+    /// \param _program Scene shader, has to be bound
+    ///
+    void bind(QOpenGLShaderProgram &_program);
+    ///
+    /// \brief clear Releases all the textures, has to be called with the context current
+    ///
+    void clear();
+
+  private:
+    struct Entry
+    {
+      ///
+      /// \brief m_set Keeps the set alive so its address can't be reused by another one while it has a texture
+      ///
+      std::shared_ptr<const sdf::InstanceSet> m_set;
+      GLuint m_buffer;
+      GLuint m_texture;
+    };
+
+    ///
+    /// \brief functions Buffer textures are core since 3.1 but not in QOpenGLFunctions, the versioned functions of the
+    ///        current context have them
+    ///
+    QOpenGLFunctions_4_1_Core *functions() const;
+    ///
+    /// \brief upload Creates the buffer and the texture of a set
+    ///
+    void upload(Entry &_entry);
+
+    ///
+    /// \brief m_entries Texture of every set in the order of the samplers
+    ///
+    std::vector<Entry> m_entries;
+  };
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "sdf/DistanceVolume.hpp"
+#include "ThreadPool.hpp"
+
+/// \file MeshImport.hpp
+/// \brief Reads a mesh or a point cloud and bakes it into a DistanceVolume on the caller's thread pool.
+///        Volumes are cached by path, resolution and modification time so scenes loading or copying the same file
+///        share one volume and an unchanged file isn't baked twice
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  struct MeshImportStats
+  {
+    size_t m_triangles = 0;
+    size_t m_points = 0;
+    double m_readMs = 0.0;
+    double m_bvhMs = 0.0;
+    double m_bakeMs = 0.0;
+    size_t m_exactEvaluations = 0;
+    bool m_cached = false;
+  };
+
+  ///
+  /// \brief importMesh Reads and bakes a mesh, or returns the volume baked from the same file before
+  /// \param _path OBJ or PLY file
+  /// \param _resolution Grid points along the longest side of the volume
+  /// \param _pool Threads the volume is baked on
+  /// \param _error Reason of the failure
+  /// \param _stats Sizes and timings of the import, optional
+  /// \return The volume, null if the file couldn't be read or baked
+  ///
+  std::shared_ptr<const sdf::DistanceVolume> importMesh(const std::string &_path, uint32_t _resolution, ThreadPool &_pool, std::string &_error,
+                                                       MeshImportStats *_stats = nullptr);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "sdf/Mesher.hpp"
+
+/// \file MeshReader.hpp
+/// \brief Reading of triangle meshes and point clouds, Wavefront OBJ and PLY in ascii or binary of either endianness.
+///        Only what the import needs is kept: the positions, the triangles and the vertex normals. Polygons are split into
+///        fans of triangles, a file without faces is a point cloud
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  ///
+  /// \brief readMesh Reads a mesh, the format is picked from the extension, .obj or .ply
+  /// \param _path Path of the file
+  /// \param _mesh Positions and triangles, no colours
+  /// \param _normals Normal of every vertex, empty if the file has none. OBJ normals are taken in the order of the
+  ///        vertices, the way point clouds are written, faces referring to other normals are ignored
+  /// \param _error Reason of the failure
+  /// \return False if the file couldn't be read or is malformed
+  ///
+  bool readMesh(const std::string &_path, sdf::Mesh &_mesh, std::vector<glm::vec3> &_normals, std::string &_error);
+}
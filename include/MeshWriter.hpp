@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+#include "sdf/Mesher.hpp"
+
+/// \file MeshWriter.hpp
+/// \brief Writing of extracted meshes, as Wavefront OBJ with the colours after the positions or as binary PLY. Both are
+///        streamed straight from the mesh through a large file buffer without building the file in memory
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  ///
+  /// \brief writeMesh Writes a mesh, the format is picked from the extension, .obj or .ply
+  /// \param _path Path of the file
+  /// \param _mesh The mesh
+  /// \param _error Reason of the failure
+  /// \return False if the format isn't supported or the file couldn't be written
+  ///
+  bool writeMesh(const std::string &_path, const sdf::Mesh &_mesh, std::string &_error);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+/// \file NodeModels.hpp
+/// \brief Registration of all the node types, shared by the editor and the headless tools so that both can load the same .flow files
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version, moved out of the MainWindow
+
+namespace hsitho
+{
+  ///
+  /// \brief registerNodeModels Registers every node type to the DataModelRegistry under its category
+  ///
+  void registerNodeModels();
+}
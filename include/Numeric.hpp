@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+/// \file Numeric.hpp
+/// \brief Locale independent conversions between numbers and the strings the expressions and node models are made of,
+///        built on std::from_chars and std::to_chars. Parsing reports success instead of throwing so telling numbers from
+///        variables is cheap enough for the hot path of the expression evaluation
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace Numeric
+  {
+    ///
+    /// \brief parseFloat Parses the whole of a string as a float, e.g. "1.5", "+2", "-.5e-3"
+    /// \param _text String to parse, nothing else than the number is allowed, including whitespace
+    /// \param _value Set to the number on success, left untouched otherwise
+    /// \return Whether the string was a number that fits in a float
+    ///
+    bool parseFloat(std::string_view _text, float &_value);
+    ///
+    /// \brief parseUnsigned Parses the whole of a string as a non-negative integer
+    /// \param _text String to parse
+    /// \param _value Set to the number on success, left untouched otherwise
+    /// \return Whether the string was a non-negative integer that fits in an unsigned int
+    ///
+    bool parseUnsigned(std::string_view _text, unsigned int &_value);
+    ///
+    /// \brief isNumber Whether parseFloat would succeed on the string
+    ///
+    bool isNumber(std::string_view _text);
+
+    ///
+    /// \brief toFixed Formats a float with a fixed number of decimals, the same as std::fixed and std::setprecision
+    /// \param _value Number to format
+    /// \param _precision Number of decimals, the expressions use 4
+    ///
+    std::string toFixed(float _value, int _precision = 4);
+    ///
+    /// \brief toString Shortest string that reads back as the same float
+    ///
+    std::string toString(float _value);
+    ///
+    /// \brief toString Formats an integer
+    ///
+    std::string toString(int _value);
+  }
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <QOffscreenSurface>
+#include <QOpenGLBuffer>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+
+#include <glm/glm.hpp>
+
+#include "GpuTimer.hpp"
+#include "InstanceTextures.hpp"
+#include "VolumeTextures.hpp"
+
+/// \file OffscreenRenderer.hpp
+/// \brief Renders the generated scene shader without a window, on an offscreen surface into a float framebuffer object.
+///        Used by the headless tools, works on any platform plugin that provides an OpenGL 4.1 core context, e.g. Mesa llvmpipe with QT_QPA_PLATFORM=offscreen
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  class OffscreenRenderer : protected QOpenGLExtraFunctions
+  {
+  public:
+    ///
+    /// \brief OffscreenRenderer Default ctor, nothing is created before initialise
+    /// \param _shaderDir Directory containing screenQuad.vert
+    ///
+    OffscreenRenderer(const std::string &_shaderDir = "shaders");
+    ///
+    /// \brief ~OffscreenRenderer Default dtor, releases the GL resources with the context current
+    ///
+    ~OffscreenRenderer();
+
+    ///
+    /// \brief initialise Creates the surface, the context and the screen quad and makes the context current
+    /// \param _error Reason of the failure
+    /// \return False if no suitable context could be created
+    ///
+    bool initialise(std::string &_error);
+    ///
+    /// \brief setFragmentShader Compiles and links the scene shader
+    /// \param _source Full source of the fragment shader, e.g. from the ShaderGenerator
+    /// \param _log Compiler and linker log
+    /// \return False if the shader couldn't be compiled or linked
+    ///
+    bool setFragmentShader(const std::string &_source, std::string &_log);
+    ///
+    /// \brief setCamera Sets the camera, it always looks at the origin like in the scene view
+    /// \param _eye Position of the camera
+    /// \param _up Up vector of the camera
+    ///
+    void setCamera(const glm::vec3 &_eye, const glm::vec3 &_up) { m_eye = _eye; m_up = _up; }
+    ///
+    /// \brief setTime Sets the value of u_GlobalTime
+    /// \param _time Time passed to the shader
+    ///
+    void setTime(float _time) { m_time = _time; }
+    ///
+    /// \brief setVolumes Uploads the distance volumes of the imported meshes the shader samples, has to be called after initialise
+    /// \param _volumes Volumes of the scene, see ShaderGenerator::volumes
+    ///
+    void setVolumes(const std::vector<std::shared_ptr<const sdf::DistanceVolume>> &_volumes) { m_volumes.update(_volumes); }
+    ///
+    /// \brief setInstances Uploads the transforms of the instance sets the shader reads, has to be called after initialise
+    /// \param _sets Instance sets of the scene, see ShaderGenerator::instanceSets
+    ///
+    void setInstances(const std::vector<std::shared_ptr<const sdf::InstanceSet>> &_sets) { m_instances.update(_sets); }
+    ///
+    /// \brief maxSize Largest width or height a single render can have
+    ///
+    int maxSize() const { return m_maxSize; }
+    ///
+    /// \brief render Renders the whole image and reads it back
+    /// \param _w Width of the image
+    /// \param _h Height of the image
+    /// \param _rgba Pixels of the image as RGBA floats, top row first
+    /// \return False if the size isn't supported or nothing can be rendered yet
+    ///
+    bool render(int _w, int _h, std::vector<float> &_rgba);
+    ///
+    /// \brief renderTile Renders a part of a larger image, the projection is adjusted so that the tiles line up exactly with a single render
+    /// \param _x Left edge of the tile in the whole image
+    /// \param _y Top edge of the tile in the whole image
+    /// \param _w Width of the tile
+    /// \param _h Height of the tile
+    /// \param _imageW Width of the whole image
+    /// \param _imageH Height of the whole image
+    /// \param _supersample Samples per pixel along each axis, averaged with a box filter
+    /// \param _rgba Pixels of the tile as RGBA floats, top row first
+    /// \return False if the supersampled tile doesn't fit into a framebuffer or nothing can be rendered yet
+    ///
+    bool renderTile(int _x, int _y, int _w, int _h, int _imageW, int _imageH, int _supersample, std::vector<float> &_rgba);
+    ///
+    /// \brief renderFrame Renders a frame without reading it back and waits for the GPU to finish it, used for timing
+    /// \param _w Width of the image
+    /// \param _h Height of the image
+    /// \param _timer Optional timer whose query is wrapped around the draw
+    /// \return False if the size isn't supported or nothing can be rendered yet
+    ///
+    bool renderFrame(int _w, int _h, GpuTimer *_timer = nullptr);
+
+    ///
+    /// \brief setReadbackSlots Sets up the ring of pixel buffers used by queueFrame, the more slots the more frames can be in flight
+    /// \param _slots Number of pixel buffers
+    ///
+    void setReadbackSlots(unsigned int _slots);
+    ///
+    /// \brief queueFrame Renders a frame and starts reading it into a pixel buffer without waiting for it,
+    ///        the readback of one slot overlaps the rendering of the next ones
+    /// \param _slot Pixel buffer to read into, mustn't hold a frame that hasn't been collected yet
+    /// \param _w Width of the image
+    /// \param _h Height of the image
+    /// \param _float Read the pixels as RGBA floats instead of RGBA bytes
+    /// \return False if the size isn't supported or nothing can be rendered yet
+    ///
+    bool queueFrame(unsigned int _slot, int _w, int _h, bool _float);
+    ///
+    /// \brief collectFrame Waits for a queued frame and copies its pixels out of the pixel buffer
+    /// \param _slot Pixel buffer the frame was queued into
+    /// \param _data Pixels of the frame, bottom row first as GL returns them
+    /// \return False if nothing was queued into the slot
+    ///
+    bool collectFrame(unsigned int _slot, std::vector<unsigned char> &_data);
+
+  protected:
+    ///
+    /// \brief bindFramebuffer Makes sure there is a float framebuffer of the given size and binds it
+    /// \param _w Width of the framebuffer
+    /// \param _h Height of the framebuffer
+    /// \return False if the size isn't supported
+    ///
+    bool bindFramebuffer(int _w, int _h);
+    ///
+    /// \brief draw Draws the screen quad into the bound framebuffer with the current camera and time
+    /// \param _w Width of the viewport
+    /// \param _h Height of the viewport
+    /// \param _resolution Size of the whole image
+    /// \param _tile Offset and scale of the screen coordinates, see u_Tile in shader.begin
+    ///
+    void draw(int _w, int _h, const glm::vec2 &_resolution, const glm::vec4 &_tile = glm::vec4(0.f, 0.f, 1.f, 1.f));
+    ///
+    /// \brief readFramebuffer Reads the bound framebuffer into memory
+    /// \param _w Width of the area to read
+    /// \param _h Height of the area to read
+    /// \param _rgba Pixels as RGBA floats, top row first
+    ///
+    void readFramebuffer(int _w, int _h, std::vector<float> &_rgba);
+
+    std::string m_shaderDir;
+    QOffscreenSurface *m_surface;
+    QOpenGLContext *m_context;
+    QOpenGLShaderProgram *m_program;
+    QOpenGLVertexArrayObject *m_vao;
+    QOpenGLBuffer m_vbo;
+    QOpenGLFramebufferObject *m_fbo;
+    ///
+    /// \brief m_pbos Ring of pixel buffers for the asynchronous readback
+    ///
+    std::vector<QOpenGLBuffer *> m_pbos;
+    ///
+    /// \brief m_fences Fence of each queued frame, null when the slot is free
+    ///
+    std::vector<GLsync> m_fences;
+    ///
+    /// \brief m_queuedSizes Size in bytes of the frame queued in each slot
+    ///
+    std::vector<size_t> m_queuedSizes;
+    VolumeTextures m_volumes;
+    InstanceTextures m_instances;
+
+    glm::vec3 m_eye;
+    glm::vec3 m_up;
+    float m_time;
+    int m_maxSize;
+  };
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// \file Profiler.hpp
+/// \brief Scoped CPU profiler. Zones and counters are recorded into per thread buffers and exported as a Chrome trace,
+///        which can be opened in chrome://tracing or ui.perfetto.dev. The macros only record anything when the project is
+///        built with HSITHO_PROFILE defined (qmake CONFIG+=hsitho_profile), otherwise they compile to nothing.
+///        Zone and counter names have to be string literals, only the pointer is stored
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  class Profiler
+  {
+  public:
+    struct Event
+    {
+      const char *m_name;
+      int64_t m_start;
+      ///
+      /// \brief m_duration Duration of a zone in nanoseconds, negative for counters
+      ///
+      int64_t m_duration;
+      double m_value;
+    };
+
+    ///
+    /// \brief instance Returns the profiler, created on first use
+    ///
+    static Profiler &instance();
+    ///
+    /// \brief compiledIn Whether the zones were compiled in, if not there is never anything to export
+    ///
+    static constexpr bool compiledIn()
+    {
+#ifdef HSITHO_PROFILE
+      return true;
+#else
+      return false;
+#endif
+    }
+
+    ///
+    /// \brief now Time since the profiler was created in nanoseconds
+    ///
+    int64_t now() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count(); }
+    ///
+    /// \brief setEnabled Starts or stops recording, recording is off by default so the buffers
+    ///        only grow while a trace is wanted, --trace and Record Trace in the editor turn it on
+    ///
+    void setEnabled(bool _enabled) { m_enabled.store(_enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    ///
+    /// \brief zone Records a finished zone on the calling thread
+    /// \param _name Name of the zone
+    /// \param _start Start time from now()
+    /// \param _end End time from now()
+    ///
+    void zone(const char *_name, int64_t _start, int64_t _end);
+    ///
+    /// \brief counter Records the value of a counter on the calling thread
+    /// \param _name Name of the counter
+    /// \param _value Value at this moment
+    ///
+    void counter(const char *_name, double _value);
+    ///
+    /// \brief setThreadName Names the calling thread in the trace
+    /// \param _name Name of the thread
+    ///
+    void setThreadName(const std::string &_name);
+
+    ///
+    /// \brief writeChromeTrace Writes everything recorded so far as Chrome trace event JSON
+    /// \param _path File to write
+    /// \return False if the file couldn't be written
+    ///
+    bool writeChromeTrace(const std::string &_path) const;
+    ///
+    /// \brief clear Throws away everything recorded so far
+    ///
+    void clear();
+
+  private:
+    struct ThreadBuffer
+    {
+      unsigned int m_id;
+      std::string m_name;
+      std::vector<Event> m_events;
+      ///
+      /// \brief m_mutex Only contended while exporting or clearing
+      ///
+      mutable std::mutex m_mutex;
+    };
+
+    Profiler();
+    Profiler(const Profiler &_rhs) = delete;
+    Profiler& operator= (const Profiler &_rhs) = delete;
+
+    ///
+    /// \brief buffer Buffer of the calling thread, registered on first use
+    ///
+    ThreadBuffer &buffer();
+
+    std::chrono::steady_clock::time_point m_epoch;
+    std::atomic<bool> m_enabled;
+    mutable std::mutex m_buffersMutex;
+    ///
+    /// \brief m_buffers Buffers of every thread that has recorded something, never shrinks so that the
+    ///        thread local pointers to them stay valid
+    ///
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+  };
+
+  ///
+  /// \brief The ProfileScope class records a zone from its construction to its destruction
+  ///
+  class ProfileScope
+  {
+  public:
+    ProfileScope(const char *_name) :
+      m_name(_name),
+      m_start(Profiler::instance().now())
+    {}
+    ~ProfileScope()
+    {
+      Profiler &p = Profiler::instance();
+      if(p.isEnabled())
+        p.zone(m_name, m_start, p.now());
+    }
+
+  private:
+    const char *m_name;
+    int64_t m_start;
+  };
+}
+
+#define HSITHO_PROFILE_CONCAT_(a, b) a##b
+#define HSITHO_PROFILE_CONCAT(a, b) HSITHO_PROFILE_CONCAT_(a, b)
+
+#ifdef HSITHO_PROFILE
+  #define HSITHO_PROFILE_SCOPE(name) hsitho::ProfileScope HSITHO_PROFILE_CONCAT(profileScope_, __LINE__)(name)
+  #define HSITHO_PROFILE_FUNCTION() HSITHO_PROFILE_SCOPE(__func__)
+  #define HSITHO_PROFILE_COUNTER(name, value) \
+    do { if(hsitho::Profiler::instance().isEnabled()) hsitho::Profiler::instance().counter(name, static_cast<double>(value)); } while(0)
+  #define HSITHO_PROFILE_THREAD(name) hsitho::Profiler::instance().setThreadName(name)
+#else
+  #define HSITHO_PROFILE_SCOPE(name) do {} while(0)
+  #define HSITHO_PROFILE_FUNCTION() do {} while(0)
+  #define HSITHO_PROFILE_COUNTER(name, value) do {} while(0)
+  #define HSITHO_PROFILE_THREAD(name) do {} while(0)
+#endif
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+/// \file RenderStats.hpp
+/// \brief Collects the GPU pass timings and shader compile statistics shown in the stats overlay,
+///        the same data can be dumped as CSV or JSON for tracking performance regressions
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  class RenderStats
+  {
+  public:
+    struct Summary
+    {
+      float m_last = 0.f;
+      float m_min = 0.f;
+      float m_avg = 0.f;
+      float m_p95 = 0.f;
+      size_t m_count = 0;
+    };
+
+    struct CompileRecord
+    {
+      ///
+      /// \brief m_generateMs Time spent traversing the node tree and generating the shader source
+      ///
+      float m_generateMs = 0.f;
+      ///
+      /// \brief m_compileMs Time spent compiling and linking the shader
+      ///
+      float m_compileMs = 0.f;
+      size_t m_sourceSize = 0;
+      bool m_success = false;
+    };
+
+    ///
+    /// \brief RenderStats Default ctor
+    /// \param _window Number of most recent samples kept per pass
+    ///
+    RenderStats(size_t _window = 600) : m_window(_window) {}
+
+    ///
+    /// \brief addSample Adds a timing for a render pass, the oldest sample is dropped once the window is full
+    /// \param _pass Name of the pass
+    /// \param _ms Time in milliseconds
+    ///
+    void addSample(const std::string &_pass, float _ms);
+    ///
+    /// \brief addCompile Records a recompile of the scene
+    /// \param _record Timings and size of the compile
+    ///
+    void addCompile(const CompileRecord &_record) { m_compiles.push_back(_record); }
+    ///
+    /// \brief addMetric Adds a per-frame value that isn't a timing, e.g. the mean march steps of the debug views
+    /// \param _name Name of the metric
+    /// \param _value Value for this frame
+    ///
+    void addMetric(const std::string &_name, float _value);
+    ///
+    /// \brief summary Calculates the min, average and 95th percentile of a pass
+    /// \param _pass Name of the pass
+    /// \return Summary of the samples in the window, zeros if there are none
+    ///
+    Summary summary(const std::string &_pass) const { return summarise(m_samples, _pass); }
+    ///
+    /// \brief metricSummary Calculates the min, average and 95th percentile of a metric
+    /// \param _name Name of the metric
+    /// \return Summary of the values in the window, zeros if there are none
+    ///
+    Summary metricSummary(const std::string &_name) const { return summarise(m_metrics, _name); }
+    ///
+    /// \brief passes Returns the names of the timed passes
+    ///
+    std::vector<std::string> passes() const;
+    ///
+    /// \brief compiles Returns all the recorded compiles, oldest first
+    ///
+    const std::vector<CompileRecord> &compiles() const { return m_compiles; }
+    ///
+    /// \brief overlayText Formats the current statistics as lines of text for the overlay
+    ///
+    std::vector<std::string> overlayText() const;
+    ///
+    /// \brief writeCsv Writes the summaries, raw samples, metrics and compiles into a CSV file
+    /// \param _path Path of the file
+    /// \return False if the file couldn't be written
+    ///
+    bool writeCsv(const std::string &_path) const;
+    ///
+    /// \brief writeJson Writes the summaries, raw samples, metrics and compiles into a JSON file
+    /// \param _path Path of the file
+    /// \return False if the file couldn't be written
+    ///
+    bool writeJson(const std::string &_path) const;
+    ///
+    /// \brief clear Removes all the samples, e.g. after the scene has changed
+    ///
+    void clear() { m_samples.clear(); m_metrics.clear(); }
+
+  private:
+    typedef std::map<std::string, std::deque<float>> Series;
+
+    static Summary summarise(const Series &_series, const std::string &_name);
+    void push(Series &_series, const std::string &_name, float _value);
+    void writeCsvSeries(std::ostream &_out, const Series &_series, const std::string &_kind) const;
+    void writeJsonSeries(std::ostream &_out, const Series &_series) const;
+
+    size_t m_window;
+    Series m_samples;
+    Series m_metrics;
+    std::vector<CompileRecord> m_compiles;
+  };
+}
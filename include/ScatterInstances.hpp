@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sdf/DistanceVolume.hpp"
+#include "sdf/InstanceSet.hpp"
+#include "ThreadPool.hpp"
+
+/// \file ScatterInstances.hpp
+/// \brief Scatters copies of one distance field over the surface of another on the caller's thread pool:
+///        both are compiled for the CPU, the surface is sampled with sdf::Scatter and every point gets a copy standing
+///        on it, its y axis along the normal and turned about it by a random angle
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  struct ScatterSettings
+  {
+    ///
+    /// \brief m_spacing Smallest distance between two copies
+    ///
+    float m_spacing = 0.5f;
+    ///
+    /// \brief m_radius Radius around its origin the copied field fits in, copies further away than that are skipped
+    ///
+    float m_radius = 0.5f;
+    uint32_t m_seed = 1;
+    ///
+    /// \brief m_extent Half the side of the cube around the origin the surface is sampled in
+    ///
+    float m_extent = 5.f;
+  };
+
+  struct ScatterStats
+  {
+    size_t m_points = 0;
+    size_t m_surfaceCells = 0;
+    double m_compileMs = 0.0;
+    double m_scatterMs = 0.0;
+  };
+
+  ///
+  /// \brief scatterInstances Samples a surface and places a copy of a field on every point
+  /// \param _surface GLSL expression of the surface, the distance code of a node tree
+  /// \param _instance GLSL expression of the field that is copied
+  /// \param _volumes Volumes the expressions sample, see ShaderGenerator::volumes
+  /// \param _sets Instance sets the expressions call, see ShaderGenerator::instanceSets
+  /// \param _settings Spacing, bound and seed
+  /// \param _pool Threads the surface is sampled on
+  /// \param _error Reason of the failure
+  /// \param _stats Sizes and timings of the scatter, optional
+  /// \return The copies, null if either expression couldn't be compiled or the surface needs too many copies
+  ///
+  std::shared_ptr<const sdf::InstanceSet> scatterInstances(const std::string &_surface, const std::string &_instance,
+                                                           const std::vector<std::shared_ptr<const sdf::DistanceVolume>> &_volumes,
+                                                           const std::vector<std::shared_ptr<const sdf::InstanceSet>> &_sets,
+                                                           const ScatterSettings &_settings, ThreadPool &_pool, std::string &_error,
+                                                           ScatterStats *_stats = nullptr);
+}
@@ -3,12 +3,20 @@
 #include <QOpenGLShaderProgram>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLBuffer>
+#include <QOpenGLFramebufferObject>
 #include <fstream>
 
 #include <glm/glm.hpp>
 
 #include "nodes/DistanceFieldData.hpp"
+#include "sdf/Picker.hpp"
+#include "GpuTimer.hpp"
+#include "InstanceTextures.hpp"
+#include "RenderStats.hpp"
+#include "ShaderGenerator.hpp"
 #include "ShaderManager.hpp"
+#include "ThreadPool.hpp"
+#include "VolumeTextures.hpp"
 #include "Window.hpp"
 
 /// \file SceneWindow.hpp
@@ -23,6 +31,7 @@ namespace hsitho
 {
   class SceneWindow : public GLWindow
   {
+  Q_OBJECT
   public:
     ///
     /// \brief SceneWindow Default ctor
@@ -49,6 +58,11 @@ namespace hsitho
     ///
 		void mousePressEvent(QMouseEvent *_event);
     ///
+    /// \brief mouseReleaseEvent Event triggered when a mouse button is released, a left click that didn't orbit the camera picks
+    /// \param _event QMouseEvent containing the details of the mouse release
+    ///
+		void mouseReleaseEvent(QMouseEvent *_event);
+    ///
     /// \brief mouseMoveEvent Event triggered when a mouse is moved
     /// \param _event Event containing the details of the mouse movement
     ///
@@ -59,42 +73,70 @@ namespace hsitho
     ///
 		void wheelEvent(QWheelEvent *_event);
 
-  private:
     ///
-    /// \brief recurseNodeTree Recursed the node tree starting from the distance node, ignores anything that's not connected to the distance node
-    /// \param _node Current node being traversed
-    /// \param _t Current transformation matrix, passed down the recursion
-    /// \param portIndex Index of an output port, used for traversing collapsed nodes
-    /// \param _cp Current copy number, used to pass the which iteration the node belongs to when using a copy-node
-    /// \return returns the shader code generated by the tree traversal
+    /// \brief setAnalyticNormals Toggles the generation of a dual-number map used for the normals, takes effect on the next compile
+    /// \param _analytic Whether to use analytic normals
+    ///
+		void setAnalyticNormals(bool _analytic) { m_generator.setAnalyticNormals(_analytic); }
+    ///
+    /// \brief setStatsOverlay Toggles the overlay showing the GPU timings and compile statistics
+    /// \param _show Whether the overlay is drawn
+    ///
+		void setStatsOverlay(bool _show) { m_showStats = _show; }
+    ///
+    /// \brief getStats Returns the collected render statistics, e.g. for dumping them into a file
     ///
-		std::string recurseNodeTree(std::shared_ptr<Node> _node, Mat4f _t, PortIndex portIndex = 0, unsigned int _cp = 0);
+		const RenderStats &getStats() const { return m_stats; }
+    ///
+    /// \brief setDebugMode Switches between the shaded view and the debug views, the debug views also read back per-frame aggregates into the stats
+    /// \param _mode 0 shaded, 1 march steps, 2 distance evaluations, 3 distance error
+    ///
+		void setDebugMode(int _mode) { m_debugMode = _mode; m_stats.clear(); }
 
+  private:
+    ///
+    /// \brief pick Traces the ray through a pixel on the CPU and signals the node of the primitive it hits, the distance
+    ///        field is compiled for picking on the first pick after the scene changes
+    /// \param _x Pixel column in widget coordinates
+    /// \param _y Pixel row in widget coordinates
+    ///
+    void pick(int _x, int _y);
+    ///
+    /// \brief drawStats Draws the stats overlay on top of the scene
+    ///
+    void drawStats();
+    ///
+    /// \brief readDebugStats Renders the raw debug counters into a float buffer and reads them back to calculate the per-frame aggregates,
+    ///        expects the screen quad and its uniforms to be set up already
+    /// \param _w Width of the viewport
+    /// \param _h Height of the viewport
+    ///
+    void readDebugStats(int _w, int _h);
     ///
     /// \brief m_shaderMan Instance of the shader manager
     ///
     std::shared_ptr<ShaderManager> m_shaderMan;
     ///
-    /// \brief m_outputNode Pointer to the distance-node
+    /// \brief m_pool Threads both generators bake imported meshes and scatter copies on
     ///
-    Node *m_outputNode;
+    ThreadPool m_pool;
     ///
-    /// \brief m_vao Vertex array object for the screen quad
+    /// \brief m_generator Traverses the node tree and generates the fragment shader
     ///
-    QOpenGLVertexArrayObject *m_vao;
+    ShaderGenerator m_generator;
     ///
-    /// \brief m_vbo Vertex buffer object for the screen quad
+    /// \brief m_pickGenerator Generates the map the picker compiles, kept apart from m_generator so its volume and instance
+    ///        tables stay the ones the textures were made for
     ///
-    QOpenGLBuffer m_vbo;
-
+    ShaderGenerator m_pickGenerator;
     ///
-    /// \brief m_shaderStart The first part of the shader code, prepended to the node tree shader code
+    /// \brief m_vao Vertex array object for the screen quad
     ///
-    std::string m_shaderStart;
+    QOpenGLVertexArrayObject *m_vao;
     ///
-    /// \brief m_shaderEnd The last part of the shader code, appended to the node tree shader code
+    /// \brief m_vbo Vertex buffer object for the screen quad
     ///
-    std::string m_shaderEnd;
+    QOpenGLBuffer m_vbo;
 
     ///
     /// \brief m_cam Scene camera location
@@ -121,6 +163,61 @@ namespace hsitho
     /// \brief m_origY Used to calculate the rotation of the camera when moved
     ///
 		int m_origY;
+    ///
+    /// \brief m_pressX Where the left button went down, a release close to it is a click rather than an orbit
+    ///
+		int m_pressX;
+		int m_pressY;
+
+    ///
+    /// \brief m_nodes Nodes of the last compile, kept for compiling the scene for picking
+    ///
+		std::unordered_map<QUuid, std::shared_ptr<Node>> m_nodes;
+    ///
+    /// \brief m_picker CPU picker of the current scene, null until the first pick after a change
+    ///
+		std::unique_ptr<sdf::Picker> m_picker;
+    ///
+    /// \brief m_pickPrimitives Node of every primitive id of the picker
+    ///
+		std::vector<QUuid> m_pickPrimitives;
+
+    ///
+    /// \brief m_sceneTimer GPU timer for the scene pass
+    ///
+		GpuTimer m_sceneTimer;
+    ///
+    /// \brief m_volumeTextures Textures of the imported meshes of the current scene
+    ///
+		VolumeTextures m_volumeTextures;
+    ///
+    /// \brief m_instanceTextures Transforms of the instance sets of the current scene
+    ///
+		InstanceTextures m_instanceTextures;
+    ///
+    /// \brief m_stats GPU timings and compile statistics
+    ///
+		RenderStats m_stats;
+    ///
+    /// \brief m_showStats Whether the stats overlay is drawn on top of the scene
+    ///
+		bool m_showStats;
+    ///
+    /// \brief m_debugMode Which view is rendered, see setDebugMode
+    ///
+		int m_debugMode;
+    ///
+    /// \brief m_statsTimer GPU timer for the debug counter pass
+    ///
+		GpuTimer m_statsTimer;
+    ///
+    /// \brief m_statsFbo Float buffer the debug counters are rendered into
+    ///
+		QOpenGLFramebufferObject *m_statsFbo;
+    ///
+    /// \brief m_statsPixels CPU copy of the debug counters
+    ///
+		std::vector<float> m_statsPixels;
 
   public slots:
     ///
@@ -128,5 +225,12 @@ namespace hsitho
     /// \param _nodes List of all the nodes in the scene
     ///
     virtual void nodeChanged(std::unordered_map<QUuid, std::shared_ptr<Node>> _nodes);
+
+  signals:
+    ///
+    /// \brief nodePicked Signalled when the scene is clicked
+    /// \param _id Node that produced the surface under the cursor, null if the click missed everything
+    ///
+    void nodePicked(QUuid _id);
   };
 }
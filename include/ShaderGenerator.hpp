@@ -0,0 +1,197 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nodeEditor/FlowScene.hpp"
+#include "nodeEditor/Node.hpp"
+#include "nodes/DistanceFieldData.hpp"
+#include "sdf/DistanceVolume.hpp"
+#include "sdf/InstanceSet.hpp"
+#include "CompileArena.hpp"
+#include "ThreadPool.hpp"
+
+/// \file ShaderGenerator.hpp
+/// \brief Traverses the node tree and generates the fragment shader for the scene, shared by the scene view and the headless tools
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version, moved out of the SceneWindow
+
+namespace hsitho
+{
+  class ShaderGenerator
+  {
+  public:
+    ///
+    /// \brief c_maxVolumes Volume textures shader.begin declares, u_Volume0 to u_Volume7
+    ///
+    static constexpr size_t c_maxVolumes = 8;
+    ///
+    /// \brief c_maxInstanceSets Instance buffers shader.begin declares, u_Instances0 to u_Instances3
+    ///
+    static constexpr size_t c_maxInstanceSets = 4;
+
+    ///
+    /// \brief ShaderGenerator Default ctor, reads the parts of the shader that surround the generated code
+    /// \param _pool Threads imported meshes are baked and copies scattered on while the scene is generated
+    /// \param _shaderDir Directory containing shader.begin and shader.end
+    ///
+    ShaderGenerator(ThreadPool &_pool, const std::string &_shaderDir = "shaders");
+
+    ///
+    /// \brief isValid Whether the surrounding shader code could be read
+    ///
+    bool isValid() const { return m_shaderStart != "" && m_shaderEnd != ""; }
+    ///
+    /// \brief generate Traverses the node tree from the distance node and generates the full fragment shader
+    /// \param _nodes List of all the nodes in the scene
+    /// \return The fragment shader source, empty if nothing is connected to the distance node
+    ///
+    std::string generate(const std::unordered_map<QUuid, std::shared_ptr<Node>> &_nodes);
+    ///
+    /// \brief generateMap Generates only the map function of the scene, the same code generate puts into the shader.
+    ///        The instances functions of the scatter nodes come before it
+    /// \param _nodes List of all the nodes in the scene
+    /// \return Source of the map function, empty if nothing is connected to the distance node
+    ///
+    std::string generateMap(const std::unordered_map<QUuid, std::shared_ptr<Node>> &_nodes);
+    ///
+    /// \brief primitives Nodes of the distance function calls in the last map function, in the order they appear in it.
+    ///        A primitive inside a collapsed node is listed as the outermost collapsed node, the one visible in the editor,
+    ///        and every copy of a primitive made by a copy node as the primitive itself
+    ///
+    const std::vector<QUuid> &primitives() const { return m_primitives; }
+    ///
+    /// \brief volumes Volumes of the imported meshes in the last shader or map function, the index of a volume is the
+    ///        index of its u_Volume uniform. Nodes sharing a volume share its slot
+    ///
+    const std::vector<std::shared_ptr<const sdf::DistanceVolume>> &volumes() const { return m_volumes; }
+    ///
+    /// \brief instanceSets Copies of the scatter nodes in the last shader or map function, the index of a set is the
+    ///        index of its u_Instances uniform and of the instances function reading it
+    ///
+    const std::vector<std::shared_ptr<const sdf::InstanceSet>> &instanceSets() const { return m_instanceSets; }
+    ///
+    /// \brief shaderStart The part of the shader before the generated code, with the distance functions and the uniforms
+    ///
+    const std::string &shaderStart() const { return m_shaderStart; }
+    ///
+    /// \brief setAnalyticNormals Toggles the generation of a dual-number map used for the normals, takes effect on the next generate
+    /// \param _analytic Whether to use analytic normals
+    ///
+    void setAnalyticNormals(bool _analytic) { m_analyticNormals = _analytic; }
+
+  private:
+    ///
+    /// \brief findOutputNode Looks up the distance node of the scene being generated, nullptr if it has none
+    /// \param _nodes List of all the nodes in the scene
+    ///
+    void findOutputNode(const std::unordered_map<QUuid, std::shared_ptr<Node>> &_nodes);
+    ///
+    /// \brief mapFunction Wraps the distance code of the node tree into the map function
+    /// \param _code Code returned by recurseNodeTree
+    /// \param _unknowns Declarations of the unknowns, replaced in the code
+    ///
+    std::string mapFunction(const std::string &_code, const std::string &_unknowns);
+    ///
+    /// \brief recurseNodeTree Recursed the node tree starting from the distance node, ignores anything that's not connected to the distance node
+    /// \param _node Current node being traversed
+    /// \param _t Current transformation matrix, passed down the recursion
+    /// \param portIndex Index of an output port, used for traversing collapsed nodes
+    /// \param _cp Current copy number, used to pass the which iteration the node belongs to when using a copy-node
+    /// \param _variant Which version of the shader code to generate, plain distances or distances with their gradients
+    /// \return returns the shader code generated by the tree traversal
+    ///
+		std::string recurseNodeTree(std::shared_ptr<Node> _node, Mat4f _t, PortIndex portIndex = 0, unsigned int _cp = 0, DFCodeVariant _variant = DFCodeVariant::DISTANCE);
+    ///
+    /// \brief finiteDifferenceDual Wraps the distance code of a node that has no derivative so that it returns a dual number,
+    ///        the gradient is estimated from four extra samples of that node only
+    /// \param _code Distance code of the node
+    /// \return Shader code returning a dual number
+    ///
+		std::string finiteDifferenceDual(const std::string &_code) const;
+    ///
+    /// \brief generateLights Generates the lighting function for the enabled light nodes in the scene, unrolled so that
+    ///        only the lights that are on are evaluated and only the shadow casters trace shadow rays
+    /// \param _nodes List of all the nodes in the scene
+    /// \return The shader code for applyLights, empty if there are no enabled lights and the default rig should be used
+    ///
+		std::string generateLights(const std::unordered_map<QUuid, std::shared_ptr<Node>> &_nodes);
+    ///
+    /// \brief collectUnionTerms Splits the top of the node tree into the terms of a plain union, primitives that can be intersected
+    ///        analytically are kept apart from the rest which still needs to be sphere traced
+    /// \param _node Current node being traversed
+    /// \param _t Current transformation matrix, passed down the recursion
+    /// \param _analytic Intersection code of the primitives that can be intersected exactly
+    /// \param _marched Distance code of the terms that need to be marched
+    /// \param portIndex Index of an output port, used for traversing collapsed nodes
+    /// \param _cp Current copy number
+    ///
+		void collectUnionTerms(std::shared_ptr<Node> _node, Mat4f _t, ArenaVector<std::string> &_analytic, ArenaVector<std::string> &_marched, PortIndex portIndex = 0, unsigned int _cp = 0);
+
+    ///
+    /// \brief assignVolume Bakes an imported mesh if its file or resolution changed and gives its volume a texture slot before
+    ///        its code is generated
+    /// \param _node A primitive node, anything but a mesh import is left alone
+    ///
+    void assignVolume(Node &_node);
+    ///
+    /// \brief assignInstances Scatters the copies of a scatter node from the code of its inputs and gives them an instance
+    ///        buffer, writing the instances function of a new buffer to m_instanceFunctions
+    /// \param _node A scatter node
+    ///
+    void assignInstances(Node &_node);
+
+    ///
+    /// \brief m_outputNode Pointer to the distance-node of the scene being generated, only valid during generate and generateMap
+    ///
+    Node *m_outputNode;
+    ///
+    /// \brief m_pool Threads of the owner of the generator, shared with whatever else it runs on the CPU
+    ///
+    ThreadPool &m_pool;
+    ///
+    /// \brief m_shaderStart The first part of the shader code, prepended to the node tree shader code
+    ///
+    std::string m_shaderStart;
+    ///
+    /// \brief m_shaderEnd The last part of the shader code, appended to the node tree shader code
+    ///
+    std::string m_shaderEnd;
+    ///
+    /// \brief m_analyticNormals Whether the normals are taken from a dual-number version of the scene instead of finite differences
+    ///
+    bool m_analyticNormals;
+    ///
+    /// \brief m_primitives Node of every primitive generateMap has written, see primitives
+    ///
+    std::vector<QUuid> m_primitives;
+    ///
+    /// \brief m_volumes Volumes given a slot by the current traversal, see volumes
+    ///
+    std::vector<std::shared_ptr<const sdf::DistanceVolume>> m_volumes;
+    ///
+    /// \brief m_instanceSets Copies given a buffer by the current traversal, see instanceSets
+    ///
+    std::vector<std::shared_ptr<const sdf::InstanceSet>> m_instanceSets;
+    ///
+    /// \brief m_instanceFunctions Instances functions of m_instanceSets, written before the map function
+    ///
+    std::string m_instanceFunctions;
+    ///
+    /// \brief m_instanceSlots Slot every scatter node got in the current traversal, a node visited again by another pass,
+    ///        a copy node or a second output keeps it instead of being scattered again
+    ///
+    std::unordered_map<QUuid, int> m_instanceSlots;
+    ///
+    /// \brief m_recordPrimitives Whether the traversal adds the primitives it writes to m_primitives, only for generateMap
+    ///
+    bool m_recordPrimitives;
+    ///
+    /// \brief m_collapsedOwner Outermost collapsed node the traversal is currently inside, null outside them
+    ///
+    QUuid m_collapsedOwner;
+  };
+}
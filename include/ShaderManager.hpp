@@ -41,8 +41,14 @@ namespace hsitho
     ///
     /// \brief updateShader Replaces the fragment shader in use with the new shader source
     /// \param _shaderCode Shader code of the new fragment shader
+    /// \return True if the shader compiled and the program was relinked
     ///
-    void updateShader(const char *_shaderCode);
+    bool updateShader(const char *_shaderCode);
+    ///
+    /// \brief getLastCompileTime Returns how long the last updateShader took to compile and link
+    /// \return Time in milliseconds
+    ///
+    float getLastCompileTime() const { return m_lastCompileTime; }
 
     ///
     /// \brief useShader Sets the active shader to a given one
@@ -54,7 +60,7 @@ namespace hsitho
     ///
     /// \brief ShaderManager Ctor hidden as we only want a single instance of this class to exist
     ///
-		ShaderManager() : m_program(nullptr), m_fragShader(nullptr) {}
+		ShaderManager() : m_program(nullptr), m_fragShader(nullptr), m_lastCompileTime(0.f) {}
     ///
     /// \brief ShaderManager Copy ctor deleted to avoid problems
     /// \param _rhs
@@ -85,5 +91,10 @@ namespace hsitho
     /// \brief m_fragShader Current fragment shader in use
     ///
     QOpenGLShader *m_fragShader;
+
+    ///
+    /// \brief m_lastCompileTime Time the last fragment shader compile and link took in milliseconds
+    ///
+    float m_lastCompileTime;
   };
 }
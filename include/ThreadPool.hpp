@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// \file ThreadPool.hpp
+/// \brief Fixed pool of worker threads running indexed tasks in parallel. Every worker starts on its own contiguous share
+///        of the indices and steals from the far end of the others' shares once it runs out, so uneven tasks such as
+///        tiles with more or less geometry in them still keep every core busy. The calling thread works as worker 0
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  class ThreadPool
+  {
+  public:
+    ///
+    /// \brief ThreadPool Default ctor, starts the worker threads
+    /// \param _workers Number of workers including the calling thread, 0 for one per hardware thread
+    ///
+    explicit ThreadPool(unsigned int _workers = 0);
+    ///
+    /// \brief ~ThreadPool Default dtor, joins the worker threads
+    ///
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &_rhs) = delete;
+    ThreadPool& operator=(const ThreadPool &_rhs) = delete;
+
+    ///
+    /// \brief size Number of workers, the worker indices passed to the tasks are below this
+    ///
+    unsigned int size() const { return static_cast<unsigned int>(m_queues.size()); }
+    ///
+    /// \brief parallelFor Runs a task for every index and returns once all of them are done
+    /// \param _count Number of tasks
+    /// \param _task Called with the index of the task and the index of the worker running it
+    ///
+    void parallelFor(size_t _count, const std::function<void(size_t, unsigned int)> &_task);
+    ///
+    /// \brief steals Tasks that were run by another worker than the one they were given to, in the last parallelFor
+    ///
+    size_t steals() const { return m_steals; }
+
+  private:
+    struct alignas(64) Queue
+    {
+      std::mutex m_mutex;
+      std::deque<size_t> m_tasks;
+    };
+
+    void run(unsigned int _worker);
+    void work(unsigned int _worker);
+    bool pop(unsigned int _worker, size_t &_task);
+    bool steal(unsigned int _worker, size_t &_task);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_hasWork;
+    std::condition_variable m_done;
+    ///
+    /// \brief m_task Task of the running parallelFor, null between them
+    ///
+    const std::function<void(size_t, unsigned int)> *m_task;
+    ///
+    /// \brief m_generation Incremented for every parallelFor so the workers can tell a new one from a spurious wake up
+    ///
+    size_t m_generation;
+    ///
+    /// \brief m_active Workers currently inside the running parallelFor
+    ///
+    unsigned int m_active;
+    std::atomic<size_t> m_remaining;
+    std::atomic<size_t> m_steals;
+    bool m_stop;
+  };
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <QOpenGLShaderProgram>
+#include <QOpenGLTexture>
+
+#include "sdf/DistanceVolume.hpp"
+
+/// \file VolumeTextures.hpp
+/// \brief 3D textures of the distance volumes of the imported meshes, uploaded once per volume as normalised signed
+///        16-bit values and bound to u_Volume0 to u_Volume7 of shader.begin in the order the ShaderGenerator assigned them
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  class VolumeTextures
+  {
+  public:
+    ///
+    /// \brief VolumeTextures Default ctor, nothing is created before update
+    ///
+    VolumeTextures() = default;
+    ///
+    /// \brief ~VolumeTextures Default dtor, the owner should call clear before with the context current
+    ///
+    ~VolumeTextures();
+    VolumeTextures(const VolumeTextures &) = delete;
+    VolumeTextures &operator=(const VolumeTextures &) = delete;
+
+    ///
+    /// \brief update Uploads the volumes that don't have a texture yet and releases the ones no longer used, has to be
+    ///        called with the context current
+    /// \param _volumes Volumes of the scene, see ShaderGenerator::volumes
+    ///
+    void update(const std::vector<std::shared_ptr<const sdf::DistanceVolume>> &_volumes);
+    ///
+    /// \brief bind Binds the textures to the first texture units and points the samplers of the program at them
+    /// \param _program Scene shader, has to be bound
+    ///
+    void bind(QOpenGLShaderProgram &_program);
+    ///
+    /// \brief clear Releases all the textures, has to be called with the context current
+    ///
+    void clear();
+
+  private:
+    struct Entry
+    {
+      ///
+      /// \brief m_volume Keeps the volume alive so its address can't be reused by another one while it has a texture
+      ///
+      std::shared_ptr<const sdf::DistanceVolume> m_volume;
+      QOpenGLTexture *m_texture;
+    };
+
+    ///
+    /// \brief upload Creates the texture of a volume
+    ///
+    QOpenGLTexture *upload(const sdf::DistanceVolume &_volume);
+
+    ///
+    /// \brief m_entries Texture of every volume in the order of the samplers
+    ///
+    std::vector<Entry> m_entries;
+  };
+}
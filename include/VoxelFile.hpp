@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <QFile>
+
+#include "sdf/VoxelGrid.hpp"
+
+/// \file VoxelFile.hpp
+/// \brief Saving of baked grids and reading them back by mapping the file. The sections of the file are the arrays of the
+///        VoxelGrid as they are in memory, 64 byte aligned, so a mapped file is looked up in place and only the pages a
+///        lookup touches are ever read from disk
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  ///
+  /// \brief writeVoxelGrid Saves a grid
+  /// \param _path Path of the file
+  /// \param _grid Grid to save
+  /// \param _error Reason of the failure
+  /// \return False if the file couldn't be written
+  ///
+  bool writeVoxelGrid(const std::string &_path, const sdf::VoxelGrid &_grid, std::string &_error);
+
+  class MappedVoxelGrid
+  {
+  public:
+    MappedVoxelGrid() : m_data(nullptr) {}
+    ~MappedVoxelGrid() { close(); }
+
+    ///
+    /// \brief open Maps a grid file, checks the header and the sizes of the sections but not the entries of the nodes,
+    ///        which would mean reading the whole file
+    /// \param _path Path of the file
+    /// \param _error Reason of the failure
+    /// \return False if the file couldn't be mapped or isn't a grid written on a machine of the same endianness
+    ///
+    bool open(const std::string &_path, std::string &_error);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    ///
+    /// \brief view Lookups into the mapped file, only valid while it's open
+    ///
+    const sdf::VoxelGridView &view() const { return m_view; }
+    const sdf::VoxelGridHeader &header() const { return *m_view.m_header; }
+
+  private:
+    std::unique_ptr<QFile> m_file;
+    uchar *m_data;
+    sdf::VoxelGridView m_view;
+  };
+}
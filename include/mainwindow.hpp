@@ -2,12 +2,14 @@
 
 #include <QMainWindow>
 #include <QColorDialog>
+#include <QComboBox>
 
 #include "nodeEditor/Node.hpp"
 #include "nodeEditor/NodeGraphicsObject.hpp"
 #include "nodeEditor/FlowView.hpp"
 #include "nodeEditor/FlowScene.hpp"
 #include "SceneWindow.hpp"
+#include "Profiler.hpp"
 #include "CubePrimitiveDataModel.hpp"
 
 /// \file mainwindow.hpp
@@ -70,6 +72,10 @@ private:
   /// \brief m_flowView Visual representation of the flow scene
   ///
 	FlowView *m_flowView;
+  ///
+  /// \brief m_debugView Selects between the shaded scene and the debug views
+  ///
+  QComboBox *m_debugView;
 
 public slots:
   ///
@@ -81,6 +87,39 @@ public slots:
   /// \brief triggered Called when the user presses Compile or it's hotkey
   ///
 	void triggered(bool) { emit(nodeEditorModified(getNodes())); }
+  ///
+  /// \brief analyticNormalsToggled Called when the analytic normals are switched on or off, recompiles the scene
+  /// \param _checked Whether analytic normals are used
+  ///
+	void analyticNormalsToggled(bool _checked) { m_gl->setAnalyticNormals(_checked); emit(nodeEditorModified(getNodes())); }
+  ///
+  /// \brief statsOverlayToggled Called when the stats overlay is switched on or off
+  /// \param _checked Whether the overlay is shown
+  ///
+	void statsOverlayToggled(bool _checked) { m_gl->setStatsOverlay(_checked); }
+  ///
+  /// \brief dumpStats Asks for a file and writes the render statistics into it, as JSON if the file ends in .json and CSV otherwise
+  ///
+	void dumpStats(bool);
+  ///
+  /// \brief recordTraceToggled Called when the profiler recording is switched on or off
+  /// \param _checked Whether the profiler records zones
+  ///
+	void recordTraceToggled(bool _checked) { hsitho::Profiler::instance().setEnabled(_checked); }
+  ///
+  /// \brief exportTrace Asks for a file and writes everything the profiler has recorded into it as a Chrome trace
+  ///
+	void exportTrace(bool);
+  ///
+  /// \brief debugViewChanged Called when a different debug view is selected
+  /// \param _index Index of the view, matches the debug modes of the scene window
+  ///
+	void debugViewChanged(int _index) { m_gl->setDebugMode(_index); }
+  ///
+  /// \brief nodePicked Called when the scene is clicked, selects the node under the cursor and centres the editor on it
+  /// \param _id Node to select, null to clear the selection
+  ///
+	void nodePicked(QUuid _id);
 signals:
   ///
   /// \brief nodeEditorModified Signal to tell the scene window to traverse the node tree and regenerate the shader code
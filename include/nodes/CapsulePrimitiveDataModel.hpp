@@ -104,6 +104,16 @@ public:
   ///
   std::string getShaderCode() override;
   ///
+  /// \brief getIntersectionCode Returns the shader code for intersecting a ray with this node exactly
+  /// \return The shader code
+  ///
+  std::string getIntersectionCode() override;
+  ///
+  /// \brief getDualShaderCode Returns the shader code that evaluates the distance along with its gradient
+  /// \return The shader code
+  ///
+  std::string getDualShaderCode() override;
+  ///
   /// \brief setTransform Sets the transformation matrix for this node
   /// \param _t New transforamtion matrix
   ///
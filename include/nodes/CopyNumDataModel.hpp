@@ -13,7 +13,7 @@ class CopyNumDataModel : public NodeDataModel
 public:
 	CopyNumDataModel() : m_val(nullptr)
 	{
-		m_val = std::make_shared<ScalarData>(boost::lexical_cast<std::string>("copyNum"));
+		m_val = std::make_shared<ScalarData>("copyNum");
 	}
 	virtual ~CopyNumDataModel() {}
 
@@ -47,6 +47,8 @@ public:
 
   DFNodeType getNodeType() const override { return DFNodeType::PRIMITIVE; }
   std::string getShaderCode() override;
+  std::string getDualShaderCode() override;
+  std::string getIntersectionCode() override;
   void setTransform(const Mat4f &_t) override;
 
 private:
@@ -2,6 +2,9 @@
 
 #include "nodeEditor/NodeData.hpp"
 #include "ExpressionEvaluator.hpp"
+#include "CompileArena.hpp"
+#include "AllocationTracker.hpp"
+#include "Profiler.hpp"
 
 /// \file DistanceFieldData.hpp
 /// \brief All the data type specific classes and structs.
@@ -53,7 +56,15 @@ enum DFNodeType
 	COLOR,
 	IO,
 	COLLAPSED,
-	COPY
+	COPY,
+	LIGHT,
+	INSTANCE
+};
+
+enum DFCodeVariant
+{
+	DISTANCE,
+	DUAL
 };
 
 class Mat4f
@@ -115,71 +126,31 @@ public:
 
 	Mat4f operator*(const Mat4f& _m) const noexcept
 	{
+		HSITHO_PROFILE_SCOPE("Mat4f::operator*");
+		HSITHO_ALLOC_STAGE(MATRIX);
 		Mat4f temp;
-		std::ostringstream row;
-
-		row << "( " << m_m4f[0][0] << " ) * ( " << _m.m_m4f[0][0] << " ) + ( " << m_m4f[1][0] << " ) * ( " << _m.m_m4f[0][1] << " ) + ( " << m_m4f[2][0] << " ) * ( " << _m.m_m4f[0][2] << " ) + ( " << m_m4f[3][0] << " ) * ( " << _m.m_m4f[0][3] << " )";
-		temp.m_m4f[0][0] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
-		row.clear();
-		row.str("");
-		row << "( " << m_m4f[0][1] << " ) * ( " << _m.m_m4f[0][0] << " ) + ( " << m_m4f[1][1] << " ) * ( " << _m.m_m4f[0][1] << " ) + ( " << m_m4f[2][1] << " ) * ( " << _m.m_m4f[0][2] << " ) + ( " << m_m4f[3][1] << " ) * ( " << _m.m_m4f[0][3] << " )";
-		temp.m_m4f[0][1] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
-		row.clear();
-		row.str("");
-		row << "( " << m_m4f[0][2] << " ) * ( " << _m.m_m4f[0][0] << " ) + ( " << m_m4f[1][2] << " ) * ( " << _m.m_m4f[0][1] << " ) + ( " << m_m4f[2][2] << " ) * ( " << _m.m_m4f[0][2] << " ) + ( " << m_m4f[3][2] << " ) * ( " << _m.m_m4f[0][3] << " )";
-		temp.m_m4f[0][2] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
-		row.clear();
-		row.str("");
-		row << "( " << m_m4f[0][3] << " ) * ( " << _m.m_m4f[0][0] << " ) + ( " << m_m4f[1][3] << " ) * ( " << _m.m_m4f[0][1] << " ) + ( " << m_m4f[2][3] << " ) * ( " << _m.m_m4f[0][2] << " ) + ( " << m_m4f[3][3] << " ) * ( " << _m.m_m4f[0][3] << " )";
-		temp.m_m4f[0][3] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
-		row.clear();
-		row.str("");
-		row << "( " << m_m4f[0][0] << " ) * ( " << _m.m_m4f[1][0] << " ) + ( " << m_m4f[1][0] << " ) * ( " << _m.m_m4f[1][1] << " ) + ( " << m_m4f[2][0] << " ) * ( " << _m.m_m4f[1][2] << " ) + ( " << m_m4f[3][0] << " ) * ( " << _m.m_m4f[1][3] << " )";
-		temp.m_m4f[1][0] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
-		row.clear();
-		row.str("");
-		row << "( " << m_m4f[0][1] << " ) * ( " << _m.m_m4f[1][0] << " ) + ( " << m_m4f[1][1] << " ) * ( " << _m.m_m4f[1][1] << " ) + ( " << m_m4f[2][1] << " ) * ( " << _m.m_m4f[1][2] << " ) + ( " << m_m4f[3][1] << " ) * ( " << _m.m_m4f[1][3] << " )";
-		temp.m_m4f[1][1] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
-		row.clear();
-		row.str("");
-		row << "( " << m_m4f[0][2] << " ) * ( " << _m.m_m4f[1][0] << " ) + ( " << m_m4f[1][2] << " ) * ( " << _m.m_m4f[1][1] << " ) + ( " << m_m4f[2][2] << " ) * ( " << _m.m_m4f[1][2] << " ) + ( " << m_m4f[3][2] << " ) * ( " << _m.m_m4f[1][3] << " )";
-		temp.m_m4f[1][2] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
-		row.clear();
-		row.str("");
-		row << "( " << m_m4f[0][3] << " ) * ( " << _m.m_m4f[1][0] << " ) + ( " << m_m4f[1][3] << " ) * ( " << _m.m_m4f[1][1] << " ) + ( " << m_m4f[2][3] << " ) * ( " << _m.m_m4f[1][2] << " ) + ( " << m_m4f[3][3] << " ) * ( " << _m.m_m4f[1][3] << " )";
-		temp.m_m4f[1][3] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
-		row.clear();
-		row.str("");
-		row << "( " << m_m4f[0][0] << " ) * ( " << _m.m_m4f[2][0] << " ) + ( " << m_m4f[1][0] << " ) * ( " << _m.m_m4f[2][1] << " ) + ( " << m_m4f[2][0] << " ) * ( " << _m.m_m4f[2][2] << " ) + ( " << m_m4f[3][0] << " ) * ( " << _m.m_m4f[2][3] << " )";
-		temp.m_m4f[2][0] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
-		row.clear();
-		row.str("");
-		row << "( " << m_m4f[0][1] << " ) * ( " << _m.m_m4f[2][0] << " ) + ( " << m_m4f[1][1] << " ) * ( " << _m.m_m4f[2][1] << " ) + ( " << m_m4f[2][1] << " ) * ( " << _m.m_m4f[2][2] << " ) + ( " << m_m4f[3][1] << " ) * ( " << _m.m_m4f[2][3] << " )";
-		temp.m_m4f[2][1] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
-		row.clear();
-		row.str("");
-		row << "( " << m_m4f[0][2] << " ) * ( " << _m.m_m4f[2][0] << " ) + ( " << m_m4f[1][2] << " ) * ( " << _m.m_m4f[2][1] << " ) + ( " << m_m4f[2][2] << " ) * ( " << _m.m_m4f[2][2] << " ) + ( " << m_m4f[3][2] << " ) * ( " << _m.m_m4f[2][3] << " )";
-		temp.m_m4f[2][2] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
-		row.clear();
-		row.str("");
-		row << "( " << m_m4f[0][3] << " ) * ( " << _m.m_m4f[2][0] << " ) + ( " << m_m4f[1][3] << " ) * ( " << _m.m_m4f[2][1] << " ) + ( " << m_m4f[2][3] << " ) * ( " << _m.m_m4f[2][2] << " ) + ( " << m_m4f[3][3] << " ) * ( " << _m.m_m4f[2][3] << " )";
-		temp.m_m4f[2][3] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
-		row.clear();
-		row.str("");
-		row << "( " << m_m4f[0][0] << " ) * ( " << _m.m_m4f[3][0] << " ) + ( " << m_m4f[1][0] << " ) * ( " << _m.m_m4f[3][1] << " ) + ( " << m_m4f[2][0] << " ) * ( " << _m.m_m4f[3][2] << " ) + ( " << m_m4f[3][0] << " ) * ( " << _m.m_m4f[3][3] << " )";
-		temp.m_m4f[3][0] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
-		row.clear();
-		row.str("");
-		row << "( " << m_m4f[0][1] << " ) * ( " << _m.m_m4f[3][0] << " ) + ( " << m_m4f[1][1] << " ) * ( " << _m.m_m4f[3][1] << " ) + ( " << m_m4f[2][1] << " ) * ( " << _m.m_m4f[3][2] << " ) + ( " << m_m4f[3][1] << " ) * ( " << _m.m_m4f[3][3] << " )";
-		temp.m_m4f[3][1] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
-		row.clear();
-		row.str("");
-		row << "( " << m_m4f[0][2] << " ) * ( " << _m.m_m4f[3][0] << " ) + ( " << m_m4f[1][2] << " ) * ( " << _m.m_m4f[3][1] << " ) + ( " << m_m4f[2][2] << " ) * ( " << _m.m_m4f[3][2] << " ) + ( " << m_m4f[3][2] << " ) * ( " << _m.m_m4f[3][3] << " )";
-		temp.m_m4f[3][2] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
-		row.clear();
-		row.str("");
-		row << "( " << m_m4f[0][3] << " ) * ( " << _m.m_m4f[3][0] << " ) + ( " << m_m4f[1][3] << " ) * ( " << _m.m_m4f[3][1] << " ) + ( " << m_m4f[2][3] << " ) * ( " << _m.m_m4f[3][2] << " ) + ( " << m_m4f[3][3] << " ) * ( " << _m.m_m4f[3][3] << " )";
-		temp.m_m4f[3][3] = hsitho::Expressions::evaluate(row.str(), "", m_cpn);
+		// Every entry is a dot product written out as an expression, one row buffer from the compile arena is reused for all 16
+		hsitho::ArenaString row(hsitho::CompileArena::resource());
+		row.reserve(256);
+
+		for(unsigned int c = 0; c < 4; ++c)
+		{
+			for(unsigned int r = 0; r < 4; ++r)
+			{
+				row.clear();
+				for(unsigned int k = 0; k < 4; ++k)
+				{
+					if(k)
+						row += " + ";
+					row += "( ";
+					row += m_m4f[k][r];
+					row += " ) * ( ";
+					row += _m.m_m4f[c][k];
+					row += " )";
+				}
+				temp.m_m4f[c][r] = hsitho::Expressions::evaluate(row, "", m_cpn);
+			}
+		}
 
 		return temp;
 	}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtWidgets/QLineEdit>
+#include <QtWidgets/QCheckBox>
+
+#include "nodeEditor/NodeDataModel.hpp"
+#include "nodes/DistanceFieldData.hpp"
+
+/// \file LightDataModel.hpp
+/// \brief Node for a light in the scene, more comments on the functions can be found in CapsulePrimitiveDataModel.hpp as all of the nodes inherit from the NodeDataModel.
+///        Lights aren't connected to the distance node, every enabled light in the scene is picked up when the scene is compiled.
+///        Built around the NodeDataModel by Dimitry Pinaev [https://github.com/paceholder/nodeeditor]
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+class LightDataModel : public NodeDataModel
+{
+  Q_OBJECT
+
+public:
+
+  LightDataModel();
+  virtual ~LightDataModel() {}
+
+  QString caption() const override
+  {
+    return QString("Light");
+  }
+
+  static QString name()
+  {
+    return QString("Light");
+  }
+
+  void save(Properties &p) const override;
+  void restore(const Properties &p) override;
+
+  void valueEdit(QString const);
+  void stateChanged(int);
+
+  unsigned int nPorts(PortType portType) const override;
+  NodeDataType dataType(PortType portType, PortIndex portIndex) const override;
+
+  std::shared_ptr<NodeData> outData(PortIndex) override { return nullptr; }
+  void setInData(std::shared_ptr<NodeData> _data, PortIndex _portIndex) override;
+
+  std::vector<QWidget *> embeddedWidget() override;
+
+  DFNodeType getNodeType() const override { return DFNodeType::LIGHT; }
+  ///
+  /// \brief getShaderCode Returns the lighting code for this light, accumulated into col inside the generated applyLights function
+  /// \return The shader code
+  ///
+  std::string getShaderCode() override;
+
+  ///
+  /// \brief isEnabled Whether the light should be included in the scene
+  /// \return True if the light is switched on and has some intensity
+  ///
+  bool isEnabled() const;
+  ///
+  /// \brief getIntensity Returns the intensity of the light, used to normalise the sum of the lights
+  /// \return The intensity
+  ///
+  std::string getIntensity() const { return m_intensity->text().toStdString(); }
+  ///
+  /// \brief getPosition Returns the position of the light, the components are expressions like in the shader code
+  ///
+  const Vec4f &getPosition() const { return m_position; }
+  ///
+  /// \brief getColor Returns the diffuse colour of the light
+  ///
+  const Vec4f &getColor() const { return m_color; }
+  ///
+  /// \brief castsShadow Whether the light traces shadow rays
+  ///
+  bool castsShadow() const { return m_shadow->isChecked(); }
+
+private:
+  Vec4f m_position;
+  Vec4f m_color;
+  QLineEdit *m_intensity;
+  QCheckBox *m_enabled;
+  QCheckBox *m_shadow;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <memory>
+
+#include <QtCore/QObject>
+#include <QtWidgets/QLineEdit>
+#include <QtWidgets/QPushButton>
+
+#include "nodeEditor/NodeDataModel.hpp"
+#include "nodes/DistanceFieldData.hpp"
+#include "sdf/DistanceVolume.hpp"
+#include "ThreadPool.hpp"
+
+/// \file MeshImportDataModel.hpp
+/// \brief Node for an imported mesh or point cloud, more comments on the functions can be found in CapsulePrimitiveDataModel.hpp as all of the nodes inherit from the NodeDataModel.
+///        The ShaderGenerator bakes the file into a distance volume when its path or resolution has changed, gives the volume
+///        one of the texture slots of the shader and the node samples it from there.
+///        Built around the NodeDataModel by Dimitry Pinaev [https://github.com/paceholder/nodeeditor]
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+class MeshImportDataModel : public NodeDataModel
+{
+  Q_OBJECT
+
+public:
+
+  MeshImportDataModel();
+  virtual ~MeshImportDataModel() {}
+
+  QString caption() const override
+  {
+    return QString("Mesh Import");
+  }
+
+  static QString name()
+  {
+    return QString("MeshImport");
+  }
+
+  void save(Properties &p) const override;
+  void restore(const Properties &p) override;
+
+  void browse();
+
+  unsigned int nPorts(PortType portType) const override;
+  NodeDataType dataType(PortType portType, PortIndex portIndex) const override;
+
+  std::shared_ptr<NodeData> outData(PortIndex) override { return nullptr; }
+  void setInData(std::shared_ptr<NodeData> _data, PortIndex _portIndex) override;
+
+  std::vector<QWidget *> embeddedWidget() override;
+
+  DFNodeType getNodeType() const override { return DFNodeType::PRIMITIVE; }
+  ///
+  /// \brief getShaderCode Samples the volume from its texture slot. Without a volume, or with more meshes in the scene than
+  ///        there are slots, the node stands in with the bounds of the mesh or nothing at all
+  /// \return The shader code
+  ///
+  std::string getShaderCode() override;
+  void setTransform(const Mat4f &_t) override;
+
+  ///
+  /// \brief volume The baked mesh, null until a file has been imported
+  ///
+  std::shared_ptr<const hsitho::sdf::DistanceVolume> volume() const { return m_volume; }
+  ///
+  /// \brief setVolumeSlot Sets the texture the volume is bound to for the next getShaderCode, set by the ShaderGenerator
+  /// \param _slot Index of the u_Volume uniform, -1 if the volume couldn't be given one
+  ///
+  void setVolumeSlot(int _slot) { m_slot = _slot; }
+  ///
+  /// \brief bake Bakes the file again if the path or the resolution have changed since the last bake, called by the
+  ///        ShaderGenerator before the volume is given a slot
+  /// \param _pool Threads the volume is baked on
+  ///
+  void bake(hsitho::ThreadPool &_pool);
+
+private:
+  ///
+  /// \brief settingsChanged Asks for the scene to be generated again, which bakes the file, if the path or the resolution
+  ///        have changed
+  ///
+  void settingsChanged();
+
+  Vec4f m_color;
+  QLineEdit *m_path;
+  QPushButton *m_browse;
+  QLineEdit *m_resolution;
+  std::string m_transform;
+  std::shared_ptr<const hsitho::sdf::DistanceVolume> m_volume;
+  QString m_importedPath;
+  QString m_importedResolution;
+  int m_slot;
+};
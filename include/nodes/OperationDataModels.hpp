@@ -47,6 +47,7 @@ public:
 
   DFNodeType getNodeType() const override { return DFNodeType::MIX; }
   std::string getShaderCode() override { return "opUnion("; }
+  std::string getDualShaderCode() override { return "opUnionD("; }
 };
 
 //------------------------------------------------------------------------------
@@ -81,6 +82,7 @@ public:
 
   DFNodeType getNodeType() const override { return DFNodeType::MIX; }
   std::string getShaderCode() override { return "opSubtraction("; }
+  std::string getDualShaderCode() override { return "opSubtractionD("; }
 };
 
 //------------------------------------------------------------------------------
@@ -115,6 +117,7 @@ public:
 
   DFNodeType getNodeType() const override { return DFNodeType::MIX; }
   std::string getShaderCode() override { return "opIntersection("; }
+  std::string getDualShaderCode() override { return "opIntersectionD("; }
 };
 
 //------------------------------------------------------------------------------
@@ -155,6 +158,7 @@ public:
 
   DFNodeType getNodeType() const override { return DFNodeType::MIX; }
   std::string getShaderCode() override { return "opBlend("; }
+  std::string getDualShaderCode() override { return "opBlendD("; }
 	std::string getExtraParams() const override {
 		if(m_blend->text().isEmpty())
 			return ", 0.0";
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <QtCore/QObject>
+#include <QtWidgets/QComboBox>
+#include <QtWidgets/QLineEdit>
+#include <QtWidgets/QPushButton>
+
+#include "nodeEditor/NodeDataModel.hpp"
+#include "nodes/DistanceFieldData.hpp"
+#include "sdf/InstanceSet.hpp"
+#include "ThreadPool.hpp"
+
+/// \file ScatterDataModel.hpp
+/// \brief Node placing copies of the field on its instance input, scattered over the surface of the field on its surface
+///        input no closer to each other than the spacing, on a grid, at random points or where a CSV file says. More
+///        comments on the functions can be found in CapsulePrimitiveDataModel.hpp as all of the nodes inherit from the
+///        NodeDataModel. The ShaderGenerator hands the node the code of both inputs, the copies are placed again when
+///        that code or the settings change and go to one of the instance buffers of the shader, which the node reads
+///        with a single call however many copies there are.
+///        Only the copies come out of the node, the surface has to be connected to the scene as well to be seen.
+///        Built around the NodeDataModel by Dimitry Pinaev [https://github.com/paceholder/nodeeditor]
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+class ScatterDataModel : public NodeDataModel
+{
+  Q_OBJECT
+
+public:
+
+  ScatterDataModel();
+  virtual ~ScatterDataModel() {}
+
+  QString caption() const override
+  {
+    return QString("Scatter");
+  }
+
+  static QString name()
+  {
+    return QString("Scatter");
+  }
+
+  void save(Properties &p) const override;
+  void restore(const Properties &p) override;
+  void valueEdit(QString const);
+  void browse();
+
+  unsigned int nPorts(PortType portType) const override;
+  NodeDataType dataType(PortType portType, PortIndex portIndex) const override;
+
+  std::shared_ptr<NodeData> outData(PortIndex) override { return nullptr; }
+  void setInData(std::shared_ptr<NodeData> _data, PortIndex _portIndex) override;
+
+  std::vector<QWidget *> embeddedWidget() override;
+
+  DFNodeType getNodeType() const override { return DFNodeType::INSTANCE; }
+  ///
+  /// \brief getShaderCode Calls the instances function of the slot of the copies. Without copies, or with more instance
+  ///        sets in the scene than there are slots, the node stands in with nothing at all
+  /// \return The shader code
+  ///
+  std::string getShaderCode() override;
+  void setTransform(const Mat4f &_t) override;
+
+  ///
+  /// \brief scatter Places the copies again if the code of the inputs, the resources it uses, the settings or the CSV file
+  ///        have changed
+  /// \param _surface Distance code of the surface input, empty if nothing is connected, only needed by the Surface source
+  /// \param _instance Distance code of the instance input, empty if nothing is connected
+  /// \param _volumes Volumes the code samples, see ShaderGenerator::volumes
+  /// \param _sets Instance sets the code calls, see ShaderGenerator::instanceSets
+  /// \param _pool Threads the surface is sampled on
+  ///
+  void scatter(const std::string &_surface, const std::string &_instance,
+               const std::vector<std::shared_ptr<const hsitho::sdf::DistanceVolume>> &_volumes,
+               const std::vector<std::shared_ptr<const hsitho::sdf::InstanceSet>> &_sets, hsitho::ThreadPool &_pool);
+  ///
+  /// \brief instances The copies, null until the inputs are connected and the copies could be placed
+  ///
+  std::shared_ptr<const hsitho::sdf::InstanceSet> instances() const { return m_instances; }
+  ///
+  /// \brief setInstanceSlot Sets the buffer the copies are read from for the next getShaderCode, set by the ShaderGenerator
+  /// \param _slot Index of the u_Instances uniform, -1 if the copies couldn't be given one
+  ///
+  void setInstanceSlot(int _slot) { m_slot = _slot; }
+
+private:
+  typedef std::tuple<std::string, std::string, QString, std::vector<const void *>> ScatterKey;
+
+  ///
+  /// \brief Source Items of m_source, where the transforms of the copies come from
+  ///
+  enum Source
+  {
+    SURFACE,
+    GRID,
+    RANDOM,
+    CSV
+  };
+
+  ///
+  /// \brief transforms Transforms of the copies from a source other than the surface
+  /// \return False if the settings don't parse or the file couldn't be read
+  ///
+  bool transforms(std::vector<glm::mat4> &_transforms, std::string &_error) const;
+
+  Vec4f m_color;
+  QComboBox *m_source;
+  QLineEdit *m_spacing;
+  QLineEdit *m_radius;
+  QLineEdit *m_seed;
+  QLineEdit *m_extent;
+  QLineEdit *m_count;
+  QLineEdit *m_path;
+  QPushButton *m_browse;
+  std::string m_transform;
+  std::shared_ptr<const hsitho::sdf::InstanceSet> m_instances;
+  ///
+  /// \brief m_scattered What the copies were scattered from, the code, settings and the resources the code uses, compared by scatter
+  ///
+  ScatterKey m_scattered;
+  int m_slot;
+};
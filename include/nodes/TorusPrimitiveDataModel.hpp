@@ -46,6 +46,7 @@ public:
 
   DFNodeType getNodeType() const override { return DFNodeType::PRIMITIVE; }
   std::string getShaderCode() override;
+  std::string getDualShaderCode() override;
 	void setTransform(const Mat4f &_t) override;
 
 private:
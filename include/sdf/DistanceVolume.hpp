@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "sdf/Interval.hpp"
+#include "sdf/Simd.hpp"
+
+/// \file DistanceVolume.hpp
+/// \brief Dense grid of signed distances an imported mesh is baked into, laid out the way it's uploaded to a 3D texture:
+///        x fastest, one normalised signed 16-bit integer per point, the distance divided by the diagonal of the bounds.
+///        Sampled by the SD_VOLUME instruction on the CPU and by sdVolume in shader.begin with the same trilinear filter.
+///        Outside the bounds the distance to the bounds is added on, so the field stays a lower bound a ray can march on
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    struct DistanceVolume
+    {
+      ///
+      /// \brief m_min Position of the first grid point, the last one is at m_max
+      ///
+      glm::vec3 m_min = glm::vec3(0.f);
+      glm::vec3 m_max = glm::vec3(1.f);
+      ///
+      /// \brief m_dims Grid points along each axis, at least 2
+      ///
+      uint32_t m_dims[3] = {2, 2, 2};
+      ///
+      /// \brief m_scale Distance a value of 32767 stands for, further points are clamped to it
+      ///
+      float m_scale = 1.f;
+      std::vector<int16_t> m_values;
+
+      ///
+      /// \brief resize Sets the bounds and the resolution and fills the grid with the largest distance
+      ///
+      void resize(const glm::vec3 &_min, const glm::vec3 &_max, const uint32_t _dims[3])
+      {
+        m_min = _min;
+        m_max = _max;
+        std::copy(_dims, _dims + 3, m_dims);
+        m_scale = glm::length(_max - _min);
+        m_values.assign(static_cast<size_t>(_dims[0]) * _dims[1] * _dims[2], 32767);
+      }
+
+      size_t index(uint32_t _i, uint32_t _j, uint32_t _k) const { return (static_cast<size_t>(_k) * m_dims[1] + _j) * m_dims[0] + _i; }
+      glm::vec3 spacing() const { return (m_max - m_min) / glm::vec3(m_dims[0] - 1, m_dims[1] - 1, m_dims[2] - 1); }
+      glm::vec3 point(uint32_t _i, uint32_t _j, uint32_t _k) const { return m_min + spacing() * glm::vec3(_i, _j, _k); }
+
+      ///
+      /// \brief set Quantises the distance of a grid point, -32768 is left out so the values are symmetric like snorm's
+      ///
+      void set(uint32_t _i, uint32_t _j, uint32_t _k, float _distance)
+      {
+        float v = std::round(std::min(std::max(_distance / m_scale, -1.f), 1.f) * 32767.f);
+        m_values[index(_i, _j, _k)] = static_cast<int16_t>(v);
+      }
+      float value(uint32_t _i, uint32_t _j, uint32_t _k) const { return m_values[index(_i, _j, _k)] * (m_scale / 32767.f); }
+
+      ///
+      /// \brief sample Trilinear interpolation of the grid, the bounds clamp the position and their distance is added on
+      ///
+      float sample(float _x, float _y, float _z) const
+      {
+        glm::vec3 p(_x, _y, _z);
+        glm::vec3 q = glm::clamp(p, m_min, m_max);
+        glm::vec3 g = (q - m_min) / (m_max - m_min) * glm::vec3(m_dims[0] - 1, m_dims[1] - 1, m_dims[2] - 1);
+        uint32_t i = std::min(static_cast<uint32_t>(g.x), m_dims[0] - 2);
+        uint32_t j = std::min(static_cast<uint32_t>(g.y), m_dims[1] - 2);
+        uint32_t k = std::min(static_cast<uint32_t>(g.z), m_dims[2] - 2);
+        glm::vec3 t = g - glm::vec3(i, j, k);
+        const int16_t *v = &m_values[index(i, j, k)];
+        size_t dy = m_dims[0];
+        size_t dz = static_cast<size_t>(m_dims[0]) * m_dims[1];
+        float c00 = v[0] + (v[1] - v[0]) * t.x;
+        float c01 = v[dy] + (v[dy + 1] - v[dy]) * t.x;
+        float c10 = v[dz] + (v[dz + 1] - v[dz]) * t.x;
+        float c11 = v[dz + dy] + (v[dz + dy + 1] - v[dz + dy]) * t.x;
+        float c0 = c00 + (c01 - c00) * t.y;
+        float c1 = c10 + (c11 - c10) * t.y;
+        float d = (c0 + (c1 - c0) * t.z) * (m_scale / 32767.f);
+        float o = glm::length(p - q);
+        return o > 0.f ? std::max(d - o, o) : d;
+      }
+
+      Lanes sample(const Lanes &_x, const Lanes &_y, const Lanes &_z) const
+      {
+        alignas(32) float x[Lanes::c_width], y[Lanes::c_width], z[Lanes::c_width];
+        _x.store(x);
+        _y.store(y);
+        _z.store(z);
+        for(size_t i = 0; i < Lanes::c_width; ++i)
+          x[i] = sample(x[i], y[i], z[i]);
+        return Lanes::load(x);
+      }
+
+      ///
+      /// \brief sample Bounds of the distance over a box. The interpolation stays between the grid points around it so a
+      ///        small box inside the bounds scans them, anything else takes the centre and how fast the field can change:
+      ///        sqrt(3) for the interpolation plus 1 for the distance to the bounds
+      ///
+      Interval sample(const Interval &_x, const Interval &_y, const Interval &_z) const
+      {
+        glm::vec3 lo(_x.m_lo, _y.m_lo, _z.m_lo);
+        glm::vec3 hi(_x.m_hi, _y.m_hi, _z.m_hi);
+        if(!(glm::all(glm::lessThanEqual(lo, hi)) && std::isfinite(lo.x + lo.y + lo.z + hi.x + hi.y + hi.z)))
+          return Interval::entire();
+
+        glm::vec3 n(m_dims[0] - 1, m_dims[1] - 1, m_dims[2] - 1);
+        glm::vec3 g0 = glm::floor((lo - m_min) / (m_max - m_min) * n);
+        glm::vec3 g1 = glm::ceil((hi - m_min) / (m_max - m_min) * n);
+        glm::vec3 cells = g1 - g0 + 1.f;
+        if(glm::all(glm::greaterThanEqual(lo, m_min)) && glm::all(glm::lessThanEqual(hi, m_max)) && cells.x * cells.y * cells.z <= 4096.f)
+        {
+          uint32_t i0 = static_cast<uint32_t>(g0.x), j0 = static_cast<uint32_t>(g0.y), k0 = static_cast<uint32_t>(g0.z);
+          uint32_t i1 = std::min(static_cast<uint32_t>(g1.x), m_dims[0] - 1);
+          uint32_t j1 = std::min(static_cast<uint32_t>(g1.y), m_dims[1] - 1);
+          uint32_t k1 = std::min(static_cast<uint32_t>(g1.z), m_dims[2] - 1);
+          int lowest = 32767, highest = -32767;
+          for(uint32_t k = k0; k <= k1; ++k)
+            for(uint32_t j = j0; j <= j1; ++j)
+              for(uint32_t i = i0; i <= i1; ++i)
+              {
+                int v = m_values[index(i, j, k)];
+                lowest = std::min(lowest, v);
+                highest = std::max(highest, v);
+              }
+          return outward(lowest * (m_scale / 32767.f), highest * (m_scale / 32767.f));
+        }
+
+        glm::vec3 centre = 0.5f * (lo + hi);
+        float radius = (std::sqrt(3.f) + 1.f) * glm::length(0.5f * (hi - lo));
+        float d = sample(centre.x, centre.y, centre.z);
+        return outward(d - radius, d + radius);
+      }
+    };
+  }
+}
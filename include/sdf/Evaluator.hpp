@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "sdf/Program.hpp"
+#include "sdf/Simd.hpp"
+
+/// \file Evaluator.hpp
+/// \brief Runs a compiled Program on the CPU for batches of points, Lanes::c_width points at a time. An evaluator owns its
+///        registers, so one evaluator per thread can share the same Program
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    class Evaluator
+    {
+    public:
+      ///
+      /// \brief Evaluator Default ctor, sets the time to 0
+      /// \param _program Compiled distance field of the scene
+      ///
+      Evaluator(std::shared_ptr<const Program> _program);
+
+      ///
+      /// \brief setTime Sets u_GlobalTime and recomputes everything that only depends on it
+      /// \param _time Time of the scene
+      ///
+      void setTime(float _time);
+      ///
+      /// \brief evaluate Evaluates the distance field at a list of points given as separate coordinate arrays
+      /// \param _x X coordinates of the points
+      /// \param _y Y coordinates of the points
+      /// \param _z Z coordinates of the points
+      /// \param _count Number of points
+      /// \param _distance Distance at each point
+      /// \param _r Optional red component of the colour at each point, same for _g and _b
+      ///
+      void evaluate(const float *_x, const float *_y, const float *_z, size_t _count, float *_distance, float *_r = nullptr, float *_g = nullptr, float *_b = nullptr);
+      ///
+      /// \brief evaluate Evaluates a single point, convenient but doesn't use the width of the batches
+      /// \param _p Position to evaluate
+      /// \return Distance and colour like map in the shader
+      ///
+      glm::vec4 evaluate(const glm::vec3 &_p);
+
+      const Program &program() const { return *m_program; }
+
+    private:
+      ///
+      /// \brief evaluateBatch Runs the per point code on one full batch
+      /// \param _x X coordinates of Lanes::c_width points, the same for _y and _z
+      /// \param _out Distance, red, green and blue of each point, Lanes::c_width floats each
+      ///
+      void evaluateBatch(const float *_x, const float *_y, const float *_z, float *_out);
+
+      std::shared_ptr<const Program> m_program;
+      std::vector<Lanes> m_registers;
+    };
+  }
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "sdf/Interval.hpp"
+#include "sdf/Program.hpp"
+#include "sdf/Simd.hpp"
+
+/// \file InstanceSet.hpp
+/// \brief Copies of one subtree placed by a list of transforms, what the SD_INSTANCES instruction evaluates. The subtree
+///        is compiled once and run for every copy in its own space instead of being written out once per copy, so a
+///        scene with thousands of copies compiles as fast as one with a single copy. Every copy is bounded by a sphere
+///        around its origin and filed in the cell of a uniform grid its origin is in. The cells are at least as wide as
+///        the largest sphere, so a point only runs the copies in its own cell and the 26 around it: any other copy is at
+///        least a cell further away than that, which is returned instead when it's closer. Cells away from every copy
+///        also know how many cells there are to the nearest one, so empty space is crossed in long steps. Within the
+///        cells a copy is skipped once its sphere is further away than the closest copy found so far.
+///        The same grid is uploaded to a buffer texture for the instances functions the ShaderGenerator writes
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    class InstanceSet
+    {
+    public:
+      ///
+      /// \brief c_texelsPerInstance RGBA32F texels of a copy in the buffer texture: the three rows of the transform from
+      ///        the world to the copy, then the factor taking distances of the copy back to the world
+      ///
+      static constexpr size_t c_texelsPerInstance = 4;
+      ///
+      /// \brief c_headerTexels Texels before the cells in the buffer texture: the origin of the grid and the width of
+      ///        its cells, then the cells along each axis and the radius of the largest sphere
+      ///
+      static constexpr size_t c_headerTexels = 2;
+      ///
+      /// \brief c_maxCells Cells the grid is kept under by widening them, a texel each in the buffer texture
+      ///
+      static constexpr size_t c_maxCells = size_t(1) << 18;
+
+      ///
+      /// \brief InstanceSet Default ctor
+      /// \param _instance The subtree, compiled from a map function of its own
+      /// \param _transforms Transform of every copy, from the space of the subtree to the world
+      /// \param _radius Radius of a sphere around the origin of the subtree that holds all of its surface
+      ///
+      InstanceSet(std::shared_ptr<const Program> _instance, const std::vector<glm::mat4> &_transforms, float _radius);
+
+      ///
+      /// \brief distance Distance to the closest copy
+      /// \param _time Time the subtree runs at, the same in every lane
+      ///
+      float distance(float _x, float _y, float _z, float _time) const;
+      Lanes distance(const Lanes &_x, const Lanes &_y, const Lanes &_z, const Lanes &_time) const;
+      Interval distance(const Interval &_x, const Interval &_y, const Interval &_z, const Interval &_time) const;
+
+      size_t size() const { return m_instances.size(); }
+      float radius() const { return m_radius; }
+      const std::vector<glm::mat4> &transforms() const { return m_transforms; }
+      float cellSize() const { return m_cellSize; }
+      glm::uvec3 cells() const { return glm::uvec3(m_dims[0], m_dims[1], m_dims[2]); }
+      ///
+      /// \brief texels Contents of the buffer texture: c_headerTexels of header, then one texel per cell with the first
+      ///        copy in it, the number of copies and the cells to the nearest copy, x fastest, then c_texelsPerInstance
+      ///        per copy in the order of the cells
+      ///
+      const std::vector<glm::vec4> &texels() const { return m_texels; }
+
+    private:
+      struct Instance
+      {
+        ///
+        /// \brief m_rows Rows of the transform from the world to the copy
+        ///
+        glm::vec4 m_rows[3];
+        ///
+        /// \brief m_scale Smallest factor a distance in the copy stretches by in the world, one over the largest
+        ///        stretch of m_rows
+        ///
+        float m_scale;
+      };
+
+      struct Cell
+      {
+        uint32_t m_first;
+        uint32_t m_count;
+        ///
+        /// \brief m_empty Cells to the nearest cell with a copy in it along the axis furthest from it, 0 if this one has one
+        ///
+        float m_empty;
+      };
+
+      ///
+      /// \brief buildGrid Picks the width of the cells, files the copies in them and finds how far the empty ones reach
+      /// \param _centres Origin of every copy in the world
+      ///
+      void buildGrid(const std::vector<glm::vec3> &_centres);
+      ///
+      /// \brief cellRange Cells a box of points is in, along one axis. Points outside the grid count as one cell beyond it
+      ///
+      void cellRange(float _lo, float _hi, int _axis, int &_first, int &_last) const;
+      ///
+      /// \brief farBounds Least and most, over a box, of the lower bound of the distance to the copies outside the cells
+      ///        around the box: the cells to the nearest copy and the distance to the grid, less the largest sphere
+      /// \param _nearest Fewest cells to the nearest copy from a cell of the box
+      ///
+      void farBounds(const glm::vec3 &_lo, const glm::vec3 &_hi, float &_least, float &_most, float &_nearest) const;
+      ///
+      /// \brief far Bound of the copies outside the cells around a point, or around each lane, or the least and the
+      ///        most over an interval
+      ///
+      float far(float _x, float _y, float _z, float &_nearest) const;
+      Lanes far(const Lanes &_x, const Lanes &_y, const Lanes &_z, float &_nearest) const;
+      Interval far(const Interval &_x, const Interval &_y, const Interval &_z, float &_nearest) const;
+
+      template<typename T>
+      T closest(const T &_x, const T &_y, const T &_z, float _time) const;
+      ///
+      /// \brief uniforms Uniform registers of the subtree at a time, computed once when the subtree doesn't use the time
+      ///
+      const std::vector<float> &uniforms(float _time, std::vector<float> &_scratch) const;
+
+      std::shared_ptr<const Program> m_instance;
+      std::vector<glm::mat4> m_transforms;
+      ///
+      /// \brief m_instances The copies in the order of the cells
+      ///
+      std::vector<Instance> m_instances;
+      std::vector<Cell> m_cells;
+      std::vector<glm::vec4> m_texels;
+      std::vector<float> m_uniforms;
+      float m_radius;
+      ///
+      /// \brief m_maxRadius Radius of the largest sphere in the world, around the origin of its copy
+      ///
+      float m_maxRadius;
+      glm::vec3 m_origin;
+      float m_cellSize;
+      int m_dims[3];
+    };
+  }
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+/// \file Interval.hpp
+/// \brief Range of values a float may take, with the GLSL built-ins the kernels use written so that the result contains
+///        every value the operation can produce for inputs in the ranges. Running a Program on intervals therefore gives
+///        bounds of the distance over a whole box. The ends are rounded outwards after every inexact operation so the
+///        bounds hold despite float rounding. The bounds are conservative but not tight, an expression using the same
+///        value twice (x - x) doesn't know the uses are correlated
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    struct Interval
+    {
+      float m_lo;
+      float m_hi;
+
+      static Interval point(float _f) { return Interval{_f, _f}; }
+      static Interval entire() { return Interval{-std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()}; }
+
+      bool contains(float _f) const { return m_lo <= _f && _f <= m_hi; }
+    };
+
+    ///
+    /// \brief outward Widens an interval by at least one unit in the last place on both ends, cheaper than nextafter and
+    ///        enough to cover the rounding of one operation. NaN ends give the entire line
+    ///
+    inline Interval outward(float _lo, float _hi)
+    {
+      const float epsilon = std::numeric_limits<float>::epsilon();
+      const float tiny = std::numeric_limits<float>::min();
+      float lo = _lo - (std::fabs(_lo) * epsilon + tiny);
+      float hi = _hi + (std::fabs(_hi) * epsilon + tiny);
+      if(!(lo <= hi))
+        return Interval::entire();
+      return Interval{lo, hi};
+    }
+
+    ///
+    /// \brief hull Smallest interval containing both
+    ///
+    inline Interval hull(const Interval &_a, const Interval &_b)
+    {
+      return Interval{_a.m_lo < _b.m_lo ? _a.m_lo : _b.m_lo, _a.m_hi < _b.m_hi ? _b.m_hi : _a.m_hi};
+    }
+
+    inline Interval operator+(const Interval &_a, const Interval &_b) { return outward(_a.m_lo + _b.m_lo, _a.m_hi + _b.m_hi); }
+    inline Interval operator-(const Interval &_a, const Interval &_b) { return outward(_a.m_lo - _b.m_hi, _a.m_hi - _b.m_lo); }
+    inline Interval operator-(const Interval &_a) { return Interval{-_a.m_hi, -_a.m_lo}; }
+
+    inline Interval operator*(const Interval &_a, const Interval &_b)
+    {
+      float p[4] = {_a.m_lo * _b.m_lo, _a.m_lo * _b.m_hi, _a.m_hi * _b.m_lo, _a.m_hi * _b.m_hi};
+      float lo = p[0], hi = p[0];
+      for(int i = 1; i < 4; ++i)
+      {
+        // 0 * inf is NaN, which outward turns into the entire line
+        if(std::isnan(p[i]))
+          return Interval::entire();
+        lo = p[i] < lo ? p[i] : lo;
+        hi = hi < p[i] ? p[i] : hi;
+      }
+      return outward(lo, hi);
+    }
+
+    inline Interval operator/(const Interval &_a, const Interval &_b)
+    {
+      if(_b.contains(0.f))
+        return Interval::entire();
+      return _a * outward(1.f / _b.m_hi, 1.f / _b.m_lo);
+    }
+
+    inline Interval min(const Interval &_a, const Interval &_b)
+    {
+      return Interval{_b.m_lo < _a.m_lo ? _b.m_lo : _a.m_lo, _b.m_hi < _a.m_hi ? _b.m_hi : _a.m_hi};
+    }
+
+    inline Interval max(const Interval &_a, const Interval &_b)
+    {
+      return Interval{_a.m_lo < _b.m_lo ? _b.m_lo : _a.m_lo, _a.m_hi < _b.m_hi ? _b.m_hi : _a.m_hi};
+    }
+
+    inline Interval operator+(const Interval &_a, float _b) { return _a + Interval::point(_b); }
+    inline Interval operator-(const Interval &_a, float _b) { return _a - Interval::point(_b); }
+    inline Interval operator*(const Interval &_a, float _b) { return _a * Interval::point(_b); }
+    inline Interval operator+(float _a, const Interval &_b) { return Interval::point(_a) + _b; }
+    inline Interval operator-(float _a, const Interval &_b) { return Interval::point(_a) - _b; }
+    inline Interval operator*(float _a, const Interval &_b) { return Interval::point(_a) * _b; }
+    inline Interval min(const Interval &_a, float _b) { return min(_a, Interval::point(_b)); }
+    inline Interval max(const Interval &_a, float _b) { return max(_a, Interval::point(_b)); }
+
+    inline Interval abs(const Interval &_a)
+    {
+      if(_a.m_lo >= 0.f)
+        return _a;
+      if(_a.m_hi <= 0.f)
+        return -_a;
+      return Interval{0.f, -_a.m_lo < _a.m_hi ? _a.m_hi : -_a.m_lo};
+    }
+
+    ///
+    /// \brief square Tighter than _a * _a, which can't tell both factors are the same and goes negative around 0
+    ///
+    inline Interval square(const Interval &_a)
+    {
+      Interval a = abs(_a);
+      return outward(a.m_lo * a.m_lo, a.m_hi * a.m_hi);
+    }
+
+    inline Interval sqrt(const Interval &_a)
+    {
+      Interval r = outward(std::sqrt(_a.m_lo > 0.f ? _a.m_lo : 0.f), std::sqrt(_a.m_hi > 0.f ? _a.m_hi : 0.f));
+      r.m_lo = r.m_lo > 0.f ? r.m_lo : 0.f;
+      return r;
+    }
+
+    // The lengths used by the distance functions, found by the kernels through argument dependent lookup and preferred
+    // over their generic versions so the squares stay positive
+    inline Interval length(const Interval &_x, const Interval &_y) { return sqrt(square(_x) + square(_y)); }
+    inline Interval length(const Interval &_x, const Interval &_y, const Interval &_z) { return sqrt(square(_x) + square(_y) + square(_z)); }
+
+    inline Interval floor(const Interval &_a) { return Interval{std::floor(_a.m_lo), std::floor(_a.m_hi)}; }
+
+    ///
+    /// \brief mod GLSL mod, exact when the range stays within one period, which is what keeps the repetitions of the copy
+    ///        node tight instead of spanning a whole period for every box
+    ///
+    inline Interval mod(const Interval &_x, const Interval &_y)
+    {
+      if(_y.m_lo == _y.m_hi && _y.m_lo > 0.f && std::isfinite(_x.m_lo) && std::isfinite(_x.m_hi))
+      {
+        float k = std::floor(_x.m_lo / _y.m_lo);
+        if(k == std::floor(_x.m_hi / _y.m_lo))
+          return _x - _y * Interval::point(k);
+        // Straddles a multiple, the rounded floor may be one off near it so allow a little either side of a period
+        float margin = std::fabs(_x.m_lo) < std::fabs(_x.m_hi) ? std::fabs(_x.m_hi) : std::fabs(_x.m_lo);
+        margin = margin * 4.f * std::numeric_limits<float>::epsilon();
+        return outward(-margin, _y.m_lo + margin);
+      }
+      return _x - _y * floor(_x / _y);
+    }
+
+    inline Interval sign(const Interval &_a)
+    {
+      auto s = [](float _f) { return _f > 0.f ? 1.f : (_f < 0.f ? -1.f : 0.f); };
+      return Interval{s(_a.m_lo), s(_a.m_hi)};
+    }
+
+    ///
+    /// \brief selectLessEqual Either branch when the comparison can go both ways over the ranges
+    ///
+    inline Interval selectLessEqual(const Interval &_a, const Interval &_b, const Interval &_t, const Interval &_f)
+    {
+      if(_a.m_hi <= _b.m_lo)
+        return _t;
+      if(_a.m_lo > _b.m_hi)
+        return _f;
+      return hull(_t, _f);
+    }
+
+    inline Interval sin(const Interval &_a)
+    {
+      const float twoPi = 6.2831853f;
+      if(!(_a.m_hi - _a.m_lo < twoPi))
+        return Interval{-1.f, 1.f};
+      float a = std::sin(_a.m_lo), b = std::sin(_a.m_hi);
+      Interval r = a < b ? outward(a, b) : outward(b, a);
+      // The extremes are reached inside wherever pi/2 + 2k pi (maximum) or -pi/2 + 2k pi (minimum) fall in the range
+      auto reaches = [&](float _phase) { return std::floor((_a.m_hi - _phase) / twoPi) * twoPi + _phase >= _a.m_lo; };
+      if(reaches(1.5707963f))
+        r.m_hi = 1.f;
+      if(reaches(-1.5707963f))
+        r.m_lo = -1.f;
+      r.m_lo = r.m_lo < -1.f ? -1.f : r.m_lo;
+      r.m_hi = r.m_hi > 1.f ? 1.f : r.m_hi;
+      return r;
+    }
+
+    inline Interval cos(const Interval &_a) { return sin(_a + 1.5707963f); }
+  }
+}
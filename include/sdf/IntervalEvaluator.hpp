@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "sdf/Interval.hpp"
+#include "sdf/Program.hpp"
+
+/// \file IntervalEvaluator.hpp
+/// \brief Runs a compiled Program on intervals to bound the distance field over an axis aligned box. Every operation of
+///        the program, the distance functions, the CSG operations and blends, the transforms and the mod of the copy
+///        node, runs on the ranges of its operands, so a box whose range doesn't contain 0 is guaranteed to be empty of
+///        surface whatever the field overestimates. The time can be a range too, giving bounds that hold for a whole
+///        animation. Like the Evaluator it owns its registers, so use one per thread
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    class IntervalEvaluator
+    {
+    public:
+      ///
+      /// \brief IntervalEvaluator Default ctor, sets the time to 0
+      /// \param _program Compiled distance field of the scene
+      ///
+      IntervalEvaluator(std::shared_ptr<const Program> _program);
+
+      ///
+      /// \brief setTime Sets u_GlobalTime and recomputes everything that only depends on it
+      /// \param _time Time of the scene
+      ///
+      void setTime(float _time) { setTimeRange(_time, _time); }
+      ///
+      /// \brief setTimeRange Lets u_GlobalTime take any value of a range, the bounds then hold for all of them
+      /// \param _from First time
+      /// \param _to Last time
+      ///
+      void setTimeRange(float _from, float _to);
+      ///
+      /// \brief evaluate Bounds the distance over a box
+      /// \param _min Lower corner of the box
+      /// \param _max Upper corner of the box
+      /// \return Range containing the distance at every point of the box
+      ///
+      Interval evaluate(const glm::vec3 &_min, const glm::vec3 &_max);
+
+      const Program &program() const { return *m_program; }
+
+    private:
+      std::shared_ptr<const Program> m_program;
+      std::vector<Interval> m_registers;
+    };
+  }
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <memory>
+
+#include "sdf/DistanceVolume.hpp"
+#include "sdf/InstanceSet.hpp"
+#include "sdf/Program.hpp"
+#include "sdf/Simd.hpp"
+
+/// \file Kernels.hpp
+/// \brief The operations of a Program written once for plain floats and for Lanes. The distance functions are line by line
+///        translations of the ones in shader.begin (originally by Inigo Quilez) so the CPU and the GPU agree
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    namespace kernels
+    {
+      template<typename T>
+      inline T clamp(const T &_x, float _lo, float _hi) { return min(max(_x, _lo), _hi); }
+
+      template<typename T>
+      inline T mod(const T &_x, const T &_y) { return _x - _y * floor(_x / _y); }
+
+      template<typename T>
+      inline T length(const T &_x, const T &_y) { return sqrt(_x * _x + _y * _y); }
+
+      template<typename T>
+      inline T length(const T &_x, const T &_y, const T &_z) { return sqrt(_x * _x + _y * _y + _z * _z); }
+
+      template<typename T>
+      inline T sdBox(const T &_px, const T &_py, const T &_pz, const T &_bx, const T &_by, const T &_bz)
+      {
+        T dx = abs(_px) - _bx;
+        T dy = abs(_py) - _by;
+        T dz = abs(_pz) - _bz;
+        return min(max(dx, max(dy, dz)), 0.f) + length(max(dx, 0.f), max(dy, 0.f), max(dz, 0.f));
+      }
+
+      template<typename T>
+      inline T udBox(const T &_px, const T &_py, const T &_pz, const T &_bx, const T &_by, const T &_bz)
+      {
+        return length(max(abs(_px) - _bx, 0.f), max(abs(_py) - _by, 0.f), max(abs(_pz) - _bz, 0.f));
+      }
+
+      template<typename T>
+      inline T sdCappedCylinder(const T &_px, const T &_py, const T &_pz, const T &_hx, const T &_hy)
+      {
+        T dx = abs(length(_px, _pz)) - _hx;
+        T dy = abs(_py) - _hy;
+        return min(max(dx, dy), 0.f) + length(max(dx, 0.f), max(dy, 0.f));
+      }
+
+      template<typename T>
+      inline T sdCappedCone(const T &_px, const T &_py, const T &_pz, const T &_cx, const T &_cy, const T &_cz)
+      {
+        T qx = length(_px, _pz);
+        T qy = _py;
+        T vx = _cz * _cy / _cx;
+        T vy = -_cz;
+        T wx = vx - qx;
+        T wy = vy - qy;
+        T vvx = vx * vx + vy * vy;
+        T vvy = vx * vx;
+        T qvx = vx * wx + vy * wy;
+        T qvy = vx * wx;
+        T dx = max(qvx, 0.f) * qvx / vvx;
+        T dy = max(qvy, 0.f) * qvy / vvy;
+        return sqrt(wx * wx + wy * wy - max(dx, dy)) * sign(max(qy * vx - qx * vy, wy));
+      }
+
+      template<typename T>
+      inline T sdCapsule(const T &_px, const T &_py, const T &_pz, const T &_ax, const T &_ay, const T &_az, const T &_bx, const T &_by, const T &_bz, const T &_r)
+      {
+        T pax = _px - _ax, pay = _py - _ay, paz = _pz - _az;
+        T bax = _bx - _ax, bay = _by - _ay, baz = _bz - _az;
+        T h = clamp((pax * bax + pay * bay + paz * baz) / (bax * bax + bay * bay + baz * baz), 0.f, 1.f);
+        return length(pax - bax * h, pay - bay * h, paz - baz * h) - _r;
+      }
+
+      ///
+      /// \brief uniformIndex Index a uniform register holds, the same in every lane or at both ends of an interval
+      ///
+      inline size_t uniformIndex(float _r) { return static_cast<size_t>(_r); }
+      inline size_t uniformIndex(const Interval &_r) { return static_cast<size_t>(_r.m_lo); }
+      inline size_t uniformIndex(const Lanes &_r)
+      {
+        alignas(32) float v[Lanes::c_width];
+        _r.store(v);
+        return static_cast<size_t>(v[0]);
+      }
+
+      ///
+      /// \brief execute Runs one instruction on a register file of floats or of Lanes
+      /// \param _ins Instruction to run
+      /// \param _r Register file
+      /// \param _operands Operand registers of the program
+      /// \param _program Program the instruction is from, only read by SD_VOLUME and SD_INSTANCES for its volumes and instances
+      ///
+      template<typename T>
+      inline void execute(const Instruction &_ins, T *_r, const uint32_t *_operands, const Program *_program = nullptr)
+      {
+        const uint32_t *o = _operands + _ins.m_first;
+        T &d = _r[_ins.m_dst];
+        switch(_ins.m_op)
+        {
+          case Op::ADD: d = _r[o[0]] + _r[o[1]]; break;
+          case Op::SUB: d = _r[o[0]] - _r[o[1]]; break;
+          case Op::MUL: d = _r[o[0]] * _r[o[1]]; break;
+          case Op::DIV: d = _r[o[0]] / _r[o[1]]; break;
+          case Op::NEG: d = -_r[o[0]]; break;
+          case Op::MIN: d = min(_r[o[0]], _r[o[1]]); break;
+          case Op::MAX: d = max(_r[o[0]], _r[o[1]]); break;
+          case Op::ABS: d = abs(_r[o[0]]); break;
+          case Op::SQRT: d = sqrt(_r[o[0]]); break;
+          case Op::FLOOR: d = floor(_r[o[0]]); break;
+          case Op::SIGN: d = sign(_r[o[0]]); break;
+          case Op::SIN: d = sin(_r[o[0]]); break;
+          case Op::COS: d = cos(_r[o[0]]); break;
+          case Op::CLAMP: d = min(max(_r[o[0]], _r[o[1]]), _r[o[2]]); break;
+          case Op::MIX: d = _r[o[0]] * (1.f - _r[o[2]]) + _r[o[1]] * _r[o[2]]; break;
+          case Op::MOD: d = mod(_r[o[0]], _r[o[1]]); break;
+          case Op::SELECT_LE: d = selectLessEqual(_r[o[0]], _r[o[1]], _r[o[2]], _r[o[3]]); break;
+          case Op::COPY: d = _r[o[0]]; break;
+
+          case Op::SD_SPHERE:
+            d = length(_r[o[0]], _r[o[1]], _r[o[2]]) - _r[o[3]];
+          break;
+          case Op::SD_BOX:
+            d = sdBox(_r[o[0]], _r[o[1]], _r[o[2]], _r[o[3]], _r[o[4]], _r[o[5]]);
+          break;
+          case Op::SD_FAST_BOX:
+            d = max(abs(_r[o[0]]) - _r[o[3]], max(abs(_r[o[1]]) - _r[o[3]], abs(_r[o[2]]) - _r[o[3]]));
+          break;
+          case Op::SD_TORUS:
+            d = length(length(_r[o[0]], _r[o[2]]) - _r[o[3]], _r[o[1]]) - _r[o[4]];
+          break;
+          case Op::SD_CYLINDER:
+            d = length(_r[o[0]] - _r[o[3]], _r[o[2]] - _r[o[4]]) - _r[o[5]];
+          break;
+          case Op::SD_CONE:
+            d = _r[o[3]] * length(_r[o[0]], _r[o[1]]) + _r[o[4]] * _r[o[2]];
+          break;
+          case Op::SD_PLANE:
+            d = _r[o[0]] * _r[o[3]] + _r[o[1]] * _r[o[4]] + _r[o[2]] * _r[o[5]] + _r[o[6]];
+          break;
+          case Op::SD_HEX_PRISM:
+          {
+            T qx = abs(_r[o[0]]), qy = abs(_r[o[1]]), qz = abs(_r[o[2]]);
+            d = max(qz - _r[o[4]], max(qx * 0.866025f + qy * 0.5f, qy) - _r[o[3]]);
+          }
+          break;
+          case Op::SD_TRI_PRISM:
+          {
+            T qx = abs(_r[o[0]]), qz = abs(_r[o[2]]);
+            d = max(qz - _r[o[4]], max(qx * 0.866025f + _r[o[1]] * 0.5f, -_r[o[1]]) - _r[o[3]] * 0.5f);
+          }
+          break;
+          case Op::SD_CAPSULE:
+            d = sdCapsule(_r[o[0]], _r[o[1]], _r[o[2]], _r[o[3]], _r[o[4]], _r[o[5]], _r[o[6]], _r[o[7]], _r[o[8]], _r[o[9]]);
+          break;
+          case Op::SD_CAPPED_CYLINDER:
+            d = sdCappedCylinder(_r[o[0]], _r[o[1]], _r[o[2]], _r[o[3]], _r[o[4]]);
+          break;
+          case Op::SD_CAPPED_CONE:
+            d = sdCappedCone(_r[o[0]], _r[o[1]], _r[o[2]], _r[o[3]], _r[o[4]], _r[o[5]]);
+          break;
+          case Op::SD_ELLIPSOID:
+            d = (length(_r[o[0]] / _r[o[3]], _r[o[1]] / _r[o[4]], _r[o[2]] / _r[o[5]]) - 1.f) * min(min(_r[o[3]], _r[o[4]]), _r[o[5]]);
+          break;
+          case Op::UD_BOX:
+            d = udBox(_r[o[0]], _r[o[1]], _r[o[2]], _r[o[3]], _r[o[4]], _r[o[5]]);
+          break;
+          case Op::UD_ROUND_BOX:
+            d = udBox(_r[o[0]], _r[o[1]], _r[o[2]], _r[o[3]], _r[o[4]], _r[o[5]]) - _r[o[6]];
+          break;
+          case Op::SD_VOLUME:
+            d = _program->m_volumes[uniformIndex(_r[o[3]])]->sample(_r[o[0]], _r[o[1]], _r[o[2]]);
+          break;
+          case Op::SD_INSTANCES:
+            d = _program->m_instances[uniformIndex(_r[o[3]])]->distance(_r[o[0]], _r[o[1]], _r[o[2]], _r[o[4]]);
+          break;
+          default:
+          break;
+        }
+      }
+    }
+  }
+}
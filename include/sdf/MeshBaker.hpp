@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "sdf/DistanceVolume.hpp"
+#include "sdf/TriangleBvh.hpp"
+#include "ThreadPool.hpp"
+
+/// \file MeshBaker.hpp
+/// \brief Bakes the signed distance of a mesh or a point cloud into a DistanceVolume. The grid is split into blocks of
+///        16^3 cells spread over a thread pool and every block refines an octree: a cell whose corners are all far from
+///        the surface on the same side is filled by interpolating its corners, lowered by how much the distance can bend
+///        within it, so only the points near the surface and the corners of the octree cost a closest point query. The
+///        sign comes from a neighbouring point when the surface can't be between them and from the winding number of the
+///        mesh otherwise. Point clouds take the side of the normal of the closest point instead
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    class MeshBaker
+    {
+    public:
+      struct Settings
+      {
+        ///
+        /// \brief m_resolution Grid points along the longest side of the bounds, the padding included
+        ///
+        uint32_t m_resolution = 128;
+        ///
+        /// \brief m_padding Grid points added around the bounds of the mesh on every side
+        ///
+        uint32_t m_padding = 4;
+      };
+
+      ///
+      /// \brief MeshBaker Default ctor
+      /// \param _pool Threads the blocks are baked on
+      ///
+      explicit MeshBaker(ThreadPool &_pool);
+
+      ///
+      /// \brief bake Samples the signed distance of a mesh
+      /// \param _bvh Hierarchy over the triangles or the points of the mesh
+      /// \param _normals Normal of every vertex in the order of the mesh, needed by point clouds and unused by meshes
+      /// \param _settings Resolution and padding
+      /// \param _volume The grid
+      /// \param _error Reason of the failure
+      /// \return False if the settings are invalid, the mesh is empty or a point cloud has no normals
+      ///
+      bool bake(const TriangleBvh &_bvh, const std::vector<glm::vec3> &_normals, const Settings &_settings, DistanceVolume &_volume, std::string &_error);
+
+      ///
+      /// \brief exactEvaluations Closest point queries made by the last bake, the rest of the points were interpolated
+      ///
+      size_t exactEvaluations() const { return m_exactEvaluations; }
+      ///
+      /// \brief windingQueries Points of the last bake whose sign needed the winding number
+      ///
+      size_t windingQueries() const { return m_windingQueries; }
+
+    private:
+      static constexpr uint32_t c_block = 16;
+      static constexpr uint32_t c_blockPoints = c_block + 1;
+
+      ///
+      /// \brief Block Grid points of the block a worker is on, NaN for the ones not known yet
+      ///
+      struct Block
+      {
+        uint32_t m_origin[3];
+        uint32_t m_end[3];
+        std::vector<float> m_values;
+        ///
+        /// \brief m_lastClosest Closest point of the last point evaluated exactly, bounds the search of the next one
+        ///
+        glm::vec3 m_lastClosest;
+        bool m_hasLast;
+        size_t m_exact;
+        size_t m_windings;
+      };
+
+      ///
+      /// \brief bakeBlock Refines the octree of a block and writes the points it owns to the volume
+      ///
+      void bakeBlock(uint32_t _bi, uint32_t _bj, uint32_t _bk, Block &_block);
+      ///
+      /// \brief refine Fills a cell of the octree, local coordinates in the block
+      /// \param _size Edge of the cell in grid points
+      /// \param _hint First corner of the parent cell, or null for the root
+      ///
+      void refine(Block &_block, uint32_t _i, uint32_t _j, uint32_t _k, uint32_t _size, const glm::uvec3 *_hint);
+      ///
+      /// \brief evaluate Signed distance at a point of a block, computed once and cached
+      /// \param _hint Point of the block known already whose sign may be reused, or null
+      ///
+      float evaluate(Block &_block, uint32_t _i, uint32_t _j, uint32_t _k, const glm::uvec3 *_hint);
+      float &local(Block &_block, uint32_t _i, uint32_t _j, uint32_t _k) const
+      {
+        return _block.m_values[(_k * c_blockPoints + _j) * c_blockPoints + _i];
+      }
+
+      ThreadPool &m_pool;
+      const TriangleBvh *m_bvh;
+      const std::vector<glm::vec3> *m_normals;
+      DistanceVolume *m_volume;
+      glm::vec3 m_spacing;
+      std::vector<Block> m_blocks;
+      std::atomic<size_t> m_exactEvaluations;
+      std::atomic<size_t> m_windingQueries;
+    };
+  }
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "sdf/Evaluator.hpp"
+#include "sdf/IntervalEvaluator.hpp"
+#include "sdf/Program.hpp"
+#include "ThreadPool.hpp"
+
+/// \file Mesher.hpp
+/// \brief Extracts a triangle mesh from the distance field of a scene. An octree is refined over the bounds one level at a
+///        time and every cell whose centre is further from the surface than its half diagonal is dropped, which is
+///        conservative as long as the field doesn't overestimate the distance. Alternatively the cells are bounded by
+///        interval arithmetic, which holds whatever the field does but keeps more cells where the bounds are loose. Only the cells along the surface survive to
+///        the finest level, so the memory grows with the area of the surface rather than the volume of the bounds.
+///        The surviving cells are polygonised in parallel, either by dual contouring, which keeps sharp edges, or by
+///        marching tetrahedra on the Freudenthal split of the cells, which needs no case tables. Both give closed meshes
+///        wherever the surface doesn't leave the bounds
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    struct Mesh
+    {
+      std::vector<glm::vec3> m_positions;
+      std::vector<glm::vec3> m_colors;
+      ///
+      /// \brief m_indices Three vertex indices per triangle, counter-clockwise seen from outside
+      ///
+      std::vector<uint32_t> m_indices;
+    };
+
+    class Mesher
+    {
+    public:
+      enum class Method
+      {
+        DUAL_CONTOURING,
+        MARCHING_TETRAHEDRA
+      };
+
+      enum class Pruning
+      {
+        ///
+        /// \brief DISTANCE Drops the cells whose centre is further than their half diagonal, one evaluation per cell
+        ///
+        DISTANCE,
+        ///
+        /// \brief INTERVAL Drops the cells whose interval bounds of the distance don't contain 0
+        ///
+        INTERVAL
+      };
+
+      struct Settings
+      {
+        glm::vec3 m_min = glm::vec3(-5.f);
+        glm::vec3 m_max = glm::vec3(5.f);
+        ///
+        /// \brief m_depth Levels of the octree, the longest side of the bounds is split into 2^depth cells
+        ///
+        unsigned int m_depth = 8;
+        Method m_method = Method::DUAL_CONTOURING;
+        ///
+        /// \brief m_lipschitz How much faster than 1 the field may change, raise it for scenes with scaled primitives
+        ///        so cells aren't dropped wrongly, at the cost of keeping more of them
+        ///
+        float m_lipschitz = 1.f;
+        Pruning m_pruning = Pruning::DISTANCE;
+      };
+
+      static constexpr unsigned int c_maxDepth = 19;
+
+      ///
+      /// \brief Mesher Default ctor
+      /// \param _program Compiled distance field of the scene
+      /// \param _pool Threads the cells are processed on, one evaluator is created per worker
+      ///
+      Mesher(std::shared_ptr<const Program> _program, ThreadPool &_pool);
+
+      ///
+      /// \brief setTime Sets u_GlobalTime for the distance field
+      /// \param _time Time of the scene
+      ///
+      void setTime(float _time);
+      ///
+      /// \brief extract Builds the mesh
+      /// \param _settings Bounds, resolution and method
+      /// \param _mesh The mesh
+      /// \param _error Reason of the failure
+      /// \return False if the settings are invalid or the mesh has too many vertices for 32-bit indices
+      ///
+      bool extract(const Settings &_settings, Mesh &_mesh, std::string &_error);
+
+      ///
+      /// \brief boundaryEdges Counts the edges that don't have exactly two triangles, 0 for a closed manifold mesh
+      /// \param _mesh Mesh to check
+      ///
+      static size_t boundaryEdges(const Mesh &_mesh);
+
+      ///
+      /// \brief cellsPerLevel Cells tested at each level of the octree by the last extract, the last entry are the surface cells
+      ///
+      const std::vector<size_t> &cellsPerLevel() const { return m_cellsPerLevel; }
+      ///
+      /// \brief evaluations Distance evaluations made by the last extract, a box evaluated on intervals counts as one
+      ///
+      size_t evaluations() const { return m_evaluations; }
+      ///
+      /// \brief traversalTime Milliseconds the last extract spent refining the octree, before polygonising
+      ///
+      double traversalTime() const { return m_traversalMs; }
+
+    private:
+      struct Batch;
+
+      ///
+      /// \brief findSurfaceCells Refines the octree down to the cells the surface may pass through
+      /// \param _leaves Keys of the cells at the finest level, sorted
+      ///
+      void findSurfaceCells(std::vector<uint64_t> &_leaves);
+      ///
+      /// \brief cornerValues Evaluates the corners of every cell
+      /// \param _leaves Keys of the cells
+      /// \param _values Distance at the eight corners of each cell
+      ///
+      void cornerValues(const std::vector<uint64_t> &_leaves, std::vector<float> &_values);
+      void dualContouring(const std::vector<uint64_t> &_leaves, Mesh &_mesh);
+      void marchingTetrahedra(const std::vector<uint64_t> &_leaves, Mesh &_mesh);
+      ///
+      /// \brief colour Evaluates the colour at every vertex of the mesh
+      ///
+      void colour(Mesh &_mesh);
+      ///
+      /// \brief corner Position of a corner of the finest grid
+      ///
+      glm::vec3 corner(uint32_t _i, uint32_t _j, uint32_t _k) const;
+
+      std::shared_ptr<const Program> m_program;
+      ThreadPool &m_pool;
+      std::vector<std::unique_ptr<Evaluator>> m_evaluators;
+      std::vector<std::unique_ptr<IntervalEvaluator>> m_intervalEvaluators;
+      Settings m_settings;
+      float m_cellSize;
+      uint32_t m_dims[3];
+      std::vector<size_t> m_cellsPerLevel;
+      std::atomic<size_t> m_evaluations;
+      double m_traversalMs;
+    };
+  }
+}
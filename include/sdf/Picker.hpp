@@ -0,0 +1,181 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "sdf/Interval.hpp"
+#include "sdf/Program.hpp"
+
+/// \file Picker.hpp
+/// \brief Finds the primitive a single ray hits first, for selecting nodes by clicking on the scene. The program has to be
+///        compiled with primitive ids (SceneCompiler::compileMap), the id of the hit comes back in its colour.
+///        Tracing the whole program would cost every primitive of the scene at every step, so the picker keeps an octree
+///        of shortened programs instead. A cell runs its parent's program on intervals over the cell, every union,
+///        intersection or min whose sides don't overlap there is replaced by the side that wins and whatever only fed the
+///        loser is dropped. Cells without surface are skipped whole. The ray walks the cells front to back and is sphere
+///        traced in the first ones that may hold surface with the few instructions left there. Cells are refined lazily
+///        along the rays and kept, so later picks near earlier ones only walk the octree
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    class Picker
+    {
+    public:
+      struct Settings
+      {
+        ///
+        /// \brief m_min Lower corner of the octree, rays are traced with the whole program outside it
+        ///
+        glm::vec3 m_min = glm::vec3(-32.f);
+        glm::vec3 m_max = glm::vec3(32.f);
+        ///
+        /// \brief m_depth Deepest level of the octree
+        ///
+        unsigned int m_depth = 7;
+      };
+
+      struct Hit
+      {
+        bool m_hit = false;
+        ///
+        /// \brief m_t Distance along the ray
+        ///
+        float m_t = 0.f;
+        glm::vec3 m_position = glm::vec3(0.f);
+        ///
+        /// \brief m_primitive Index of the primitive in ShaderGenerator::primitives, c_none for a miss
+        ///
+        uint32_t m_primitive = Program::c_none;
+      };
+
+      static constexpr float c_tmin = 1.f;
+      static constexpr float c_tmax = 20.f;
+      ///
+      /// \brief c_maxCells Cells kept before the octree is thrown away and started again
+      ///
+      static constexpr size_t c_maxCells = 1 << 20;
+
+      ///
+      /// \brief Picker Default ctor, sets the time to 0
+      /// \param _program Distance field compiled with primitive ids
+      /// \param _settings Bounds and depth of the octree
+      ///
+      Picker(std::shared_ptr<const Program> _program, const Settings &_settings);
+
+      ///
+      /// \brief setTime Sets u_GlobalTime, the octree of an animated scene is started again when the time changes
+      /// \param _time Time of the scene
+      ///
+      void setTime(float _time);
+      ///
+      /// \brief pick Traces a ray like castRay in shader.end does, from c_tmin to c_tmax
+      /// \param _origin Start of the ray
+      /// \param _direction Direction of the ray, normalised
+      /// \return The first surface along the ray and the primitive it belongs to
+      ///
+      Hit pick(const glm::vec3 &_origin, const glm::vec3 &_direction);
+      ///
+      /// \brief cameraRay Direction of the ray through a pixel, createRay of shader.end with its 90 degree field of view
+      ///        looking at the origin
+      /// \param _eye Camera position
+      /// \param _up Camera up vector
+      /// \param _x Pixel column from the left edge, can be fractional
+      /// \param _y Pixel row from the top edge
+      /// \param _w Width of the image
+      /// \param _h Height of the image
+      ///
+      static glm::vec3 cameraRay(const glm::vec3 &_eye, const glm::vec3 &_up, float _x, float _y, int _w, int _h);
+
+      ///
+      /// \brief cellCount Cells of the octree refined so far
+      ///
+      size_t cellCount() const { return m_cells.size(); }
+      ///
+      /// \brief steps Points the last pick evaluated while sphere tracing
+      ///
+      size_t steps() const { return m_steps; }
+      ///
+      /// \brief instructions Instructions the last pick ran, on intervals to refine cells and on floats to trace
+      ///
+      size_t instructions() const { return m_instructions; }
+
+    private:
+      ///
+      /// \brief Tape Shortened program of a cell, the registers are those of the full program
+      ///
+      struct Tape
+      {
+        std::vector<Instruction> m_code;
+        std::vector<uint32_t> m_operands;
+      };
+
+      struct Cell
+      {
+        ///
+        /// \brief m_tape Index of the shortened program of the cell, c_none until a ray reaches it
+        ///
+        uint32_t m_tape;
+        ///
+        /// \brief m_children Index of the first of the 8 children, c_none until the cell is refined
+        ///
+        uint32_t m_children;
+        ///
+        /// \brief m_empty Whether the distance is above the hit threshold everywhere in the cell
+        ///
+        bool m_empty;
+      };
+
+      ///
+      /// \brief reset Drops the octree and starts again from the whole program over the bounds
+      ///
+      void reset();
+      ///
+      /// \brief shorten Runs a tape on intervals over a box and shortens it to what decides the distance and the id there
+      /// \param _tape Index of the tape to run
+      /// \param _min Lower corner of the box
+      /// \param _max Upper corner of the box
+      /// \param _range Bounds of the distance over the box
+      /// \return Index of the shortened tape, _tape if nothing could be dropped
+      ///
+      uint32_t shorten(uint32_t _tape, const glm::vec3 &_min, const glm::vec3 &_max, Interval &_range);
+      ///
+      /// \brief traverse Runs a cell on intervals the first time a ray reaches it and walks its children the ray passes
+      ///        through front to back
+      /// \param _parentTape Tape of the parent cell, the cell's own is shortened from it
+      /// \param _t Sphere tracing position along the ray, carried over from cell to cell
+      /// \return Whether the ray hit something in the cell
+      ///
+      bool traverse(uint32_t _cell, uint32_t _parentTape, const glm::vec3 &_min, const glm::vec3 &_max, unsigned int _depth, float _t0, float _t1, float &_t, Hit &_hit);
+      ///
+      /// \brief march Sphere traces a tape from _t up to _t1
+      ///
+      bool march(uint32_t _tape, float &_t, float _t1, Hit &_hit);
+
+      std::shared_ptr<const Program> m_program;
+      Settings m_settings;
+      float m_time;
+      std::vector<Tape> m_tapes;
+      std::vector<Cell> m_cells;
+      std::vector<float> m_registers;
+      std::vector<Interval> m_intervals;
+      ///
+      /// \brief m_choices Operand each instruction of the tape being shortened settled on, -1 for none
+      ///
+      std::vector<int> m_choices;
+      std::vector<char> m_live;
+
+      glm::vec3 m_origin;
+      glm::vec3 m_direction;
+      glm::vec3 m_inverse;
+      size_t m_steps;
+      size_t m_instructions;
+    };
+  }
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// \file Program.hpp
+/// \brief Flat instruction list the SceneCompiler turns the map function of a scene into. Every value of the GLSL code is
+///        split into its float components and every instruction writes one component to a register. Registers below
+///        m_uniformCount are the same for every point: the constants and whatever only depends on them and the time.
+///        They're computed once by m_uniformCode, the remaining registers are computed for every batch of points by m_code
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    struct DistanceVolume;
+    class InstanceSet;
+
+    enum class Op : uint8_t
+    {
+      // Component-wise arithmetic and built-ins
+      ADD,
+      SUB,
+      MUL,
+      DIV,
+      NEG,
+      MIN,
+      MAX,
+      ABS,
+      SQRT,
+      FLOOR,
+      SIGN,
+      SIN,
+      COS,
+      CLAMP,
+      MIX,
+      MOD,
+      // a <= b ? c : d, the ternaries of opUnion and the rest
+      SELECT_LE,
+      // Register move, what the Picker leaves of a select it has settled
+      COPY,
+      // The distance functions of shader.begin, the operands are the components of their arguments without the colour
+      SD_SPHERE,
+      SD_BOX,
+      SD_FAST_BOX,
+      SD_TORUS,
+      SD_CYLINDER,
+      SD_CONE,
+      SD_PLANE,
+      SD_HEX_PRISM,
+      SD_TRI_PRISM,
+      SD_CAPSULE,
+      SD_CAPPED_CYLINDER,
+      SD_CAPPED_CONE,
+      SD_ELLIPSOID,
+      UD_BOX,
+      UD_ROUND_BOX,
+      // Imported mesh, the position and the uniform register holding the index of its volume in Program::m_volumes
+      SD_VOLUME,
+      // Copies of a subtree, the position, the uniform register holding the index of the set in Program::m_instances and
+      // the time the subtree runs at
+      SD_INSTANCES,
+      COUNT
+    };
+
+    ///
+    /// \brief operandCount Number of operands an operation reads
+    ///
+    inline unsigned int operandCount(Op _op)
+    {
+      static const unsigned char counts[static_cast<size_t>(Op::COUNT)] = {
+        2, 2, 2, 2, 1, 2, 2, 1, 1, 1, 1, 1, 1, 3, 3, 2,
+        4, 1,
+        4, 6, 4, 5, 6, 5, 7, 5, 5, 10, 5, 6, 6, 6, 7,
+        4, 5
+      };
+      return counts[static_cast<size_t>(_op)];
+    }
+
+    struct Instruction
+    {
+      Op m_op;
+      ///
+      /// \brief m_dst Register written
+      ///
+      uint32_t m_dst;
+      ///
+      /// \brief m_first Index of the first operand register in Program::m_operands
+      ///
+      uint32_t m_first;
+    };
+
+    struct Program
+    {
+      static constexpr uint32_t c_none = 0xffffffff;
+
+      ///
+      /// \brief m_uniformCode Instructions run when the time changes, they only touch the uniform registers
+      ///
+      std::vector<Instruction> m_uniformCode;
+      ///
+      /// \brief m_code Instructions run for every batch of points, in order
+      ///
+      std::vector<Instruction> m_code;
+      ///
+      /// \brief m_operands Operand registers of all the instructions
+      ///
+      std::vector<uint32_t> m_operands;
+      ///
+      /// \brief m_constants Initial values of the uniform registers, the literals of the code
+      ///
+      std::vector<float> m_constants;
+      uint32_t m_uniformCount = 0;
+      ///
+      /// \brief m_registerCount Uniform and per point registers, the per point ones are reused once they're dead
+      ///
+      uint32_t m_registerCount = 0;
+      ///
+      /// \brief m_time Uniform register of u_GlobalTime, c_none if the scene doesn't use it
+      ///
+      uint32_t m_time = c_none;
+      ///
+      /// \brief m_position Registers of the components of _position
+      ///
+      std::array<uint32_t, 3> m_position = {{c_none, c_none, c_none}};
+      ///
+      /// \brief m_result Registers of the distance and the colour returned by map
+      ///
+      std::array<uint32_t, 4> m_result = {{c_none, c_none, c_none, c_none}};
+      ///
+      /// \brief m_volumes Baked meshes the SD_VOLUME instructions sample, shared with the node models that imported them
+      ///
+      std::vector<std::shared_ptr<const DistanceVolume>> m_volumes;
+      ///
+      /// \brief m_instances Instanced subtrees the SD_INSTANCES instructions run, shared with the nodes that scattered them
+      ///
+      std::vector<std::shared_ptr<const InstanceSet>> m_instances;
+    };
+  }
+}
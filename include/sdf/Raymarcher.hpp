@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "nodeEditor/Node.hpp"
+#include "sdf/Evaluator.hpp"
+#include "sdf/Program.hpp"
+#include "ThreadPool.hpp"
+
+/// \file Raymarcher.hpp
+/// \brief Renders a compiled scene on the CPU the way shader.end does on the GPU: the same camera, sphere tracing,
+///        normals, ambient occlusion, soft shadows, lights, sky, fog and vignette. The image is split into tiles spread
+///        over a ThreadPool and every tile is traced as a packet: the rays still marching are gathered into batches for the
+///        Evaluator at each step, so the SIMD lanes stay full while rays finish at different depths
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    struct Light
+    {
+      glm::vec3 m_position;
+      glm::vec3 m_diffuse;
+      glm::vec3 m_ambient = glm::vec3(1.00f, 0.90f, 0.70f);
+      glm::vec3 m_specular = glm::vec3(0.40f, 0.60f, 1.00f);
+      float m_intensity = 1.f;
+      bool m_shadow = true;
+    };
+
+    class Raymarcher
+    {
+    public:
+      ///
+      /// \brief Raymarcher Default ctor, uses the default lights and the camera of the scene view
+      /// \param _program Compiled distance field of the scene
+      /// \param _pool Threads the tiles are rendered on, one evaluator is created per worker
+      ///
+      Raymarcher(std::shared_ptr<const Program> _program, ThreadPool &_pool);
+      ///
+      /// \brief ~Raymarcher Default dtor
+      ///
+      ~Raymarcher();
+
+      ///
+      /// \brief setCamera Sets the camera, it always looks at the origin like in the scene view
+      /// \param _eye Position of the camera
+      /// \param _up Up vector of the camera
+      ///
+      void setCamera(const glm::vec3 &_eye, const glm::vec3 &_up) { m_eye = _eye; m_up = _up; }
+      ///
+      /// \brief setTime Sets u_GlobalTime for the distance field
+      /// \param _time Time of the scene
+      ///
+      void setTime(float _time);
+      ///
+      /// \brief setLights Sets the lights, the default rig of shader.end when empty
+      /// \param _lights Lights of the scene, e.g. from sceneLights
+      ///
+      void setLights(const std::vector<Light> &_lights);
+      ///
+      /// \brief render Renders the whole image
+      /// \param _w Width of the image
+      /// \param _h Height of the image
+      /// \param _rgba Pixels of the image as RGBA floats, top row first like OffscreenRenderer::render
+      /// \return False if the size is invalid
+      ///
+      bool render(int _w, int _h, std::vector<float> &_rgba);
+      ///
+      /// \brief evaluations Distance evaluations made by the last render, including normals, occlusion and shadows
+      ///
+      size_t evaluations() const { return m_evaluations; }
+
+      ///
+      /// \brief defaultLights The four lights shader.end uses when the scene has no light nodes
+      ///
+      static std::vector<Light> defaultLights();
+      ///
+      /// \brief sceneLights Collects the enabled light nodes in the same order as the generated applyLights
+      /// \param _nodes List of all the nodes in the scene
+      /// \param _time Time the light parameters are evaluated at
+      /// \param _lights The lights, empty if the scene has none
+      /// \param _error Reason of the failure
+      /// \return False if a light parameter can't be evaluated on the CPU
+      ///
+      static bool sceneLights(const std::unordered_map<QUuid, std::shared_ptr<Node>> &_nodes, float _time, std::vector<Light> &_lights, std::string &_error);
+
+    private:
+      struct Packet;
+
+      ///
+      /// \brief renderTile Traces and shades one tile
+      /// \param _x Left edge of the tile
+      /// \param _y Top edge of the tile
+      /// \param _w Width of the tile
+      /// \param _h Height of the tile
+      /// \param _imageW Width of the whole image
+      /// \param _imageH Height of the whole image
+      /// \param _rgba Pixels of the whole image
+      /// \param _worker Worker running the tile, selects the evaluator and the scratch memory
+      ///
+      void renderTile(int _x, int _y, int _w, int _h, int _imageW, int _imageH, float *_rgba, unsigned int _worker);
+
+      std::shared_ptr<const Program> m_program;
+      ThreadPool &m_pool;
+      std::vector<std::unique_ptr<Evaluator>> m_evaluators;
+      std::vector<std::unique_ptr<Packet>> m_packets;
+      std::vector<Light> m_lights;
+      glm::vec3 m_eye;
+      glm::vec3 m_up;
+      std::atomic<size_t> m_evaluations;
+    };
+  }
+}
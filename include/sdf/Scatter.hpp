@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "sdf/Program.hpp"
+#include "sdf/SceneQuery.hpp"
+#include "ThreadPool.hpp"
+
+/// \file Scatter.hpp
+/// \brief Poisson-disk sampling of the surface of a distance field: points on the zero level set that are no closer to
+///        each other than a spacing. The cells of a grid as wide as the spacing that the surface may pass through are
+///        found by refining an octree, random candidates in them are pulled onto the surface along the gradient and
+///        then thrown as darts. A dart only has to look at the 27 cells around its own, so cells two apart along some
+///        axis never see each other's points and the eight cells of a 2x2x2 block take turns: all the cells of one
+///        parity throw in parallel, then the next parity, once per candidate. Whichever thread runs a cell, the points
+///        are the same for the same seed
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    class Scatter
+    {
+    public:
+      struct Settings
+      {
+        glm::vec3 m_min = glm::vec3(-5.f);
+        glm::vec3 m_max = glm::vec3(5.f);
+        ///
+        /// \brief m_spacing Smallest distance between two points
+        ///
+        float m_spacing = 0.25f;
+        uint32_t m_seed = 1;
+        ///
+        /// \brief m_candidates Random candidates started in every cell near the surface, more fill the gaps better
+        ///
+        unsigned int m_candidates = 8;
+        ///
+        /// \brief m_steps Newton steps taking the candidates onto the surface
+        ///
+        unsigned int m_steps = 4;
+        ///
+        /// \brief m_lipschitz How much faster than 1 the field may change, as for the Mesher
+        ///
+        float m_lipschitz = 1.f;
+        ///
+        /// \brief m_maxPoints Points above which the scatter fails instead of filling the memory, raise the spacing
+        ///
+        size_t m_maxPoints = 100000;
+      };
+
+      struct Point
+      {
+        glm::vec3 m_position;
+        ///
+        /// \brief m_normal Unit gradient of the field at the point
+        ///
+        glm::vec3 m_normal;
+      };
+
+      ///
+      /// \brief Scatter Default ctor
+      /// \param _program Compiled distance field of the surface
+      /// \param _pool Threads the cells are processed on
+      ///
+      Scatter(std::shared_ptr<const Program> _program, ThreadPool &_pool);
+
+      ///
+      /// \brief setTime Sets u_GlobalTime for the distance field
+      /// \param _time Time of the scene
+      ///
+      void setTime(float _time);
+      ///
+      /// \brief scatter Samples the surface
+      /// \param _settings Bounds, spacing and seed
+      /// \param _points The points, in the order of their cells
+      /// \param _error Reason of the failure
+      /// \return False if the settings are invalid or the surface needs more than the maximum number of points
+      ///
+      bool scatter(const Settings &_settings, std::vector<Point> &_points, std::string &_error);
+
+      ///
+      /// \brief surfaceCells Cells of the last scatter the surface may pass through
+      ///
+      size_t surfaceCells() const { return m_surfaceCells; }
+      ///
+      /// \brief candidates Candidates of the last scatter that reached the surface, the darts thrown
+      ///
+      size_t candidates() const { return m_candidates; }
+
+    private:
+      ///
+      /// \brief findSurfaceCells Refines the octree down to the cells as wide as the spacing the surface may pass through
+      /// \param _cells Keys of the cells, sorted
+      ///
+      void findSurfaceCells(std::vector<uint64_t> &_cells);
+      ///
+      /// \brief project Moves points onto the surface with Newton steps on the distance
+      /// \param _points Coordinates, x, y and z of each point one after the other
+      /// \param _distance Distance left at each point afterwards
+      /// \param _gradient Gradient at each point afterwards
+      ///
+      void project(std::vector<float> &_points, std::vector<float> &_distance, std::vector<float> &_gradient);
+
+      SceneQuery m_query;
+      ThreadPool &m_pool;
+      Settings m_settings;
+      uint32_t m_dims[3];
+      size_t m_surfaceCells;
+      size_t m_candidates;
+    };
+  }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nodeEditor/Node.hpp"
+#include "sdf/Program.hpp"
+#include "ShaderGenerator.hpp"
+
+/// \file SceneCompiler.hpp
+/// \brief Compiles the distance field of a scene into a Program for the CPU. It reads the map function the ShaderGenerator
+///        writes for the GPU, so the CPU sees exactly the graph reachable from the distance node that the shader does,
+///        and understands the subset of GLSL the node models generate: the distance functions and operations of
+///        shader.begin, vector and matrix constructors, swizzles, arithmetic and the common built-ins.
+///        Constants are folded and repeated subexpressions shared while compiling, the unused code is dropped afterwards
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    class SceneCompiler
+    {
+    public:
+      ///
+      /// \brief compile Generates the map function of the scene and compiles it
+      /// \param _generator Generator used for the map function, also used for the shader of the scene
+      /// \param _nodes List of all the nodes in the scene
+      /// \param _error Reason of the failure
+      /// \param _primitiveIds Compile the map with primitive ids instead of colours, see compileMap
+      /// \return The program, null if nothing is connected to the distance node or the code couldn't be compiled
+      ///
+      static std::shared_ptr<Program> compile(ShaderGenerator &_generator, const std::unordered_map<QUuid, std::shared_ptr<Node>> &_nodes, std::string &_error, bool _primitiveIds = false);
+      ///
+      /// \brief compileMap Compiles the source of a map function
+      /// \param _source GLSL of the function, vec4 map(vec3 _position) { ... return ...; }
+      /// \param _error Reason of the failure
+      /// \param _primitiveIds Replaces the colour of every distance function call by its index in the source, the first
+      ///        component of the colour the program returns is then the index of the primitive the distance comes from,
+      ///        ShaderGenerator::primitives has the node of every index. Blends take the id of the closer side
+      /// \param _volumes Volumes of the imported meshes, sdVolume calls read u_Volume0 onwards from them
+      /// \param _instances Instance sets of the scattered subtrees, called as instances0 onwards
+      /// \return The program, null if the code uses something the CPU doesn't support
+      ///
+      static std::shared_ptr<Program> compileMap(const std::string &_source, std::string &_error, bool _primitiveIds = false,
+                                                 const std::vector<std::shared_ptr<const DistanceVolume>> &_volumes = {},
+                                                 const std::vector<std::shared_ptr<const InstanceSet>> &_instances = {});
+    };
+  }
+}
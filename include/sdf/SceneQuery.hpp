@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "sdf/Evaluator.hpp"
+#include "sdf/Program.hpp"
+#include "ThreadPool.hpp"
+
+/// \file SceneQuery.hpp
+/// \brief Distance, gradient and primitive id of the scene at large arrays of points, for tools asking how far things are
+///        from the model rather than rendering it. The points are split into chunks spread over a thread pool and every
+///        chunk is evaluated in SIMD batches. The gradient is the tetrahedron of calcNormal in the shader, four more
+///        evaluations per point, and comes back unnormalised so its length shows where the field isn't a true distance
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    class SceneQuery
+    {
+    public:
+      struct Settings
+      {
+        ///
+        /// \brief m_gradientStep Offset of the samples around each point along every axis, larger than the shader's since
+        ///        points far from the surface lose the difference of their samples to the precision of floats sooner
+        ///
+        float m_gradientStep = 0.001f;
+        ///
+        /// \brief m_chunk Points per task, small enough for the scratch arrays of a task to stay in the cache
+        ///
+        size_t m_chunk = 4096;
+      };
+
+      ///
+      /// \brief SceneQuery Default ctor, sets the time to 0
+      /// \param _program Compiled distance field of the scene, compiled with primitive ids for the ids to be queried
+      /// \param _pool Threads the chunks are evaluated on, one evaluator is created per worker
+      /// \param _settings Gradient step and chunk size
+      ///
+      SceneQuery(std::shared_ptr<const Program> _program, ThreadPool &_pool, const Settings &_settings);
+
+      ///
+      /// \brief setTime Sets u_GlobalTime for the distance field
+      /// \param _time Time of the scene
+      ///
+      void setTime(float _time);
+      ///
+      /// \brief query Evaluates a list of points, any of the outputs can be null to skip it
+      /// \param _points Coordinates of the points, x, y and z of each point one after the other
+      /// \param _count Number of points
+      /// \param _distance Distance at each point
+      /// \param _gradient Gradient of the distance at each point, x, y and z one after the other
+      /// \param _ids Index of the closest primitive in ShaderGenerator::primitives, Program::c_none where the program
+      ///        has none. Only meaningful for programs compiled with primitive ids, others return their red channel
+      ///
+      void query(const float *_points, size_t _count, float *_distance, float *_gradient, uint32_t *_ids);
+
+      ///
+      /// \brief evaluations Points evaluated by the last query, the gradient samples included
+      ///
+      size_t evaluations() const { return m_evaluations; }
+
+    private:
+      ///
+      /// \brief Scratch Coordinates and results of the chunk a worker is on
+      ///
+      struct Scratch
+      {
+        std::vector<float> m_x;
+        std::vector<float> m_y;
+        std::vector<float> m_z;
+        std::vector<float> m_distance;
+        std::vector<float> m_id;
+      };
+
+      ///
+      /// \brief queryChunk Evaluates one chunk of the points on a worker
+      ///
+      void queryChunk(const float *_points, size_t _first, size_t _count, unsigned int _worker, float *_distance, float *_gradient, uint32_t *_ids);
+
+      std::shared_ptr<const Program> m_program;
+      ThreadPool &m_pool;
+      Settings m_settings;
+      std::vector<std::unique_ptr<Evaluator>> m_evaluators;
+      std::vector<Scratch> m_scratch;
+      std::atomic<size_t> m_evaluations;
+    };
+  }
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#endif
+
+/// \file Simd.hpp
+/// \brief Eight float lanes evaluated together, one AVX register, two SSE registers or a plain array depending on what the
+///        compiler targets (qmake QMAKE_CXXFLAGS+=-mavx2 or -march=native for the wide version). The same batch size is used
+///        everywhere so the evaluator doesn't depend on the instruction set. The free functions mirror the GLSL built-ins
+///        the distance functions use and have plain float overloads so the kernels can be written once for both
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    struct Lanes
+    {
+      static constexpr size_t c_width = 8;
+
+#if defined(__AVX__)
+      __m256 m_v;
+
+      static Lanes broadcast(float _f) { return Lanes{_mm256_set1_ps(_f)}; }
+      static Lanes load(const float *_p) { return Lanes{_mm256_loadu_ps(_p)}; }
+      void store(float *_p) const { _mm256_storeu_ps(_p, m_v); }
+#elif defined(__SSE2__) || defined(_M_X64)
+      __m128 m_lo;
+      __m128 m_hi;
+
+      static Lanes broadcast(float _f) { return Lanes{_mm_set1_ps(_f), _mm_set1_ps(_f)}; }
+      static Lanes load(const float *_p) { return Lanes{_mm_loadu_ps(_p), _mm_loadu_ps(_p + 4)}; }
+      void store(float *_p) const { _mm_storeu_ps(_p, m_lo); _mm_storeu_ps(_p + 4, m_hi); }
+#else
+      float m_v[c_width];
+
+      static Lanes broadcast(float _f) { Lanes l; for(size_t i = 0; i < c_width; ++i) l.m_v[i] = _f; return l; }
+      static Lanes load(const float *_p) { Lanes l; for(size_t i = 0; i < c_width; ++i) l.m_v[i] = _p[i]; return l; }
+      void store(float *_p) const { for(size_t i = 0; i < c_width; ++i) _p[i] = m_v[i]; }
+#endif
+    };
+
+#if defined(__AVX__)
+#define HSITHO_LANES_BINARY(NAME, AVX, SSE, SCALAR) \
+    inline Lanes NAME(const Lanes &_a, const Lanes &_b) { return Lanes{AVX(_a.m_v, _b.m_v)}; }
+#elif defined(__SSE2__) || defined(_M_X64)
+#define HSITHO_LANES_BINARY(NAME, AVX, SSE, SCALAR) \
+    inline Lanes NAME(const Lanes &_a, const Lanes &_b) { return Lanes{SSE(_a.m_lo, _b.m_lo), SSE(_a.m_hi, _b.m_hi)}; }
+#else
+#define HSITHO_LANES_BINARY(NAME, AVX, SSE, SCALAR) \
+    inline Lanes NAME(const Lanes &_a, const Lanes &_b) { Lanes r; for(size_t i = 0; i < Lanes::c_width; ++i) { float a = _a.m_v[i], b = _b.m_v[i]; r.m_v[i] = SCALAR; } return r; }
+#endif
+
+    HSITHO_LANES_BINARY(operator+, _mm256_add_ps, _mm_add_ps, a + b)
+    HSITHO_LANES_BINARY(operator-, _mm256_sub_ps, _mm_sub_ps, a - b)
+    HSITHO_LANES_BINARY(operator*, _mm256_mul_ps, _mm_mul_ps, a * b)
+    HSITHO_LANES_BINARY(operator/, _mm256_div_ps, _mm_div_ps, a / b)
+    HSITHO_LANES_BINARY(min, _mm256_min_ps, _mm_min_ps, b < a ? b : a)
+    HSITHO_LANES_BINARY(max, _mm256_max_ps, _mm_max_ps, a < b ? b : a)
+
+#undef HSITHO_LANES_BINARY
+
+    inline Lanes operator-(const Lanes &_a) { return Lanes::broadcast(0.f) - _a; }
+    inline Lanes operator+(const Lanes &_a, float _b) { return _a + Lanes::broadcast(_b); }
+    inline Lanes operator-(const Lanes &_a, float _b) { return _a - Lanes::broadcast(_b); }
+    inline Lanes operator*(const Lanes &_a, float _b) { return _a * Lanes::broadcast(_b); }
+    inline Lanes operator+(float _a, const Lanes &_b) { return Lanes::broadcast(_a) + _b; }
+    inline Lanes operator-(float _a, const Lanes &_b) { return Lanes::broadcast(_a) - _b; }
+    inline Lanes operator*(float _a, const Lanes &_b) { return Lanes::broadcast(_a) * _b; }
+    inline Lanes min(const Lanes &_a, float _b) { return min(_a, Lanes::broadcast(_b)); }
+    inline Lanes max(const Lanes &_a, float _b) { return max(_a, Lanes::broadcast(_b)); }
+
+    inline Lanes sqrt(const Lanes &_a)
+    {
+#if defined(__AVX__)
+      return Lanes{_mm256_sqrt_ps(_a.m_v)};
+#elif defined(__SSE2__) || defined(_M_X64)
+      return Lanes{_mm_sqrt_ps(_a.m_lo), _mm_sqrt_ps(_a.m_hi)};
+#else
+      Lanes r;
+      for(size_t i = 0; i < Lanes::c_width; ++i)
+        r.m_v[i] = std::sqrt(_a.m_v[i]);
+      return r;
+#endif
+    }
+
+    inline Lanes abs(const Lanes &_a)
+    {
+#if defined(__AVX__)
+      return Lanes{_mm256_andnot_ps(_mm256_set1_ps(-0.f), _a.m_v)};
+#elif defined(__SSE2__) || defined(_M_X64)
+      __m128 sign = _mm_set1_ps(-0.f);
+      return Lanes{_mm_andnot_ps(sign, _a.m_lo), _mm_andnot_ps(sign, _a.m_hi)};
+#else
+      Lanes r;
+      for(size_t i = 0; i < Lanes::c_width; ++i)
+        r.m_v[i] = std::fabs(_a.m_v[i]);
+      return r;
+#endif
+    }
+
+    inline Lanes floor(const Lanes &_a)
+    {
+#if defined(__AVX__)
+      return Lanes{_mm256_floor_ps(_a.m_v)};
+#elif defined(__SSE4_1__)
+      return Lanes{_mm_floor_ps(_a.m_lo), _mm_floor_ps(_a.m_hi)};
+#elif defined(__SSE2__) || defined(_M_X64)
+      // Truncate and step down where that rounded up, only valid within the int range which is plenty for the scene
+      auto floor4 = [](__m128 _x) {
+        __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(_x));
+        return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, _x), _mm_set1_ps(1.f)));
+      };
+      return Lanes{floor4(_a.m_lo), floor4(_a.m_hi)};
+#else
+      Lanes r;
+      for(size_t i = 0; i < Lanes::c_width; ++i)
+        r.m_v[i] = std::floor(_a.m_v[i]);
+      return r;
+#endif
+    }
+
+    ///
+    /// \brief selectLessEqual Per lane _a <= _b ? _t : _f, what the ternaries of the GLSL operations compile to
+    ///
+    inline Lanes selectLessEqual(const Lanes &_a, const Lanes &_b, const Lanes &_t, const Lanes &_f)
+    {
+#if defined(__AVX__)
+      return Lanes{_mm256_blendv_ps(_f.m_v, _t.m_v, _mm256_cmp_ps(_a.m_v, _b.m_v, _CMP_LE_OQ))};
+#elif defined(__SSE2__) || defined(_M_X64)
+      auto select4 = [](__m128 _m, __m128 _t, __m128 _f) { return _mm_or_ps(_mm_and_ps(_m, _t), _mm_andnot_ps(_m, _f)); };
+      return Lanes{select4(_mm_cmple_ps(_a.m_lo, _b.m_lo), _t.m_lo, _f.m_lo), select4(_mm_cmple_ps(_a.m_hi, _b.m_hi), _t.m_hi, _f.m_hi)};
+#else
+      Lanes r;
+      for(size_t i = 0; i < Lanes::c_width; ++i)
+        r.m_v[i] = _a.m_v[i] <= _b.m_v[i] ? _t.m_v[i] : _f.m_v[i];
+      return r;
+#endif
+    }
+
+    ///
+    /// \brief sign Per lane -1, 0 or 1
+    ///
+    inline Lanes sign(const Lanes &_a)
+    {
+      Lanes zero = Lanes::broadcast(0.f);
+      Lanes one = Lanes::broadcast(1.f);
+      Lanes positive = selectLessEqual(_a, zero, zero, one);
+      Lanes negative = selectLessEqual(zero, _a, zero, one);
+      return positive - negative;
+    }
+
+    ///
+    /// \brief perLane Applies a scalar function to every lane, for the few functions without a vector instruction
+    ///
+    template<typename F>
+    inline Lanes perLane(const Lanes &_a, F _f)
+    {
+      alignas(32) float v[Lanes::c_width];
+      _a.store(v);
+      for(size_t i = 0; i < Lanes::c_width; ++i)
+        v[i] = _f(v[i]);
+      return Lanes::load(v);
+    }
+
+    inline Lanes sin(const Lanes &_a) { return perLane(_a, [](float _x) { return std::sin(_x); }); }
+    inline Lanes cos(const Lanes &_a) { return perLane(_a, [](float _x) { return std::cos(_x); }); }
+
+    // Scalar versions with the same names, used when evaluating the uniform part of a program and for folding constants
+    inline float sqrt(float _a) { return std::sqrt(_a); }
+    inline float abs(float _a) { return std::fabs(_a); }
+    inline float floor(float _a) { return std::floor(_a); }
+    inline float sin(float _a) { return std::sin(_a); }
+    inline float cos(float _a) { return std::cos(_a); }
+    inline float min(float _a, float _b) { return _b < _a ? _b : _a; }
+    inline float max(float _a, float _b) { return _a < _b ? _b : _a; }
+    inline float selectLessEqual(float _a, float _b, float _t, float _f) { return _a <= _b ? _t : _f; }
+    inline float sign(float _a) { return _a > 0.f ? 1.f : (_a < 0.f ? -1.f : 0.f); }
+  }
+}
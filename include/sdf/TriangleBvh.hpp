@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "sdf/Mesher.hpp"
+
+/// \file TriangleBvh.hpp
+/// \brief Bounding volume hierarchy over the triangles of a mesh, answering the two questions a signed distance needs:
+///        the closest point of the surface and whether a point is inside. The inside test is the fast winding number
+///        of Barill et al., every node keeps the area weighted normal of its triangles so a far away node counts as a
+///        single dipole and only the triangles near the point have their solid angle computed. Points of a point cloud
+///        are stored as triangles with three times the same vertex
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    class TriangleBvh
+    {
+    public:
+      ///
+      /// \brief TriangleBvh Builds the hierarchy, splitting the nodes at the median of their longest axis
+      /// \param _mesh Mesh the triangles are copied from, a mesh without triangles is treated as a point cloud
+      ///
+      explicit TriangleBvh(const Mesh &_mesh);
+
+      ///
+      /// \brief closest Closest point of the mesh, the nodes nearer to the point are visited first
+      /// \param _p Point
+      /// \param _bound Squared distance below which the closest point is known to be, from a neighbouring point or
+      ///        infinity. A good bound skips most of the tree
+      /// \param _triangle Closest triangle in the order of the tree, left untouched if nothing is closer than the bound
+      /// \return Closest point, undefined if nothing is closer than the bound
+      ///
+      glm::vec3 closest(const glm::vec3 &_p, float &_bound, uint32_t &_triangle) const;
+      ///
+      /// \brief winding Generalised winding number of the mesh at a point, close to 1 inside and 0 outside even where
+      ///        the mesh has holes or overlaps
+      /// \param _p Point
+      ///
+      float winding(const glm::vec3 &_p) const;
+
+      ///
+      /// \brief triangle Vertices of a triangle
+      ///
+      const glm::vec3 *triangle(uint32_t _triangle) const { return &m_vertices[_triangle * 3]; }
+      ///
+      /// \brief original Index of a triangle in the mesh, or of the vertex for a point cloud
+      ///
+      uint32_t original(uint32_t _triangle) const { return m_original[_triangle]; }
+      size_t triangleCount() const { return m_vertices.size() / 3; }
+      ///
+      /// \brief points Whether the mesh had no triangles and its vertices were taken as a point cloud
+      ///
+      bool points() const { return m_points; }
+      const glm::vec3 &min() const { return m_nodes[0].m_min; }
+      const glm::vec3 &max() const { return m_nodes[0].m_max; }
+
+    private:
+      struct Node
+      {
+        glm::vec3 m_min;
+        glm::vec3 m_max;
+        ///
+        /// \brief m_centre Area weighted centroid of the triangles, where the dipole of the node sits
+        ///
+        glm::vec3 m_centre;
+        ///
+        /// \brief m_normal Sum of the area weighted normals of the triangles
+        ///
+        glm::vec3 m_normal;
+        float m_area;
+        ///
+        /// \brief m_radius Distance from the centre to the farthest corner of the bounds
+        ///
+        float m_radius;
+        ///
+        /// \brief m_first First triangle of a leaf or first child of an inner node, the second child follows it
+        ///
+        uint32_t m_first;
+        ///
+        /// \brief m_count Triangles of a leaf, 0 for an inner node
+        ///
+        uint32_t m_count;
+      };
+
+      static constexpr uint32_t c_leafSize = 4;
+
+      ///
+      /// \brief build Builds the subtree of a node from a range of the triangles, reordering them
+      ///
+      void build(uint32_t _node, uint32_t _first, uint32_t _count, const std::vector<glm::vec3> &_centroids);
+      ///
+      /// \brief boxDistance Squared distance from a point to the bounds of a node
+      ///
+      float boxDistance(const Node &_node, const glm::vec3 &_p) const;
+
+      std::vector<Node> m_nodes;
+      ///
+      /// \brief m_vertices Three vertices per triangle in the order of the leaves
+      ///
+      std::vector<glm::vec3> m_vertices;
+      std::vector<uint32_t> m_original;
+      bool m_points;
+    };
+  }
+}
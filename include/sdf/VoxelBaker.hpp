@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "sdf/Evaluator.hpp"
+#include "sdf/IntervalEvaluator.hpp"
+#include "sdf/Mesher.hpp"
+#include "sdf/Program.hpp"
+#include "sdf/VoxelGrid.hpp"
+#include "ThreadPool.hpp"
+
+/// \file VoxelBaker.hpp
+/// \brief Samples the distance field of a scene into a sparse VoxelGrid. An octree over the bricks of the grid is refined
+///        the same way the mesher refines its cells, except that cells are kept while they may hold a point within the
+///        band of the surface and the cells dropped remember which side of the surface they are on. Only the bricks left
+///        at the end are evaluated, in parallel, so the work and the memory grow with the area of the surface
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    class VoxelBaker
+    {
+    public:
+      struct Settings
+      {
+        glm::vec3 m_min = glm::vec3(-5.f);
+        glm::vec3 m_max = glm::vec3(5.f);
+        float m_voxelSize = 0.05f;
+        ///
+        /// \brief m_band Half width of the band around the surface in voxels, distances are clamped to it
+        ///
+        float m_band = 3.f;
+        Mesher::Pruning m_pruning = Mesher::Pruning::DISTANCE;
+        ///
+        /// \brief m_lipschitz How much faster than 1 the field may change, only used by the distance pruning
+        ///
+        float m_lipschitz = 1.f;
+      };
+
+      ///
+      /// \brief VoxelBaker Default ctor
+      /// \param _program Compiled distance field of the scene
+      /// \param _pool Threads the bricks are evaluated on, one evaluator is created per worker
+      ///
+      VoxelBaker(std::shared_ptr<const Program> _program, ThreadPool &_pool);
+
+      ///
+      /// \brief setTime Sets u_GlobalTime for the distance field
+      /// \param _time Time of the scene
+      ///
+      void setTime(float _time);
+      ///
+      /// \brief bake Samples the grid
+      /// \param _settings Bounds, resolution and band
+      /// \param _grid The grid
+      /// \param _error Reason of the failure
+      /// \return False if the settings are invalid or the grid would have too many points
+      ///
+      bool bake(const Settings &_settings, VoxelGrid &_grid, std::string &_error);
+
+      ///
+      /// \brief cellsPerLevel Cells tested at each level of the octree by the last bake, the last entry are the bricks evaluated
+      ///
+      const std::vector<size_t> &cellsPerLevel() const { return m_cellsPerLevel; }
+      ///
+      /// \brief evaluations Distance evaluations made by the last bake, a box evaluated on intervals counts as one
+      ///
+      size_t evaluations() const { return m_evaluations; }
+
+    private:
+      ///
+      /// \brief Dropped A cell of the octree that is completely outside the band
+      ///
+      struct Dropped
+      {
+        uint64_t m_key;
+        unsigned int m_level;
+        bool m_inside;
+      };
+
+      ///
+      /// \brief findBandBricks Refines the octree down to the bricks that may hold points within the band
+      /// \param _bricks Keys of the bricks, sorted
+      /// \param _dropped Cells dropped on the way
+      ///
+      void findBandBricks(std::vector<uint64_t> &_bricks, std::vector<Dropped> &_dropped);
+      ///
+      /// \brief sampleBricks Evaluates and quantises every point of the bricks
+      /// \param _bricks Keys of the bricks
+      /// \param _values VoxelGridView::c_brickPoints values per brick
+      ///
+      void sampleBricks(const std::vector<uint64_t> &_bricks, std::vector<int8_t> &_values);
+      ///
+      /// \brief assemble Builds the top table and the nodes from the bricks and the dropped cells
+      ///
+      void assemble(const std::vector<uint64_t> &_bricks, std::vector<int8_t> &_values, const std::vector<Dropped> &_dropped, VoxelGrid &_grid);
+      ///
+      /// \brief point Position of a grid point
+      ///
+      glm::vec3 point(uint32_t _i, uint32_t _j, uint32_t _k) const;
+
+      std::shared_ptr<const Program> m_program;
+      ThreadPool &m_pool;
+      std::vector<std::unique_ptr<Evaluator>> m_evaluators;
+      std::vector<std::unique_ptr<IntervalEvaluator>> m_intervalEvaluators;
+      Settings m_settings;
+      uint32_t m_dims[3];
+      uint32_t m_bricks[3];
+      unsigned int m_depth;
+      std::vector<size_t> m_cellsPerLevel;
+      std::atomic<size_t> m_evaluations;
+    };
+  }
+}
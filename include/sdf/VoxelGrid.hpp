@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/// \file VoxelGrid.hpp
+/// \brief Sparse narrow band grid of quantised distances, laid out the same in memory and on disk so a file can be mapped
+///        and read in place. Grid points are grouped into dense bricks of 8^3, bricks into tiles of 16^3 bricks. A dense
+///        top table has one entry per tile, either the index of its node or the side of the surface the whole tile is on.
+///        A node has one entry per brick of the tile, again either a brick index or a side. Bricks hold one signed byte
+///        per point, the distance divided by the band, so a lookup is three array reads whatever the size of the grid
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    struct VoxelGridHeader
+    {
+      static constexpr uint32_t c_version = 1;
+      ///
+      /// \brief c_byteOrder Written as is, reads back differently on a machine of the other endianness
+      ///
+      static constexpr uint32_t c_byteOrder = 0x01020304;
+
+      char m_magic[4];
+      uint32_t m_version;
+      uint32_t m_byteOrder;
+      ///
+      /// \brief m_dims Grid points along each axis, point (0, 0, 0) is at m_min
+      ///
+      uint32_t m_dims[3];
+      ///
+      /// \brief m_tiles Tiles along each axis, the size of the top table is their product
+      ///
+      uint32_t m_tiles[3];
+      uint32_t m_nodeCount;
+      uint32_t m_brickCount;
+      float m_min[3];
+      float m_voxelSize;
+      ///
+      /// \brief m_band Distance a quantised value of 127 stands for, further points are clamped to it
+      ///
+      float m_band;
+      ///
+      /// \brief m_topOffset Byte offsets of the sections from the start of the file, 64 byte aligned
+      ///
+      uint64_t m_topOffset;
+      uint64_t m_nodesOffset;
+      uint64_t m_bricksOffset;
+      uint64_t m_size;
+    };
+
+    static_assert(std::is_trivially_copyable<VoxelGridHeader>::value, "The header is written and mapped as raw bytes");
+
+    ///
+    /// \brief VoxelGridView Lookups into the sections of a grid wherever they live, in a VoxelGrid or in a mapped file
+    ///
+    struct VoxelGridView
+    {
+      static constexpr uint32_t c_brick = 8;
+      static constexpr uint32_t c_tile = 16;
+      static constexpr uint32_t c_brickShift = 3;
+      static constexpr uint32_t c_tileShift = 7;
+      static constexpr uint32_t c_brickPoints = c_brick * c_brick * c_brick;
+      static constexpr uint32_t c_nodeEntries = c_tile * c_tile * c_tile;
+      ///
+      /// \brief c_outside Entry of a tile or brick completely outside the band on the outside of the surface
+      ///
+      static constexpr uint32_t c_outside = 0xffffffff;
+      static constexpr uint32_t c_inside = 0xfffffffe;
+
+      const VoxelGridHeader *m_header = nullptr;
+      const uint32_t *m_top = nullptr;
+      const uint32_t *m_nodes = nullptr;
+      const int8_t *m_bricks = nullptr;
+
+      ///
+      /// \brief value Distance at a grid point, points outside the grid are outside the surface
+      ///
+      float value(uint32_t _i, uint32_t _j, uint32_t _k) const
+      {
+        const VoxelGridHeader &h = *m_header;
+        if(_i >= h.m_dims[0] || _j >= h.m_dims[1] || _k >= h.m_dims[2])
+          return h.m_band;
+        uint32_t entry = m_top[((_k >> c_tileShift) * h.m_tiles[1] + (_j >> c_tileShift)) * h.m_tiles[0] + (_i >> c_tileShift)];
+        if(entry < c_inside)
+        {
+          const uint32_t brickMask = c_tile - 1;
+          const uint32_t *node = m_nodes + static_cast<size_t>(entry) * c_nodeEntries;
+          entry = node[(((_k >> c_brickShift) & brickMask) * c_tile + ((_j >> c_brickShift) & brickMask)) * c_tile + ((_i >> c_brickShift) & brickMask)];
+          // Too many node entries to check when a file is opened, one past the bricks reads as outside the band
+          if(entry < c_inside && entry >= h.m_brickCount)
+            return h.m_band;
+          if(entry < c_inside)
+          {
+            const uint32_t pointMask = c_brick - 1;
+            const int8_t *brick = m_bricks + static_cast<size_t>(entry) * c_brickPoints;
+            return brick[((_k & pointMask) * c_brick + (_j & pointMask)) * c_brick + (_i & pointMask)] * (h.m_band / 127.f);
+          }
+        }
+        return entry == c_inside ? -h.m_band : h.m_band;
+      }
+
+      ///
+      /// \brief sample Trilinear interpolation of the grid points around a position
+      ///
+      float sample(const glm::vec3 &_p) const
+      {
+        const VoxelGridHeader &h = *m_header;
+        glm::vec3 g = (_p - glm::vec3(h.m_min[0], h.m_min[1], h.m_min[2])) / h.m_voxelSize;
+        if(!(g.x >= 0.f && g.y >= 0.f && g.z >= 0.f && g.x < h.m_dims[0] && g.y < h.m_dims[1] && g.z < h.m_dims[2]))
+          return h.m_band;
+        glm::vec3 f = glm::floor(g);
+        glm::vec3 t = g - f;
+        uint32_t i = static_cast<uint32_t>(f.x), j = static_cast<uint32_t>(f.y), k = static_cast<uint32_t>(f.z);
+        float c[2][2];
+        for(uint32_t dz = 0; dz < 2; ++dz)
+          for(uint32_t dy = 0; dy < 2; ++dy)
+            c[dz][dy] = glm::mix(value(i, j + dy, k + dz), value(i + 1, j + dy, k + dz), t.x);
+        return glm::mix(glm::mix(c[0][0], c[0][1], t.y), glm::mix(c[1][0], c[1][1], t.y), t.z);
+      }
+    };
+
+    ///
+    /// \brief VoxelGrid A grid held in memory, what the baker produces and the writer saves
+    ///
+    struct VoxelGrid
+    {
+      VoxelGridHeader m_header;
+      std::vector<uint32_t> m_top;
+      std::vector<uint32_t> m_nodes;
+      std::vector<int8_t> m_bricks;
+
+      VoxelGridView view() const { return VoxelGridView{&m_header, m_top.data(), m_nodes.data(), m_bricks.data()}; }
+    };
+  }
+}
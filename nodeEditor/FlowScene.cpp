@@ -23,6 +23,8 @@
 #include "FlowView.hpp"
 #include "DataModelRegistry.hpp"
 #include "nodes/CollapsedNodeDataModel.hpp"
+#include "AllocationTracker.hpp"
+#include "Profiler.hpp"
 
 std::shared_ptr<Connection>
 FlowScene::
@@ -60,9 +62,17 @@ restoreConnection(Properties const &p)
   p.get("in_index", &portIndexIn);
   p.get("out_index", &portIndexOut);
 
-  auto nodeIn  = _nodes[nodeInId];
-  auto nodeOut = _nodes[nodeOutId];
+  return createConnection(_nodes[nodeInId], portIndexIn, _nodes[nodeOutId], portIndexOut);
+}
+
 
+std::shared_ptr<Connection>
+FlowScene::
+createConnection(std::shared_ptr<Node> nodeIn,
+                 PortIndex portIndexIn,
+                 std::shared_ptr<Node> nodeOut,
+                 PortIndex portIndexOut)
+{
   auto connection =
     std::make_shared<Connection>(nodeIn,
                                  portIndexIn,
@@ -212,6 +222,28 @@ void
 FlowScene::
 save() const
 {
+  QString fileName =
+    QFileDialog::getSaveFileName(nullptr,
+                                 tr("Open Flow Scene"),
+                                 QDir::homePath(),
+                                 tr("Flow Scene Files (*.flow)"));
+
+	if(!fileName.isEmpty())
+  {
+    if (!fileName.endsWith("flow", Qt::CaseInsensitive))
+      fileName += ".flow";
+
+    save(fileName);
+  }
+}
+
+
+bool
+FlowScene::
+save(QString const &fileName) const
+{
+  HSITHO_PROFILE_SCOPE("FlowScene::save");
+  HSITHO_ALLOC_STAGE(SERIALISATION);
   QByteArray byteArray;
   QBuffer    writeBuffer(&byteArray);
 
@@ -253,21 +285,11 @@ save() const
 
   //qDebug() << byteArray;
 
-  QString fileName =
-    QFileDialog::getSaveFileName(nullptr,
-                                 tr("Open Flow Scene"),
-                                 QDir::homePath(),
-                                 tr("Flow Scene Files (*.flow)"));
-
-	if(!fileName.isEmpty())
-  {
-    if (!fileName.endsWith("flow", Qt::CaseInsensitive))
-      fileName += ".flow";
+  QFile file(fileName);
+  if(!file.open(QIODevice::WriteOnly))
+    return false;
 
-    QFile file(fileName);
-    file.open(QIODevice::WriteOnly);
-    file.write(byteArray);
-  }
+  return file.write(byteArray) == byteArray.size();
 }
 
 
@@ -282,13 +304,23 @@ load()
                                  QDir::homePath(),
                                  tr("Flow Scene Files (*.flow)"));
 
+  load(fileName);
+}
+
+
+bool
+FlowScene::
+load(QString const &fileName)
+{
+  HSITHO_PROFILE_SCOPE("FlowScene::load");
+  HSITHO_ALLOC_STAGE(SERIALISATION);
   if (!QFileInfo::exists(fileName))
-    return;
+    return false;
 
   QFile file(fileName);
 
 	if(!file.open(QIODevice::ReadOnly))
-    return;
+    return false;
 
 	_connections.clear();
 	std::unordered_map<QUuid, SharedNode> swapNodes;
@@ -353,13 +385,17 @@ load()
 	}
 	for(auto &p : collapsedConnections)
 		restoreConnection(p);
+
+	return true;
 }
 
 
 FlowScene::
 FlowScene(QWidget *_parent)
 {
-	connect(this, SIGNAL(nodeEditorChanged()), _parent, SLOT(nodeChanged()));
+	// Headless tools use the scene without a window to notify
+	if(_parent != nullptr)
+		connect(this, SIGNAL(nodeEditorChanged()), _parent, SLOT(nodeChanged()));
   setItemIndexMethod(QGraphicsScene::NoIndex);
 }
 
@@ -51,6 +51,13 @@ public:
                    std::shared_ptr<Node> node,
                    PortIndex portIndex);
 
+  /// Connects an output port to an input port, used when building scenes from code
+  std::shared_ptr<Connection>
+  createConnection(std::shared_ptr<Node> nodeIn,
+                   PortIndex portIndexIn,
+                   std::shared_ptr<Node> nodeOut,
+                   PortIndex portIndexOut);
+
   std::shared_ptr<Connection>
   restoreConnection(Properties const &p);
 
@@ -72,9 +79,17 @@ public:
   void
   save() const;
 
+  /// Saves the scene without asking for a file, returns false if the file couldn't be written
+  bool
+  save(QString const &fileName) const;
+
   void
   load();
 
+  /// Loads the scene without asking for a file, returns false if the file couldn't be read
+  bool
+  load(QString const &fileName);
+
   std::unordered_map<QUuid, std::shared_ptr<Node>> getNodes() { return _nodes; }
 
 private:
@@ -11,6 +11,7 @@
 
 #include "ConnectionGraphicsObject.hpp"
 #include "ConnectionState.hpp"
+#include "Profiler.hpp"
 
 //------------------------------------------------------------------------------
 
@@ -191,6 +192,7 @@ void
 Node::
 onDataUpdated(PortIndex index)
 {
+	HSITHO_PROFILE_SCOPE("Node::onDataUpdated");
 	auto nodeData = _nodeDataModel->outData(index);
 
 	auto connections = _nodeState.connection(PortType::Out, index);
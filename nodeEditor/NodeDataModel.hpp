@@ -69,6 +69,10 @@ public:
 	virtual void setScene(FlowScene *_scene) { m_scene = _scene; }
 	virtual std::string getExtraParams() const { return ""; }
 	virtual std::string getShaderCode() { return ""; }
+	/// Closed-form ray intersection for the primitive, empty if the node can only be sphere traced
+	virtual std::string getIntersectionCode() { return ""; }
+	/// Dual-number (distance and gradient) version of the shader code, empty if the node has no derivative
+	virtual std::string getDualShaderCode() { return ""; }
 	virtual DFNodeType getNodeType() const = 0;
 	virtual Mat4f getTransform() { return Mat4f(); }
 	virtual void setTransform(const Mat4f &_t) {}
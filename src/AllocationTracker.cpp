@@ -0,0 +1,288 @@
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+#include "AllocationTracker.hpp"
+
+namespace hsitho
+{
+  namespace
+  {
+    const unsigned int c_stages = static_cast<unsigned int>(AllocationStage::COUNT);
+
+    // Plain zero initialised statics, operator new can run before any dynamic initialisation
+    thread_local unsigned int t_stage = 0;
+
+    struct Counters
+    {
+      std::atomic<size_t> m_count;
+      std::atomic<size_t> m_bytes;
+      std::atomic<size_t> m_frees;
+      std::atomic<int64_t> m_live;
+      std::atomic<int64_t> m_peakLive;
+    };
+    // One per stage and the total last
+    Counters s_counters[c_stages + 1];
+
+    void raisePeak(Counters &_c, int64_t _live)
+    {
+      int64_t peak = _c.m_peakLive.load(std::memory_order_relaxed);
+      while(_live > peak && !_c.m_peakLive.compare_exchange_weak(peak, _live, std::memory_order_relaxed))
+        ;
+    }
+
+    void add(Counters &_c, size_t _bytes)
+    {
+      _c.m_count.fetch_add(1, std::memory_order_relaxed);
+      _c.m_bytes.fetch_add(_bytes, std::memory_order_relaxed);
+      raisePeak(_c, _c.m_live.fetch_add(static_cast<int64_t>(_bytes), std::memory_order_relaxed) + static_cast<int64_t>(_bytes));
+    }
+
+    void remove(Counters &_c, size_t _bytes)
+    {
+      _c.m_frees.fetch_add(1, std::memory_order_relaxed);
+      _c.m_live.fetch_sub(static_cast<int64_t>(_bytes), std::memory_order_relaxed);
+    }
+  }
+
+  AllocationStage AllocationTracker::stage()
+  {
+    return static_cast<AllocationStage>(t_stage);
+  }
+
+  void AllocationTracker::setStage(AllocationStage _stage)
+  {
+    t_stage = static_cast<unsigned int>(_stage);
+  }
+
+  const char *AllocationTracker::stageName(AllocationStage _stage)
+  {
+    switch(_stage)
+    {
+      case AllocationStage::OTHER: return "other";
+      case AllocationStage::EVALUATE: return "evaluate";
+      case AllocationStage::MATRIX: return "matrix multiply";
+      case AllocationStage::CODEGEN: return "codegen";
+      case AllocationStage::UNKNOWNS: return "unknown replacement";
+      case AllocationStage::SERIALISATION: return "serialisation";
+      default: return "total";
+    }
+  }
+
+  void AllocationTracker::recordAllocation(AllocationStage _stage, size_t _bytes)
+  {
+    add(s_counters[static_cast<unsigned int>(_stage)], _bytes);
+    add(s_counters[c_stages], _bytes);
+  }
+
+  void AllocationTracker::recordFree(AllocationStage _stage, size_t _bytes)
+  {
+    remove(s_counters[static_cast<unsigned int>(_stage)], _bytes);
+    remove(s_counters[c_stages], _bytes);
+  }
+
+  void AllocationTracker::beginCompile()
+  {
+    for(auto &c : s_counters)
+    {
+      c.m_count.store(0, std::memory_order_relaxed);
+      c.m_bytes.store(0, std::memory_order_relaxed);
+      c.m_frees.store(0, std::memory_order_relaxed);
+      c.m_peakLive.store(c.m_live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+  }
+
+  namespace
+  {
+    AllocationTracker::StageStats load(const Counters &_c)
+    {
+      AllocationTracker::StageStats s;
+      s.m_count = _c.m_count.load(std::memory_order_relaxed);
+      s.m_bytes = _c.m_bytes.load(std::memory_order_relaxed);
+      s.m_frees = _c.m_frees.load(std::memory_order_relaxed);
+      s.m_live = _c.m_live.load(std::memory_order_relaxed);
+      s.m_peakLive = _c.m_peakLive.load(std::memory_order_relaxed);
+      return s;
+    }
+  }
+
+  std::vector<AllocationTracker::StageStats> AllocationTracker::snapshot()
+  {
+    std::vector<StageStats> stats(c_stages + 1);
+    for(unsigned int i = 0; i <= c_stages; ++i)
+      stats[i] = load(s_counters[i]);
+    return stats;
+  }
+
+  AllocationTracker::StageStats AllocationTracker::total()
+  {
+    return load(s_counters[c_stages]);
+  }
+
+  void AllocationTracker::report(std::ostream &_out)
+  {
+    std::vector<StageStats> stats = snapshot();
+    _out << std::left << std::setw(22) << "stage" << std::right << std::setw(12) << "allocs" << std::setw(14) << "bytes"
+         << std::setw(12) << "frees" << std::setw(14) << "peak live" << "\n";
+    for(unsigned int i = 0; i <= c_stages; ++i)
+    {
+      _out << std::left << std::setw(22) << stageName(static_cast<AllocationStage>(i)) << std::right
+           << std::setw(12) << stats[i].m_count << std::setw(14) << stats[i].m_bytes
+           << std::setw(12) << stats[i].m_frees << std::setw(14) << stats[i].m_peakLive << "\n";
+    }
+  }
+}
+
+#ifdef HSITHO_TRACK_ALLOCATIONS
+namespace
+{
+  // Every block is preceded by a header holding its size and stage, 16 bytes keeps the block aligned for any fundamental
+  // type. Over-aligned blocks are padded, the header sits right before the block and knows where the malloc'd memory starts
+  struct alignas(16) Header
+  {
+    size_t m_size;
+    unsigned int m_stage;
+    unsigned int m_offset;
+  };
+  static_assert(sizeof(Header) == 16, "The header has to keep the alignment of malloc");
+
+  void *trackedAllocate(size_t _size, size_t _alignment = sizeof(Header))
+  {
+    size_t padding = _alignment > sizeof(Header) ? _alignment : 0;
+    char *raw = static_cast<char *>(std::malloc(sizeof(Header) + padding + _size));
+    if(raw == nullptr)
+      return nullptr;
+    uintptr_t block = reinterpret_cast<uintptr_t>(raw) + sizeof(Header);
+    block = (block + padding) & ~static_cast<uintptr_t>(padding ? padding - 1 : 0);
+    Header *h = reinterpret_cast<Header *>(block) - 1;
+    h->m_size = _size;
+    h->m_stage = static_cast<unsigned int>(hsitho::AllocationTracker::stage());
+    h->m_offset = static_cast<unsigned int>(block - reinterpret_cast<uintptr_t>(raw));
+    hsitho::AllocationTracker::recordAllocation(static_cast<hsitho::AllocationStage>(h->m_stage), _size);
+    return h + 1;
+  }
+
+  void trackedFree(void *_p)
+  {
+    if(_p == nullptr)
+      return;
+    Header *h = static_cast<Header *>(_p) - 1;
+    hsitho::AllocationTracker::recordFree(static_cast<hsitho::AllocationStage>(h->m_stage), h->m_size);
+    std::free(static_cast<char *>(_p) - h->m_offset);
+  }
+}
+
+void *operator new(size_t _size)
+{
+  void *p = trackedAllocate(_size);
+  if(p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t _size)
+{
+  void *p = trackedAllocate(_size);
+  if(p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new(size_t _size, const std::nothrow_t &) noexcept
+{
+  return trackedAllocate(_size);
+}
+
+void *operator new[](size_t _size, const std::nothrow_t &) noexcept
+{
+  return trackedAllocate(_size);
+}
+
+void operator delete(void *_p) noexcept
+{
+  trackedFree(_p);
+}
+
+void operator delete[](void *_p) noexcept
+{
+  trackedFree(_p);
+}
+
+void operator delete(void *_p, size_t) noexcept
+{
+  trackedFree(_p);
+}
+
+void operator delete[](void *_p, size_t) noexcept
+{
+  trackedFree(_p);
+}
+
+void operator delete(void *_p, const std::nothrow_t &) noexcept
+{
+  trackedFree(_p);
+}
+
+void operator delete[](void *_p, const std::nothrow_t &) noexcept
+{
+  trackedFree(_p);
+}
+
+// Types such as the AVX lanes of the SIMD evaluator are allocated through the aligned overloads
+void *operator new(size_t _size, std::align_val_t _alignment)
+{
+  void *p = trackedAllocate(_size, static_cast<size_t>(_alignment));
+  if(p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t _size, std::align_val_t _alignment)
+{
+  void *p = trackedAllocate(_size, static_cast<size_t>(_alignment));
+  if(p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new(size_t _size, std::align_val_t _alignment, const std::nothrow_t &) noexcept
+{
+  return trackedAllocate(_size, static_cast<size_t>(_alignment));
+}
+
+void *operator new[](size_t _size, std::align_val_t _alignment, const std::nothrow_t &) noexcept
+{
+  return trackedAllocate(_size, static_cast<size_t>(_alignment));
+}
+
+void operator delete(void *_p, std::align_val_t) noexcept
+{
+  trackedFree(_p);
+}
+
+void operator delete[](void *_p, std::align_val_t) noexcept
+{
+  trackedFree(_p);
+}
+
+void operator delete(void *_p, size_t, std::align_val_t) noexcept
+{
+  trackedFree(_p);
+}
+
+void operator delete[](void *_p, size_t, std::align_val_t) noexcept
+{
+  trackedFree(_p);
+}
+
+void operator delete(void *_p, std::align_val_t, const std::nothrow_t &) noexcept
+{
+  trackedFree(_p);
+}
+
+void operator delete[](void *_p, std::align_val_t, const std::nothrow_t &) noexcept
+{
+  trackedFree(_p);
+}
+#endif
@@ -0,0 +1,32 @@
+#include "CompileArena.hpp"
+
+namespace hsitho
+{
+  namespace
+  {
+    thread_local std::pmr::memory_resource *t_current = nullptr;
+  }
+
+  CompileArena::CompileArena(size_t _initialSize) :
+    m_buffer(new std::byte[_initialSize]),
+    m_resource(m_buffer.get(), _initialSize, std::pmr::new_delete_resource()),
+    m_previous(t_current)
+  {
+    t_current = &m_resource;
+  }
+
+  CompileArena::~CompileArena()
+  {
+    t_current = m_previous;
+  }
+
+  std::pmr::memory_resource *CompileArena::resource()
+  {
+    return t_current ? t_current : std::pmr::new_delete_resource();
+  }
+
+  bool CompileArena::active()
+  {
+    return t_current != nullptr;
+  }
+}
@@ -1,5 +1,10 @@
-#include <iomanip>
+#include <algorithm>
+#include <cmath>
 #include "ExpressionEvaluator.hpp"
+#include "AllocationTracker.hpp"
+#include "CompileArena.hpp"
+#include "Numeric.hpp"
+#include "Profiler.hpp"
 
 /*
  * Please do not look at these!
@@ -183,10 +188,12 @@ namespace hsitho {
 			return no;
 		}
 
-		std::string evaluate(const std::string &_expression, const std::string &_prev, const int &_copyNum, const unsigned int &_gen)
+		std::string evaluate(std::string_view _expression, const std::string &_prev, const int &_copyNum, const unsigned int &_gen)
 		{
+			HSITHO_PROFILE_SCOPE("Expressions::evaluate");
+			HSITHO_ALLOC_STAGE(EVALUATE);
       // Generate postfix notation for the expression
-			std::string exp = _expression;
+			std::string exp(_expression);
 			bool parsed = false;
 			size_t cos = 0;
 			size_t sin = 0;
@@ -233,13 +240,13 @@ namespace hsitho {
 			}
 			if(_copyNum != -1) {
 				size_t pos;
+				std::string copyNum = Numeric::toString(_copyNum);
 				while((pos = exp.find("copyNum")) != std::string::npos) {
-					try {
-						exp.replace(pos, 7, boost::lexical_cast<std::string>(_copyNum));
-					} catch(const boost::bad_lexical_cast e) {}
+					exp.replace(pos, 7, copyNum);
 				}
 			}
-      std::vector<std::string> expElements;
+      // The terms only live for this evaluation, short ones stay inside the strings so the vectors are all that's allocated
+      ArenaVector<std::string> expElements(CompileArena::resource());
       size_t poss = 0;
       while((poss = exp.find(" ")) != std::string::npos) {
         if(exp.substr(0, poss) != "") {
@@ -250,16 +257,14 @@ namespace hsitho {
       expElements.push_back(exp.substr(0, poss));
       exp.erase(0, poss + 1);
 
-      std::vector<std::string> outputQueue, stack;
+      ArenaVector<std::string> outputQueue(CompileArena::resource()), stack(CompileArena::resource());
       for(auto &i : expElements)
       {
-        try {
-					float val = boost::lexical_cast<float>(i);
-					std::ostringstream ss;
-					ss << std::fixed << std::setprecision(4) << val;
-					outputQueue.push_back(ss.str());
+				float val;
+				if(Numeric::parseFloat(i, val)) {
+					outputQueue.push_back(Numeric::toFixed(val));
           continue;
-				} catch(const boost::bad_lexical_cast &) {}
+				}
         if(i == "*" || i == "/") {
           if(stack.size()) {
             std::string op = stack.back();
@@ -321,50 +326,43 @@ namespace hsitho {
       return finalOutput;
     }
 
-		std::string evaluatePostFix(std::vector<std::string> outputQueue)
+		std::string evaluatePostFix(const ArenaVector<std::string> &outputQueue)
     {
-      std::vector<std::string> stack;
+      ArenaVector<std::string> stack(CompileArena::resource());
 
       for(auto &o : outputQueue)
       {
-        try {
-					size_t pos;
-					if((pos = o.find("-sin(")) != std::string::npos) {
-						unsigned int startPos = pos+5;
-						float sineval = std::sin(boost::lexical_cast<float>(o.substr(startPos, o.find(")", pos) - startPos)));
-						std::ostringstream ss;
-						ss << std::fixed << std::setprecision(4) << "-" << sineval;
-						stack.push_back(o.substr(0, pos) + ss.str() + o.substr(o.find(")", pos) + 1));
-						continue;
-					} else if((pos = o.find("sin(")) != std::string::npos) {
-						unsigned int startPos = pos+4;
-						float sineval = std::sin(boost::lexical_cast<float>(o.substr(startPos, o.find(")", pos) - startPos)));
-						std::ostringstream ss;
-						ss << std::fixed << std::setprecision(4) << sineval;
-						stack.push_back(o.substr(0, pos) + ss.str() + o.substr(o.find(")", pos) + 1));
+				// Numbers and sines or cosines of numbers are folded, anything else is left for the operators below
+				size_t pos;
+				float val;
+				if((pos = o.find("-sin(")) != std::string::npos) {
+					unsigned int startPos = pos+5;
+					if(Numeric::parseFloat(std::string_view(o).substr(startPos, o.find(")", pos) - startPos), val)) {
+						stack.push_back(o.substr(0, pos) + "-" + Numeric::toFixed(std::sin(val)) + o.substr(o.find(")", pos) + 1));
 						continue;
-					} else if((pos = o.find("-cos(")) != std::string::npos) {
-						unsigned int startPos = pos+5;
-						float cosineval = std::cos(boost::lexical_cast<float>(o.substr(startPos, o.find(")", pos) - startPos)));
-						std::ostringstream ss;
-						ss << std::fixed << std::setprecision(4) << "-" << cosineval;
-						stack.push_back(o.substr(0, pos) + ss.str() + o.substr(o.find(")", pos) + 1));
+					}
+				} else if((pos = o.find("sin(")) != std::string::npos) {
+					unsigned int startPos = pos+4;
+					if(Numeric::parseFloat(std::string_view(o).substr(startPos, o.find(")", pos) - startPos), val)) {
+						stack.push_back(o.substr(0, pos) + Numeric::toFixed(std::sin(val)) + o.substr(o.find(")", pos) + 1));
 						continue;
-					} else if((pos = o.find("cos(")) != std::string::npos) {
-						unsigned int startPos = pos+4;
-						float cosineval = std::cos(boost::lexical_cast<float>(o.substr(startPos, o.find(")", pos) - startPos)));
-						std::ostringstream ss;
-						ss << std::fixed << std::setprecision(4) << cosineval;
-						stack.push_back(o.substr(0, pos) + ss.str() + o.substr(o.find(")", pos) + 1));
+					}
+				} else if((pos = o.find("-cos(")) != std::string::npos) {
+					unsigned int startPos = pos+5;
+					if(Numeric::parseFloat(std::string_view(o).substr(startPos, o.find(")", pos) - startPos), val)) {
+						stack.push_back(o.substr(0, pos) + "-" + Numeric::toFixed(std::cos(val)) + o.substr(o.find(")", pos) + 1));
 						continue;
-					} else {
-						float val = boost::lexical_cast<float>(o);
-						std::ostringstream ss;
-						ss << std::fixed << std::setprecision(4) << val;
-						stack.push_back(ss.str());
+					}
+				} else if((pos = o.find("cos(")) != std::string::npos) {
+					unsigned int startPos = pos+4;
+					if(Numeric::parseFloat(std::string_view(o).substr(startPos, o.find(")", pos) - startPos), val)) {
+						stack.push_back(o.substr(0, pos) + Numeric::toFixed(std::cos(val)) + o.substr(o.find(")", pos) + 1));
 						continue;
 					}
-				} catch(const boost::bad_lexical_cast &) {}
+				} else if(Numeric::parseFloat(o, val)) {
+					stack.push_back(Numeric::toFixed(val));
+					continue;
+				}
 
         if((o == "*" || o == "/" || o == "+" || o == "-") && stack.size()) {
           std::string vals[2];
@@ -376,11 +374,10 @@ namespace hsitho {
             parseExpression(vals[1]);
             stack.pop_back();
           }
-          try
+          float v1, v2;
+          if(Numeric::parseFloat(vals[0], v1) && Numeric::parseFloat(vals[1], v2))
           {
             float result;
-						float v1 = boost::lexical_cast<float>(vals[0]);
-						float v2 = boost::lexical_cast<float>(vals[1]);
             if(o == "*") {
               result = v2 * v1;
             } else if(o == "/") {
@@ -390,10 +387,8 @@ namespace hsitho {
             } else if(o == "-") {
               result = v2 - v1;
             }
-						std::ostringstream ss;
-						ss << std::fixed << std::setprecision(4) << result;
-						stack.push_back(ss.str());
-					} catch(const boost::bad_lexical_cast &) {
+						stack.push_back(Numeric::toFixed(result));
+					} else {
             if(o == "*") {
 							bool parsed = false;
 							if(vals[0] != "0.0000" && vals[1] != "0.0000") {
@@ -551,12 +546,15 @@ namespace hsitho {
         }
       }
 
-      std::ostringstream output;
+      size_t length = 0;
+      for(auto &s : stack)
+        length += s.size();
+      std::string final;
+      final.reserve(length);
       for(auto &s : stack)
       {
-        output << s;
+        final += s;
       }
-      std::string final = output.str();
       parseExpression(final);
       return final;
     }
@@ -574,7 +572,7 @@ namespace hsitho {
 		{
 			std::shared_ptr<Unknowns> u = Unknowns::instance();
 			std::string exp = _expression;
-			std::vector<std::string> expElements;
+			ArenaVector<std::string> expElements(CompileArena::resource());
 			size_t poss = 0;
 			while((poss = exp.find(" ")) != std::string::npos) {
 				if(exp.substr(0, poss) != "") {
@@ -585,13 +583,12 @@ namespace hsitho {
 			expElements.push_back(exp.substr(0, poss));
 			exp.erase(0, poss + 1);
 
-			std::vector<std::string> outputQueue, stack;
+			ArenaVector<std::string> stack(CompileArena::resource());
 			for(auto &i : expElements)
 			{
-				try {
-					boost::lexical_cast<float>(i);
+				if(Numeric::isNumber(i)) {
 					continue;
-				} catch(const boost::bad_lexical_cast &) {}
+				}
 				if(i == "*" || i == "/") {
 					if(stack.size()) {
 						std::string op = stack.back();
@@ -620,9 +617,7 @@ namespace hsitho {
 					}
 					if(stack.size()) stack.pop_back();
 				} else {
-					try {
-						boost::lexical_cast<float>(i);
-					} catch(boost::bad_lexical_cast &) {
+					if(!Numeric::isNumber(i)) {
 						u->setUnknown(i);
 					}
 				}
@@ -631,6 +626,8 @@ namespace hsitho {
 
 		std::string replaceUnknowns(const std::string &_expression)
 		{
+			HSITHO_PROFILE_SCOPE("Expressions::replaceUnknowns");
+			HSITHO_ALLOC_STAGE(UNKNOWNS);
 			std::shared_ptr<Unknowns> u = Unknowns::instance();
 			std::string thisOutput = _expression;
 			for(auto &s : u->getUnknowns()) {
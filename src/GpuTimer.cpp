@@ -0,0 +1,76 @@
+#include "GpuTimer.hpp"
+
+namespace hsitho
+{
+  GpuTimer::GpuTimer(unsigned int _ringSize) :
+    m_queries(_ringSize, nullptr),
+    m_head(0),
+    m_tail(0),
+    m_pending(0),
+    m_supported(false),
+    m_active(false)
+  {
+  }
+
+  GpuTimer::~GpuTimer()
+  {
+    destroy();
+  }
+
+  bool GpuTimer::init()
+  {
+    m_supported = true;
+    for(auto &query : m_queries)
+    {
+      if(query == nullptr)
+        query = new QOpenGLTimerQuery();
+      if(!query->isCreated() && !query->create())
+        m_supported = false;
+    }
+    return m_supported;
+  }
+
+  void GpuTimer::destroy()
+  {
+    for(auto &query : m_queries)
+    {
+      delete query;
+      query = nullptr;
+    }
+    m_head = m_tail = m_pending = 0;
+    m_supported = false;
+    m_active = false;
+  }
+
+  void GpuTimer::begin()
+  {
+    // Rather drop a sample than wait for the oldest query to finish
+    if(!m_supported || m_pending == m_queries.size())
+      return;
+
+    m_queries[m_head]->begin();
+    m_active = true;
+  }
+
+  void GpuTimer::end()
+  {
+    if(!m_active)
+      return;
+
+    m_queries[m_head]->end();
+    m_head = (m_head + 1) % m_queries.size();
+    ++m_pending;
+    m_active = false;
+  }
+
+  bool GpuTimer::poll(float &_ms)
+  {
+    if(m_pending == 0 || !m_queries[m_tail]->isResultAvailable())
+      return false;
+
+    _ms = m_queries[m_tail]->waitForResult() / 1000000.f;
+    m_tail = (m_tail + 1) % m_queries.size();
+    --m_pending;
+    return true;
+  }
+}
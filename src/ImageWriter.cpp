@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include <QImage>
+#include <QString>
+
+#include "ImageWriter.hpp"
+
+namespace hsitho
+{
+  namespace
+  {
+    // EXR is little-endian, as are all the platforms the tools run on
+    void putInt(std::vector<char> &_out, int32_t _v)
+    {
+      const char *b = reinterpret_cast<const char *>(&_v);
+      _out.insert(_out.end(), b, b + 4);
+    }
+
+    void putFloat(std::vector<char> &_out, float _v)
+    {
+      const char *b = reinterpret_cast<const char *>(&_v);
+      _out.insert(_out.end(), b, b + 4);
+    }
+
+    void putString(std::vector<char> &_out, const std::string &_s)
+    {
+      _out.insert(_out.end(), _s.begin(), _s.end());
+      _out.push_back('\0');
+    }
+
+    void putAttribute(std::vector<char> &_out, const std::string &_name, const std::string &_type, const std::vector<char> &_value)
+    {
+      putString(_out, _name);
+      putString(_out, _type);
+      putInt(_out, static_cast<int32_t>(_value.size()));
+      _out.insert(_out.end(), _value.begin(), _value.end());
+    }
+
+    std::vector<char> box(int _w, int _h)
+    {
+      std::vector<char> v;
+      putInt(v, 0);
+      putInt(v, 0);
+      putInt(v, _w - 1);
+      putInt(v, _h - 1);
+      return v;
+    }
+
+    bool endsWith(const std::string &_path, const char *_extension)
+    {
+      return QString::fromStdString(_path).endsWith(_extension, Qt::CaseInsensitive);
+    }
+  }
+
+  bool ScanlineWriter::open(const std::string &_path, int _w, int _h, bool _resume, int &_rowsDone)
+  {
+    close();
+    m_width = _w;
+    m_height = _h;
+    _rowsDone = 0;
+
+    std::vector<char> head = header();
+    m_headerSize = static_cast<long long>(head.size());
+
+    if(_resume)
+      m_file = std::fopen(_path.c_str(), "r+b");
+    if(m_file != nullptr)
+    {
+      // Only files with the exact same header are from this image
+      std::vector<char> existing(head.size());
+      if(std::fread(existing.data(), 1, existing.size(), m_file) != existing.size() || existing != head)
+      {
+        close();
+        return false;
+      }
+      std::fseek(m_file, 0, SEEK_END);
+      long long size = std::ftell(m_file);
+      _rowsDone = static_cast<int>(std::min<long long>((size - m_headerSize) / rowSize(), _h));
+      return true;
+    }
+
+    m_file = std::fopen(_path.c_str(), "w+b");
+    if(m_file == nullptr)
+      return false;
+    return std::fwrite(head.data(), 1, head.size(), m_file) == head.size();
+  }
+
+  bool ScanlineWriter::writeRows(int _y, int _count, const float *_rgba)
+  {
+    if(m_file == nullptr || _y < 0 || _y + _count > m_height)
+      return false;
+
+    if(std::fseek(m_file, rowOffset(_y), SEEK_SET) != 0)
+      return false;
+
+    m_row.resize(static_cast<size_t>(rowSize()));
+    for(int row = 0; row < _count; ++row)
+    {
+      encodeRow(_y + row, _rgba + static_cast<size_t>(row) * m_width * 4, m_row);
+      if(std::fwrite(m_row.data(), 1, m_row.size(), m_file) != m_row.size())
+        return false;
+    }
+    return true;
+  }
+
+  bool ScanlineWriter::close()
+  {
+    if(m_file == nullptr)
+      return true;
+
+    bool success = std::fclose(m_file) == 0;
+    m_file = nullptr;
+    return success;
+  }
+
+  std::vector<char> ExrScanlineWriter::header() const
+  {
+    std::vector<char> head;
+    putInt(head, 20000630);
+    putInt(head, 2);
+
+    // Channels are stored in alphabetical order, all 32-bit float
+    std::vector<char> channels;
+    for(auto name : {"A", "B", "G", "R"})
+    {
+      putString(channels, name);
+      putInt(channels, 2);
+      channels.insert(channels.end(), 4, '\0');
+      putInt(channels, 1);
+      putInt(channels, 1);
+    }
+    channels.push_back('\0');
+
+    std::vector<char> v;
+    putAttribute(head, "channels", "chlist", channels);
+    putAttribute(head, "compression", "compression", std::vector<char>(1, '\0'));
+    putAttribute(head, "dataWindow", "box2i", box(m_width, m_height));
+    putAttribute(head, "displayWindow", "box2i", box(m_width, m_height));
+    putAttribute(head, "lineOrder", "lineOrder", std::vector<char>(1, '\0'));
+    putFloat(v, 1.f);
+    putAttribute(head, "pixelAspectRatio", "float", v);
+    v.clear();
+    putFloat(v, 0.f);
+    putFloat(v, 0.f);
+    putAttribute(head, "screenWindowCenter", "v2f", v);
+    v.clear();
+    putFloat(v, 1.f);
+    putAttribute(head, "screenWindowWidth", "float", v);
+    head.push_back('\0');
+
+    // Uncompressed rows all have the same size, so the line offset table is known before any of them is written
+    long long dataStart = static_cast<long long>(head.size()) + static_cast<long long>(m_height) * 8;
+    for(int y = 0; y < m_height; ++y)
+    {
+      uint64_t offset = static_cast<uint64_t>(dataStart + y * rowSize());
+      const char *b = reinterpret_cast<const char *>(&offset);
+      head.insert(head.end(), b, b + 8);
+    }
+    return head;
+  }
+
+  void ExrScanlineWriter::encodeRow(int _y, const float *_rgba, std::vector<char> &_out) const
+  {
+    int32_t y = _y;
+    int32_t size = m_width * 4 * 4;
+    std::memcpy(&_out[0], &y, 4);
+    std::memcpy(&_out[4], &size, 4);
+
+    // Each row holds the channels one after the other: A, B, G, R
+    char *dst = &_out[8];
+    for(int c = 0; c < 4; ++c)
+    {
+      int channel = 3 - c;
+      for(int x = 0; x < m_width; ++x)
+      {
+        float v = _rgba[x * 4 + channel];
+        if(channel != 3)
+          v = toLinear(v);
+        std::memcpy(dst, &v, 4);
+        dst += 4;
+      }
+    }
+  }
+
+  std::vector<char> PpmScanlineWriter::header() const
+  {
+    std::string head = "P6\n" + std::to_string(m_width) + " " + std::to_string(m_height) + "\n255\n";
+    return std::vector<char>(head.begin(), head.end());
+  }
+
+  void PpmScanlineWriter::encodeRow(int, const float *_rgba, std::vector<char> &_out) const
+  {
+    for(int x = 0; x < m_width; ++x)
+      for(int c = 0; c < 3; ++c)
+        _out[x * 3 + c] = static_cast<char>(static_cast<unsigned char>(std::min(std::max(_rgba[x * 4 + c], 0.f), 1.f) * 255.f + 0.5f));
+  }
+
+  std::unique_ptr<ScanlineWriter> createScanlineWriter(const std::string &_path)
+  {
+    if(endsWith(_path, ".exr"))
+      return std::unique_ptr<ScanlineWriter>(new ExrScanlineWriter());
+    if(endsWith(_path, ".ppm"))
+      return std::unique_ptr<ScanlineWriter>(new PpmScanlineWriter());
+    return nullptr;
+  }
+
+  bool isExr(const std::string &_path)
+  {
+    return endsWith(_path, ".exr");
+  }
+
+  float toLinear(float _c)
+  {
+    return std::pow(std::max(_c, 0.f), 1.f / 0.4545f);
+  }
+
+  bool writeImage(const std::string &_path, int _w, int _h, const std::vector<float> &_rgba, std::string &_error)
+  {
+    std::unique_ptr<ScanlineWriter> writer = createScanlineWriter(_path);
+    if(writer)
+    {
+      int rowsDone;
+      if(!writer->open(_path, _w, _h, false, rowsDone) || !writer->writeRows(0, _h, _rgba.data()) || !writer->close())
+      {
+        _error = "Couldn't write " + _path;
+        return false;
+      }
+      return true;
+    }
+
+    QImage image(_w, _h, QImage::Format_RGBA8888);
+    for(int y = 0; y < _h; ++y)
+    {
+      uchar *line = image.scanLine(y);
+      const float *src = &_rgba[static_cast<size_t>(y) * _w * 4];
+      for(int i = 0; i < _w * 4; ++i)
+        line[i] = static_cast<uchar>(std::min(std::max(src[i], 0.f), 1.f) * 255.f + 0.5f);
+    }
+    if(!image.save(QString::fromStdString(_path)))
+    {
+      _error = "Couldn't write " + _path + ", unknown format or no permission";
+      return false;
+    }
+    return true;
+  }
+}
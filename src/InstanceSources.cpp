@@ -0,0 +1,180 @@
+#include <cmath>
+#include <fstream>
+#include <string_view>
+
+#include <glm/gtc/constants.hpp>
+
+#include "sdf/SceneCompiler.hpp"
+#include "InstanceSources.hpp"
+#include "Numeric.hpp"
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  namespace
+  {
+    std::string_view trim(std::string_view _s)
+    {
+      while(!_s.empty() && (_s.front() == ' ' || _s.front() == '\t'))
+        _s.remove_prefix(1);
+      while(!_s.empty() && (_s.back() == ' ' || _s.back() == '\t' || _s.back() == '\r'))
+        _s.remove_suffix(1);
+      return _s;
+    }
+
+    ///
+    /// \brief rotation Rotation about x, then y, then z, in radians
+    ///
+    glm::mat3 rotation(float _x, float _y, float _z)
+    {
+      float cx = std::cos(_x), sx = std::sin(_x);
+      float cy = std::cos(_y), sy = std::sin(_y);
+      float cz = std::cos(_z), sz = std::sin(_z);
+      glm::mat3 x(1.f), y(1.f), z(1.f);
+      x[1][1] = cx; x[1][2] = sx; x[2][1] = -sx; x[2][2] = cx;
+      y[0][0] = cy; y[0][2] = -sy; y[2][0] = sy; y[2][2] = cy;
+      z[0][0] = cz; z[0][1] = sz; z[1][0] = -sz; z[1][1] = cz;
+      return z * y * x;
+    }
+
+    glm::mat4 place(const glm::mat3 &_m, const glm::vec3 &_position)
+    {
+      glm::mat4 t(1.f);
+      for(int i = 0; i < 3; ++i)
+        t[i] = glm::vec4(_m[i], 0.f);
+      t[3] = glm::vec4(_position, 1.f);
+      return t;
+    }
+  }
+
+  float randomUnit(uint32_t _seed, uint64_t _index)
+  {
+    uint64_t z = (uint64_t(_seed) << 32) + _index + 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    z ^= z >> 31;
+    return static_cast<float>(z >> 40) / static_cast<float>(uint64_t(1) << 24);
+  }
+
+  bool readInstances(const std::string &_path, std::vector<glm::mat4> &_transforms, std::string &_error)
+  {
+    HSITHO_PROFILE_SCOPE("readInstances");
+    std::ifstream file(_path);
+    if(!file)
+    {
+      _error = "Couldn't open " + _path;
+      return false;
+    }
+    _transforms.clear();
+    std::string line;
+    size_t number = 0;
+    while(std::getline(file, line))
+    {
+      ++number;
+      std::string_view text = trim(line);
+      if(text.empty() || text.front() == '#')
+        continue;
+
+      std::vector<float> values;
+      bool numbers = true;
+      while(numbers)
+      {
+        size_t comma = text.find(',');
+        float value;
+        numbers = Numeric::parseFloat(trim(text.substr(0, comma)), value);
+        values.push_back(value);
+        if(comma == std::string_view::npos)
+          break;
+        text.remove_prefix(comma + 1);
+      }
+      if(!numbers)
+      {
+        // Column names
+        if(number == 1)
+          continue;
+        _error = _path + ":" + std::to_string(number) + ": expected numbers separated by commas";
+        return false;
+      }
+
+      const float radians = glm::pi<float>() / 180.f;
+      glm::vec3 position(values[0], values.size() > 2 ? values[1] : 0.f, values.size() > 2 ? values[2] : 0.f);
+      switch(values.size())
+      {
+        case 3:
+          _transforms.push_back(place(glm::mat3(1.f), position));
+        break;
+        case 4:
+          _transforms.push_back(place(glm::mat3(values[3]), position));
+        break;
+        case 7:
+          _transforms.push_back(place(rotation(values[3] * radians, values[4] * radians, values[5] * radians) * glm::mat3(values[6]), position));
+        break;
+        case 12:
+        {
+          glm::mat4 t(1.f);
+          for(int row = 0; row < 3; ++row)
+            for(int column = 0; column < 4; ++column)
+              t[column][row] = values[row * 4 + column];
+          _transforms.push_back(t);
+        } break;
+        default:
+          _error = _path + ":" + std::to_string(number) + ": expected 3, 4, 7 or 12 values, got " + std::to_string(values.size());
+          return false;
+      }
+    }
+    return true;
+  }
+
+  void gridInstances(unsigned int _count, float _spacing, std::vector<glm::mat4> &_transforms)
+  {
+    unsigned int side = 1;
+    while(side * side * side < _count)
+      ++side;
+    float centre = 0.5f * (side - 1) * _spacing;
+    _transforms.clear();
+    _transforms.reserve(_count);
+    for(unsigned int i = 0; i < _count; ++i)
+    {
+      glm::vec3 position(static_cast<float>(i % side), static_cast<float>(i / side % side), static_cast<float>(i / side / side));
+      _transforms.push_back(place(glm::mat3(1.f), position * _spacing - glm::vec3(centre)));
+    }
+  }
+
+  void randomInstances(unsigned int _count, float _extent, uint32_t _seed, std::vector<glm::mat4> &_transforms)
+  {
+    _transforms.clear();
+    _transforms.reserve(_count);
+    for(unsigned int i = 0; i < _count; ++i)
+    {
+      float u[6];
+      for(int j = 0; j < 6; ++j)
+        u[j] = randomUnit(_seed, uint64_t(i) * 6 + j);
+      // Uniform over the rotations, from a uniform unit quaternion
+      const float tau = glm::two_pi<float>();
+      float a = std::sqrt(1.f - u[3]), b = std::sqrt(u[3]);
+      float x = a * std::sin(tau * u[4]), y = a * std::cos(tau * u[4]);
+      float z = b * std::sin(tau * u[5]), w = b * std::cos(tau * u[5]);
+      glm::mat3 r(1.f - 2.f * (y * y + z * z), 2.f * (x * y + w * z), 2.f * (x * z - w * y),
+                  2.f * (x * y - w * z), 1.f - 2.f * (x * x + z * z), 2.f * (y * z + w * x),
+                  2.f * (x * z + w * y), 2.f * (y * z - w * x), 1.f - 2.f * (x * x + y * y));
+      glm::vec3 position(u[0], u[1], u[2]);
+      _transforms.push_back(place(r, (position * 2.f - 1.f) * _extent));
+    }
+  }
+
+  std::shared_ptr<const sdf::InstanceSet> makeInstances(const std::string &_instance,
+                                                        const std::vector<std::shared_ptr<const sdf::DistanceVolume>> &_volumes,
+                                                        const std::vector<std::shared_ptr<const sdf::InstanceSet>> &_sets,
+                                                        const std::vector<glm::mat4> &_transforms, float _radius, std::string &_error)
+  {
+    HSITHO_PROFILE_SCOPE("makeInstances");
+    std::string map = "vec4 map(vec3 _position)\n{\n  return " + _instance + ";\n}\n";
+    std::shared_ptr<const sdf::Program> instance = sdf::SceneCompiler::compileMap(map, _error, false, _volumes, _sets);
+    if(!instance)
+    {
+      _error = "Couldn't compile the instance: " + _error;
+      return nullptr;
+    }
+    return std::make_shared<const sdf::InstanceSet>(instance, _transforms, _radius);
+  }
+}
@@ -0,0 +1,89 @@
+#include <string>
+
+#include <QOpenGLContext>
+
+#include "InstanceTextures.hpp"
+#include "Profiler.hpp"
+#include "ShaderGenerator.hpp"
+
+namespace hsitho
+{
+  InstanceTextures::~InstanceTextures()
+  {
+    clear();
+  }
+
+  QOpenGLFunctions_4_1_Core *InstanceTextures::functions() const
+  {
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    return context ? context->versionFunctions<QOpenGLFunctions_4_1_Core>() : nullptr;
+  }
+
+  void InstanceTextures::update(const std::vector<std::shared_ptr<const sdf::InstanceSet>> &_sets)
+  {
+    std::vector<Entry> entries;
+    entries.reserve(_sets.size());
+    for(auto &set : _sets)
+    {
+      Entry entry{set, 0, 0};
+      for(auto &old : m_entries)
+        if(old.m_set == set && old.m_texture != 0)
+        {
+          std::swap(entry.m_buffer, old.m_buffer);
+          std::swap(entry.m_texture, old.m_texture);
+          break;
+        }
+      if(entry.m_texture == 0)
+        upload(entry);
+      entries.push_back(entry);
+    }
+    clear();
+    m_entries.swap(entries);
+  }
+
+  void InstanceTextures::bind(QOpenGLShaderProgram &_program)
+  {
+    QOpenGLFunctions_4_1_Core *f = functions();
+    if(!f)
+      return;
+    for(size_t i = 0; i < m_entries.size(); ++i)
+    {
+      GLuint unit = static_cast<GLuint>(ShaderGenerator::c_maxVolumes + i);
+      f->glActiveTexture(GL_TEXTURE0 + unit);
+      f->glBindTexture(GL_TEXTURE_BUFFER, m_entries[i].m_texture);
+      _program.setUniformValue(("u_Instances" + std::to_string(i)).c_str(), static_cast<GLint>(unit));
+    }
+    f->glActiveTexture(GL_TEXTURE0);
+  }
+
+  void InstanceTextures::clear()
+  {
+    QOpenGLFunctions_4_1_Core *f = functions();
+    for(auto &entry : m_entries)
+    {
+      if(f && entry.m_texture != 0)
+      {
+        f->glDeleteTextures(1, &entry.m_texture);
+        f->glDeleteBuffers(1, &entry.m_buffer);
+      }
+    }
+    m_entries.clear();
+  }
+
+  void InstanceTextures::upload(Entry &_entry)
+  {
+    HSITHO_PROFILE_SCOPE("InstanceTextures::upload");
+    QOpenGLFunctions_4_1_Core *f = functions();
+    if(!f)
+      return;
+    const std::vector<glm::vec4> &texels = _entry.m_set->texels();
+    f->glGenBuffers(1, &_entry.m_buffer);
+    f->glBindBuffer(GL_TEXTURE_BUFFER, _entry.m_buffer);
+    f->glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(texels.size() * sizeof(glm::vec4)), texels.data(), GL_STATIC_DRAW);
+    f->glGenTextures(1, &_entry.m_texture);
+    f->glBindTexture(GL_TEXTURE_BUFFER, _entry.m_texture);
+    f->glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, _entry.m_buffer);
+    f->glBindTexture(GL_TEXTURE_BUFFER, 0);
+    f->glBindBuffer(GL_TEXTURE_BUFFER, 0);
+  }
+}
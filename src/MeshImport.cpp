@@ -0,0 +1,94 @@
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
+
+#include "sdf/MeshBaker.hpp"
+#include "MeshImport.hpp"
+#include "MeshReader.hpp"
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  namespace
+  {
+    typedef std::tuple<std::string, uint32_t, qint64> CacheKey;
+
+    ///
+    /// \brief cache Volumes still in use by a node, they're dropped once the last node using them is
+    ///
+    std::map<CacheKey, std::weak_ptr<const sdf::DistanceVolume>> &cache()
+    {
+      static std::map<CacheKey, std::weak_ptr<const sdf::DistanceVolume>> volumes;
+      return volumes;
+    }
+
+    std::mutex &cacheMutex()
+    {
+      static std::mutex mutex;
+      return mutex;
+    }
+  }
+
+  std::shared_ptr<const sdf::DistanceVolume> importMesh(const std::string &_path, uint32_t _resolution, ThreadPool &_pool, std::string &_error,
+                                                       MeshImportStats *_stats)
+  {
+    HSITHO_PROFILE_SCOPE("importMesh");
+    MeshImportStats stats;
+    QFileInfo info(QString::fromStdString(_path));
+    if(!info.isFile())
+    {
+      _error = "Couldn't find " + _path;
+      return nullptr;
+    }
+    CacheKey key(info.canonicalFilePath().toStdString(), _resolution, info.lastModified().toMSecsSinceEpoch());
+
+    // Baking holds the lock, a second node asking for the same file waits for the first one instead of baking it again
+    std::lock_guard<std::mutex> lock(cacheMutex());
+    auto cached = cache().find(key);
+    if(cached != cache().end())
+    {
+      if(auto volume = cached->second.lock())
+      {
+        stats.m_cached = true;
+        if(_stats)
+          *_stats = stats;
+        return volume;
+      }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    sdf::Mesh mesh;
+    std::vector<glm::vec3> normals;
+    if(!readMesh(_path, mesh, normals, _error))
+      return nullptr;
+    stats.m_readMs = timer.nsecsElapsed() / 1e6;
+    timer.restart();
+    sdf::TriangleBvh bvh(mesh);
+    stats.m_triangles = bvh.points() ? 0 : bvh.triangleCount();
+    stats.m_points = bvh.points() ? bvh.triangleCount() : 0;
+    stats.m_bvhMs = timer.nsecsElapsed() / 1e6;
+    mesh = sdf::Mesh();
+
+    timer.restart();
+    sdf::MeshBaker baker(_pool);
+    sdf::MeshBaker::Settings settings;
+    settings.m_resolution = _resolution;
+    auto volume = std::make_shared<sdf::DistanceVolume>();
+    if(!baker.bake(bvh, normals, settings, *volume, _error))
+      return nullptr;
+    stats.m_bakeMs = timer.nsecsElapsed() / 1e6;
+    stats.m_exactEvaluations = baker.exactEvaluations();
+    if(_stats)
+      *_stats = stats;
+
+    for(auto it = cache().begin(); it != cache().end();)
+      it = it->second.expired() ? cache().erase(it) : std::next(it);
+    cache()[key] = volume;
+    return volume;
+  }
+}
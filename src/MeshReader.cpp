@@ -0,0 +1,391 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+
+#include "MeshReader.hpp"
+#include "Numeric.hpp"
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  namespace
+  {
+    bool endsWith(const std::string &_s, const std::string &_suffix)
+    {
+      if(_s.size() < _suffix.size())
+        return false;
+      return std::equal(_suffix.rbegin(), _suffix.rend(), _s.rbegin(), [](char _expected, char _c) { return std::tolower(static_cast<unsigned char>(_c)) == _expected; });
+    }
+
+    bool readFile(const std::string &_path, std::string &_data, std::string &_error)
+    {
+      std::FILE *file = std::fopen(_path.c_str(), "rb");
+      if(!file)
+      {
+        _error = "Couldn't open " + _path;
+        return false;
+      }
+      std::fseek(file, 0, SEEK_END);
+      long size = std::ftell(file);
+      std::fseek(file, 0, SEEK_SET);
+      _data.resize(size > 0 ? static_cast<size_t>(size) : 0);
+      bool ok = size >= 0 && std::fread(&_data[0], 1, _data.size(), file) == _data.size();
+      std::fclose(file);
+      if(!ok)
+        _error = "Couldn't read " + _path;
+      return ok;
+    }
+
+    ///
+    /// \brief Cursor Walks whitespace separated tokens of a line of text without copying them
+    ///
+    struct Cursor
+    {
+      const char *m_p;
+      const char *m_end;
+
+      std::string_view token()
+      {
+        while(m_p < m_end && (*m_p == ' ' || *m_p == '\t' || *m_p == '\r'))
+          ++m_p;
+        const char *start = m_p;
+        while(m_p < m_end && *m_p != ' ' && *m_p != '\t' && *m_p != '\r')
+          ++m_p;
+        return std::string_view(start, m_p - start);
+      }
+    };
+
+    bool readObj(const std::string &_data, sdf::Mesh &_mesh, std::vector<glm::vec3> &_normals, std::string &_error)
+    {
+      const char *p = _data.data();
+      const char *end = p + _data.size();
+      size_t line = 0;
+      std::vector<uint32_t> polygon;
+      while(p < end)
+      {
+        ++line;
+        const char *eol = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        if(!eol)
+          eol = end;
+        Cursor c{p, eol};
+        p = eol + 1;
+
+        std::string_view keyword = c.token();
+        if(keyword == "v" || keyword == "vn")
+        {
+          glm::vec3 v;
+          for(int i = 0; i < 3; ++i)
+          {
+            if(!Numeric::parseFloat(c.token(), v[i]))
+            {
+              _error = "Invalid vertex on line " + std::to_string(line);
+              return false;
+            }
+          }
+          (keyword == "v" ? _mesh.m_positions : _normals).push_back(v);
+        }
+        else if(keyword == "f")
+        {
+          // Only the position index of v/vt/vn matters, negative indices count back from the last vertex
+          polygon.clear();
+          for(std::string_view t = c.token(); !t.empty(); t = c.token())
+          {
+            std::string_view position = t.substr(0, t.find('/'));
+            bool negative = !position.empty() && position[0] == '-';
+            unsigned int index;
+            if(!Numeric::parseUnsigned(negative ? position.substr(1) : position, index) || index == 0 || index > _mesh.m_positions.size())
+            {
+              _error = "Invalid face on line " + std::to_string(line);
+              return false;
+            }
+            polygon.push_back(negative ? static_cast<uint32_t>(_mesh.m_positions.size() - index) : index - 1);
+          }
+          for(size_t i = 2; i < polygon.size(); ++i)
+          {
+            _mesh.m_indices.push_back(polygon[0]);
+            _mesh.m_indices.push_back(polygon[i - 1]);
+            _mesh.m_indices.push_back(polygon[i]);
+          }
+        }
+      }
+      // Normals that don't pair up with the vertices belong to the faces, which the import doesn't need
+      if(_normals.size() != _mesh.m_positions.size())
+        _normals.clear();
+      return true;
+    }
+
+    struct PlyProperty
+    {
+      std::string m_name;
+      std::string m_type;
+      ///
+      /// \brief m_countType Type of the length of a list property, empty for a single value
+      ///
+      std::string m_countType;
+    };
+
+    struct PlyElement
+    {
+      std::string m_name;
+      size_t m_count;
+      std::vector<PlyProperty> m_properties;
+    };
+
+    size_t plySize(const std::string &_type)
+    {
+      if(_type == "char" || _type == "uchar" || _type == "int8" || _type == "uint8")
+        return 1;
+      if(_type == "short" || _type == "ushort" || _type == "int16" || _type == "uint16")
+        return 2;
+      if(_type == "int" || _type == "uint" || _type == "int32" || _type == "uint32" || _type == "float" || _type == "float32")
+        return 4;
+      if(_type == "double" || _type == "float64")
+        return 8;
+      return 0;
+    }
+
+    ///
+    /// \brief PlyReader Reads the values of the body one at a time, converting them from the type in the header
+    ///
+    class PlyReader
+    {
+    public:
+      PlyReader(const char *_p, const char *_end, bool _ascii, bool _swap) : m_p(_p), m_end(_end), m_ascii(_ascii), m_swap(_swap) {}
+
+      bool read(const std::string &_type, double &_value)
+      {
+        if(m_ascii)
+        {
+          while(m_p < m_end && std::isspace(static_cast<unsigned char>(*m_p)))
+            ++m_p;
+          const char *start = m_p;
+          while(m_p < m_end && !std::isspace(static_cast<unsigned char>(*m_p)))
+            ++m_p;
+          float f;
+          if(!Numeric::parseFloat(std::string_view(start, m_p - start), f))
+            return false;
+          _value = f;
+          return true;
+        }
+
+        size_t size = plySize(_type);
+        if(size == 0 || static_cast<size_t>(m_end - m_p) < size)
+          return false;
+        unsigned char bytes[8];
+        std::memcpy(bytes, m_p, size);
+        m_p += size;
+        if(m_swap)
+          std::reverse(bytes, bytes + size);
+        _value = convert(_type, bytes);
+        return true;
+      }
+
+    private:
+      static double convert(const std::string &_type, const unsigned char *_bytes)
+      {
+        auto as = [&](auto _v) { std::memcpy(&_v, _bytes, sizeof(_v)); return static_cast<double>(_v); };
+        if(_type == "char" || _type == "int8") return as(int8_t());
+        if(_type == "uchar" || _type == "uint8") return as(uint8_t());
+        if(_type == "short" || _type == "int16") return as(int16_t());
+        if(_type == "ushort" || _type == "uint16") return as(uint16_t());
+        if(_type == "int" || _type == "int32") return as(int32_t());
+        if(_type == "uint" || _type == "uint32") return as(uint32_t());
+        if(_type == "float" || _type == "float32") return as(float());
+        return as(double());
+      }
+
+      const char *m_p;
+      const char *m_end;
+      bool m_ascii;
+      bool m_swap;
+    };
+
+    bool readPly(const std::string &_data, sdf::Mesh &_mesh, std::vector<glm::vec3> &_normals, std::string &_error)
+    {
+      size_t headerEnd = _data.find("end_header");
+      if(_data.compare(0, 3, "ply") != 0 || headerEnd == std::string::npos)
+      {
+        _error = "Not a PLY file";
+        return false;
+      }
+      size_t bodyStart = _data.find('\n', headerEnd);
+      bodyStart = bodyStart == std::string::npos ? _data.size() : bodyStart + 1;
+
+      std::string format;
+      std::vector<PlyElement> elements;
+      const char *p = _data.data();
+      const char *headerStop = _data.data() + headerEnd;
+      while(p < headerStop)
+      {
+        const char *eol = static_cast<const char *>(std::memchr(p, '\n', headerStop - p));
+        if(!eol)
+          eol = headerStop;
+        Cursor c{p, eol};
+        p = eol + 1;
+        std::string_view keyword = c.token();
+        if(keyword == "format")
+          format = std::string(c.token());
+        else if(keyword == "element")
+        {
+          PlyElement e;
+          e.m_name = std::string(c.token());
+          unsigned int count;
+          if(!Numeric::parseUnsigned(c.token(), count))
+          {
+            _error = "Invalid element " + e.m_name + " in the PLY header";
+            return false;
+          }
+          e.m_count = count;
+          elements.push_back(e);
+        }
+        else if(keyword == "property" && !elements.empty())
+        {
+          PlyProperty property;
+          std::string_view type = c.token();
+          if(type == "list")
+          {
+            property.m_countType = std::string(c.token());
+            type = c.token();
+          }
+          property.m_type = std::string(type);
+          property.m_name = std::string(c.token());
+          if(plySize(property.m_type) == 0 || (!property.m_countType.empty() && plySize(property.m_countType) == 0))
+          {
+            _error = "Unsupported property type " + property.m_type + " in the PLY header";
+            return false;
+          }
+          elements.back().m_properties.push_back(property);
+        }
+      }
+
+      uint32_t one = 1;
+      unsigned char littleEndian;
+      std::memcpy(&littleEndian, &one, 1);
+      bool ascii = format == "ascii";
+      if(!ascii && format != "binary_little_endian" && format != "binary_big_endian")
+      {
+        _error = "Unsupported PLY format " + format;
+        return false;
+      }
+      PlyReader reader(_data.data() + bodyStart, _data.data() + _data.size(), ascii, !ascii && (format == "binary_little_endian") != (littleEndian != 0));
+
+      std::vector<uint32_t> polygon;
+      for(auto &e : elements)
+      {
+        bool vertex = e.m_name == "vertex";
+        bool face = e.m_name == "face";
+        if(vertex)
+        {
+          _mesh.m_positions.reserve(e.m_count);
+          for(auto &property : e.m_properties)
+          {
+            if(property.m_name == "nx")
+              _normals.reserve(e.m_count);
+          }
+        }
+        for(size_t i = 0; i < e.m_count; ++i)
+        {
+          glm::vec3 position(0.f), normal(0.f);
+          bool hasNormal = false;
+          for(auto &property : e.m_properties)
+          {
+            double value;
+            if(property.m_countType.empty())
+            {
+              if(!reader.read(property.m_type, value))
+              {
+                _error = "The PLY file is truncated or malformed";
+                return false;
+              }
+              const char *axes[] = {"x", "y", "z"};
+              const char *normals[] = {"nx", "ny", "nz"};
+              for(int a = 0; a < 3; ++a)
+              {
+                if(property.m_name == axes[a])
+                  position[a] = static_cast<float>(value);
+                if(property.m_name == normals[a])
+                {
+                  normal[a] = static_cast<float>(value);
+                  hasNormal = true;
+                }
+              }
+              continue;
+            }
+
+            double count;
+            if(!reader.read(property.m_countType, count) || count < 0.0)
+            {
+              _error = "The PLY file is truncated or malformed";
+              return false;
+            }
+            bool indices = face && (property.m_name == "vertex_indices" || property.m_name == "vertex_index");
+            polygon.clear();
+            for(size_t k = 0; k < static_cast<size_t>(count); ++k)
+            {
+              if(!reader.read(property.m_type, value))
+              {
+                _error = "The PLY file is truncated or malformed";
+                return false;
+              }
+              polygon.push_back(static_cast<uint32_t>(value));
+            }
+            if(!indices)
+              continue;
+            for(size_t k = 2; k < polygon.size(); ++k)
+            {
+              _mesh.m_indices.push_back(polygon[0]);
+              _mesh.m_indices.push_back(polygon[k - 1]);
+              _mesh.m_indices.push_back(polygon[k]);
+            }
+          }
+          if(vertex)
+          {
+            _mesh.m_positions.push_back(position);
+            if(hasNormal)
+              _normals.push_back(normal);
+          }
+        }
+      }
+
+      for(uint32_t index : _mesh.m_indices)
+      {
+        if(index >= _mesh.m_positions.size())
+        {
+          _error = "A face of the PLY file refers to a missing vertex";
+          return false;
+        }
+      }
+      if(_normals.size() != _mesh.m_positions.size())
+        _normals.clear();
+      return true;
+    }
+  }
+
+  bool readMesh(const std::string &_path, sdf::Mesh &_mesh, std::vector<glm::vec3> &_normals, std::string &_error)
+  {
+    HSITHO_PROFILE_SCOPE("readMesh");
+    _mesh = sdf::Mesh();
+    _normals.clear();
+    bool obj = endsWith(_path, ".obj");
+    if(!obj && !endsWith(_path, ".ply"))
+    {
+      _error = "Unsupported mesh format, use .obj or .ply";
+      return false;
+    }
+    std::string data;
+    if(!readFile(_path, data, _error))
+      return false;
+    bool ok = obj ? readObj(data, _mesh, _normals, _error) : readPly(data, _mesh, _normals, _error);
+    if(ok && _mesh.m_positions.empty())
+    {
+      _error = _path + " has no vertices";
+      return false;
+    }
+    if(!ok)
+      _error = _path + ": " + _error;
+    return ok;
+  }
+}
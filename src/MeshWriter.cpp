@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "MeshWriter.hpp"
+
+namespace hsitho
+{
+  namespace
+  {
+    bool endsWith(const std::string &_s, const std::string &_suffix)
+    {
+      if(_s.size() < _suffix.size())
+        return false;
+      return std::equal(_suffix.rbegin(), _suffix.rend(), _s.rbegin(), [](char _expected, char _c) { return std::tolower(static_cast<unsigned char>(_c)) == _expected; });
+    }
+
+    unsigned char toByte(float _f)
+    {
+      return static_cast<unsigned char>(std::min(std::max(_f, 0.f), 1.f) * 255.f + 0.5f);
+    }
+
+    bool writeObj(std::FILE *_file, const sdf::Mesh &_mesh)
+    {
+      std::fprintf(_file, "# %zu vertices, %zu triangles\n", _mesh.m_positions.size(), _mesh.m_indices.size() / 3);
+      for(size_t i = 0; i < _mesh.m_positions.size(); ++i)
+      {
+        const glm::vec3 &p = _mesh.m_positions[i];
+        const glm::vec3 &c = _mesh.m_colors[i];
+        std::fprintf(_file, "v %.6g %.6g %.6g %.4g %.4g %.4g\n", p.x, p.y, p.z, c.x, c.y, c.z);
+      }
+      for(size_t t = 0; t + 2 < _mesh.m_indices.size(); t += 3)
+        std::fprintf(_file, "f %u %u %u\n", _mesh.m_indices[t] + 1, _mesh.m_indices[t + 1] + 1, _mesh.m_indices[t + 2] + 1);
+      return true;
+    }
+
+    bool writePly(std::FILE *_file, const sdf::Mesh &_mesh)
+    {
+      uint32_t one = 1;
+      unsigned char littleEndian;
+      std::memcpy(&littleEndian, &one, 1);
+      std::fprintf(_file, "ply\nformat %s 1.0\nelement vertex %zu\n", littleEndian ? "binary_little_endian" : "binary_big_endian", _mesh.m_positions.size());
+      std::fprintf(_file, "property float x\nproperty float y\nproperty float z\n");
+      std::fprintf(_file, "property uchar red\nproperty uchar green\nproperty uchar blue\n");
+      std::fprintf(_file, "element face %zu\nproperty list uchar uint vertex_indices\nend_header\n", _mesh.m_indices.size() / 3);
+
+      // Records are packed by hand, the structs would be padded
+      char vertex[15];
+      for(size_t i = 0; i < _mesh.m_positions.size(); ++i)
+      {
+        std::memcpy(vertex, &_mesh.m_positions[i].x, 4);
+        std::memcpy(vertex + 4, &_mesh.m_positions[i].y, 4);
+        std::memcpy(vertex + 8, &_mesh.m_positions[i].z, 4);
+        vertex[12] = static_cast<char>(toByte(_mesh.m_colors[i].x));
+        vertex[13] = static_cast<char>(toByte(_mesh.m_colors[i].y));
+        vertex[14] = static_cast<char>(toByte(_mesh.m_colors[i].z));
+        if(std::fwrite(vertex, sizeof(vertex), 1, _file) != 1)
+          return false;
+      }
+      char face[13];
+      face[0] = 3;
+      for(size_t t = 0; t + 2 < _mesh.m_indices.size(); t += 3)
+      {
+        std::memcpy(face + 1, &_mesh.m_indices[t], 12);
+        if(std::fwrite(face, sizeof(face), 1, _file) != 1)
+          return false;
+      }
+      return true;
+    }
+  }
+
+  bool writeMesh(const std::string &_path, const sdf::Mesh &_mesh, std::string &_error)
+  {
+    bool obj = endsWith(_path, ".obj");
+    if(!obj && !endsWith(_path, ".ply"))
+    {
+      _error = "Meshes can only be written as .obj or .ply";
+      return false;
+    }
+
+    std::FILE *file = std::fopen(_path.c_str(), "wb");
+    if(!file)
+    {
+      _error = "Couldn't create " + _path;
+      return false;
+    }
+    std::vector<char> buffer(1 << 20);
+    std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+    bool written = obj ? writeObj(file, _mesh) : writePly(file, _mesh);
+    written = !std::ferror(file) && written;
+    written = std::fclose(file) == 0 && written;
+    if(!written)
+      _error = "Couldn't write " + _path;
+    return written;
+  }
+}
@@ -0,0 +1,73 @@
+#include "nodeEditor/DataModelRegistry.hpp"
+
+#include "nodes/DistanceFieldOutputDataModel.hpp"
+#include "nodes/CollapsedNodeDataModel.hpp"
+#include "nodes/OperationDataModels.hpp"
+#include "nodes/CopyNumDataModel.hpp"
+#include "nodes/TimeDataModel.hpp"
+#include "nodes/TranslateDataModel.hpp"
+#include "nodes/RotateDataModel.hpp"
+#include "nodes/ScaleDataModel.hpp"
+#include "nodes/ColorPickerDataModel.hpp"
+#include "nodes/CubePrimitiveDataModel.hpp"
+#include "nodes/SpherePrimitiveDataModel.hpp"
+#include "nodes/TorusPrimitiveDataModel.hpp"
+#include "nodes/CylinderPrimitiveDataModel.hpp"
+#include "nodes/CapsulePrimitiveDataModel.hpp"
+#include "nodes/PlanePrimitiveDataModel.hpp"
+#include "nodes/TriangularPrismPrimitiveDataModel.hpp"
+#include "nodes/HexagonalPrismPrimitiveDataModel.hpp"
+#include "nodes/ConePrimitiveDataModel.hpp"
+#include "nodes/MeshImportDataModel.hpp"
+#include "nodes/CopyDataModel.hpp"
+#include "nodes/ScatterDataModel.hpp"
+#include "nodes/LightDataModel.hpp"
+
+#include "nodes/MathsDataModels.hpp"
+
+#include "NodeModels.hpp"
+
+namespace hsitho
+{
+  void registerNodeModels()
+  {
+    DataModelRegistry::registerModel<CubePrimitiveDataModel>("Primitives");
+    DataModelRegistry::registerModel<TorusPrimitiveDataModel>("Primitives");
+    DataModelRegistry::registerModel<SpherePrimitiveDataModel>("Primitives");
+    DataModelRegistry::registerModel<CylinderPrimitiveDataModel>("Primitives");
+    DataModelRegistry::registerModel<CapsulePrimitiveDataModel>("Primitives");
+    DataModelRegistry::registerModel<PlanePrimitiveDataModel>("Primitives");
+    DataModelRegistry::registerModel<ConePrimitiveDataModel>("Primitives");
+    DataModelRegistry::registerModel<TriangularPrismPrimitiveDataModel>("Primitives");
+    DataModelRegistry::registerModel<HexagonalPrismPrimitiveDataModel>("Primitives");
+    DataModelRegistry::registerModel<MeshImportDataModel>("Primitives");
+
+    DataModelRegistry::registerModel<UnionDataModel>("Operations");
+    DataModelRegistry::registerModel<SubtractionOpDataModel>("Operations");
+    DataModelRegistry::registerModel<IntersectionDataModel>("Operations");
+    DataModelRegistry::registerModel<BlendDataModel>("Operations");
+
+    DataModelRegistry::registerModel<TranslateDataModel>("Transforms");
+    DataModelRegistry::registerModel<ScaleDataModel>("Transforms");
+    DataModelRegistry::registerModel<RotateDataModel>("Transforms");
+
+    DataModelRegistry::registerModel<VectorDataModel>("Maths");
+    DataModelRegistry::registerModel<ScalarDataModel>("Maths");
+    DataModelRegistry::registerModel<SineDataModel>("Maths");
+    DataModelRegistry::registerModel<CosineDataModel>("Maths");
+    DataModelRegistry::registerModel<MultiplyDataModel>("Maths");
+    DataModelRegistry::registerModel<DivideDataModel>("Maths");
+    DataModelRegistry::registerModel<AdditionDataModel>("Maths");
+    DataModelRegistry::registerModel<SubtractionDataModel>("Maths");
+
+    DataModelRegistry::registerModel<TimeDataModel>("Misc");
+    DataModelRegistry::registerModel<LightDataModel>("Misc");
+    DataModelRegistry::registerModel<ColorPickerDataModel>("Color");
+    DataModelRegistry::registerModel<OutputDataModel>("Generic");
+    DataModelRegistry::registerModel<InputDataModel>("Generic");
+    DataModelRegistry::registerModel<CopyDataModel>("Generic");
+    DataModelRegistry::registerModel<CopyNumDataModel>("Generic");
+    DataModelRegistry::registerModel<ScatterDataModel>("Generic");
+    DataModelRegistry::registerModel<CollapsedNodeDataModel>("Generic");
+  }
+}
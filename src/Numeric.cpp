@@ -0,0 +1,80 @@
+#include <charconv>
+
+#include "Numeric.hpp"
+
+namespace hsitho
+{
+  namespace Numeric
+  {
+    namespace
+    {
+      // Enough for the integer digits of FLT_MAX, the sign, the point and the decimals the expressions use
+      const size_t c_bufferSize = 64;
+
+      bool stripPlus(std::string_view &_text)
+      {
+        // from_chars has no explicit plus sign, the expressions have plenty of them
+        if(!_text.empty() && _text.front() == '+')
+        {
+          _text.remove_prefix(1);
+          if(!_text.empty() && (_text.front() == '+' || _text.front() == '-'))
+            return false;
+        }
+        return !_text.empty();
+      }
+    }
+
+    bool parseFloat(std::string_view _text, float &_value)
+    {
+      if(!stripPlus(_text))
+        return false;
+      const char *end = _text.data() + _text.size();
+      float value;
+      std::from_chars_result result = std::from_chars(_text.data(), end, value);
+      if(result.ec != std::errc() || result.ptr != end)
+        return false;
+      _value = value;
+      return true;
+    }
+
+    bool parseUnsigned(std::string_view _text, unsigned int &_value)
+    {
+      if(!stripPlus(_text))
+        return false;
+      const char *end = _text.data() + _text.size();
+      unsigned int value;
+      std::from_chars_result result = std::from_chars(_text.data(), end, value);
+      if(result.ec != std::errc() || result.ptr != end)
+        return false;
+      _value = value;
+      return true;
+    }
+
+    bool isNumber(std::string_view _text)
+    {
+      float value;
+      return parseFloat(_text, value);
+    }
+
+    std::string toFixed(float _value, int _precision)
+    {
+      char buffer[c_bufferSize];
+      std::to_chars_result result = std::to_chars(buffer, buffer + c_bufferSize, _value, std::chars_format::fixed, _precision);
+      return std::string(buffer, result.ptr);
+    }
+
+    std::string toString(float _value)
+    {
+      char buffer[c_bufferSize];
+      std::to_chars_result result = std::to_chars(buffer, buffer + c_bufferSize, _value);
+      return std::string(buffer, result.ptr);
+    }
+
+    std::string toString(int _value)
+    {
+      char buffer[c_bufferSize];
+      std::to_chars_result result = std::to_chars(buffer, buffer + c_bufferSize, _value);
+      return std::string(buffer, result.ptr);
+    }
+  }
+}
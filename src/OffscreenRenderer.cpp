@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <cstring>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include "OffscreenRenderer.hpp"
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  OffscreenRenderer::OffscreenRenderer(const std::string &_shaderDir) :
+    m_shaderDir(_shaderDir),
+    m_surface(nullptr),
+    m_context(nullptr),
+    m_program(nullptr),
+    m_vao(nullptr),
+    m_fbo(nullptr),
+    m_eye(glm::vec3(0.f, 0.132164f, 0.991228f) * 15.f),
+    m_up(0.f, 1.f, 0.f),
+    m_time(0.f),
+    m_maxSize(0)
+  {
+  }
+
+  OffscreenRenderer::~OffscreenRenderer()
+  {
+    if(m_context != nullptr && m_context->makeCurrent(m_surface))
+    {
+      setReadbackSlots(0);
+      m_volumes.clear();
+      m_instances.clear();
+      delete m_fbo;
+      delete m_program;
+      delete m_vao;
+      m_vbo.destroy();
+      m_context->doneCurrent();
+    }
+    delete m_context;
+    delete m_surface;
+  }
+
+  bool OffscreenRenderer::initialise(std::string &_error)
+  {
+    QSurfaceFormat format;
+    format.setVersion(4, 1);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+
+    m_surface = new QOffscreenSurface();
+    m_surface->setFormat(format);
+    m_surface->create();
+
+    m_context = new QOpenGLContext();
+    m_context->setFormat(format);
+    if(!m_context->create() || !m_context->makeCurrent(m_surface))
+    {
+      _error = "Couldn't create an OpenGL 4.1 core context";
+      return false;
+    }
+    if(m_context->format().version() < qMakePair(4, 1))
+    {
+      _error = "OpenGL 4.1 is required, got " + std::to_string(m_context->format().majorVersion()) + "." + std::to_string(m_context->format().minorVersion());
+      return false;
+    }
+    initializeOpenGLFunctions();
+
+    GLint maxTexture = 0, maxRenderbuffer = 0, maxViewport[2] = {0, 0};
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTexture);
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxRenderbuffer);
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxViewport);
+    m_maxSize = std::min(std::min(maxTexture, maxRenderbuffer), std::min(maxViewport[0], maxViewport[1]));
+
+    // Same screen quad as in the scene view so the images match
+    float vertices[] = {
+      -1.0f,  1.0f,
+      -1.0f, -1.0f,
+       1.0f,  1.0f,
+      -1.0f, -1.0f,
+       1.0f, -1.0f,
+       1.0f,  1.0f
+    };
+    float uvs[] = {
+      1.0f, 1.0f,
+      1.0f, 0.0f,
+      0.0f, 1.0f,
+      1.0f, 0.0f,
+      0.0f, 0.0f,
+      0.0f, 1.0f
+    };
+
+    m_vao = new QOpenGLVertexArrayObject();
+    m_vao->create();
+    m_vao->bind();
+    m_vbo.create();
+    m_vbo.bind();
+    m_vbo.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_vbo.allocate(nullptr, sizeof(vertices) + sizeof(uvs));
+    m_vbo.write(0, vertices, sizeof(vertices));
+    m_vbo.write(sizeof(vertices), uvs, sizeof(uvs));
+    m_vao->release();
+
+    return true;
+  }
+
+  bool OffscreenRenderer::setFragmentShader(const std::string &_source, std::string &_log)
+  {
+    HSITHO_PROFILE_SCOPE("OffscreenRenderer::setFragmentShader");
+    QOpenGLShaderProgram *program = new QOpenGLShaderProgram();
+    bool success = program->addShaderFromSourceFile(QOpenGLShader::Vertex, QString::fromStdString(m_shaderDir + "/screenQuad.vert")) &&
+                   program->addShaderFromSourceCode(QOpenGLShader::Fragment, QString::fromStdString(_source)) &&
+                   program->link();
+    _log = program->log().toStdString();
+    if(!success)
+    {
+      delete program;
+      return false;
+    }
+
+    delete m_program;
+    m_program = program;
+    return true;
+  }
+
+  bool OffscreenRenderer::bindFramebuffer(int _w, int _h)
+  {
+    if(_w <= 0 || _h <= 0 || _w > m_maxSize || _h > m_maxSize)
+      return false;
+
+    if(m_fbo == nullptr || m_fbo->width() < _w || m_fbo->height() < _h)
+    {
+      delete m_fbo;
+      QOpenGLFramebufferObjectFormat format;
+      format.setInternalTextureFormat(GL_RGBA32F);
+      m_fbo = new QOpenGLFramebufferObject(_w, _h, format);
+    }
+    return m_fbo->bind();
+  }
+
+  void OffscreenRenderer::draw(int _w, int _h, const glm::vec2 &_resolution, const glm::vec4 &_tile)
+  {
+    HSITHO_PROFILE_SCOPE("OffscreenRenderer::draw");
+    glViewport(0, 0, _w, _h);
+
+    m_vao->bind();
+    m_vbo.bind();
+    m_program->bind();
+
+    m_program->enableAttributeArray("a_Position");
+    m_program->enableAttributeArray("a_FragCoord");
+    m_program->setAttributeBuffer(m_program->attributeLocation("a_Position"), GL_FLOAT, 0, 2, 0);
+    m_program->setAttributeBuffer(m_program->attributeLocation("a_FragCoord"), GL_FLOAT, 6*2*sizeof(float), 2, 0);
+
+    m_program->setUniformValue("u_GlobalTime", m_time);
+    m_program->setUniformValueArray("u_Resolution", glm::value_ptr(_resolution), 1, 2);
+    m_program->setUniformValueArray("u_Tile", glm::value_ptr(_tile), 1, 4);
+    m_program->setUniformValueArray("u_Camera", glm::value_ptr(m_eye), 1, 3);
+    m_program->setUniformValueArray("u_CameraUp", glm::value_ptr(m_up), 1, 3);
+    m_program->setUniformValue("u_DebugMode", 0);
+    m_volumes.bind(*m_program);
+    m_instances.bind(*m_program);
+
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    m_program->disableAttributeArray("a_Position");
+    m_program->disableAttributeArray("a_FragCoord");
+    m_program->release();
+    m_vbo.release();
+    m_vao->release();
+  }
+
+  bool OffscreenRenderer::render(int _w, int _h, std::vector<float> &_rgba)
+  {
+    if(m_program == nullptr || !bindFramebuffer(_w, _h))
+      return false;
+
+    draw(_w, _h, glm::vec2(_w, _h));
+    readFramebuffer(_w, _h, _rgba);
+    m_fbo->release();
+    return true;
+  }
+
+  bool OffscreenRenderer::renderFrame(int _w, int _h, GpuTimer *_timer)
+  {
+    if(m_program == nullptr || !bindFramebuffer(_w, _h))
+      return false;
+
+    if(_timer != nullptr)
+      _timer->begin();
+    draw(_w, _h, glm::vec2(_w, _h));
+    if(_timer != nullptr)
+      _timer->end();
+    glFinish();
+    m_fbo->release();
+    return true;
+  }
+
+  bool OffscreenRenderer::renderTile(int _x, int _y, int _w, int _h, int _imageW, int _imageH, int _supersample, std::vector<float> &_rgba)
+  {
+    int ss = std::max(_supersample, 1);
+    if(m_program == nullptr || !bindFramebuffer(_w * ss, _h * ss))
+      return false;
+
+    // The screen quad runs its x coordinate from right to left and y from bottom to top,
+    // map the tile's corner and size into the coordinates of the whole image accordingly
+    glm::vec4 tile(1.f - static_cast<float>(_x + _w) / _imageW,
+                   static_cast<float>(_imageH - _y - _h) / _imageH,
+                   static_cast<float>(_w) / _imageW,
+                   static_cast<float>(_h) / _imageH);
+    draw(_w * ss, _h * ss, glm::vec2(_imageW, _imageH), tile);
+
+    if(ss == 1)
+    {
+      readFramebuffer(_w, _h, _rgba);
+      m_fbo->release();
+      return true;
+    }
+
+    std::vector<float> samples;
+    readFramebuffer(_w * ss, _h * ss, samples);
+    m_fbo->release();
+
+    _rgba.assign(static_cast<size_t>(_w) * _h * 4, 0.f);
+    float weight = 1.f / (ss * ss);
+    size_t sampleRow = static_cast<size_t>(_w) * ss * 4;
+    for(int y = 0; y < _h; ++y)
+      for(int sy = 0; sy < ss; ++sy)
+      {
+        const float *src = &samples[(static_cast<size_t>(y) * ss + sy) * sampleRow];
+        float *dst = &_rgba[static_cast<size_t>(y) * _w * 4];
+        for(int x = 0; x < _w; ++x)
+          for(int sx = 0; sx < ss; ++sx)
+            for(int c = 0; c < 4; ++c)
+              dst[x * 4 + c] += src[(x * ss + sx) * 4 + c] * weight;
+      }
+    return true;
+  }
+
+  void OffscreenRenderer::readFramebuffer(int _w, int _h, std::vector<float> &_rgba)
+  {
+    HSITHO_PROFILE_SCOPE("OffscreenRenderer::readFramebuffer");
+    _rgba.resize(static_cast<size_t>(_w) * _h * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, _w, _h, GL_RGBA, GL_FLOAT, _rgba.data());
+
+    // GL rows start from the bottom
+    size_t row = static_cast<size_t>(_w) * 4;
+    for(int y = 0; y < _h / 2; ++y)
+      std::swap_ranges(_rgba.begin() + y * row, _rgba.begin() + (y + 1) * row, _rgba.begin() + (_h - 1 - y) * row);
+  }
+
+  void OffscreenRenderer::setReadbackSlots(unsigned int _slots)
+  {
+    for(size_t i = 0; i < m_pbos.size(); ++i)
+    {
+      if(m_fences[i] != nullptr)
+        glDeleteSync(m_fences[i]);
+      m_pbos[i]->destroy();
+      delete m_pbos[i];
+    }
+    m_pbos.clear();
+
+    for(unsigned int i = 0; i < _slots; ++i)
+    {
+      QOpenGLBuffer *pbo = new QOpenGLBuffer(QOpenGLBuffer::PixelPackBuffer);
+      pbo->create();
+      pbo->setUsagePattern(QOpenGLBuffer::StreamRead);
+      m_pbos.push_back(pbo);
+    }
+    m_fences.assign(_slots, nullptr);
+    m_queuedSizes.assign(_slots, 0);
+  }
+
+  bool OffscreenRenderer::queueFrame(unsigned int _slot, int _w, int _h, bool _float)
+  {
+    if(m_program == nullptr || _slot >= m_pbos.size() || m_fences[_slot] != nullptr || !bindFramebuffer(_w, _h))
+      return false;
+
+    draw(_w, _h, glm::vec2(_w, _h));
+
+    size_t size = static_cast<size_t>(_w) * _h * 4 * (_float ? sizeof(float) : 1);
+    QOpenGLBuffer *pbo = m_pbos[_slot];
+    pbo->bind();
+    if(static_cast<size_t>(pbo->size()) < size)
+      pbo->allocate(static_cast<int>(size));
+
+    // With a pack buffer bound the read only gets queued, the copy happens on the GPU while the next frame renders
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, _w, _h, GL_RGBA, _float ? GL_FLOAT : GL_UNSIGNED_BYTE, nullptr);
+    pbo->release();
+    m_fbo->release();
+
+    m_fences[_slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_queuedSizes[_slot] = size;
+    glFlush();
+    return true;
+  }
+
+  bool OffscreenRenderer::collectFrame(unsigned int _slot, std::vector<unsigned char> &_data)
+  {
+    if(_slot >= m_pbos.size() || m_fences[_slot] == nullptr)
+      return false;
+
+    while(glClientWaitSync(m_fences[_slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {}
+    glDeleteSync(m_fences[_slot]);
+    m_fences[_slot] = nullptr;
+
+    size_t size = m_queuedSizes[_slot];
+    m_pbos[_slot]->bind();
+    void *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT);
+    bool success = mapped != nullptr;
+    if(success)
+    {
+      _data.resize(size);
+      std::memcpy(_data.data(), mapped, size);
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    m_pbos[_slot]->release();
+    return success;
+  }
+}
@@ -0,0 +1,116 @@
+#include <fstream>
+#include <locale>
+
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  namespace
+  {
+    thread_local void *t_buffer = nullptr;
+
+    void writeString(std::ostream &_out, const std::string &_s)
+    {
+      _out << '"';
+      for(char c : _s)
+      {
+        if(c == '"' || c == '\\')
+          _out << '\\';
+        _out << c;
+      }
+      _out << '"';
+    }
+  }
+
+  Profiler &Profiler::instance()
+  {
+    static Profiler profiler;
+    return profiler;
+  }
+
+  Profiler::Profiler() :
+    m_epoch(std::chrono::steady_clock::now()),
+    m_enabled(false)
+  {
+  }
+
+  Profiler::ThreadBuffer &Profiler::buffer()
+  {
+    if(t_buffer == nullptr)
+    {
+      std::lock_guard<std::mutex> lock(m_buffersMutex);
+      m_buffers.emplace_back(new ThreadBuffer());
+      m_buffers.back()->m_id = static_cast<unsigned int>(m_buffers.size());
+      m_buffers.back()->m_name = m_buffers.size() == 1 ? "main" : "thread " + std::to_string(m_buffers.size());
+      t_buffer = m_buffers.back().get();
+    }
+    return *static_cast<ThreadBuffer *>(t_buffer);
+  }
+
+  void Profiler::zone(const char *_name, int64_t _start, int64_t _end)
+  {
+    ThreadBuffer &b = buffer();
+    std::lock_guard<std::mutex> lock(b.m_mutex);
+    b.m_events.push_back(Event{_name, _start, _end - _start, 0.0});
+  }
+
+  void Profiler::counter(const char *_name, double _value)
+  {
+    ThreadBuffer &b = buffer();
+    std::lock_guard<std::mutex> lock(b.m_mutex);
+    b.m_events.push_back(Event{_name, now(), -1, _value});
+  }
+
+  void Profiler::setThreadName(const std::string &_name)
+  {
+    ThreadBuffer &b = buffer();
+    std::lock_guard<std::mutex> lock(b.m_mutex);
+    b.m_name = _name;
+  }
+
+  bool Profiler::writeChromeTrace(const std::string &_path) const
+  {
+    std::ofstream file(_path);
+    if(!file.is_open())
+      return false;
+    file.imbue(std::locale::classic());
+    file.precision(3);
+    file << std::fixed;
+
+    // Trace timestamps are in microseconds
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    bool first = true;
+    std::lock_guard<std::mutex> buffersLock(m_buffersMutex);
+    for(auto &b : m_buffers)
+    {
+      std::lock_guard<std::mutex> lock(b->m_mutex);
+      file << (first ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << b->m_id << ", \"args\": {\"name\": ";
+      writeString(file, b->m_name);
+      file << "}}";
+      first = false;
+
+      for(auto &e : b->m_events)
+      {
+        file << ",\n{\"name\": ";
+        writeString(file, e.m_name);
+        if(e.m_duration >= 0)
+          file << ", \"cat\": \"hsitho\", \"ph\": \"X\", \"ts\": " << e.m_start / 1000.0 << ", \"dur\": " << e.m_duration / 1000.0;
+        else
+          file << ", \"ph\": \"C\", \"ts\": " << e.m_start / 1000.0 << ", \"args\": {\"value\": " << e.m_value << "}";
+        file << ", \"pid\": 1, \"tid\": " << b->m_id << "}";
+      }
+    }
+    file << "\n]}\n";
+    return file.good();
+  }
+
+  void Profiler::clear()
+  {
+    std::lock_guard<std::mutex> buffersLock(m_buffersMutex);
+    for(auto &b : m_buffers)
+    {
+      std::lock_guard<std::mutex> lock(b->m_mutex);
+      b->m_events.clear();
+    }
+  }
+}
@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <locale>
+#include <sstream>
+
+#include "RenderStats.hpp"
+
+namespace hsitho
+{
+  void RenderStats::addSample(const std::string &_pass, float _ms)
+  {
+    push(m_samples, _pass, _ms);
+  }
+
+  void RenderStats::addMetric(const std::string &_name, float _value)
+  {
+    push(m_metrics, _name, _value);
+  }
+
+  void RenderStats::push(Series &_series, const std::string &_name, float _value)
+  {
+    std::deque<float> &values = _series[_name];
+    values.push_back(_value);
+    while(values.size() > m_window)
+      values.pop_front();
+  }
+
+  RenderStats::Summary RenderStats::summarise(const Series &_series, const std::string &_name)
+  {
+    Summary s;
+    auto it = _series.find(_name);
+    if(it == _series.end() || it->second.empty())
+      return s;
+
+    std::vector<float> sorted(it->second.begin(), it->second.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    float sum = 0.f;
+    for(auto v : sorted)
+      sum += v;
+
+    // Nearest-rank percentile
+    size_t rank = static_cast<size_t>(std::ceil(0.95 * sorted.size()));
+
+    s.m_last = it->second.back();
+    s.m_min = sorted.front();
+    s.m_avg = sum / sorted.size();
+    s.m_p95 = sorted[std::max<size_t>(rank, 1) - 1];
+    s.m_count = sorted.size();
+    return s;
+  }
+
+  std::vector<std::string> RenderStats::passes() const
+  {
+    std::vector<std::string> names;
+    for(auto &pass : m_samples)
+      names.push_back(pass.first);
+    return names;
+  }
+
+  std::vector<std::string> RenderStats::overlayText() const
+  {
+    std::vector<std::string> lines;
+    std::ostringstream ss;
+    ss.imbue(std::locale::classic());
+    ss << std::fixed << std::setprecision(2);
+
+    for(auto &pass : m_samples)
+    {
+      Summary s = summary(pass.first);
+      ss.str("");
+      ss << pass.first << ": " << s.m_last << " ms  (min " << s.m_min << "  avg " << s.m_avg << "  p95 " << s.m_p95 << ")";
+      lines.push_back(ss.str());
+    }
+
+    for(auto &metric : m_metrics)
+    {
+      Summary s = metricSummary(metric.first);
+      ss.str("");
+      ss << metric.first << ": " << s.m_last << "  (avg " << s.m_avg << "  p95 " << s.m_p95 << ")";
+      lines.push_back(ss.str());
+    }
+
+    if(!m_compiles.empty())
+    {
+      const CompileRecord &c = m_compiles.back();
+      ss.str("");
+      ss << "compile: " << c.m_generateMs << " ms codegen  " << c.m_compileMs << " ms GL" << (c.m_success ? "" : "  (failed)");
+      lines.push_back(ss.str());
+      ss.str("");
+      ss << "shader: " << c.m_sourceSize << " bytes";
+      lines.push_back(ss.str());
+    }
+    return lines;
+  }
+
+  void RenderStats::writeCsvSeries(std::ostream &_out, const Series &_series, const std::string &_kind) const
+  {
+    for(auto &entry : _series)
+    {
+      Summary s = summarise(_series, entry.first);
+      _out << _kind << "_summary," << entry.first << ",min," << s.m_min << "\n";
+      _out << _kind << "_summary," << entry.first << ",avg," << s.m_avg << "\n";
+      _out << _kind << "_summary," << entry.first << ",p95," << s.m_p95 << "\n";
+      size_t i = 0;
+      for(auto v : entry.second)
+        _out << _kind << "," << entry.first << "," << i++ << "," << v << "\n";
+    }
+  }
+
+  bool RenderStats::writeCsv(const std::string &_path) const
+  {
+    std::ofstream file(_path);
+    if(!file.is_open())
+      return false;
+    // The application sets a global locale, keep the numbers machine readable
+    file.imbue(std::locale::classic());
+
+    file << "kind,name,index,value\n";
+    writeCsvSeries(file, m_samples, "pass");
+    writeCsvSeries(file, m_metrics, "metric");
+    for(size_t i = 0; i < m_compiles.size(); ++i)
+    {
+      file << "compile,generate_ms," << i << "," << m_compiles[i].m_generateMs << "\n";
+      file << "compile,compile_ms," << i << "," << m_compiles[i].m_compileMs << "\n";
+      file << "compile,source_bytes," << i << "," << m_compiles[i].m_sourceSize << "\n";
+      file << "compile,success," << i << "," << m_compiles[i].m_success << "\n";
+    }
+    return file.good();
+  }
+
+  void RenderStats::writeJsonSeries(std::ostream &_out, const Series &_series) const
+  {
+    _out << "{";
+    bool first = true;
+    for(auto &entry : _series)
+    {
+      Summary s = summarise(_series, entry.first);
+      _out << (first ? "\n" : ",\n");
+      _out << "    \"" << entry.first << "\": { \"min\": " << s.m_min << ", \"avg\": " << s.m_avg << ", \"p95\": " << s.m_p95 << ", \"samples\": [";
+      for(size_t i = 0; i < entry.second.size(); ++i)
+        _out << (i ? ", " : "") << entry.second[i];
+      _out << "] }";
+      first = false;
+    }
+    _out << "\n  }";
+  }
+
+  bool RenderStats::writeJson(const std::string &_path) const
+  {
+    std::ofstream file(_path);
+    if(!file.is_open())
+      return false;
+    file.imbue(std::locale::classic());
+
+    file << "{\n  \"passes\": ";
+    writeJsonSeries(file, m_samples);
+    file << ",\n  \"metrics\": ";
+    writeJsonSeries(file, m_metrics);
+    file << ",\n  \"compiles\": [";
+    for(size_t i = 0; i < m_compiles.size(); ++i)
+    {
+      const CompileRecord &c = m_compiles[i];
+      file << (i ? ",\n" : "\n");
+      file << "    { \"generate_ms\": " << c.m_generateMs << ", \"compile_ms\": " << c.m_compileMs
+           << ", \"source_bytes\": " << c.m_sourceSize << ", \"success\": " << (c.m_success ? "true" : "false") << " }";
+    }
+    file << "\n  ]\n}\n";
+    return file.good();
+  }
+}
@@ -0,0 +1,86 @@
+#include <cmath>
+
+#include <QElapsedTimer>
+
+#include <glm/gtc/constants.hpp>
+
+#include "sdf/Scatter.hpp"
+#include "sdf/SceneCompiler.hpp"
+#include "InstanceSources.hpp"
+#include "Profiler.hpp"
+#include "ScatterInstances.hpp"
+
+namespace hsitho
+{
+  namespace
+  {
+    ///
+    /// \brief twist Angle of a copy about its normal, hashed from the seed and its index so the copies keep their
+    ///        angles when the scene is generated again
+    ///
+    float twist(uint32_t _seed, size_t _index)
+    {
+      return glm::two_pi<float>() * randomUnit(_seed, _index);
+    }
+
+    ///
+    /// \brief standOn Transform of a copy standing on a point, y along the normal
+    ///
+    glm::mat4 standOn(const sdf::Scatter::Point &_point, float _angle)
+    {
+      glm::vec3 y = _point.m_normal;
+      glm::vec3 helper = std::fabs(y.y) < 0.9f ? glm::vec3(0.f, 1.f, 0.f) : glm::vec3(1.f, 0.f, 0.f);
+      glm::vec3 x = glm::normalize(glm::cross(helper, y));
+      glm::vec3 z = glm::cross(x, y);
+      float c = std::cos(_angle), s = std::sin(_angle);
+      glm::mat4 t(1.f);
+      t[0] = glm::vec4(c * x - s * z, 0.f);
+      t[1] = glm::vec4(y, 0.f);
+      t[2] = glm::vec4(s * x + c * z, 0.f);
+      t[3] = glm::vec4(_point.m_position, 1.f);
+      return t;
+    }
+  }
+
+  std::shared_ptr<const sdf::InstanceSet> scatterInstances(const std::string &_surface, const std::string &_instance,
+                                                           const std::vector<std::shared_ptr<const sdf::DistanceVolume>> &_volumes,
+                                                           const std::vector<std::shared_ptr<const sdf::InstanceSet>> &_sets,
+                                                           const ScatterSettings &_settings, ThreadPool &_pool, std::string &_error,
+                                                           ScatterStats *_stats)
+  {
+    HSITHO_PROFILE_SCOPE("scatterInstances");
+    ScatterStats stats;
+    QElapsedTimer timer;
+    timer.start();
+    auto map = [](const std::string &_code) { return "vec4 map(vec3 _position)\n{\n  return " + _code + ";\n}\n"; };
+    std::shared_ptr<const sdf::Program> surface = sdf::SceneCompiler::compileMap(map(_surface), _error, false, _volumes, _sets);
+    if(!surface)
+    {
+      _error = "Couldn't compile the surface: " + _error;
+      return nullptr;
+    }
+    stats.m_compileMs = timer.nsecsElapsed() / 1e6;
+
+    timer.restart();
+    sdf::Scatter scatter(surface, _pool);
+    sdf::Scatter::Settings settings;
+    settings.m_min = glm::vec3(-_settings.m_extent);
+    settings.m_max = glm::vec3(_settings.m_extent);
+    settings.m_spacing = _settings.m_spacing;
+    settings.m_seed = _settings.m_seed;
+    std::vector<sdf::Scatter::Point> points;
+    if(!scatter.scatter(settings, points, _error))
+      return nullptr;
+    stats.m_scatterMs = timer.nsecsElapsed() / 1e6;
+    stats.m_points = points.size();
+    stats.m_surfaceCells = scatter.surfaceCells();
+    if(_stats)
+      *_stats = stats;
+
+    std::vector<glm::mat4> transforms;
+    transforms.reserve(points.size());
+    for(size_t i = 0; i < points.size(); ++i)
+      transforms.push_back(standOn(points[i], twist(_settings.m_seed, i)));
+    return makeInstances(_instance, _volumes, _sets, transforms, _settings.m_radius, _error);
+  }
+}
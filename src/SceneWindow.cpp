@@ -1,13 +1,21 @@
 #include <iostream>
 #include <string>
 #include <memory>
+#include <algorithm>
+#include <cstdlib>
+
+#include <QElapsedTimer>
+#include <QPainter>
 
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "nodeEditor/Node.hpp"
 #include "nodeEditor/NodeDataModel.hpp"
-#include "nodes/CollapsedNodeDataModel.hpp"
+#include "sdf/SceneCompiler.hpp"
+#include "AllocationTracker.hpp"
+#include "CompileArena.hpp"
+#include "Profiler.hpp"
 #include "SceneWindow.hpp"
 
 namespace hsitho
@@ -15,21 +23,31 @@ namespace hsitho
   SceneWindow::SceneWindow(QWidget *_parent) :
     GLWindow(_parent),
     m_shaderMan(ShaderManager::instance()),
-		m_outputNode(nullptr),
+    m_generator(m_pool),
+    m_pickGenerator(m_pool),
 		m_cam(glm::vec4(0.f, 0.132164f, 0.991228f, 0.f)),
 		m_camU(glm::vec3(0.f, 1.f, 0.f)),
     m_camL(glm::vec3(1.f, 0.f, 0.f)),
-		m_camDist(15.f)
+		m_camDist(15.f),
+		m_pressX(0),
+		m_pressY(0),
+		m_showStats(false),
+		m_debugMode(0),
+		m_statsFbo(nullptr)
   {
-    std::ifstream s("shaders/shader.begin");
-    std::ifstream e("shaders/shader.end");
-    m_shaderStart = std::string((std::istreambuf_iterator<char>(s)), std::istreambuf_iterator<char>());
-    m_shaderEnd = std::string((std::istreambuf_iterator<char>(e)), std::istreambuf_iterator<char>());
   }
 
   SceneWindow::~SceneWindow()
   {
+    makeCurrent();
+    m_volumeTextures.clear();
+    m_instanceTextures.clear();
+    // Everything holding GL objects goes while the context is still current
+    m_sceneTimer.destroy();
+    m_statsTimer.destroy();
+    delete m_statsFbo;
     delete m_vao;
+    doneCurrent();
   }
 
   void SceneWindow::initializeGL()
@@ -70,6 +88,10 @@ namespace hsitho
     m_vbo.allocate(nullptr, sizeof(vertices)*sizeof(uvs));
     m_vbo.write(0, vertices, sizeof(vertices));
     m_vbo.write(sizeof(vertices), uvs, sizeof(uvs));
+
+    m_statsTimer.init();
+    if(!m_sceneTimer.init())
+      std::cout << "Timer queries not supported, GPU timings are disabled\n";
   }
 
 	void SceneWindow::mousePressEvent(QMouseEvent *_event)
@@ -78,7 +100,46 @@ namespace hsitho
 		{
 			m_origX = _event->x();
 			m_origY = _event->y();
+			m_pressX = _event->x();
+			m_pressY = _event->y();
+		}
+	}
+
+	void SceneWindow::mouseReleaseEvent(QMouseEvent *_event)
+	{
+		// Moving a few pixels while clicking shouldn't count as orbiting
+		if(_event->button() == Qt::LeftButton && std::abs(_event->x() - m_pressX) + std::abs(_event->y() - m_pressY) <= 3)
+			pick(_event->x(), _event->y());
+	}
+
+	void SceneWindow::pick(int _x, int _y)
+	{
+		HSITHO_PROFILE_SCOPE("SceneWindow::pick");
+		if(!m_picker)
+		{
+			std::string error;
+			std::shared_ptr<sdf::Program> program = sdf::SceneCompiler::compile(m_pickGenerator, m_nodes, error, true);
+			if(!program)
+			{
+				std::cout << "Couldn't compile the scene for picking: " << error << "\n";
+				return;
+			}
+			m_pickPrimitives = m_pickGenerator.primitives();
+			m_picker.reset(new sdf::Picker(program, sdf::Picker::Settings()));
 		}
+
+		QElapsedTimer timer;
+		timer.start();
+		m_picker->setTime(getTimePassed());
+		glm::vec3 eye = m_camDist * glm::vec3(m_cam);
+		glm::vec3 direction = sdf::Picker::cameraRay(eye, m_camU, _x + 0.5f, _y + 0.5f, width(), height());
+		sdf::Picker::Hit hit = m_picker->pick(eye, direction);
+		m_stats.addSample("pick", timer.nsecsElapsed() / 1000000.f);
+
+		if(hit.m_hit && hit.m_primitive < m_pickPrimitives.size())
+			emit nodePicked(m_pickPrimitives[hit.m_primitive]);
+		else
+			emit nodePicked(QUuid());
 	}
 
 	void SceneWindow::mouseMoveEvent(QMouseEvent *_event)
@@ -115,10 +176,21 @@ namespace hsitho
 
   void SceneWindow::paintGL()
   {
+    HSITHO_PROFILE_SCOPE("SceneWindow::paintGL");
 		const qreal retinaScale = devicePixelRatio();
 		GLfloat resolution[] = {width() * (float)retinaScale, height() * (float)retinaScale};
 		glViewport(0, 0, width() * retinaScale, height() * retinaScale);
 
+    // Results of earlier frames, read back only when they're ready so the pipeline never stalls
+    float ms;
+    while(m_sceneTimer.poll(ms))
+    {
+      m_stats.addSample("scene", ms);
+      HSITHO_PROFILE_COUNTER("scene gpu ms", ms);
+    }
+    while(m_statsTimer.poll(ms))
+      m_stats.addSample("debug counters", ms);
+
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     m_vao->bind();
@@ -138,7 +210,19 @@ namespace hsitho
 		m_shaderMan->getProgram()->setUniformValueArray("u_Camera", glm::value_ptr((m_camDist*m_cam)), 1, 3);
 		m_shaderMan->getProgram()->setUniformValueArray("u_CameraUp", glm::value_ptr(m_camU), 1, 3);
 
+    // Volumes and instances of a new scene are uploaded by the first frame drawn with it, unchanged ones keep their texture
+    m_volumeTextures.update(m_generator.volumes());
+    m_volumeTextures.bind(*m_shaderMan->getProgram());
+    m_instanceTextures.update(m_generator.instanceSets());
+    m_instanceTextures.bind(*m_shaderMan->getProgram());
+
+    if(m_debugMode != 0)
+      readDebugStats(resolution[0], resolution[1]);
+    m_shaderMan->getProgram()->setUniformValue("u_DebugMode", m_debugMode);
+
+    m_sceneTimer.begin();
     glDrawArrays(GL_TRIANGLES, 0, 6);
+    m_sceneTimer.end();
 
     m_shaderMan->getProgram()->disableAttributeArray("a_Position");
     m_shaderMan->getProgram()->disableAttributeArray("a_FragCoord");
@@ -147,121 +231,109 @@ namespace hsitho
     m_vbo.release();
     m_vao->release();
 
+    if(m_showStats)
+      drawStats();
+
 		++m_frames;
   }
 
-  void SceneWindow::nodeChanged(std::unordered_map<QUuid, std::shared_ptr<Node>> _nodes)
+  void SceneWindow::readDebugStats(int _w, int _h)
   {
-    if(m_outputNode == nullptr)
+    if(_w <= 0 || _h <= 0)
+      return;
+
+    if(m_statsFbo == nullptr || m_statsFbo->size() != QSize(_w, _h))
     {
-      for(auto node : _nodes)
-      {
-        if(node.second.get()->nodeDataModel()->getShaderCode() == "final")
-        {
-          m_outputNode = node.second.get();
-          break;
-        }
-      }
+      delete m_statsFbo;
+      QOpenGLFramebufferObjectFormat format;
+      format.setInternalTextureFormat(GL_RGBA32F);
+      m_statsFbo = new QOpenGLFramebufferObject(_w, _h, format);
     }
-    if(m_outputNode != nullptr)
-		{
-      std::string shadercode;
-      Mat4f translation;
-			hsitho::Expressions::flushUnknowns();
-      for(auto connection : m_outputNode->nodeState().connection(PortType::In, 0))
-      {
-        if(connection.get() && connection->getNode(PortType::Out).lock())
-        {
-          shadercode += recurseNodeTree(connection->getNode(PortType::Out).lock(), translation);
-        }
-      }
 
-      if(shadercode != "")
+    m_statsFbo->bind();
+    m_shaderMan->getProgram()->setUniformValue("u_DebugMode", 4);
+    m_statsTimer.begin();
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    m_statsTimer.end();
+
+    // Synchronous read, the debug views are for tuning so exact per-frame numbers matter more than the stall
+    m_statsPixels.resize(static_cast<size_t>(_w) * _h * 4);
+    glReadPixels(0, 0, _w, _h, GL_RGBA, GL_FLOAT, m_statsPixels.data());
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+
+    // r = march steps, g = distance evaluations, b = distance error where the marcher gave up, a = hit
+    double steps = 0.0, evals = 0.0, error = 0.0;
+    float maxSteps = 0.f, maxEvals = 0.f;
+    size_t hits = 0, unconverged = 0;
+    size_t count = static_cast<size_t>(_w) * _h;
+    for(size_t i = 0; i < count; ++i)
+    {
+      const float *px = &m_statsPixels[i * 4];
+      steps += px[0];
+      evals += px[1];
+      maxSteps = std::max(maxSteps, px[0]);
+      maxEvals = std::max(maxEvals, px[1]);
+      if(px[2] > 0.f)
       {
-				std::string fragmentShader = m_shaderStart;
-
-				fragmentShader += hsitho::Expressions::getUnknowns();
-				fragmentShader += "pos = ";
-				fragmentShader += hsitho::Expressions::replaceUnknowns(shadercode);
-				fragmentShader += ";";
-
-        fragmentShader += m_shaderEnd;
-
-        m_shaderMan->updateShader(fragmentShader.c_str());
+        error += px[2];
+        ++unconverged;
       }
+      if(px[3] > 0.5f)
+        ++hits;
     }
+
+    m_stats.addMetric("steps mean", steps / count);
+    m_stats.addMetric("steps max", maxSteps);
+    m_stats.addMetric("evals mean", evals / count);
+    m_stats.addMetric("evals max", maxEvals);
+    m_stats.addMetric("hit ratio", static_cast<float>(hits) / count);
+    m_stats.addMetric("unconverged ratio", static_cast<float>(unconverged) / count);
+    m_stats.addMetric("error mean", unconverged ? error / unconverged : 0.0);
   }
 
-	std::string SceneWindow::recurseNodeTree(std::shared_ptr<Node> _node, Mat4f _t, PortIndex portIndex, unsigned int _cp)
-	{
-		unsigned int iter = 1;
-		std::string shadercode;
-		_t.setCpn(_cp);
-		_node->nodeDataModel()->setCopyNum(_cp);
+  void SceneWindow::drawStats()
+  {
+    std::vector<std::string> lines = m_stats.overlayText();
+    if(!m_sceneTimer.isSupported())
+      lines.insert(lines.begin(), "GPU timer queries not supported");
+
+    QPainter painter(this);
+    QFont font("Monospace");
+    font.setStyleHint(QFont::TypeWriter);
+    font.setPixelSize(12);
+    painter.setFont(font);
+
+    int lineHeight = painter.fontMetrics().height();
+    painter.fillRect(QRect(4, 4, 420, lineHeight * lines.size() + 8), QColor(0, 0, 0, 160));
+    painter.setPen(Qt::white);
+    for(size_t i = 0; i < lines.size(); ++i)
+      painter.drawText(10, 4 + lineHeight * (i + 1), QString::fromStdString(lines[i]));
+  }
 
-    if(_node->nodeDataModel()->getNodeType() == DFNodeType::TRANSFORM)
-		{
-			_t = _t * _node->nodeDataModel()->getTransform();
-    }
-    else if(_node->nodeDataModel()->getNodeType() == DFNodeType::PRIMITIVE)
+  void SceneWindow::nodeChanged(std::unordered_map<QUuid, std::shared_ptr<Node>> _nodes)
+  {
+    HSITHO_PROFILE_SCOPE("SceneWindow::nodeChanged");
+    m_nodes = _nodes;
+    m_picker.reset();
+    AllocationTracker::beginCompile();
+    // Temporaries of the code generation, all released together when the compile is done
+    CompileArena arena;
+    QElapsedTimer timer;
+    timer.start();
+    std::string fragmentShader = m_generator.generate(_nodes);
+    if(fragmentShader != "")
     {
-      _node->nodeDataModel()->setTransform(_t);
-      shadercode += _node->nodeDataModel()->getShaderCode();
+      RenderStats::CompileRecord record;
+      record.m_generateMs = timer.nsecsElapsed() / 1000000.f;
+      record.m_sourceSize = fragmentShader.size();
+      HSITHO_PROFILE_COUNTER("shader bytes", record.m_sourceSize);
+      record.m_success = m_shaderMan->updateShader(fragmentShader.c_str());
+      record.m_compileMs = m_shaderMan->getLastCompileTime();
+      m_stats.addCompile(record);
+      if(AllocationTracker::compiledIn())
+        AllocationTracker::report(std::cout);
+      // The old timings are for a different scene
+      m_stats.clear();
     }
-    else if(_node->nodeDataModel()->getNodeType() == DFNodeType::MIX)
-    {
-      shadercode += _node->nodeDataModel()->getShaderCode();
-		}
-		else if(_node->nodeDataModel()->getNodeType() == DFNodeType::COPY)
-		{
-			iter = boost::lexical_cast<unsigned int>(_node->nodeDataModel()->getShaderCode());
-		}
-
-		for(unsigned int it = 0; it < iter; ++it)
-		{
-			if(iter > 1)
-			{
-				_cp = it;
-				if(iter - it > 1)
-				{
-					shadercode += "opUnion(";
-				}
-			}
-			std::vector<std::shared_ptr<Connection>> inConns = _node->nodeState().connection(PortType::In);
-			if(_node->nodeDataModel()->getNodeType() == DFNodeType::COLLAPSED) {
-				std::vector<std::shared_ptr<Connection>> inConnsTmp;
-				std::shared_ptr<Node> o = dynamic_cast<CollapsedNodeDataModel *>(_node->nodeDataModel().get())->getOutputs()[portIndex];
-				for(auto &c : o->nodeState().connection(PortType::In)) {
-					inConnsTmp.push_back(c);
-				}
-				inConns.swap(inConnsTmp);
-				inConnsTmp.clear();
-			}
-
-			unsigned int i = 0;
-			for(auto connection : inConns)
-			{
-				if(connection.get() && connection->getNode(PortType::Out).lock()) {
-					++i;
-					shadercode += recurseNodeTree(connection->getNode(PortType::Out).lock(), _t, connection->getPortIndex(PortType::Out), _cp);
-					if(_node->nodeDataModel()->getNodeType() == DFNodeType::MIX) {
-						if(i < inConns.size())
-							shadercode += ",";
-						else
-							shadercode += _node->nodeDataModel()->getExtraParams() + ")";
-					}
-				}
-			}
-			if(iter > 1 && iter - it > 1)
-			{
-				shadercode += ",";
-			}
-		}
-		if(iter > 1)
-		{
-			for(unsigned int it = 0; it < iter - 1; ++it)
-				shadercode += ")";
-		}
-    return shadercode;
   }
 }
@@ -0,0 +1,477 @@
+#include <algorithm>
+#include <fstream>
+
+#include "nodeEditor/NodeDataModel.hpp"
+#include "nodes/CollapsedNodeDataModel.hpp"
+#include "nodes/LightDataModel.hpp"
+#include "nodes/MeshImportDataModel.hpp"
+#include "nodes/ScatterDataModel.hpp"
+#include "AllocationTracker.hpp"
+#include "Numeric.hpp"
+#include "Profiler.hpp"
+#include "ShaderGenerator.hpp"
+
+namespace hsitho
+{
+  ShaderGenerator::ShaderGenerator(ThreadPool &_pool, const std::string &_shaderDir) :
+    m_outputNode(nullptr),
+    m_pool(_pool),
+    m_analyticNormals(false),
+    m_recordPrimitives(false)
+  {
+    std::ifstream s(_shaderDir + "/shader.begin");
+    std::ifstream e(_shaderDir + "/shader.end");
+    m_shaderStart = std::string((std::istreambuf_iterator<char>(s)), std::istreambuf_iterator<char>());
+    m_shaderEnd = std::string((std::istreambuf_iterator<char>(e)), std::istreambuf_iterator<char>());
+  }
+
+  std::string ShaderGenerator::generate(const std::unordered_map<QUuid, std::shared_ptr<Node>> &_nodes)
+  {
+    HSITHO_PROFILE_SCOPE("ShaderGenerator::generate");
+    HSITHO_ALLOC_STAGE(CODEGEN);
+    HSITHO_PROFILE_COUNTER("nodes", _nodes.size());
+    findOutputNode(_nodes);
+    m_volumes.clear();
+    m_instanceSets.clear();
+    m_instanceFunctions.clear();
+    m_instanceSlots.clear();
+    if(m_outputNode != nullptr)
+		{
+      std::string shadercode;
+      ArenaVector<std::string> analytic(CompileArena::resource());
+      ArenaVector<std::string> marched(CompileArena::resource());
+      std::string dualcode;
+      Mat4f translation;
+			hsitho::Expressions::flushUnknowns();
+      for(auto connection : m_outputNode->nodeState().connection(PortType::In, 0))
+      {
+        if(connection.get() && connection->getNode(PortType::Out).lock())
+        {
+          shadercode += recurseNodeTree(connection->getNode(PortType::Out).lock(), translation);
+          collectUnionTerms(connection->getNode(PortType::Out).lock(), translation, analytic, marched);
+          if(m_analyticNormals)
+            dualcode += recurseNodeTree(connection->getNode(PortType::Out).lock(), translation, 0, 0, DFCodeVariant::DUAL);
+        }
+      }
+
+      if(shadercode != "")
+      {
+				std::string fragmentShader = m_shaderStart;
+				std::string unknowns = hsitho::Expressions::getUnknowns();
+
+				fragmentShader += m_instanceFunctions;
+				fragmentShader += mapFunction(shadercode, unknowns);
+
+				if(m_analyticNormals)
+				{
+					fragmentShader += "#define HSITHO_ANALYTIC_NORMALS\n";
+					fragmentShader += "Dual mapDual(vec3 _position)\n{\n  ";
+					fragmentShader += unknowns;
+					fragmentShader += "return " + hsitho::Expressions::replaceUnknowns(dualcode) + ";\n}\n\n";
+				}
+
+        // Only split the scene when part of it can be intersected exactly, otherwise the marcher runs on the full map
+				if(analytic.size())
+				{
+					fragmentShader += "#define HSITHO_ANALYTIC\n";
+					fragmentShader += "vec4 intersectAnalytic(vec3 _ro, vec3 _rd, float _tmin)\n{\n";
+					fragmentShader += "  vec4 hit = vec4(analyticmiss, vec3(0.0));\n  ";
+					fragmentShader += unknowns;
+					for(auto &code : analytic)
+					{
+						fragmentShader += "\n  hit = opUnion(hit, " + hsitho::Expressions::replaceUnknowns(code) + ");";
+					}
+					fragmentShader += "\n  return hit;\n}\n\n";
+
+					if(marched.size())
+					{
+						std::string marchedcode = marched.back();
+						for(auto it = marched.rbegin() + 1; it != marched.rend(); ++it)
+						{
+							marchedcode = "opUnion(" + *it + "," + marchedcode + ")";
+						}
+						fragmentShader += "#define HSITHO_MARCHED\n";
+						fragmentShader += "vec4 mapMarched(vec3 _position)\n{\n  ";
+						fragmentShader += unknowns;
+						fragmentShader += "return " + hsitho::Expressions::replaceUnknowns(marchedcode) + ";\n}\n\n";
+					}
+				}
+				else
+				{
+					fragmentShader += "#define HSITHO_MARCHED\n";
+					fragmentShader += "#define mapMarched map\n\n";
+				}
+
+				fragmentShader += generateLights(_nodes);
+
+        fragmentShader += m_shaderEnd;
+        return fragmentShader;
+      }
+    }
+    return "";
+  }
+
+  std::string ShaderGenerator::generateMap(const std::unordered_map<QUuid, std::shared_ptr<Node>> &_nodes)
+  {
+    HSITHO_PROFILE_SCOPE("ShaderGenerator::generateMap");
+    HSITHO_ALLOC_STAGE(CODEGEN);
+    findOutputNode(_nodes);
+    if(m_outputNode == nullptr)
+      return "";
+
+    std::string shadercode;
+    Mat4f translation;
+    hsitho::Expressions::flushUnknowns();
+    m_primitives.clear();
+    m_volumes.clear();
+    m_instanceSets.clear();
+    m_instanceFunctions.clear();
+    m_instanceSlots.clear();
+    m_recordPrimitives = true;
+    for(auto connection : m_outputNode->nodeState().connection(PortType::In, 0))
+    {
+      if(connection.get() && connection->getNode(PortType::Out).lock())
+        shadercode += recurseNodeTree(connection->getNode(PortType::Out).lock(), translation);
+    }
+    m_recordPrimitives = false;
+    if(shadercode == "")
+      return "";
+    return m_instanceFunctions + mapFunction(shadercode, hsitho::Expressions::getUnknowns());
+  }
+
+  void ShaderGenerator::findOutputNode(const std::unordered_map<QUuid, std::shared_ptr<Node>> &_nodes)
+  {
+    // Looked up again on every call, scenes get reloaded and one generator serves every scene it's given
+    m_outputNode = nullptr;
+    for(auto node : _nodes)
+    {
+      if(node.second.get()->nodeDataModel()->getShaderCode() == "final")
+      {
+        m_outputNode = node.second.get();
+        break;
+      }
+    }
+  }
+
+  std::string ShaderGenerator::mapFunction(const std::string &_code, const std::string &_unknowns)
+  {
+    std::string map = "vec4 map(vec3 _position)\n{\n";
+    map += "  vec4 pos = vec4(4.0, 3.0, 4.0, 0.0);\n  ";
+    map += _unknowns;
+    map += "pos = ";
+    map += hsitho::Expressions::replaceUnknowns(_code);
+    map += ";\n  return pos;\n}\n\n";
+    return map;
+  }
+
+	std::string ShaderGenerator::generateLights(const std::unordered_map<QUuid, std::shared_ptr<Node>> &_nodes)
+	{
+		HSITHO_PROFILE_SCOPE("ShaderGenerator::generateLights");
+		// Sorted by id so the light order in the generated code doesn't depend on the hash map order
+		std::vector<std::pair<QUuid, LightDataModel *>> lights;
+		for(auto &node : _nodes)
+		{
+			if(node.second->nodeDataModel()->getNodeType() != DFNodeType::LIGHT)
+				continue;
+			LightDataModel *light = dynamic_cast<LightDataModel *>(node.second->nodeDataModel());
+			if(light && light->isEnabled())
+				lights.push_back(std::make_pair(node.first, light));
+		}
+		std::sort(lights.begin(), lights.end(), [](const std::pair<QUuid, LightDataModel *> &_a, const std::pair<QUuid, LightDataModel *> &_b) { return _a.first < _b.first; });
+
+		// Without any enabled light nodes the default rig in shader.end is used
+		if(lights.empty())
+			return "";
+
+		std::string code = "#define HSITHO_LIGHTS\n";
+		code += "vec3 applyLights(vec3 _p, vec3 _n, vec3 _reflection, vec3 _albedo)\n{\n";
+		code += "  vec3 col = vec3(0.0);\n";
+		code += "  vec3 lightDir;\n  vec3 acc;\n  float diffuse;\n  float specular;\n  float intensitySum = 0.0;\n";
+		code += "  float ambient = clamp(0.5 + 0.5*_n.y, 0.0, 1.0);\n";
+		code += "  float occlusion = calcAO(_p, _n);\n";
+		for(auto &light : lights)
+		{
+			code += light.second->getShaderCode();
+		}
+		code += "  return col / max(intensitySum, 1e-4);\n}\n\n";
+		return code;
+	}
+
+	void ShaderGenerator::collectUnionTerms(std::shared_ptr<Node> _node, Mat4f _t, ArenaVector<std::string> &_analytic, ArenaVector<std::string> &_marched, PortIndex portIndex, unsigned int _cp)
+	{
+		HSITHO_PROFILE_SCOPE("ShaderGenerator::collectUnionTerms");
+		unsigned int iter = 1;
+		bool isUnion = false;
+		_t.setCpn(_cp);
+		_node->nodeDataModel()->setCopyNum(_cp);
+
+		switch(_node->nodeDataModel()->getNodeType())
+		{
+			case DFNodeType::PRIMITIVE:
+			{
+				_node->nodeDataModel()->setTransform(_t);
+				assignVolume(*_node);
+				std::string code = _node->nodeDataModel()->getIntersectionCode();
+				if(code != "")
+				{
+					_analytic.push_back(code);
+					return;
+				}
+			} break;
+			case DFNodeType::TRANSFORM:
+				_t = _t * _node->nodeDataModel()->getTransform();
+				isUnion = true;
+			break;
+			case DFNodeType::MIX:
+				isUnion = _node->nodeDataModel()->getShaderCode() == "opUnion(";
+			break;
+			case DFNodeType::COPY:
+				// A copy count that isn't a plain number yet still passes its input through once
+				if(!Numeric::parseUnsigned(_node->nodeDataModel()->getShaderCode(), iter))
+					iter = 1;
+				isUnion = true;
+			break;
+			case DFNodeType::COLLAPSED:
+				isUnion = true;
+			break;
+			default:
+			break;
+		}
+
+		// Anything that isn't a plain union (or a transform/copy/collapsed node wrapping one) is left for the marcher
+		if(!isUnion)
+		{
+			std::string code = recurseNodeTree(_node, _t, portIndex, _cp);
+			if(code != "")
+				_marched.push_back(code);
+			return;
+		}
+
+		std::vector<std::shared_ptr<Connection>> inConns = _node->nodeState().connection(PortType::In);
+		if(_node->nodeDataModel()->getNodeType() == DFNodeType::COLLAPSED) {
+			std::shared_ptr<Node> o = dynamic_cast<CollapsedNodeDataModel *>(_node->nodeDataModel().get())->getOutputs()[portIndex];
+			inConns = o->nodeState().connection(PortType::In);
+		}
+
+		for(unsigned int it = 0; it < iter; ++it)
+		{
+			for(auto connection : inConns)
+			{
+				if(connection.get() && connection->getNode(PortType::Out).lock()) {
+					collectUnionTerms(connection->getNode(PortType::Out).lock(), _t, _analytic, _marched, connection->getPortIndex(PortType::Out), iter > 1 ? it : _cp);
+				}
+			}
+		}
+	}
+
+	void ShaderGenerator::assignVolume(Node &_node)
+	{
+		MeshImportDataModel *mesh = dynamic_cast<MeshImportDataModel *>(_node.nodeDataModel().get());
+		if(!mesh)
+			return;
+		mesh->bake(m_pool);
+		if(!mesh->volume())
+			return;
+		auto slot = std::find(m_volumes.begin(), m_volumes.end(), mesh->volume());
+		if(slot == m_volumes.end() && m_volumes.size() < c_maxVolumes)
+			slot = m_volumes.insert(m_volumes.end(), mesh->volume());
+		mesh->setVolumeSlot(slot == m_volumes.end() ? -1 : static_cast<int>(slot - m_volumes.begin()));
+	}
+
+	void ShaderGenerator::assignInstances(Node &_node)
+	{
+		ScatterDataModel *scatter = dynamic_cast<ScatterDataModel *>(_node.nodeDataModel().get());
+		if(!scatter)
+			return;
+		auto assigned = m_instanceSlots.find(_node.id());
+		if(assigned != m_instanceSlots.end())
+		{
+			scatter->setInstanceSlot(assigned->second);
+			return;
+		}
+
+		// The inputs are generated in their own space and don't write distance function calls into the map function
+		bool record = m_recordPrimitives;
+		m_recordPrimitives = false;
+		std::string code[2];
+		for(PortIndex port = 1; port < 3; ++port)
+		{
+			for(auto connection : _node.nodeState().connection(PortType::In, port))
+			{
+				if(connection.get() && connection->getNode(PortType::Out).lock())
+					code[port - 1] += recurseNodeTree(connection->getNode(PortType::Out).lock(), Mat4f(), connection->getPortIndex(PortType::Out));
+			}
+		}
+		m_recordPrimitives = record;
+
+		scatter->scatter(code[0], code[1], m_volumes, m_instanceSets, m_pool);
+		std::shared_ptr<const sdf::InstanceSet> set = scatter->instances();
+		auto slot = std::find(m_instanceSets.begin(), m_instanceSets.end(), set);
+		if(!set || slot != m_instanceSets.end() || m_instanceSets.size() == c_maxInstanceSets)
+		{
+			int index = !set || slot == m_instanceSets.end() ? -1 : static_cast<int>(slot - m_instanceSets.begin());
+			scatter->setInstanceSlot(index);
+			m_instanceSlots[_node.id()] = index;
+			return;
+		}
+
+		// The copies in the cells around the point run the copied code, see sdf::InstanceSet for the grid and the texels
+		std::string n = std::to_string(m_instanceSets.size());
+		std::string buffer = "u_Instances" + n;
+		std::string texels = std::to_string(sdf::InstanceSet::c_texelsPerInstance);
+		std::string header = std::to_string(sdf::InstanceSet::c_headerTexels);
+		std::string &f = m_instanceFunctions;
+		f += "vec4 instances" + n + "(vec3 _world, vec3 _color)\n{\n";
+		f += "  vec4 grid = texelFetch(" + buffer + ", 0);\n";
+		f += "  vec4 size = texelFetch(" + buffer + ", 1);\n";
+		f += "  ivec3 dims = ivec3(size.xyz);\n";
+		f += "  int copies = " + header + " + dims.x*dims.y*dims.z;\n";
+		f += "  ivec3 cell = ivec3(floor(clamp((_world - grid.xyz)/grid.w, vec3(-1.0), vec3(dims))));\n";
+		f += "  ivec3 nearest = clamp(cell, ivec3(0), dims - 1);\n";
+		f += "  float empty = texelFetch(" + buffer + ", " + header + " + nearest.x + dims.x*(nearest.y + dims.y*nearest.z)).z;\n";
+		f += "  vec3 outside = max(max(grid.xyz - _world, _world - grid.xyz - vec3(dims)*grid.w), 0.0);\n";
+		f += "  float d = max((max(empty, 2.0) - 1.0)*grid.w, length(outside)) - size.w;\n";
+		f += "  if(empty >= 2.0)\n    return vec4(d, _color);\n";
+		f += "  ivec3 lo = max(cell - 1, ivec3(0));\n";
+		f += "  ivec3 hi = min(cell + 1, dims - 1);\n";
+		f += "  for(int k = lo.z; k <= hi.z; ++k)\n";
+		f += "  for(int j = lo.y; j <= hi.y; ++j)\n";
+		f += "  for(int c = lo.x; c <= hi.x; ++c)\n  {\n";
+		f += "    vec4 range = texelFetch(" + buffer + ", " + header + " + c + dims.x*(j + dims.y*k));\n";
+		f += "    for(int i = int(range.x); i < int(range.x + range.y); ++i)\n    {\n";
+		f += "      int t = copies + " + texels + "*i;\n";
+		f += "      vec4 x = texelFetch(" + buffer + ", t);\n";
+		f += "      vec4 y = texelFetch(" + buffer + ", t + 1);\n";
+		f += "      vec4 z = texelFetch(" + buffer + ", t + 2);\n";
+		f += "      float scale = texelFetch(" + buffer + ", t + 3).x;\n";
+		f += "      vec3 _position = vec3(dot(x, vec4(_world, 1.0)), dot(y, vec4(_world, 1.0)), dot(z, vec4(_world, 1.0)));\n";
+		f += "      if((length(_position) - " + Numeric::toString(set->radius()) + ")*scale >= d)\n        continue;\n";
+		f += "      d = min(d, (" + code[1] + ").x*scale);\n";
+		f += "    }\n  }\n  return vec4(d, _color);\n}\n\n";
+		scatter->setInstanceSlot(static_cast<int>(m_instanceSets.size()));
+		m_instanceSlots[_node.id()] = static_cast<int>(m_instanceSets.size());
+		m_instanceSets.push_back(set);
+	}
+
+	std::string ShaderGenerator::finiteDifferenceDual(const std::string &_code) const
+	{
+		const std::string offsets[4] = {"vec3(0.0005, -0.0005, -0.0005)", "vec3(-0.0005, -0.0005, 0.0005)", "vec3(-0.0005, 0.0005, -0.0005)", "vec3(0.0005)"};
+		std::string dual = "dualFromSamples(" + _code;
+		for(auto &offset : offsets)
+		{
+			std::string sample = _code;
+			std::string shifted = "(_position + " + offset + ")";
+			size_t pos = 0;
+			while((pos = sample.find("_position", pos)) != std::string::npos)
+			{
+				sample.replace(pos, 9, shifted);
+				pos += shifted.length();
+			}
+			dual += ", " + sample + ".x";
+		}
+		return dual + ", 0.0005)";
+	}
+
+	std::string ShaderGenerator::recurseNodeTree(std::shared_ptr<Node> _node, Mat4f _t, PortIndex portIndex, unsigned int _cp, DFCodeVariant _variant)
+	{
+		HSITHO_PROFILE_SCOPE("ShaderGenerator::recurseNodeTree");
+		unsigned int iter = 1;
+		std::string shadercode;
+
+		// Nodes without a derivative fall back to finite differences of their own distance code
+		if(_variant == DFCodeVariant::DUAL &&
+			 (_node->nodeDataModel()->getNodeType() == DFNodeType::PRIMITIVE || _node->nodeDataModel()->getNodeType() == DFNodeType::MIX ||
+			  _node->nodeDataModel()->getNodeType() == DFNodeType::INSTANCE) &&
+			 _node->nodeDataModel()->getDualShaderCode() == "")
+		{
+			return finiteDifferenceDual(recurseNodeTree(_node, _t, portIndex, _cp, DFCodeVariant::DISTANCE));
+		}
+
+		_t.setCpn(_cp);
+		_node->nodeDataModel()->setCopyNum(_cp);
+
+    if(_node->nodeDataModel()->getNodeType() == DFNodeType::TRANSFORM)
+		{
+			_t = _t * _node->nodeDataModel()->getTransform();
+    }
+    else if(_node->nodeDataModel()->getNodeType() == DFNodeType::PRIMITIVE)
+    {
+      _node->nodeDataModel()->setTransform(_t);
+      assignVolume(*_node);
+      shadercode += _variant == DFCodeVariant::DUAL ? _node->nodeDataModel()->getDualShaderCode() : _node->nodeDataModel()->getShaderCode();
+      // Every primitive writes exactly one distance function call, so the calls can be matched back to the nodes
+      if(m_recordPrimitives && _variant == DFCodeVariant::DISTANCE)
+        m_primitives.push_back(m_collapsedOwner.isNull() ? _node->id() : m_collapsedOwner);
+    }
+    else if(_node->nodeDataModel()->getNodeType() == DFNodeType::INSTANCE)
+    {
+      // The inputs end up in the instances function, not in the code of this tree
+      _node->nodeDataModel()->setTransform(_t);
+      assignInstances(*_node);
+      if(m_recordPrimitives && _variant == DFCodeVariant::DISTANCE)
+        m_primitives.push_back(m_collapsedOwner.isNull() ? _node->id() : m_collapsedOwner);
+      return _node->nodeDataModel()->getShaderCode();
+    }
+    else if(_node->nodeDataModel()->getNodeType() == DFNodeType::MIX)
+    {
+      shadercode += _variant == DFCodeVariant::DUAL ? _node->nodeDataModel()->getDualShaderCode() : _node->nodeDataModel()->getShaderCode();
+		}
+		else if(_node->nodeDataModel()->getNodeType() == DFNodeType::COPY)
+		{
+			if(!Numeric::parseUnsigned(_node->nodeDataModel()->getShaderCode(), iter))
+				iter = 1;
+		}
+		bool outermostCollapsed = _node->nodeDataModel()->getNodeType() == DFNodeType::COLLAPSED && m_collapsedOwner.isNull();
+		if(outermostCollapsed)
+			m_collapsedOwner = _node->id();
+
+		for(unsigned int it = 0; it < iter; ++it)
+		{
+			if(iter > 1)
+			{
+				_cp = it;
+				if(iter - it > 1)
+				{
+					shadercode += _variant == DFCodeVariant::DUAL ? "opUnionD(" : "opUnion(";
+				}
+			}
+			std::vector<std::shared_ptr<Connection>> inConns = _node->nodeState().connection(PortType::In);
+			if(_node->nodeDataModel()->getNodeType() == DFNodeType::COLLAPSED) {
+				std::vector<std::shared_ptr<Connection>> inConnsTmp;
+				std::shared_ptr<Node> o = dynamic_cast<CollapsedNodeDataModel *>(_node->nodeDataModel().get())->getOutputs()[portIndex];
+				for(auto &c : o->nodeState().connection(PortType::In)) {
+					inConnsTmp.push_back(c);
+				}
+				inConns.swap(inConnsTmp);
+				inConnsTmp.clear();
+			}
+
+			unsigned int i = 0;
+			for(auto connection : inConns)
+			{
+				if(connection.get() && connection->getNode(PortType::Out).lock()) {
+					++i;
+					shadercode += recurseNodeTree(connection->getNode(PortType::Out).lock(), _t, connection->getPortIndex(PortType::Out), _cp, _variant);
+					if(_node->nodeDataModel()->getNodeType() == DFNodeType::MIX) {
+						if(i < inConns.size())
+							shadercode += ",";
+						else
+							shadercode += _node->nodeDataModel()->getExtraParams() + ")";
+					}
+				}
+			}
+			if(iter > 1 && iter - it > 1)
+			{
+				shadercode += ",";
+			}
+		}
+		if(iter > 1)
+		{
+			for(unsigned int it = 0; it < iter - 1; ++it)
+				shadercode += ")";
+		}
+		if(outermostCollapsed)
+			m_collapsedOwner = QUuid();
+    return shadercode;
+  }
+}
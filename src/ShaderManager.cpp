@@ -1,7 +1,9 @@
 #include <QOpenGLShader>
+#include <QElapsedTimer>
 #include <iostream>
 #include <cstdlib>
 
+#include "Profiler.hpp"
 #include "ShaderManager.hpp"
 
 namespace hsitho
@@ -25,14 +27,23 @@ namespace hsitho
 		m_shaders[_name] = program;
   }
 
-  void ShaderManager::updateShader(const char *_shaderCode)
+  bool ShaderManager::updateShader(const char *_shaderCode)
 	{
+		HSITHO_PROFILE_SCOPE("ShaderManager::updateShader");
+		QElapsedTimer timer;
+		timer.start();
+		bool success = false;
+
 		if(m_fragShader == nullptr)
 			m_fragShader = new QOpenGLShader(QOpenGLShader::Fragment);
 
-		m_fragShader->compileSourceCode(QString(_shaderCode));
+		{
+			HSITHO_PROFILE_SCOPE("compile fragment shader");
+			m_fragShader->compileSourceCode(QString(_shaderCode));
+		}
 		if(m_program != nullptr && m_fragShader->isCompiled() == 1)
 		{
+			HSITHO_PROFILE_SCOPE("link program");
 //			std::cout << _shaderCode << "\n";
 			m_program->release();
 
@@ -40,8 +51,10 @@ namespace hsitho
 			m_program->addShaderFromSourceFile(QOpenGLShader::Vertex, "./shaders/screenQuad.vert");
 			m_program->addShader(m_fragShader);
 
-			m_program->link();
+			success = m_program->link();
 		}
+		m_lastCompileTime = timer.nsecsElapsed() / 1000000.f;
+		return success;
   }
 
   void ShaderManager::useShader(const std::string &_name)
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <string>
+
+#include "Profiler.hpp"
+#include "ThreadPool.hpp"
+
+namespace hsitho
+{
+  ThreadPool::ThreadPool(unsigned int _workers) :
+    m_task(nullptr),
+    m_generation(0),
+    m_active(0),
+    m_remaining(0),
+    m_steals(0),
+    m_stop(false)
+  {
+    unsigned int workers = _workers ? _workers : std::max(std::thread::hardware_concurrency(), 1u);
+    for(unsigned int i = 0; i < workers; ++i)
+      m_queues.emplace_back(new Queue());
+    for(unsigned int i = 1; i < workers; ++i)
+      m_threads.emplace_back(&ThreadPool::run, this, i);
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_hasWork.notify_all();
+    for(auto &thread : m_threads)
+      thread.join();
+  }
+
+  void ThreadPool::parallelFor(size_t _count, const std::function<void(size_t, unsigned int)> &_task)
+  {
+    if(_count == 0)
+      return;
+    HSITHO_PROFILE_SCOPE("ThreadPool::parallelFor");
+
+    // Contiguous shares keep neighbouring tasks, e.g. neighbouring tiles, on the same core
+    size_t workers = m_queues.size();
+    for(size_t w = 0; w < workers; ++w)
+    {
+      std::lock_guard<std::mutex> lock(m_queues[w]->m_mutex);
+      for(size_t i = _count * w / workers; i < _count * (w + 1) / workers; ++i)
+        m_queues[w]->m_tasks.push_back(i);
+    }
+    m_remaining = _count;
+    m_steals = 0;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_task = &_task;
+      ++m_generation;
+      ++m_active;
+    }
+    m_hasWork.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    --m_active;
+    m_done.wait(lock, [this] { return m_remaining == 0 && m_active == 0; });
+    // Workers waking up late mustn't see the task once this returns
+    m_task = nullptr;
+  }
+
+  void ThreadPool::run(unsigned int _worker)
+  {
+    HSITHO_PROFILE_THREAD("pool worker " + std::to_string(_worker));
+    size_t seen = 0;
+    for(;;)
+    {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_hasWork.wait(lock, [this, seen] { return m_stop || (m_generation != seen && m_task != nullptr); });
+        if(m_stop)
+          return;
+        seen = m_generation;
+        ++m_active;
+      }
+
+      work(_worker);
+
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_active;
+      }
+      m_done.notify_all();
+    }
+  }
+
+  void ThreadPool::work(unsigned int _worker)
+  {
+    const std::function<void(size_t, unsigned int)> &task = *m_task;
+    size_t index;
+    while(pop(_worker, index) || steal(_worker, index))
+    {
+      task(index, _worker);
+      if(--m_remaining == 0)
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done.notify_all();
+      }
+    }
+  }
+
+  bool ThreadPool::pop(unsigned int _worker, size_t &_task)
+  {
+    Queue &q = *m_queues[_worker];
+    std::lock_guard<std::mutex> lock(q.m_mutex);
+    if(q.m_tasks.empty())
+      return false;
+    _task = q.m_tasks.front();
+    q.m_tasks.pop_front();
+    return true;
+  }
+
+  bool ThreadPool::steal(unsigned int _worker, size_t &_task)
+  {
+    // Taking from the back leaves the victim the tasks next to the one it's working on
+    for(size_t i = 1; i < m_queues.size(); ++i)
+    {
+      Queue &q = *m_queues[(_worker + i) % m_queues.size()];
+      std::lock_guard<std::mutex> lock(q.m_mutex);
+      if(q.m_tasks.empty())
+        continue;
+      _task = q.m_tasks.back();
+      q.m_tasks.pop_back();
+      ++m_steals;
+      return true;
+    }
+    return false;
+  }
+}
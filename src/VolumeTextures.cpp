@@ -0,0 +1,69 @@
+#include <string>
+
+#include <QOpenGLPixelTransferOptions>
+
+#include "VolumeTextures.hpp"
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  VolumeTextures::~VolumeTextures()
+  {
+    clear();
+  }
+
+  void VolumeTextures::update(const std::vector<std::shared_ptr<const sdf::DistanceVolume>> &_volumes)
+  {
+    std::vector<Entry> entries;
+    entries.reserve(_volumes.size());
+    for(auto &volume : _volumes)
+    {
+      Entry entry{volume, nullptr};
+      for(auto &old : m_entries)
+        if(old.m_volume == volume && old.m_texture != nullptr)
+        {
+          std::swap(entry.m_texture, old.m_texture);
+          break;
+        }
+      if(entry.m_texture == nullptr)
+        entry.m_texture = upload(*volume);
+      entries.push_back(entry);
+    }
+    clear();
+    m_entries.swap(entries);
+  }
+
+  void VolumeTextures::bind(QOpenGLShaderProgram &_program)
+  {
+    for(size_t i = 0; i < m_entries.size(); ++i)
+    {
+      m_entries[i].m_texture->bind(static_cast<GLuint>(i));
+      _program.setUniformValue(("u_Volume" + std::to_string(i)).c_str(), static_cast<GLint>(i));
+    }
+  }
+
+  void VolumeTextures::clear()
+  {
+    for(auto &entry : m_entries)
+      delete entry.m_texture;
+    m_entries.clear();
+  }
+
+  QOpenGLTexture *VolumeTextures::upload(const sdf::DistanceVolume &_volume)
+  {
+    HSITHO_PROFILE_SCOPE("VolumeTextures::upload");
+    QOpenGLTexture *texture = new QOpenGLTexture(QOpenGLTexture::Target3D);
+    texture->setFormat(QOpenGLTexture::R16_SNorm);
+    texture->setSize(static_cast<int>(_volume.m_dims[0]), static_cast<int>(_volume.m_dims[1]), static_cast<int>(_volume.m_dims[2]));
+    texture->setMipLevels(1);
+    texture->allocateStorage(QOpenGLTexture::Red, QOpenGLTexture::Int16);
+    // Rows of an odd width aren't a multiple of the default alignment of 4 bytes
+    QOpenGLPixelTransferOptions options;
+    options.setAlignment(2);
+    texture->setData(QOpenGLTexture::Red, QOpenGLTexture::Int16, _volume.m_values.data(), &options);
+    texture->setMinificationFilter(QOpenGLTexture::Linear);
+    texture->setMagnificationFilter(QOpenGLTexture::Linear);
+    texture->setWrapMode(QOpenGLTexture::ClampToEdge);
+    return texture;
+  }
+}
@@ -0,0 +1,120 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "VoxelFile.hpp"
+
+namespace hsitho
+{
+  namespace
+  {
+    uint64_t align(uint64_t _offset)
+    {
+      return (_offset + 63) & ~uint64_t(63);
+    }
+  }
+
+  bool writeVoxelGrid(const std::string &_path, const sdf::VoxelGrid &_grid, std::string &_error)
+  {
+    sdf::VoxelGridHeader h = _grid.m_header;
+    h.m_topOffset = align(sizeof(h));
+    h.m_nodesOffset = align(h.m_topOffset + _grid.m_top.size() * sizeof(uint32_t));
+    h.m_bricksOffset = align(h.m_nodesOffset + _grid.m_nodes.size() * sizeof(uint32_t));
+    h.m_size = h.m_bricksOffset + _grid.m_bricks.size();
+
+    std::FILE *file = std::fopen(_path.c_str(), "wb");
+    if(!file)
+    {
+      _error = "Couldn't create " + _path;
+      return false;
+    }
+    std::vector<char> buffer(1 << 20);
+    std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+    const char zeros[64] = {};
+    uint64_t written = 0;
+    auto write = [&](const void *_data, uint64_t _size, uint64_t _offset) {
+      bool ok = std::fwrite(zeros, 1, _offset - written, file) == _offset - written &&
+                (_size == 0 || std::fwrite(_data, 1, _size, file) == _size);
+      written = _offset + _size;
+      return ok;
+    };
+    bool ok = write(&h, sizeof(h), 0) &&
+              write(_grid.m_top.data(), _grid.m_top.size() * sizeof(uint32_t), h.m_topOffset) &&
+              write(_grid.m_nodes.data(), _grid.m_nodes.size() * sizeof(uint32_t), h.m_nodesOffset) &&
+              write(_grid.m_bricks.data(), _grid.m_bricks.size(), h.m_bricksOffset);
+    ok = std::fclose(file) == 0 && ok;
+    if(!ok)
+      _error = "Couldn't write " + _path;
+    return ok;
+  }
+
+  bool MappedVoxelGrid::open(const std::string &_path, std::string &_error)
+  {
+    close();
+    auto fail = [&](const std::string &_reason) {
+      _error = _reason;
+      close();
+      return false;
+    };
+
+    m_file.reset(new QFile(QString::fromStdString(_path)));
+    if(!m_file->open(QIODevice::ReadOnly))
+      return fail("Couldn't open " + _path);
+
+    uint64_t size = static_cast<uint64_t>(m_file->size());
+    sdf::VoxelGridHeader h;
+    if(size < sizeof(h) || m_file->read(reinterpret_cast<char *>(&h), sizeof(h)) != sizeof(h) || std::memcmp(h.m_magic, "HSVG", 4) != 0)
+      return fail(_path + " isn't a voxel grid");
+    if(h.m_byteOrder != sdf::VoxelGridHeader::c_byteOrder || h.m_version != sdf::VoxelGridHeader::c_version)
+      return fail(_path + " was written by another version or on a machine of different endianness");
+
+    // The tile counts come from the file, their product is only formed once it can't wrap and fits in the file
+    uint64_t maxTiles = size / sizeof(uint32_t);
+    uint64_t tiles = 1;
+    bool valid = true;
+    for(int a = 0; a < 3; ++a)
+    {
+      valid = valid && h.m_tiles[a] <= maxTiles && (h.m_tiles[a] == 0 || tiles <= maxTiles / h.m_tiles[a]);
+      tiles = valid ? tiles * h.m_tiles[a] : 0;
+    }
+    valid = valid && h.m_size == size && h.m_topOffset >= sizeof(h) &&
+            h.m_topOffset <= size && h.m_nodesOffset <= size && h.m_bricksOffset <= size &&
+            h.m_topOffset % 64 == 0 && h.m_nodesOffset % 64 == 0 && h.m_bricksOffset % 64 == 0 &&
+            h.m_topOffset + tiles * sizeof(uint32_t) <= h.m_nodesOffset &&
+            h.m_nodesOffset + uint64_t(h.m_nodeCount) * sdf::VoxelGridView::c_nodeEntries * sizeof(uint32_t) <= h.m_bricksOffset &&
+            h.m_bricksOffset + uint64_t(h.m_brickCount) * sdf::VoxelGridView::c_brickPoints <= size;
+    for(int a = 0; a < 3; ++a)
+    {
+      uint64_t bricks = (uint64_t(h.m_dims[a]) + sdf::VoxelGridView::c_brick - 1) / sdf::VoxelGridView::c_brick;
+      valid = valid && (bricks + sdf::VoxelGridView::c_tile - 1) / sdf::VoxelGridView::c_tile == h.m_tiles[a];
+    }
+    if(!valid)
+      return fail(_path + " is truncated or corrupt");
+
+    m_data = m_file->map(0, static_cast<qint64>(size));
+    if(!m_data)
+      return fail("Couldn't map " + _path);
+    m_view.m_header = reinterpret_cast<const sdf::VoxelGridHeader *>(m_data);
+    m_view.m_top = reinterpret_cast<const uint32_t *>(m_data + h.m_topOffset);
+    m_view.m_nodes = reinterpret_cast<const uint32_t *>(m_data + h.m_nodesOffset);
+    m_view.m_bricks = reinterpret_cast<const int8_t *>(m_data + h.m_bricksOffset);
+
+    // The top table is small and every lookup goes through it, so its entries are checked here, node entries on lookup
+    for(uint64_t t = 0; t < tiles; ++t)
+    {
+      if(m_view.m_top[t] >= h.m_nodeCount && m_view.m_top[t] < sdf::VoxelGridView::c_inside)
+        return fail(_path + " is corrupt");
+    }
+    return true;
+  }
+
+  void MappedVoxelGrid::close()
+  {
+    if(m_data)
+      m_file->unmap(m_data);
+    m_data = nullptr;
+    m_file.reset();
+    m_view = sdf::VoxelGridView();
+  }
+}
@@ -1,12 +1,22 @@
 #include <QApplication>
 #include <QGLFormat>
+#include <iostream>
 #include <locale>
 
 #include "mainwindow.hpp"
+#include "Profiler.hpp"
 
 int main(int argc, char* argv[])
 {
   QApplication app(argc, argv);
+  HSITHO_PROFILE_THREAD("main");
+
+  // --trace file.json writes the profiler zones out on exit, see Profiler.hpp
+  QString trace;
+  int traceArg = app.arguments().indexOf("--trace");
+  if(traceArg > 0 && traceArg + 1 < app.arguments().size())
+    trace = app.arguments()[traceArg + 1];
+  hsitho::Profiler::instance().setEnabled(!trace.isEmpty());
 
   QSurfaceFormat format;
   format.setSamples(16);
@@ -19,5 +29,8 @@ int main(int argc, char* argv[])
   MainWindow window;
   window.show();
 
-	return app.exec();
+  int result = app.exec();
+  if(!trace.isEmpty() && !hsitho::Profiler::instance().writeChromeTrace(trace.toStdString()))
+    std::cout << "Couldn't write the trace to " << trace.toStdString() << "\n";
+	return result;
 }
@@ -1,34 +1,16 @@
 #include <iostream>
 
+#include <QFileDialog>
+
 #include "mainwindow.hpp"
 #include "ui_mainwindow.h"
 
 #include "nodeEditor/NodeData.hpp"
 #include "nodeEditor/DataModelRegistry.hpp"
 
-#include "ExpressionEvaluator.hpp"
-#include "nodes/DistanceFieldOutputDataModel.hpp"
-#include "nodes/CollapsedNodeDataModel.hpp"
-#include "nodes/OperationDataModels.hpp"
-#include "nodes/CopyNumDataModel.hpp"
-#include "nodes/TimeDataModel.hpp"
-#include "nodes/TranslateDataModel.hpp"
-#include "nodes/RotateDataModel.hpp"
-#include "nodes/ScaleDataModel.hpp"
 #include "nodes/DistanceFieldOutputDataModel.hpp"
-#include "nodes/ColorPickerDataModel.hpp"
-#include "nodes/CubePrimitiveDataModel.hpp"
-#include "nodes/SpherePrimitiveDataModel.hpp"
-#include "nodes/TorusPrimitiveDataModel.hpp"
-#include "nodes/CylinderPrimitiveDataModel.hpp"
-#include "nodes/CapsulePrimitiveDataModel.hpp"
-#include "nodes/PlanePrimitiveDataModel.hpp"
-#include "nodes/TriangularPrismPrimitiveDataModel.hpp"
-#include "nodes/HexagonalPrismPrimitiveDataModel.hpp"
-#include "nodes/ConePrimitiveDataModel.hpp"
-#include "nodes/CopyDataModel.hpp"
-
-#include "nodes/MathsDataModels.hpp"
+#include "NodeModels.hpp"
+#include "Profiler.hpp"
 
 MainWindow::MainWindow(QWidget *_parent) :
   QMainWindow(_parent),
@@ -39,44 +21,25 @@ MainWindow::MainWindow(QWidget *_parent) :
   m_gl = new hsitho::SceneWindow(this);
 
   // Register the nodes
-	DataModelRegistry::registerModel<CubePrimitiveDataModel>("Primitives");
-  DataModelRegistry::registerModel<TorusPrimitiveDataModel>("Primitives");
-  DataModelRegistry::registerModel<SpherePrimitiveDataModel>("Primitives");
-  DataModelRegistry::registerModel<CylinderPrimitiveDataModel>("Primitives");
-  DataModelRegistry::registerModel<CapsulePrimitiveDataModel>("Primitives");
-  DataModelRegistry::registerModel<PlanePrimitiveDataModel>("Primitives");
-  DataModelRegistry::registerModel<ConePrimitiveDataModel>("Primitives");
-  DataModelRegistry::registerModel<TriangularPrismPrimitiveDataModel>("Primitives");
-  DataModelRegistry::registerModel<HexagonalPrismPrimitiveDataModel>("Primitives");
-
-	DataModelRegistry::registerModel<UnionDataModel>("Operations");
-	DataModelRegistry::registerModel<SubtractionOpDataModel>("Operations");
-  DataModelRegistry::registerModel<IntersectionDataModel>("Operations");
-  DataModelRegistry::registerModel<BlendDataModel>("Operations");
-
-	DataModelRegistry::registerModel<TranslateDataModel>("Transforms");
-	DataModelRegistry::registerModel<ScaleDataModel>("Transforms");
-  DataModelRegistry::registerModel<RotateDataModel>("Transforms");
-
-	DataModelRegistry::registerModel<VectorDataModel>("Maths");
-  DataModelRegistry::registerModel<ScalarDataModel>("Maths");
-  DataModelRegistry::registerModel<SineDataModel>("Maths");
-  DataModelRegistry::registerModel<CosineDataModel>("Maths");
-  DataModelRegistry::registerModel<MultiplyDataModel>("Maths");
-  DataModelRegistry::registerModel<DivideDataModel>("Maths");
-	DataModelRegistry::registerModel<AdditionDataModel>("Maths");
-	DataModelRegistry::registerModel<SubtractionDataModel>("Maths");
-
-	DataModelRegistry::registerModel<TimeDataModel>("Misc");
-	DataModelRegistry::registerModel<ColorPickerDataModel>("Color");
-  DataModelRegistry::registerModel<OutputDataModel>("Generic");
-	DataModelRegistry::registerModel<InputDataModel>("Generic");
-	DataModelRegistry::registerModel<CopyDataModel>("Generic");
-	DataModelRegistry::registerModel<CopyNumDataModel>("Generic");
-	DataModelRegistry::registerModel<CollapsedNodeDataModel>("Generic");
+  hsitho::registerNodeModels();
 
   connect(this, SIGNAL(nodeEditorModified(std::unordered_map<QUuid, std::shared_ptr<Node>>)), m_gl, SLOT(nodeChanged(std::unordered_map<QUuid, std::shared_ptr<Node>>)));
 	connect(m_ui->actionCompile, &QAction::triggered, this, &MainWindow::triggered);
+	connect(m_ui->actionAnalyticNormals, &QAction::toggled, this, &MainWindow::analyticNormalsToggled);
+	connect(m_ui->actionStatsOverlay, &QAction::toggled, this, &MainWindow::statsOverlayToggled);
+	connect(m_ui->actionDumpStats, &QAction::triggered, this, &MainWindow::dumpStats);
+	connect(m_ui->actionExportTrace, &QAction::triggered, this, &MainWindow::exportTrace);
+	m_ui->actionRecordTrace->setChecked(hsitho::Profiler::instance().isEnabled());
+	connect(m_ui->actionRecordTrace, &QAction::toggled, this, &MainWindow::recordTraceToggled);
+	connect(m_gl, &hsitho::SceneWindow::nodePicked, this, &MainWindow::nodePicked);
+	m_ui->actionRecordTrace->setEnabled(hsitho::Profiler::compiledIn());
+	m_ui->actionExportTrace->setEnabled(hsitho::Profiler::compiledIn());
+
+  m_debugView = new QComboBox(this);
+  m_debugView->addItems(QStringList() << "Shaded" << "Step Count" << "Distance Evaluations" << "Distance Error");
+  m_debugView->setToolTip("Debug view, the per-frame aggregates are shown in the stats overlay");
+  m_ui->toolBar->addWidget(m_debugView);
+  connect(m_debugView, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &MainWindow::debugViewChanged);
 
   m_nodes = new FlowScene(this);
   m_flowView = new FlowView(m_nodes);
@@ -125,6 +88,46 @@ void MainWindow::keyPressEvent(QKeyEvent *_event)
   }
 }
 
+void MainWindow::dumpStats(bool)
+{
+  QString fileName = QFileDialog::getSaveFileName(nullptr, tr("Save Render Stats"), QDir::homePath(), tr("CSV (*.csv);;JSON (*.json)"));
+  if(fileName.isEmpty())
+    return;
+
+  bool saved;
+  if(fileName.endsWith(".json", Qt::CaseInsensitive))
+    saved = m_gl->getStats().writeJson(fileName.toStdString());
+  else
+    saved = m_gl->getStats().writeCsv(fileName.toStdString());
+
+  if(!saved)
+    std::cout << "Couldn't write the render stats to " << fileName.toStdString() << "\n";
+}
+
+void MainWindow::exportTrace(bool)
+{
+  QString fileName = QFileDialog::getSaveFileName(nullptr, tr("Export Trace"), QDir::homePath(), tr("Chrome trace (*.json)"));
+  if(fileName.isEmpty())
+    return;
+
+  if(!hsitho::Profiler::instance().writeChromeTrace(fileName.toStdString()))
+    std::cout << "Couldn't write the trace to " << fileName.toStdString() << "\n";
+}
+
+void MainWindow::nodePicked(QUuid _id)
+{
+  m_nodes->clearSelection();
+  if(_id.isNull())
+    return;
+
+  std::unordered_map<QUuid, std::shared_ptr<Node>> nodes = getNodes();
+  auto node = nodes.find(_id);
+  if(node == nodes.end())
+    return;
+  node->second->nodeGraphicsObject()->setSelected(true);
+  m_flowView->centerOn(node->second->nodeGraphicsObject().get());
+}
+
 MainWindow::~MainWindow()
 {
   delete m_nodes;
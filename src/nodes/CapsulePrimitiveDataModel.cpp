@@ -160,3 +160,19 @@ std::string CapsulePrimitiveDataModel::getShaderCode()
 	else
 		return "sdCapsule(vec3(" + m_transform + " * vec4(_position, 1.0)).xyz, vec3(" + m_startPos.m_x + ", " + m_startPos.m_y + ", " + m_startPos.m_z + "), vec3(" + m_endPos.m_x + ", " + m_endPos.m_y + ", " + m_endPos.m_z + "), " + m_r->text().toStdString() + ",  vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
 }
+
+std::string CapsulePrimitiveDataModel::getIntersectionCode()
+{
+	if(m_transform == "")
+		return "iCapsule(_ro, _rd, _tmin, vec3(" + m_startPos.m_x + ", " + m_startPos.m_y + ", " + m_startPos.m_z + "), vec3(" + m_endPos.m_x + ", " + m_endPos.m_y + ", " + m_endPos.m_z + "), " + m_r->text().toStdString() + ",  vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+	else
+		return "iCapsule((" + m_transform + " * vec4(_ro, 1.0)).xyz, (" + m_transform + " * vec4(_rd, 0.0)).xyz, _tmin, vec3(" + m_startPos.m_x + ", " + m_startPos.m_y + ", " + m_startPos.m_z + "), vec3(" + m_endPos.m_x + ", " + m_endPos.m_y + ", " + m_endPos.m_z + "), " + m_r->text().toStdString() + ",  vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+}
+
+std::string CapsulePrimitiveDataModel::getDualShaderCode()
+{
+	if(m_transform == "")
+		return "sdCapsuleD(_position, mat3(1.0), vec3(" + m_startPos.m_x + ", " + m_startPos.m_y + ", " + m_startPos.m_z + "), vec3(" + m_endPos.m_x + ", " + m_endPos.m_y + ", " + m_endPos.m_z + "), " + m_r->text().toStdString() + ",  vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+	else
+		return "sdCapsuleD(vec3(" + m_transform + " * vec4(_position, 1.0)).xyz, mat3(" + m_transform + "), vec3(" + m_startPos.m_x + ", " + m_startPos.m_y + ", " + m_startPos.m_z + "), vec3(" + m_endPos.m_x + ", " + m_endPos.m_y + ", " + m_endPos.m_z + "), " + m_r->text().toStdString() + ",  vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+}
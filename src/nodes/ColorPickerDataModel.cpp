@@ -4,6 +4,22 @@
 
 #include "ColorPickerDataModel.hpp"
 #include "ExpressionEvaluator.hpp"
+#include "Numeric.hpp"
+
+namespace
+{
+  // Only plain numbers can be shown as a colour, components with variables in them leave the swatch black
+  bool toColor(const std::string &_r, const std::string &_g, const std::string &_b, QColor &_color)
+  {
+    float r, g, b;
+    if(!hsitho::Numeric::parseFloat(_r, r) || !hsitho::Numeric::parseFloat(_g, g) || !hsitho::Numeric::parseFloat(_b, b))
+      return false;
+    _color = QColor(hsitho::Expressions::clamp<int>((int)(r * 255), 0, 255),
+                    hsitho::Expressions::clamp<int>((int)(g * 255), 0, 255),
+                    hsitho::Expressions::clamp<int>((int)(b * 255), 0, 255));
+    return true;
+  }
+}
 
 ColorPickerDataModel::ColorPickerDataModel()
   : _label(new QLabel("Select Color")),
@@ -142,12 +158,15 @@ void ColorPickerDataModel::restore(const Properties &p)
 	m_y->setText(p.values().find("m_y").value().toString());
 	m_z->setText(p.values().find("m_z").value().toString());
 
-	int r = hsitho::Expressions::clamp<int>((int)(boost::lexical_cast<float>(m_x->text().toStdString()) * 255), 0, 255);
-	int g = hsitho::Expressions::clamp<int>((int)(boost::lexical_cast<float>(m_y->text().toStdString()) * 255), 0, 255);
-	int b = hsitho::Expressions::clamp<int>((int)(boost::lexical_cast<float>(m_z->text().toStdString()) * 255), 0, 255);
-	current_color = QColor(r, g, b);
-	setPalColor();
-	m_vars = false;
+	if(toColor(m_x->text().toStdString(), m_y->text().toStdString(), m_z->text().toStdString(), current_color)) {
+		setPalColor();
+		m_vars = false;
+	} else {
+		current_color = QColor(0, 0, 0);
+		m_palColor.setColor(_label->backgroundRole(), current_color);
+		_label->setPalette(m_palColor);
+		m_vars = true;
+	}
 
 	m_cd = std::make_shared<ColorData>(m_x->text().toStdString(),
 																		 m_y->text().toStdString(),
@@ -204,16 +223,11 @@ void ColorPickerDataModel::setInData(std::shared_ptr<NodeData> _data, int)
 {
   auto data = std::dynamic_pointer_cast<VectorData>(_data);
 	if(data) {
-    try {
-      Vec4f vec = data->vector();
-
-      int r = hsitho::Expressions::clamp<int>((int)(boost::lexical_cast<float>(vec.m_x) * 255), 0, 255);
-      int g = hsitho::Expressions::clamp<int>((int)(boost::lexical_cast<float>(vec.m_y) * 255), 0, 255);
-      int b = hsitho::Expressions::clamp<int>((int)(boost::lexical_cast<float>(vec.m_z) * 255), 0, 255);
-      current_color = QColor(r, g, b);
+    Vec4f vec = data->vector();
+    if(toColor(vec.m_x, vec.m_y, vec.m_z, current_color)) {
       setPalColor();
 			m_vars = false;
-    } catch(boost::exception &) {
+    } else {
       current_color = QColor(0, 0, 0);
       m_palColor.setColor(_label->backgroundRole(), current_color);
 			_label->setPalette(m_palColor);
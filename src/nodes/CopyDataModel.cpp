@@ -1,5 +1,6 @@
 #include <QtGui/QIntValidator>
 #include "CopyDataModel.hpp"
+#include "Numeric.hpp"
 
 CopyDataModel::CopyDataModel() :
 	m_cp(new QLineEdit)
@@ -87,11 +88,11 @@ void CopyDataModel::setInData(std::shared_ptr<NodeData> _data, PortIndex)
 	if(data)
 	{
 		m_cp->setVisible(false);
-		try {
-			float val = boost::lexical_cast<float>(data->value().c_str());
-			m_cp->setText(boost::lexical_cast<std::string>((int)val).c_str());
+		float val;
+		if(hsitho::Numeric::parseFloat(data->value(), val)) {
+			m_cp->setText(hsitho::Numeric::toString((int)val).c_str());
 			return;
-		} catch(boost::bad_lexical_cast &) {}
+		}
 	}
 	m_cp->setVisible(true);
 	m_cp->setText("1");
@@ -114,3 +114,19 @@ std::string CubePrimitiveDataModel::getShaderCode()
 	else
 		return "sdBox(vec3(" + m_transform + " * vec4(_position, 1.0)).xyz, vec3(" + m_dimensions.m_x + ", " + m_dimensions.m_y + ", " + m_dimensions.m_z + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
 }
+
+std::string CubePrimitiveDataModel::getIntersectionCode()
+{
+	if(m_transform == "")
+		return "iBox(_ro, _rd, _tmin, vec3(" + m_dimensions.m_x + ", " + m_dimensions.m_y + ", " + m_dimensions.m_z + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+	else
+		return "iBox((" + m_transform + " * vec4(_ro, 1.0)).xyz, (" + m_transform + " * vec4(_rd, 0.0)).xyz, _tmin, vec3(" + m_dimensions.m_x + ", " + m_dimensions.m_y + ", " + m_dimensions.m_z + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+}
+
+std::string CubePrimitiveDataModel::getDualShaderCode()
+{
+	if(m_transform == "")
+		return "sdBoxD(_position, mat3(1.0), vec3(" + m_dimensions.m_x + ", " + m_dimensions.m_y + ", " + m_dimensions.m_z + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+	else
+		return "sdBoxD(vec3(" + m_transform + " * vec4(_position, 1.0)).xyz, mat3(" + m_transform + "), vec3(" + m_dimensions.m_x + ", " + m_dimensions.m_y + ", " + m_dimensions.m_z + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+}
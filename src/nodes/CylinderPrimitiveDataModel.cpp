@@ -168,3 +168,19 @@ std::string CylinderPrimitiveDataModel::getShaderCode()
 	else
 		return "sdCappedCylinder(vec3(" + m_transform + " * vec4(_position, 1.0)).xyz, vec2(" + m_r->text().toStdString() + ", " + m_height->text().toStdString() + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
 }
+
+std::string CylinderPrimitiveDataModel::getIntersectionCode()
+{
+	if(m_transform == "")
+		return "iCappedCylinder(_ro, _rd, _tmin, vec2(" + m_r->text().toStdString() + ", " + m_height->text().toStdString() + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+	else
+		return "iCappedCylinder((" + m_transform + " * vec4(_ro, 1.0)).xyz, (" + m_transform + " * vec4(_rd, 0.0)).xyz, _tmin, vec2(" + m_r->text().toStdString() + ", " + m_height->text().toStdString() + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+}
+
+std::string CylinderPrimitiveDataModel::getDualShaderCode()
+{
+	if(m_transform == "")
+		return "sdCappedCylinderD(_position, mat3(1.0), vec2(" + m_r->text().toStdString() + ", " + m_height->text().toStdString() + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+	else
+		return "sdCappedCylinderD(vec3(" + m_transform + " * vec4(_position, 1.0)).xyz, mat3(" + m_transform + "), vec2(" + m_r->text().toStdString() + ", " + m_height->text().toStdString() + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+}
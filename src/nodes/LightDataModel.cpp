@@ -0,0 +1,165 @@
+#include <QtGui/QDoubleValidator>
+#include "LightDataModel.hpp"
+
+LightDataModel::LightDataModel() :
+  m_position(Vec4f("2.0", "2.5", "2.0", "1.0")),
+  m_color(Vec4f("1.0", "0.9", "0.7", "1.0")),
+  m_intensity(new QLineEdit),
+  m_enabled(new QCheckBox("On")),
+  m_shadow(new QCheckBox("Shadow"))
+{
+  auto d = new QDoubleValidator();
+  d->setLocale(QLocale("en_GB"));
+
+  int margin = 12;
+  int x = 0, y = 0;
+  int w = m_intensity->sizeHint().width()/3;
+  int h = m_intensity->sizeHint().height();
+
+  m_intensity->setValidator(d);
+  m_intensity->setMaximumSize(m_intensity->sizeHint());
+  m_intensity->setGeometry(x, y, w, h);
+  m_intensity->setText("1.0");
+  connect(m_intensity, &QLineEdit::textChanged, this, &LightDataModel::valueEdit);
+
+  m_enabled->setGeometry(x, y + h + margin, m_enabled->sizeHint().width(), h);
+  m_enabled->setChecked(true);
+  connect(m_enabled, &QCheckBox::stateChanged, this, &LightDataModel::stateChanged);
+
+  m_shadow->setGeometry(x, y + (h + margin)*2, m_shadow->sizeHint().width(), h);
+  m_shadow->setChecked(true);
+  connect(m_shadow, &QCheckBox::stateChanged, this, &LightDataModel::stateChanged);
+}
+
+void LightDataModel::save(Properties &p) const
+{
+  p.put("model_name", name());
+  p.put("intensity", m_intensity->text());
+  p.put("enabled", m_enabled->isChecked());
+  p.put("shadow", m_shadow->isChecked());
+}
+
+void LightDataModel::restore(const Properties &p)
+{
+  m_intensity->setText(p.values().find("intensity").value().toString());
+  m_enabled->setChecked(p.values().value("enabled", true).toBool());
+  m_shadow->setChecked(p.values().value("shadow", true).toBool());
+}
+
+void LightDataModel::valueEdit(QString const)
+{
+  emit dataUpdated(0);
+}
+
+void LightDataModel::stateChanged(int)
+{
+  emit dataUpdated(0);
+}
+
+unsigned int LightDataModel::nPorts(PortType portType) const
+{
+  unsigned int result = 0;
+
+  switch(portType)
+  {
+    case PortType::In:
+      result = 3;
+    break;
+
+    default:
+      break;
+  }
+
+  return result;
+}
+
+NodeDataType LightDataModel::dataType(PortType portType, PortIndex portIndex) const
+{
+  switch(portIndex)
+  {
+    case 0:
+      return VectorData("Pos").type();
+    break;
+    case 1:
+      return ColorData().type();
+    break;
+    case 2:
+      return NodeDataType{"Scalar", "Intensity", Qt::red};
+    break;
+  }
+  return VectorData("Pos").type();
+}
+
+void LightDataModel::setInData(std::shared_ptr<NodeData> _data, PortIndex _portIndex)
+{
+  auto cd = std::dynamic_pointer_cast<ColorData>(_data);
+  if(cd) {
+    m_color = cd->color();
+    return;
+  }
+  auto vecdata = std::dynamic_pointer_cast<VectorData>(_data);
+  if(vecdata) {
+    m_position = vecdata->vector();
+    return;
+  }
+  auto szdata = std::dynamic_pointer_cast<ScalarData>(_data);
+  if(szdata) {
+    m_intensity->setVisible(false);
+    m_intensity->setText(szdata->value().c_str());
+    return;
+  }
+
+  switch(_portIndex)
+  {
+    case 0:
+      m_position = Vec4f("2.0", "2.5", "2.0", "1.0");
+    break;
+    case 1:
+      m_color = Vec4f("1.0", "0.9", "0.7", "1.0");
+    break;
+    case 2:
+    {
+      bool valid;
+      m_intensity->setVisible(true);
+      m_intensity->text().toFloat(&valid);
+      if(!valid)
+        m_intensity->setText("1.0");
+    } break;
+    default:
+      break;
+  }
+}
+
+std::vector<QWidget *> LightDataModel::embeddedWidget()
+{
+  return std::vector<QWidget *>{m_intensity, m_enabled, m_shadow};
+}
+
+bool LightDataModel::isEnabled() const
+{
+  if(!m_enabled->isChecked())
+    return false;
+
+  // Intensities driven by other nodes can't be known here, only skip the ones that are explicitly zero
+  bool valid;
+  float intensity = m_intensity->text().toFloat(&valid);
+  return !valid || intensity > 0.f;
+}
+
+std::string LightDataModel::getShaderCode()
+{
+  std::string position = "vec3(" + m_position.m_x + ", " + m_position.m_y + ", " + m_position.m_z + ")";
+  std::string color = "vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + ")";
+
+  // Ambient and occlusion are shared by every light and computed once in applyLights
+  std::string code = "  lightDir = normalize(" + position + " - _p);\n";
+  code += "  diffuse = clamp(dot(_n, lightDir), 0.0, 1.0)";
+  if(m_shadow->isChecked())
+    code += " * softshadow(_p, " + position + ", 0.02, 2.5)";
+  code += ";\n";
+  code += "  specular = pow(clamp(dot(_reflection, lightDir), 0.0, 1.0), 16.0);\n";
+  code += "  acc = 1.40 * diffuse * " + color + " + 1.20 * ambient * vec3(1.00, 0.90, 0.70) * occlusion + 2.00 * specular * vec3(0.40, 0.60, 1.00) * diffuse;\n";
+  code += "  col += _albedo * acc * " + getIntensity() + ";\n";
+  code += "  intensitySum += " + getIntensity() + ";\n";
+  return code;
+}
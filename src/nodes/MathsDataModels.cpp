@@ -1,6 +1,7 @@
 #include <QtGui/QDoubleValidator>
 #include <iostream>
 #include "MathsDataModels.hpp"
+#include "Numeric.hpp"
 
 // **********************************************
 //	SCALAR
@@ -34,9 +35,7 @@ void ScalarDataModel::valueEdit(QString const)
 		return;
 	}
 
-	try {
-		m_v = std::make_shared<ScalarData>(boost::lexical_cast<std::string>(value));
-	} catch( const boost::bad_lexical_cast &) { std::cerr << "1\n"; exit(0); }
+	m_v = std::make_shared<ScalarData>(hsitho::Numeric::toString(value));
 	emit dataUpdated(0);
 }
 
@@ -0,0 +1,172 @@
+#include <QtGui/QIntValidator>
+#include <QtWidgets/QFileDialog>
+#include "MeshImportDataModel.hpp"
+#include "MeshImport.hpp"
+#include "Numeric.hpp"
+
+MeshImportDataModel::MeshImportDataModel() :
+  m_color(Vec4f("0.6", "0.6", "0.6", "1.0")),
+  m_path(new QLineEdit),
+  m_browse(new QPushButton("Browse")),
+  m_resolution(new QLineEdit),
+  m_slot(-1)
+{
+  auto d = new QIntValidator(16, 1024);
+  d->setLocale(QLocale("en_GB"));
+
+  int margin = 12;
+  int x = 0, y = 0;
+  int w = m_path->sizeHint().width();
+  int h = m_path->sizeHint().height();
+
+  m_path->setMaximumSize(m_path->sizeHint());
+  m_path->setGeometry(x, y, w, h);
+  m_path->setPlaceholderText("OBJ or PLY file");
+  connect(m_path, &QLineEdit::editingFinished, this, &MeshImportDataModel::settingsChanged);
+
+  m_browse->setGeometry(x, y + h + margin, m_browse->sizeHint().width(), h);
+  connect(m_browse, &QPushButton::clicked, this, &MeshImportDataModel::browse);
+
+  m_resolution->setValidator(d);
+  m_resolution->setMaximumSize(m_resolution->sizeHint());
+  m_resolution->setGeometry(x, y + (h + margin)*2, w/3, h);
+  m_resolution->setText("128");
+  m_resolution->setToolTip("Grid points along the longest side");
+  connect(m_resolution, &QLineEdit::editingFinished, this, &MeshImportDataModel::settingsChanged);
+}
+
+void MeshImportDataModel::save(Properties &p) const
+{
+  p.put("model_name", name());
+  p.put("path", m_path->text());
+  p.put("resolution", m_resolution->text());
+}
+
+void MeshImportDataModel::restore(const Properties &p)
+{
+  m_path->setText(p.values().value("path", "").toString());
+  m_resolution->setText(p.values().value("resolution", "128").toString());
+  settingsChanged();
+}
+
+void MeshImportDataModel::browse()
+{
+  QString fileName = QFileDialog::getOpenFileName(nullptr, tr("Import Mesh"), m_path->text(), tr("Meshes (*.obj *.ply)"));
+  if(fileName.isEmpty())
+    return;
+  m_path->setText(fileName);
+  settingsChanged();
+}
+
+void MeshImportDataModel::settingsChanged()
+{
+  if(m_path->text() != m_importedPath || m_resolution->text() != m_importedResolution)
+    emit dataUpdated(0);
+}
+
+void MeshImportDataModel::bake(hsitho::ThreadPool &_pool)
+{
+  if(m_path->text() == m_importedPath && m_resolution->text() == m_importedResolution)
+    return;
+  m_importedPath = m_path->text();
+  m_importedResolution = m_resolution->text();
+
+  m_volume.reset();
+  m_path->setToolTip("");
+  unsigned int resolution;
+  if(!m_importedPath.isEmpty() && hsitho::Numeric::parseUnsigned(m_importedResolution.toStdString(), resolution))
+  {
+    std::string error;
+    hsitho::MeshImportStats stats;
+    m_volume = hsitho::importMesh(m_importedPath.toStdString(), resolution, _pool, error, &stats);
+    if(m_volume)
+      m_path->setToolTip(QString("%1 triangles, %2 points, baked in %3 ms")
+                         .arg(stats.m_triangles).arg(stats.m_points).arg(stats.m_readMs + stats.m_bvhMs + stats.m_bakeMs, 0, 'f', 0));
+    else
+      m_path->setToolTip(QString::fromStdString(error));
+  }
+}
+
+unsigned int MeshImportDataModel::nPorts(PortType portType) const
+{
+  unsigned int result = 1;
+
+  switch(portType)
+  {
+    case PortType::In:
+      result = 1;
+    break;
+
+    case PortType::Out:
+      result = 1;
+    break;
+
+    default:
+      break;
+  }
+
+  return result;
+}
+
+NodeDataType MeshImportDataModel::dataType(PortType portType, PortIndex portIndex) const
+{
+  switch(portType)
+  {
+    case PortType::In:
+      return ColorData().type();
+    break;
+    case PortType::Out:
+      return DistanceFieldOutput().type();
+    break;
+
+    default:
+      break;
+  }
+  return DistanceFieldOutput().type();
+}
+
+void MeshImportDataModel::setInData(std::shared_ptr<NodeData> _data, PortIndex)
+{
+  auto cd = std::dynamic_pointer_cast<ColorData>(_data);
+  if(cd) {
+    m_color = cd->color();
+    return;
+  }
+  m_color = Vec4f("0.6", "0.6", "0.6", "1.0");
+}
+
+std::vector<QWidget *> MeshImportDataModel::embeddedWidget()
+{
+  return std::vector<QWidget *>{m_path, m_browse, m_resolution};
+}
+
+void MeshImportDataModel::setTransform(const Mat4f &_t)
+{
+  std::ostringstream ss;
+  for(int y = 0; y < 4; ++y)
+  {
+    for(int x = 0; x < 4; ++x)
+    {
+      if(x || y)
+        ss << ", ";
+      ss << _t.matrix(x, y);
+    }
+  }
+  m_transform = "mat4x4(" + ss.str() + ")";
+}
+
+std::string MeshImportDataModel::getShaderCode()
+{
+  using hsitho::Numeric::toString;
+  std::string position = m_transform == "" ? "_position" : "vec3(" + m_transform + " * vec4(_position, 1.0)).xyz";
+  std::string color = "vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + ")";
+  auto vec3 = [](const glm::vec3 &_v) { return "vec3(" + toString(_v.x) + ", " + toString(_v.y) + ", " + toString(_v.z) + ")"; };
+
+  // Still one distance function call without a volume, the primitive ids count on it
+  if(!m_volume)
+    return "sdSphere(" + position + " - vec3(10000.0), 0.0, " + color + ")";
+  if(m_slot < 0)
+    return "sdBox(" + position + " - " + vec3(0.5f * (m_volume->m_min + m_volume->m_max)) + ", " + vec3(0.5f * (m_volume->m_max - m_volume->m_min)) + ", " + color + ")";
+  return "sdVolume(" + position + ", u_Volume" + std::to_string(m_slot) + ", " + vec3(m_volume->m_min) + ", " + vec3(m_volume->m_max) + ", " +
+         toString(m_volume->m_scale) + ", " + color + ")";
+}
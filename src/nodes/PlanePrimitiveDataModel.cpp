@@ -116,3 +116,19 @@ std::string PlanePrimitiveDataModel::getShaderCode()
 	else
 		return "sdPlane(vec3(" + m_transform + " * vec4(_position, 1.0)).xyz, vec4(" + m_normal.m_x + ", " + m_normal.m_y + ", " + m_normal.m_z + ", " + m_normal.m_w + ") ,vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
 }
+
+std::string PlanePrimitiveDataModel::getIntersectionCode()
+{
+	if(m_transform == "")
+		return "iPlane(_ro, _rd, _tmin, vec4(" + m_normal.m_x + ", " + m_normal.m_y + ", " + m_normal.m_z + ", " + m_normal.m_w + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+	else
+		return "iPlane((" + m_transform + " * vec4(_ro, 1.0)).xyz, (" + m_transform + " * vec4(_rd, 0.0)).xyz, _tmin, vec4(" + m_normal.m_x + ", " + m_normal.m_y + ", " + m_normal.m_z + ", " + m_normal.m_w + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+}
+
+std::string PlanePrimitiveDataModel::getDualShaderCode()
+{
+	if(m_transform == "")
+		return "sdPlaneD(_position, mat3(1.0), vec4(" + m_normal.m_x + ", " + m_normal.m_y + ", " + m_normal.m_z + ", " + m_normal.m_w + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+	else
+		return "sdPlaneD(vec3(" + m_transform + " * vec4(_position, 1.0)).xyz, mat3(" + m_transform + "), vec4(" + m_normal.m_x + ", " + m_normal.m_y + ", " + m_normal.m_z + ", " + m_normal.m_w + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+}
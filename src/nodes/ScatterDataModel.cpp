@@ -0,0 +1,290 @@
+#include <QtCore/QFileInfo>
+#include <QtGui/QDoubleValidator>
+#include <QtGui/QIntValidator>
+#include <QtWidgets/QFileDialog>
+#include "ScatterDataModel.hpp"
+#include "InstanceSources.hpp"
+#include "Numeric.hpp"
+#include "ScatterInstances.hpp"
+
+ScatterDataModel::ScatterDataModel() :
+  m_color(Vec4f("0.6", "0.6", "0.6", "1.0")),
+  m_source(new QComboBox),
+  m_spacing(new QLineEdit),
+  m_radius(new QLineEdit),
+  m_seed(new QLineEdit),
+  m_extent(new QLineEdit),
+  m_count(new QLineEdit),
+  m_path(new QLineEdit),
+  m_browse(new QPushButton("Browse")),
+  m_slot(-1)
+{
+  auto positive = new QDoubleValidator(0.001, 1000.0, 4);
+  positive->setLocale(QLocale("en_GB"));
+  auto seed = new QIntValidator(0, 1000000);
+  seed->setLocale(QLocale("en_GB"));
+  auto count = new QIntValidator(1, 1000000);
+  count->setLocale(QLocale("en_GB"));
+
+  int margin = 12;
+  int x = 0, y = 0;
+  int w = m_path->sizeHint().width();
+  int h = m_path->sizeHint().height();
+
+  m_source->addItems(QStringList() << "Surface" << "Grid" << "Random" << "CSV");
+  m_source->setGeometry(x, y, w, h);
+  m_source->setToolTip("Where the copies go");
+  connect(m_source, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, [this]() { valueEdit(""); });
+
+  QLineEdit *fields[5] = {m_spacing, m_radius, m_seed, m_extent, m_count};
+  QValidator *validators[5] = {positive, positive, seed, positive, count};
+  const char *defaults[5] = {"0.5", "0.5", "1", "5.0", "1000"};
+  const char *tips[5] = {"Smallest distance between two copies, or between the copies of the grid", "Radius around its origin the instance fits in",
+                         "Seed of the random points", "Half the side of the cube the surface or the random points are in",
+                         "Copies on the grid or at random points"};
+  for(int i = 0; i < 5; ++i)
+  {
+    fields[i]->setValidator(validators[i]);
+    fields[i]->setMaximumSize(fields[i]->sizeHint());
+    fields[i]->setGeometry(x, y + (h + margin)*(i + 1), w/3, h);
+    fields[i]->setText(defaults[i]);
+    fields[i]->setToolTip(tips[i]);
+    connect(fields[i], &QLineEdit::editingFinished, this, [this]() { valueEdit(""); });
+  }
+
+  m_path->setMaximumSize(m_path->sizeHint());
+  m_path->setGeometry(x, y + (h + margin)*6, w, h);
+  m_path->setPlaceholderText("CSV file");
+  connect(m_path, &QLineEdit::editingFinished, this, [this]() { valueEdit(""); });
+
+  m_browse->setGeometry(x, y + (h + margin)*7, m_browse->sizeHint().width(), h);
+  connect(m_browse, &QPushButton::clicked, this, &ScatterDataModel::browse);
+}
+
+void ScatterDataModel::save(Properties &p) const
+{
+  p.put("model_name", name());
+  p.put("source", m_source->currentIndex());
+  p.put("spacing", m_spacing->text());
+  p.put("radius", m_radius->text());
+  p.put("seed", m_seed->text());
+  p.put("extent", m_extent->text());
+  p.put("count", m_count->text());
+  p.put("path", m_path->text());
+}
+
+void ScatterDataModel::restore(const Properties &p)
+{
+  m_source->setCurrentIndex(p.values().value("source", 0).toInt());
+  m_spacing->setText(p.values().value("spacing", "0.5").toString());
+  m_radius->setText(p.values().value("radius", "0.5").toString());
+  m_seed->setText(p.values().value("seed", "1").toString());
+  m_extent->setText(p.values().value("extent", "5.0").toString());
+  m_count->setText(p.values().value("count", "1000").toString());
+  m_path->setText(p.values().value("path", "").toString());
+}
+
+void ScatterDataModel::valueEdit(QString const)
+{
+  emit dataUpdated(0);
+}
+
+void ScatterDataModel::browse()
+{
+  QString fileName = QFileDialog::getOpenFileName(nullptr, tr("Instances"), m_path->text(), tr("Transforms (*.csv *.txt)"));
+  if(fileName.isEmpty())
+    return;
+  m_path->setText(fileName);
+  m_source->setCurrentIndex(Source::CSV);
+  valueEdit("");
+}
+
+bool ScatterDataModel::transforms(std::vector<glm::mat4> &_transforms, std::string &_error) const
+{
+  unsigned int count, seed;
+  float spacing, extent;
+  switch(m_source->currentIndex())
+  {
+    case Source::GRID:
+      if(!hsitho::Numeric::parseUnsigned(m_count->text().toStdString(), count) ||
+         !hsitho::Numeric::parseFloat(m_spacing->text().toStdString(), spacing))
+        break;
+      hsitho::gridInstances(count, spacing, _transforms);
+      return true;
+    case Source::RANDOM:
+      if(!hsitho::Numeric::parseUnsigned(m_count->text().toStdString(), count) ||
+         !hsitho::Numeric::parseFloat(m_extent->text().toStdString(), extent) ||
+         !hsitho::Numeric::parseUnsigned(m_seed->text().toStdString(), seed))
+        break;
+      hsitho::randomInstances(count, extent, seed, _transforms);
+      return true;
+    case Source::CSV:
+      return hsitho::readInstances(m_path->text().toStdString(), _transforms, _error);
+    default:
+    break;
+  }
+  _error = "Invalid settings";
+  return false;
+}
+
+void ScatterDataModel::scatter(const std::string &_surface, const std::string &_instance,
+                               const std::vector<std::shared_ptr<const hsitho::sdf::DistanceVolume>> &_volumes,
+                               const std::vector<std::shared_ptr<const hsitho::sdf::InstanceSet>> &_sets, hsitho::ThreadPool &_pool)
+{
+  // The code refers to the resources by their slots, only the ones it uses are part of the field. Later slots are
+  // filled while the rest of the scene is generated and would make the same field look different on every visit
+  std::vector<const void *> resources;
+  std::string code = _surface + _instance;
+  for(size_t i = 0; i < _volumes.size(); ++i)
+  {
+    if(code.find("u_Volume" + std::to_string(i)) != std::string::npos)
+      resources.push_back(_volumes[i].get());
+  }
+  for(size_t i = 0; i < _sets.size(); ++i)
+  {
+    if(code.find("instances" + std::to_string(i) + "(") != std::string::npos)
+      resources.push_back(_sets[i].get());
+  }
+  Source source = static_cast<Source>(m_source->currentIndex());
+  QString settings = QString::number(source) + " " + m_spacing->text() + " " + m_radius->text() + " " + m_seed->text() + " " +
+                     m_extent->text() + " " + m_count->text();
+  if(source == Source::CSV)
+    settings += " " + m_path->text() + " " + QFileInfo(m_path->text()).lastModified().toString(Qt::ISODate);
+  ScatterKey key(source == Source::SURFACE ? _surface : "", _instance, settings, resources);
+  if(key == m_scattered)
+    return;
+  m_scattered = key;
+
+  m_instances.reset();
+  m_source->setToolTip("Where the copies go");
+  hsitho::ScatterSettings s;
+  unsigned int seed;
+  if(_instance.empty() || (source == Source::SURFACE && _surface.empty()) ||
+     !hsitho::Numeric::parseFloat(m_radius->text().toStdString(), s.m_radius))
+    return;
+
+  std::string error;
+  if(source == Source::SURFACE)
+  {
+    hsitho::ScatterStats stats;
+    if(hsitho::Numeric::parseFloat(m_spacing->text().toStdString(), s.m_spacing) &&
+       hsitho::Numeric::parseUnsigned(m_seed->text().toStdString(), seed) &&
+       hsitho::Numeric::parseFloat(m_extent->text().toStdString(), s.m_extent))
+    {
+      s.m_seed = seed;
+      m_instances = hsitho::scatterInstances(_surface, _instance, _volumes, _sets, s, _pool, error, &stats);
+    }
+    else
+      error = "Invalid settings";
+    if(m_instances)
+      m_source->setToolTip(QString("%1 copies over %2 surface cells, scattered in %3 ms")
+                           .arg(stats.m_points).arg(stats.m_surfaceCells).arg(stats.m_compileMs + stats.m_scatterMs, 0, 'f', 0));
+  }
+  else
+  {
+    std::vector<glm::mat4> transforms;
+    if(this->transforms(transforms, error))
+      m_instances = hsitho::makeInstances(_instance, _volumes, _sets, transforms, s.m_radius, error);
+    if(m_instances)
+      m_source->setToolTip(QString("%1 copies").arg(m_instances->size()));
+  }
+  if(m_instances)
+  {
+    glm::uvec3 cells = m_instances->cells();
+    m_source->setToolTip(m_source->toolTip() + QString(", grid of %1x%2x%3 cells").arg(cells.x).arg(cells.y).arg(cells.z));
+  }
+  else
+    m_source->setToolTip(QString::fromStdString(error));
+}
+
+unsigned int ScatterDataModel::nPorts(PortType portType) const
+{
+  unsigned int result = 1;
+
+  switch(portType)
+  {
+    case PortType::In:
+      result = 3;
+    break;
+
+    case PortType::Out:
+      result = 1;
+    break;
+
+    default:
+      break;
+  }
+
+  return result;
+}
+
+NodeDataType ScatterDataModel::dataType(PortType portType, PortIndex portIndex) const
+{
+  switch(portType)
+  {
+    case PortType::In:
+      switch(portIndex)
+      {
+        case 0:
+          return ColorData().type();
+        break;
+        case 1:
+          return NodeDataType {"DistanceFieldData", "Surface", Qt::green};
+        break;
+        case 2:
+          return NodeDataType {"DistanceFieldData", "Instance", Qt::green};
+        break;
+      }
+    break;
+    case PortType::Out:
+      return DistanceFieldOutput().type();
+    break;
+
+    default:
+      break;
+  }
+  return DistanceFieldOutput().type();
+}
+
+void ScatterDataModel::setInData(std::shared_ptr<NodeData> _data, PortIndex _portIndex)
+{
+  if(_portIndex != 0)
+    return;
+  auto cd = std::dynamic_pointer_cast<ColorData>(_data);
+  if(cd) {
+    m_color = cd->color();
+    return;
+  }
+  m_color = Vec4f("0.6", "0.6", "0.6", "1.0");
+}
+
+std::vector<QWidget *> ScatterDataModel::embeddedWidget()
+{
+  return std::vector<QWidget *>{m_source, m_spacing, m_radius, m_seed, m_extent, m_count, m_path, m_browse};
+}
+
+void ScatterDataModel::setTransform(const Mat4f &_t)
+{
+  std::ostringstream ss;
+  for(int y = 0; y < 4; ++y)
+  {
+    for(int x = 0; x < 4; ++x)
+    {
+      if(x || y)
+        ss << ", ";
+      ss << _t.matrix(x, y);
+    }
+  }
+  m_transform = "mat4x4(" + ss.str() + ")";
+}
+
+std::string ScatterDataModel::getShaderCode()
+{
+  std::string position = m_transform == "" ? "_position" : "vec3(" + m_transform + " * vec4(_position, 1.0)).xyz";
+  std::string color = "vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + ")";
+
+  // Still one distance function call without copies, the primitive ids count on it
+  if(!m_instances || m_slot < 0)
+    return "sdSphere(" + position + " - vec3(10000.0), 0.0, " + color + ")";
+  return "instances" + std::to_string(m_slot) + "(" + position + ", " + color + ")";
+}
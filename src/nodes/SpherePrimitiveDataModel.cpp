@@ -136,3 +136,19 @@ std::string SpherePrimitiveDataModel::getShaderCode()
 	else
 		return "sdSphere(vec3(" + m_transform + " * vec4(_position, 1.0)).xyz, " + m_size->text().toStdString() + ", vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
 }
+
+std::string SpherePrimitiveDataModel::getIntersectionCode()
+{
+	if(m_transform == "")
+		return "iSphere(_ro, _rd, _tmin, " + m_size->text().toStdString() + ", vec3(clamp(" + m_color.m_x + ", 0.0, 1.0), clamp(" + m_color.m_y + ", 0.0, 1.0), clamp(" + m_color.m_z + ", 0.0, 1.0)))";
+	else
+		return "iSphere((" + m_transform + " * vec4(_ro, 1.0)).xyz, (" + m_transform + " * vec4(_rd, 0.0)).xyz, _tmin, " + m_size->text().toStdString() + ", vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+}
+
+std::string SpherePrimitiveDataModel::getDualShaderCode()
+{
+	if(m_transform == "")
+		return "sdSphereD(_position, mat3(1.0), " + m_size->text().toStdString() + ", vec3(clamp(" + m_color.m_x + ", 0.0, 1.0), clamp(" + m_color.m_y + ", 0.0, 1.0), clamp(" + m_color.m_z + ", 0.0, 1.0)))";
+	else
+		return "sdSphereD(vec3(" + m_transform + " * vec4(_position, 1.0)).xyz, mat3(" + m_transform + "), " + m_size->text().toStdString() + ", vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+}
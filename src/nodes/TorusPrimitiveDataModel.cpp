@@ -168,3 +168,11 @@ std::string TorusPrimitiveDataModel::getShaderCode()
 	else
 		return "sdTorus(vec3(" + m_transform + " * vec4(_position, 1.0)).xyz, vec2(" + m_outerR->text().toStdString() + ", " + m_ringR->text().toStdString() + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
 }
+
+std::string TorusPrimitiveDataModel::getDualShaderCode()
+{
+	if(m_transform == "")
+		return "sdTorusD(_position, mat3(1.0), vec2(" + m_outerR->text().toStdString() + ", " + m_ringR->text().toStdString() + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+	else
+		return "sdTorusD(vec3(" + m_transform + " * vec4(_position, 1.0)).xyz, mat3(" + m_transform + "), vec2(" + m_outerR->text().toStdString() + ", " + m_ringR->text().toStdString() + "), vec3(" + m_color.m_x + ", " + m_color.m_y + ", " + m_color.m_z + "))";
+}
@@ -0,0 +1,88 @@
+#include <algorithm>
+
+#include "sdf/Evaluator.hpp"
+#include "sdf/Kernels.hpp"
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    Evaluator::Evaluator(std::shared_ptr<const Program> _program) :
+      m_program(_program),
+      m_registers(_program->m_registerCount, Lanes::broadcast(0.f))
+    {
+      setTime(0.f);
+    }
+
+    void Evaluator::setTime(float _time)
+    {
+      // The uniform part runs once on plain floats and is then copied to every lane
+      std::vector<float> uniforms(m_program->m_constants);
+      uniforms.resize(m_program->m_uniformCount, 0.f);
+      if(m_program->m_time != Program::c_none)
+        uniforms[m_program->m_time] = _time;
+      for(auto &ins : m_program->m_uniformCode)
+        kernels::execute(ins, uniforms.data(), m_program->m_operands.data());
+      for(size_t i = 0; i < uniforms.size(); ++i)
+        m_registers[i] = Lanes::broadcast(uniforms[i]);
+    }
+
+    void Evaluator::evaluateBatch(const float *_x, const float *_y, const float *_z, float *_out)
+    {
+      Lanes *r = m_registers.data();
+      const float *position[3] = {_x, _y, _z};
+      for(size_t i = 0; i < 3; ++i)
+      {
+        if(m_program->m_position[i] != Program::c_none)
+          r[m_program->m_position[i]] = Lanes::load(position[i]);
+      }
+
+      const uint32_t *operands = m_program->m_operands.data();
+      for(auto &ins : m_program->m_code)
+        kernels::execute(ins, r, operands, m_program.get());
+
+      for(size_t i = 0; i < 4; ++i)
+        r[m_program->m_result[i]].store(_out + i * Lanes::c_width);
+    }
+
+    void Evaluator::evaluate(const float *_x, const float *_y, const float *_z, size_t _count, float *_distance, float *_r, float *_g, float *_b)
+    {
+      HSITHO_PROFILE_SCOPE("sdf::Evaluator::evaluate");
+      float *channels[4] = {_distance, _r, _g, _b};
+      alignas(32) float out[4 * Lanes::c_width];
+      alignas(32) float padded[3][Lanes::c_width];
+
+      for(size_t first = 0; first < _count; first += Lanes::c_width)
+      {
+        size_t n = std::min(Lanes::c_width, _count - first);
+        if(n == Lanes::c_width)
+          evaluateBatch(_x + first, _y + first, _z + first, out);
+        else
+        {
+          // The last partial batch repeats its last point in the unused lanes
+          const float *source[3] = {_x, _y, _z};
+          for(size_t c = 0; c < 3; ++c)
+          {
+            for(size_t i = 0; i < Lanes::c_width; ++i)
+              padded[c][i] = source[c][first + std::min(i, n - 1)];
+          }
+          evaluateBatch(padded[0], padded[1], padded[2], out);
+        }
+
+        for(size_t c = 0; c < 4; ++c)
+        {
+          if(channels[c])
+            std::copy(out + c * Lanes::c_width, out + c * Lanes::c_width + n, channels[c] + first);
+        }
+      }
+    }
+
+    glm::vec4 Evaluator::evaluate(const glm::vec3 &_p)
+    {
+      glm::vec4 result;
+      evaluate(&_p.x, &_p.y, &_p.z, 1, &result.x, &result.y, &result.z, &result.w);
+      return result;
+    }
+  }
+}
@@ -0,0 +1,408 @@
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+
+#include "sdf/InstanceSet.hpp"
+#include "sdf/Kernels.hpp"
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    namespace
+    {
+      template<typename T> T splat(float _f);
+      template<> float splat<float>(float _f) { return _f; }
+      template<> Lanes splat<Lanes>(float _f) { return Lanes::broadcast(_f); }
+      template<> Interval splat<Interval>(float _f) { return Interval::point(_f); }
+
+      ///
+      /// \brief lowest Smallest value of every lane or of the interval
+      ///
+      float lowest(float _a) { return _a; }
+      float lowest(const Interval &_a) { return _a.m_lo; }
+      float lowest(const Lanes &_a)
+      {
+        alignas(32) float v[Lanes::c_width];
+        _a.store(v);
+        float result = v[0];
+        for(size_t i = 1; i < Lanes::c_width; ++i)
+          result = v[i] < result ? v[i] : result;
+        return result;
+      }
+
+      float highest(float _a) { return _a; }
+      float highest(const Interval &_a) { return _a.m_hi; }
+      float highest(const Lanes &_a)
+      {
+        alignas(32) float v[Lanes::c_width];
+        _a.store(v);
+        float result = v[0];
+        for(size_t i = 1; i < Lanes::c_width; ++i)
+          result = result < v[i] ? v[i] : result;
+        return result;
+      }
+
+      ///
+      /// \brief registers Register file of the subtree at a nesting depth, instances inside instances get the next one.
+      ///        Kept per thread so the evaluation doesn't allocate
+      ///
+      template<typename T>
+      std::vector<T> &registers(unsigned int _depth)
+      {
+        thread_local std::deque<std::vector<T>> files;
+        while(files.size() <= _depth)
+          files.emplace_back();
+        return files[_depth];
+      }
+
+      thread_local unsigned int t_depth = 0;
+
+      ///
+      /// \brief c_laneCells Cells around a batch of lanes above which the lanes are evaluated one by one, each lane on
+      ///        its own runs 27 cells and a batch runs its copies about as fast as a few lanes run them one by one
+      ///
+      constexpr size_t c_laneCells = 4 * 27;
+
+      ///
+      /// \brief largestStretch Largest singular value of the 3x3 part of the rows, by power iteration on its square
+      ///
+      float largestStretch(const glm::vec4 _rows[3])
+      {
+        // The rows go in as columns, the transpose stretches as much
+        glm::mat3 a = glm::mat3(glm::vec3(_rows[0]), glm::vec3(_rows[1]), glm::vec3(_rows[2]));
+        glm::mat3 ata = glm::transpose(a) * a;
+        glm::vec3 v = glm::normalize(glm::vec3(1.f, 0.7f, 0.3f));
+        float lambda = 0.f;
+        for(int i = 0; i < 32; ++i)
+        {
+          glm::vec3 w = ata * v;
+          float length = glm::length(w);
+          if(!(length > 0.f))
+            break;
+          lambda = length;
+          v = w / length;
+        }
+        return std::sqrt(lambda);
+      }
+    }
+
+    InstanceSet::InstanceSet(std::shared_ptr<const Program> _instance, const std::vector<glm::mat4> &_transforms, float _radius) :
+      m_instance(_instance),
+      m_transforms(_transforms),
+      m_radius(_radius),
+      m_maxRadius(0.f),
+      m_origin(0.f),
+      m_cellSize(1.f),
+      m_dims{1, 1, 1}
+    {
+      std::vector<glm::vec3> centres;
+      m_instances.reserve(_transforms.size());
+      centres.reserve(_transforms.size());
+      for(auto &t : _transforms)
+      {
+        glm::mat4 inverse = glm::inverse(t);
+        Instance instance;
+        for(int i = 0; i < 3; ++i)
+          instance.m_rows[i] = glm::vec4(inverse[0][i], inverse[1][i], inverse[2][i], inverse[3][i]);
+        // Power iteration creeps up on the largest stretch from below, the margin keeps the distances lower bounds
+        float stretch = largestStretch(instance.m_rows) * 1.0001f;
+        // A transform that flattens the copy has no inverse, the copy is left out
+        if(!(stretch > 0.f) || !std::isfinite(stretch))
+          continue;
+        instance.m_scale = 1.f / stretch;
+        glm::vec4 forward[3];
+        for(int i = 0; i < 3; ++i)
+          forward[i] = glm::vec4(t[0][i], t[1][i], t[2][i], t[3][i]);
+        m_maxRadius = std::max(m_maxRadius, m_radius * largestStretch(forward) * 1.0001f);
+        m_instances.push_back(instance);
+        centres.push_back(glm::vec3(t[3]));
+      }
+      buildGrid(centres);
+
+      if(m_instance->m_time == Program::c_none)
+      {
+        std::vector<float> scratch;
+        m_uniforms = uniforms(0.f, scratch);
+      }
+    }
+
+    void InstanceSet::buildGrid(const std::vector<glm::vec3> &_centres)
+    {
+      glm::vec3 lo(0.f), hi(0.f);
+      if(!_centres.empty())
+        lo = hi = _centres[0];
+      for(auto &c : _centres)
+      {
+        lo = glm::min(lo, c);
+        hi = glm::max(hi, c);
+      }
+      glm::vec3 extent = hi - lo;
+
+      // No narrower than the largest sphere across, so the cells around a point hold every copy that can reach it
+      // first, and about one copy per cell where the copies are further apart than that
+      double volume = static_cast<double>(extent.x) * extent.y * extent.z;
+      float size = std::max(2.f * m_maxRadius, static_cast<float>(std::cbrt(volume / std::max<size_t>(_centres.size(), 1))));
+      if(!(size > 0.f))
+        size = std::max(std::max(extent.x, std::max(extent.y, extent.z)) / 64.f, 1e-3f);
+      auto cells = [&](float _size)
+      {
+        double n = 1.0;
+        for(int a = 0; a < 3; ++a)
+          n *= std::floor(extent[a] / _size) + 1.0;
+        return n;
+      };
+      while(cells(size) > static_cast<double>(c_maxCells))
+        size *= 1.25f;
+
+      m_origin = lo;
+      m_cellSize = size;
+      for(int a = 0; a < 3; ++a)
+        m_dims[a] = static_cast<int>(std::floor(extent[a] / size)) + 1;
+      size_t count = static_cast<size_t>(m_dims[0]) * m_dims[1] * m_dims[2];
+
+      // Counting sort of the copies by cell
+      m_cells.assign(count, Cell{0, 0, 0.f});
+      std::vector<uint32_t> cellOf(_centres.size());
+      for(size_t i = 0; i < _centres.size(); ++i)
+      {
+        int c[3];
+        for(int a = 0; a < 3; ++a)
+          c[a] = std::min(static_cast<int>((_centres[i][a] - m_origin[a]) / size), m_dims[a] - 1);
+        cellOf[i] = static_cast<uint32_t>((c[2] * m_dims[1] + c[1]) * m_dims[0] + c[0]);
+        ++m_cells[cellOf[i]].m_count;
+      }
+      std::vector<uint32_t> next(count);
+      uint32_t first = 0;
+      for(size_t i = 0; i < count; ++i)
+      {
+        m_cells[i].m_first = next[i] = first;
+        first += m_cells[i].m_count;
+      }
+      std::vector<Instance> sorted(m_instances.size());
+      for(size_t i = 0; i < m_instances.size(); ++i)
+        sorted[next[cellOf[i]]++] = m_instances[i];
+      m_instances.swap(sorted);
+
+      // Breadth first from every cell with a copy over all 26 neighbours counts the cells to the nearest copy along the
+      // axis furthest from it. Without any copies the cells are as far as the 1e10 of an empty set
+      const float unreached = 1e10f;
+      std::vector<uint32_t> queue;
+      queue.reserve(count);
+      for(size_t i = 0; i < count; ++i)
+      {
+        m_cells[i].m_empty = m_cells[i].m_count ? 0.f : unreached;
+        if(m_cells[i].m_count)
+          queue.push_back(static_cast<uint32_t>(i));
+      }
+      for(size_t head = 0; head < queue.size(); ++head)
+      {
+        uint32_t c = queue[head];
+        int i = static_cast<int>(c % m_dims[0]), j = static_cast<int>(c / m_dims[0] % m_dims[1]), k = static_cast<int>(c / m_dims[0] / m_dims[1]);
+        for(int z = std::max(k - 1, 0); z <= std::min(k + 1, m_dims[2] - 1); ++z)
+          for(int y = std::max(j - 1, 0); y <= std::min(j + 1, m_dims[1] - 1); ++y)
+            for(int x = std::max(i - 1, 0); x <= std::min(i + 1, m_dims[0] - 1); ++x)
+            {
+              Cell &n = m_cells[(z * m_dims[1] + y) * m_dims[0] + x];
+              if(n.m_empty != unreached)
+                continue;
+              n.m_empty = m_cells[c].m_empty + 1.f;
+              queue.push_back(static_cast<uint32_t>((z * m_dims[1] + y) * m_dims[0] + x));
+            }
+      }
+
+      m_texels.clear();
+      m_texels.reserve(c_headerTexels + count + m_instances.size() * c_texelsPerInstance);
+      m_texels.push_back(glm::vec4(m_origin, m_cellSize));
+      m_texels.push_back(glm::vec4(static_cast<float>(m_dims[0]), static_cast<float>(m_dims[1]), static_cast<float>(m_dims[2]), m_maxRadius));
+      for(auto &cell : m_cells)
+        m_texels.push_back(glm::vec4(static_cast<float>(cell.m_first), static_cast<float>(cell.m_count), cell.m_empty, 0.f));
+      for(auto &instance : m_instances)
+      {
+        m_texels.insert(m_texels.end(), instance.m_rows, instance.m_rows + 3);
+        m_texels.push_back(glm::vec4(instance.m_scale, 0.f, 0.f, 0.f));
+      }
+    }
+
+    void InstanceSet::cellRange(float _lo, float _hi, int _axis, int &_first, int &_last) const
+    {
+      // Clamped before the conversion so far away points don't overflow, NaN goes below the grid
+      float a = (_lo - m_origin[_axis]) / m_cellSize;
+      float b = (_hi - m_origin[_axis]) / m_cellSize;
+      float beyond = static_cast<float>(m_dims[_axis]);
+      _first = static_cast<int>(std::floor(a >= -1.f ? std::min(a, beyond) : -1.f));
+      _last = static_cast<int>(std::floor(b >= -1.f ? std::min(b, beyond) : -1.f));
+    }
+
+    void InstanceSet::farBounds(const glm::vec3 &_lo, const glm::vec3 &_hi, float &_least, float &_most, float &_nearest) const
+    {
+      int first[3], last[3];
+      float outsideLeast = 0.f, outsideMost = 0.f;
+      for(int a = 0; a < 3; ++a)
+      {
+        cellRange(_lo[a], _hi[a], a, first[a], last[a]);
+        first[a] = std::max(std::min(first[a], m_dims[a] - 1), 0);
+        last[a] = std::max(std::min(last[a], m_dims[a] - 1), 0);
+        float end = m_origin[a] + m_dims[a] * m_cellSize;
+        float least = std::max(std::max(m_origin[a] - _hi[a], _lo[a] - end), 0.f);
+        float most = std::max(std::max(m_origin[a] - _lo[a], _hi[a] - end), 0.f);
+        outsideLeast += least * least;
+        outsideMost += most * most;
+      }
+
+      // A point outside the grid is at least as many cells from a copy as the cell of the grid it's nearest to
+      float fewest = std::numeric_limits<float>::max(), most = 0.f;
+      for(int k = first[2]; k <= last[2]; ++k)
+        for(int j = first[1]; j <= last[1]; ++j)
+          for(int i = first[0]; i <= last[0]; ++i)
+          {
+            float empty = m_cells[(k * m_dims[1] + j) * m_dims[0] + i].m_empty;
+            fewest = std::min(fewest, empty);
+            most = std::max(most, empty);
+          }
+      // A copy n cells away is at least n - 1 cells away, and the cells around are always visited
+      _nearest = fewest;
+      _least = std::max((std::max(fewest, 2.f) - 1.f) * m_cellSize, std::sqrt(outsideLeast)) - m_maxRadius;
+      _most = std::max((std::max(most, 2.f) - 1.f) * m_cellSize, std::sqrt(outsideMost)) - m_maxRadius;
+    }
+
+    float InstanceSet::far(float _x, float _y, float _z, float &_nearest) const
+    {
+      float least, most;
+      glm::vec3 p(_x, _y, _z);
+      farBounds(p, p, least, most, _nearest);
+      return least;
+    }
+
+    Lanes InstanceSet::far(const Lanes &_x, const Lanes &_y, const Lanes &_z, float &_nearest) const
+    {
+      alignas(32) float x[Lanes::c_width], y[Lanes::c_width], z[Lanes::c_width], bound[Lanes::c_width];
+      _x.store(x);
+      _y.store(y);
+      _z.store(z);
+      _nearest = std::numeric_limits<float>::max();
+      for(size_t i = 0; i < Lanes::c_width; ++i)
+      {
+        float nearest;
+        bound[i] = far(x[i], y[i], z[i], nearest);
+        _nearest = std::min(_nearest, nearest);
+      }
+      return Lanes::load(bound);
+    }
+
+    Interval InstanceSet::far(const Interval &_x, const Interval &_y, const Interval &_z, float &_nearest) const
+    {
+      Interval bound;
+      farBounds(glm::vec3(_x.m_lo, _y.m_lo, _z.m_lo), glm::vec3(_x.m_hi, _y.m_hi, _z.m_hi), bound.m_lo, bound.m_hi, _nearest);
+      return bound;
+    }
+
+    const std::vector<float> &InstanceSet::uniforms(float _time, std::vector<float> &_scratch) const
+    {
+      if(!m_uniforms.empty() || m_instance->m_uniformCount == 0)
+        return m_uniforms;
+      _scratch = m_instance->m_constants;
+      _scratch.resize(m_instance->m_uniformCount, 0.f);
+      if(m_instance->m_time != Program::c_none)
+        _scratch[m_instance->m_time] = _time;
+      for(auto &ins : m_instance->m_uniformCode)
+        kernels::execute(ins, _scratch.data(), m_instance->m_operands.data(), m_instance.get());
+      return _scratch;
+    }
+
+    template<typename T>
+    T InstanceSet::closest(const T &_x, const T &_y, const T &_z, float _time) const
+    {
+      if(m_instances.empty())
+        return splat<T>(1e10f);
+
+      // Copies outside the cells around the points are no closer than the bound, copies inside are only run if their
+      // spheres are closer than the closest so far
+      float nearest;
+      T best = far(_x, _y, _z, nearest);
+      if(nearest >= 2.f)
+        return best;
+      const T *position[3] = {&_x, &_y, &_z};
+      int first[3], last[3];
+      for(int a = 0; a < 3; ++a)
+      {
+        cellRange(lowest(*position[a]), highest(*position[a]), a, first[a], last[a]);
+        first[a] = std::max(first[a] - 1, 0);
+        last[a] = std::min(last[a] + 1, m_dims[a] - 1);
+      }
+
+      std::vector<float> scratch;
+      const std::vector<float> &u = uniforms(_time, scratch);
+      std::vector<T> &file = registers<T>(t_depth);
+      file.resize(m_instance->m_registerCount);
+      T *r = file.data();
+      for(size_t i = 0; i < u.size(); ++i)
+        r[i] = splat<T>(u[i]);
+
+      ++t_depth;
+      const uint32_t *operands = m_instance->m_operands.data();
+      const std::array<uint32_t, 3> &input = m_instance->m_position;
+      for(int k = first[2]; k <= last[2]; ++k)
+        for(int j = first[1]; j <= last[1]; ++j)
+          for(int i = first[0]; i <= last[0]; ++i)
+          {
+            const Cell &cell = m_cells[(k * m_dims[1] + j) * m_dims[0] + i];
+            for(uint32_t n = cell.m_first; n < cell.m_first + cell.m_count; ++n)
+            {
+              const Instance &instance = m_instances[n];
+              T q[3];
+              for(int c = 0; c < 3; ++c)
+                q[c] = _x * instance.m_rows[c].x + _y * instance.m_rows[c].y + _z * instance.m_rows[c].z + instance.m_rows[c].w;
+              // Nothing of the copy is nearer than its bounding sphere, once every lane has something closer it's skipped
+              if(lowest(kernels::length(q[0], q[1], q[2]) - m_radius) * instance.m_scale >= highest(best))
+                continue;
+
+              for(int c = 0; c < 3; ++c)
+              {
+                if(input[c] != Program::c_none)
+                  r[input[c]] = q[c];
+              }
+              for(auto &ins : m_instance->m_code)
+                kernels::execute(ins, r, operands, m_instance.get());
+              best = min(best, r[m_instance->m_result[0]] * instance.m_scale);
+            }
+          }
+      --t_depth;
+      return best;
+    }
+
+    float InstanceSet::distance(float _x, float _y, float _z, float _time) const
+    {
+      return closest(_x, _y, _z, _time);
+    }
+
+    Lanes InstanceSet::distance(const Lanes &_x, const Lanes &_y, const Lanes &_z, const Lanes &_time) const
+    {
+      // Lanes far apart would run every copy between them, one at a time they only run the copies around each
+      const Lanes *position[3] = {&_x, &_y, &_z};
+      size_t cells = 1;
+      for(int a = 0; a < 3; ++a)
+      {
+        int first, last;
+        cellRange(lowest(*position[a]), highest(*position[a]), a, first, last);
+        cells *= static_cast<size_t>(last - first + 3);
+      }
+      if(cells <= c_laneCells)
+        return closest(_x, _y, _z, lowest(_time));
+
+      alignas(32) float x[Lanes::c_width], y[Lanes::c_width], z[Lanes::c_width], d[Lanes::c_width];
+      _x.store(x);
+      _y.store(y);
+      _z.store(z);
+      for(size_t i = 0; i < Lanes::c_width; ++i)
+        d[i] = closest(x[i], y[i], z[i], lowest(_time));
+      return Lanes::load(d);
+    }
+
+    Interval InstanceSet::distance(const Interval &_x, const Interval &_y, const Interval &_z, const Interval &_time) const
+    {
+      return closest(_x, _y, _z, _time.m_lo);
+    }
+  }
+}
@@ -0,0 +1,43 @@
+#include <algorithm>
+
+#include "sdf/IntervalEvaluator.hpp"
+#include "sdf/Kernels.hpp"
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    IntervalEvaluator::IntervalEvaluator(std::shared_ptr<const Program> _program) :
+      m_program(_program),
+      m_registers(_program->m_registerCount, Interval::point(0.f))
+    {
+      setTime(0.f);
+    }
+
+    void IntervalEvaluator::setTimeRange(float _from, float _to)
+    {
+      // Unlike the Evaluator the uniform part runs on intervals as well, the time may be a range
+      for(size_t i = 0; i < m_program->m_constants.size(); ++i)
+        m_registers[i] = Interval::point(m_program->m_constants[i]);
+      if(m_program->m_time != Program::c_none)
+        m_registers[m_program->m_time] = Interval{std::min(_from, _to), std::max(_from, _to)};
+      for(auto &ins : m_program->m_uniformCode)
+        kernels::execute(ins, m_registers.data(), m_program->m_operands.data());
+    }
+
+    Interval IntervalEvaluator::evaluate(const glm::vec3 &_min, const glm::vec3 &_max)
+    {
+      Interval *r = m_registers.data();
+      for(int i = 0; i < 3; ++i)
+      {
+        if(m_program->m_position[i] != Program::c_none)
+          r[m_program->m_position[i]] = Interval{_min[i], _max[i]};
+      }
+
+      const uint32_t *operands = m_program->m_operands.data();
+      for(auto &ins : m_program->m_code)
+        kernels::execute(ins, r, operands, m_program.get());
+      return r[m_program->m_result[0]];
+    }
+  }
+}
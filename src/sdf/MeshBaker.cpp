@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "sdf/MeshBaker.hpp"
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    namespace
+    {
+      constexpr uint32_t c_maxResolution = 1024;
+      constexpr uint32_t c_none = 0xffffffff;
+    }
+
+    MeshBaker::MeshBaker(ThreadPool &_pool) :
+      m_pool(_pool),
+      m_bvh(nullptr),
+      m_normals(nullptr),
+      m_volume(nullptr),
+      m_spacing(0.f),
+      m_blocks(_pool.size()),
+      m_exactEvaluations(0),
+      m_windingQueries(0)
+    {
+    }
+
+    bool MeshBaker::bake(const TriangleBvh &_bvh, const std::vector<glm::vec3> &_normals, const Settings &_settings, DistanceVolume &_volume, std::string &_error)
+    {
+      HSITHO_PROFILE_SCOPE("sdf::MeshBaker::bake");
+      if(_bvh.triangleCount() == 0)
+      {
+        _error = "The mesh is empty";
+        return false;
+      }
+      if(_bvh.points() && _normals.size() != _bvh.triangleCount())
+      {
+        _error = "A point cloud needs a normal for every point to tell inside from outside";
+        return false;
+      }
+      if(_settings.m_resolution < 2 * _settings.m_padding + 2 || _settings.m_resolution > c_maxResolution)
+      {
+        _error = "The resolution must be between " + std::to_string(2 * _settings.m_padding + 2) + " and " + std::to_string(c_maxResolution);
+        return false;
+      }
+
+      // The grid is cubic, the longest side of the mesh sets the spacing and the other sides get as many points as they need
+      glm::vec3 extent = _bvh.max() - _bvh.min();
+      float longest = std::max(extent.x, std::max(extent.y, extent.z));
+      if(!(longest > 0.f))
+        longest = 1.f;
+      float spacing = longest / (_settings.m_resolution - 1 - 2 * _settings.m_padding);
+      uint32_t dims[3];
+      for(int a = 0; a < 3; ++a)
+        dims[a] = std::min(static_cast<uint32_t>(std::ceil(extent[a] / spacing)) + 1 + 2 * _settings.m_padding, _settings.m_resolution);
+      glm::vec3 half = 0.5f * spacing * glm::vec3(dims[0] - 1, dims[1] - 1, dims[2] - 1);
+      glm::vec3 centre = 0.5f * (_bvh.min() + _bvh.max());
+      _volume.resize(centre - half, centre + half, dims);
+
+      m_bvh = &_bvh;
+      m_normals = &_normals;
+      m_volume = &_volume;
+      m_spacing = _volume.spacing();
+      m_exactEvaluations = 0;
+      m_windingQueries = 0;
+
+      uint32_t blocks[3];
+      for(int a = 0; a < 3; ++a)
+        blocks[a] = (dims[a] - 1 + c_block - 1) / c_block;
+      for(auto &b : m_blocks)
+      {
+        b.m_values.resize(c_blockPoints * c_blockPoints * c_blockPoints);
+        b.m_exact = 0;
+        b.m_windings = 0;
+      }
+      m_pool.parallelFor(static_cast<size_t>(blocks[0]) * blocks[1] * blocks[2], [&](size_t _index, unsigned int _worker) {
+        uint32_t bi = static_cast<uint32_t>(_index % blocks[0]);
+        uint32_t bj = static_cast<uint32_t>(_index / blocks[0] % blocks[1]);
+        uint32_t bk = static_cast<uint32_t>(_index / blocks[0] / blocks[1]);
+        bakeBlock(bi, bj, bk, m_blocks[_worker]);
+      });
+      for(auto &b : m_blocks)
+      {
+        m_exactEvaluations += b.m_exact;
+        m_windingQueries += b.m_windings;
+      }
+      return true;
+    }
+
+    void MeshBaker::bakeBlock(uint32_t _bi, uint32_t _bj, uint32_t _bk, Block &_block)
+    {
+      const uint32_t b[3] = {_bi, _bj, _bk};
+      for(int a = 0; a < 3; ++a)
+      {
+        _block.m_origin[a] = b[a] * c_block;
+        _block.m_end[a] = std::min(_block.m_origin[a] + c_block, m_volume->m_dims[a] - 1);
+      }
+      std::fill(_block.m_values.begin(), _block.m_values.end(), std::numeric_limits<float>::quiet_NaN());
+      _block.m_hasLast = false;
+      refine(_block, 0, 0, 0, c_block, nullptr);
+
+      // Points on the faces between blocks are written by the block before, the last block of a row writes its far face
+      uint32_t last[3];
+      for(int a = 0; a < 3; ++a)
+      {
+        uint32_t n = _block.m_end[a] - _block.m_origin[a];
+        last[a] = _block.m_end[a] == m_volume->m_dims[a] - 1 ? n : n - 1;
+      }
+      for(uint32_t k = 0; k <= last[2]; ++k)
+        for(uint32_t j = 0; j <= last[1]; ++j)
+          for(uint32_t i = 0; i <= last[0]; ++i)
+            m_volume->set(_block.m_origin[0] + i, _block.m_origin[1] + j, _block.m_origin[2] + k, local(_block, i, j, k));
+    }
+
+    void MeshBaker::refine(Block &_block, uint32_t _i, uint32_t _j, uint32_t _k, uint32_t _size, const glm::uvec3 *_hint)
+    {
+      const uint32_t limit[3] = {_block.m_end[0] - _block.m_origin[0], _block.m_end[1] - _block.m_origin[1], _block.m_end[2] - _block.m_origin[2]};
+      if(_i >= limit[0] || _j >= limit[1] || _k >= limit[2])
+        return;
+
+      glm::uvec3 lo(_i, _j, _k);
+      bool clipped = _i + _size > limit[0] || _j + _size > limit[1] || _k + _size > limit[2];
+      if(!clipped)
+      {
+        float corners[8];
+        float nearest = std::numeric_limits<float>::max();
+        bool inside = false, outside = false;
+        corners[0] = evaluate(_block, _i, _j, _k, _hint);
+        for(uint32_t c = 0; c < 8; ++c)
+        {
+          if(c > 0)
+            corners[c] = evaluate(_block, _i + (c & 1) * _size, _j + ((c >> 1) & 1) * _size, _k + (c >> 2) * _size, &lo);
+          nearest = std::min(nearest, std::abs(corners[c]));
+          (corners[c] < 0.f ? inside : outside) = true;
+        }
+        if(_size == 1)
+          return;
+
+        // Nothing in the cell is nearer to the surface than its nearest corner less half its diagonal. The distance to a
+        // surface bends by at most 1 / distance, which the interpolation of the corners can overshoot by 3 h^2 / 8 over
+        // the edge h of the cell, taking that off keeps the filled points below the true distance
+        float edge = _size * std::max(m_spacing.x, std::max(m_spacing.y, m_spacing.z));
+        const float sqrt3 = std::sqrt(3.f);
+        if(inside != outside && nearest >= sqrt3 * edge)
+        {
+          float sign = inside ? -1.f : 1.f;
+          float correction = 3.f * edge * edge / (8.f * (nearest - 0.5f * sqrt3 * edge));
+          float scale = 1.f / _size;
+          for(uint32_t k = 0; k <= _size; ++k)
+            for(uint32_t j = 0; j <= _size; ++j)
+              for(uint32_t i = 0; i <= _size; ++i)
+              {
+                float &v = local(_block, _i + i, _j + j, _k + k);
+                if(!std::isnan(v))
+                  continue;
+                float tx = i * scale, ty = j * scale, tz = k * scale;
+                float c00 = corners[0] + (corners[1] - corners[0]) * tx;
+                float c10 = corners[2] + (corners[3] - corners[2]) * tx;
+                float c01 = corners[4] + (corners[5] - corners[4]) * tx;
+                float c11 = corners[6] + (corners[7] - corners[6]) * tx;
+                float c0 = c00 + (c10 - c00) * ty;
+                float c1 = c01 + (c11 - c01) * ty;
+                v = sign * (std::abs(c0 + (c1 - c0) * tz) - correction);
+              }
+          return;
+        }
+      }
+
+      uint32_t half = _size / 2;
+      const glm::uvec3 *hint = clipped ? _hint : &lo;
+      for(uint32_t c = 0; c < 8; ++c)
+        refine(_block, _i + (c & 1) * half, _j + ((c >> 1) & 1) * half, _k + (c >> 2) * half, half, hint);
+    }
+
+    float MeshBaker::evaluate(Block &_block, uint32_t _i, uint32_t _j, uint32_t _k, const glm::uvec3 *_hint)
+    {
+      float &v = local(_block, _i, _j, _k);
+      if(!std::isnan(v))
+        return v;
+
+      glm::vec3 p = m_volume->point(_block.m_origin[0] + _i, _block.m_origin[1] + _j, _block.m_origin[2] + _k);
+      // The closest point of the previous point is on the surface, so it bounds the distance of this one and skips
+      // whatever of the tree is further away
+      float bound = std::numeric_limits<float>::infinity();
+      if(_block.m_hasLast)
+      {
+        float b = glm::length(p - _block.m_lastClosest) * 1.0001f + 1e-6f;
+        bound = b * b;
+      }
+      uint32_t triangle = c_none;
+      glm::vec3 q = m_bvh->closest(p, bound, triangle);
+      if(triangle == c_none)
+      {
+        bound = std::numeric_limits<float>::infinity();
+        q = m_bvh->closest(p, bound, triangle);
+      }
+      float distance = std::sqrt(bound);
+      _block.m_lastClosest = q;
+      _block.m_hasLast = true;
+      ++_block.m_exact;
+
+      if(m_bvh->points())
+      {
+        // The surface through the points is somewhere between the tangent plane of the closest one and the point itself
+        glm::vec3 n = (*m_normals)[m_bvh->original(triangle)];
+        float length = glm::length(n);
+        float along = length > 0.f ? glm::dot(p - q, n) / length : distance;
+        float spacing = std::max(m_spacing.x, std::max(m_spacing.y, m_spacing.z));
+        v = std::max(std::abs(along), distance - spacing);
+        v = along < 0.f ? -v : v;
+        return v;
+      }
+
+      // A point further from the hint than the hint is from the surface is on the same side
+      bool inside;
+      float h = _hint ? local(_block, _hint->x, _hint->y, _hint->z) : std::numeric_limits<float>::quiet_NaN();
+      if(!std::isnan(h) && std::abs(h) > glm::length(p - m_volume->point(_block.m_origin[0] + _hint->x, _block.m_origin[1] + _hint->y, _block.m_origin[2] + _hint->z)))
+        inside = h < 0.f;
+      else
+      {
+        inside = m_bvh->winding(p) >= 0.5f;
+        ++_block.m_windings;
+      }
+      v = inside ? -distance : distance;
+      return v;
+    }
+  }
+}
@@ -0,0 +1,658 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "sdf/Mesher.hpp"
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    namespace
+    {
+      constexpr size_t c_chunk = 4096;
+      constexpr unsigned int c_bits = 20;
+      constexpr uint64_t c_mask = (uint64_t(1) << c_bits) - 1;
+
+      ///
+      /// \brief pack Key of a cell or a corner, sorting the keys sorts by z, then y, then x
+      ///
+      uint64_t pack(uint32_t _i, uint32_t _j, uint32_t _k)
+      {
+        return (uint64_t(_k) << (2 * c_bits)) | (uint64_t(_j) << c_bits) | _i;
+      }
+
+      void unpack(uint64_t _key, uint32_t &_i, uint32_t &_j, uint32_t &_k)
+      {
+        _i = static_cast<uint32_t>(_key & c_mask);
+        _j = static_cast<uint32_t>((_key >> c_bits) & c_mask);
+        _k = static_cast<uint32_t>(_key >> (2 * c_bits));
+      }
+
+      ///
+      /// \brief offset Offset of corner _c of a cell, bit 0 is x, bit 1 y and bit 2 z
+      ///
+      glm::vec3 offset(unsigned int _c)
+      {
+        return glm::vec3(_c & 1, (_c >> 1) & 1, (_c >> 2) & 1);
+      }
+
+      ///
+      /// \brief crossing Where the surface crosses the edge between two corners, always interpolated from the same end so
+      ///        that the cells sharing the edge agree on the point exactly
+      ///
+      glm::vec3 crossing(const glm::vec3 &_a, const glm::vec3 &_b, float _va, float _vb)
+      {
+        float t = _va / (_va - _vb);
+        return _a + (_b - _a) * t;
+      }
+
+      ///
+      /// \brief eigen Jacobi eigen decomposition of a symmetric 3x3 matrix, _m is left with the eigenvalues on its diagonal
+      ///        and the columns of _v are the eigenvectors
+      ///
+      void eigen(float _m[3][3], float _v[3][3])
+      {
+        for(int i = 0; i < 3; ++i)
+          for(int j = 0; j < 3; ++j)
+            _v[i][j] = i == j ? 1.f : 0.f;
+
+        for(int sweep = 0; sweep < 8; ++sweep)
+        {
+          for(int p = 0; p < 2; ++p)
+          {
+            for(int q = p + 1; q < 3; ++q)
+            {
+              if(std::fabs(_m[p][q]) < 1e-12f)
+                continue;
+              float theta = (_m[q][q] - _m[p][p]) / (2.f * _m[p][q]);
+              float t = (theta >= 0.f ? 1.f : -1.f) / (std::fabs(theta) + std::sqrt(theta * theta + 1.f));
+              float c = 1.f / std::sqrt(t * t + 1.f);
+              float s = t * c;
+              for(int k = 0; k < 3; ++k)
+              {
+                float mkp = _m[k][p], mkq = _m[k][q];
+                _m[k][p] = c * mkp - s * mkq;
+                _m[k][q] = s * mkp + c * mkq;
+              }
+              for(int k = 0; k < 3; ++k)
+              {
+                float mpk = _m[p][k], mqk = _m[q][k];
+                _m[p][k] = c * mpk - s * mqk;
+                _m[q][k] = s * mpk + c * mqk;
+              }
+              for(int k = 0; k < 3; ++k)
+              {
+                float vkp = _v[k][p], vkq = _v[k][q];
+                _v[k][p] = c * vkp - s * vkq;
+                _v[k][q] = s * vkp + c * vkq;
+              }
+            }
+          }
+        }
+      }
+
+      ///
+      /// \brief solveQef Point closest to all the tangent planes through the crossings, the directions the planes don't
+      ///        constrain are left at the mass point so flat areas get evenly spaced vertices and edges and corners stay sharp
+      ///
+      glm::vec3 solveQef(const glm::vec3 *_points, const glm::vec3 *_normals, size_t _count)
+      {
+        glm::vec3 mass(0.f);
+        for(size_t i = 0; i < _count; ++i)
+          mass += _points[i];
+        mass /= static_cast<float>(_count);
+
+        float ata[3][3] = {{0.f, 0.f, 0.f}, {0.f, 0.f, 0.f}, {0.f, 0.f, 0.f}};
+        glm::vec3 atb(0.f);
+        for(size_t i = 0; i < _count; ++i)
+        {
+          const glm::vec3 &n = _normals[i];
+          float b = glm::dot(n, _points[i] - mass);
+          for(int r = 0; r < 3; ++r)
+          {
+            for(int c = 0; c < 3; ++c)
+              ata[r][c] += n[r] * n[c];
+            atb[r] += n[r] * b;
+          }
+        }
+
+        float v[3][3];
+        eigen(ata, v);
+        float largest = std::max({std::fabs(ata[0][0]), std::fabs(ata[1][1]), std::fabs(ata[2][2])});
+        glm::vec3 x(0.f);
+        for(int e = 0; e < 3; ++e)
+        {
+          // Truncated pseudo inverse, V diag(1/l) V^T atb
+          if(std::fabs(ata[e][e]) < 0.1f * largest || largest == 0.f)
+            continue;
+          float projection = v[0][e] * atb[0] + v[1][e] * atb[1] + v[2][e] * atb[2];
+          for(int r = 0; r < 3; ++r)
+            x[r] += v[r][e] * projection / ata[e][e];
+        }
+        return mass + x;
+      }
+    }
+
+    ///
+    /// \brief Batch Points gathered for the evaluator by one task
+    ///
+    struct Mesher::Batch
+    {
+      std::vector<float> m_x;
+      std::vector<float> m_y;
+      std::vector<float> m_z;
+      std::vector<float> m_distance;
+      std::vector<float> m_r;
+      std::vector<float> m_g;
+      std::vector<float> m_b;
+
+      void push(const glm::vec3 &_p)
+      {
+        m_x.push_back(_p.x);
+        m_y.push_back(_p.y);
+        m_z.push_back(_p.z);
+      }
+
+      void evaluate(Evaluator &_evaluator, std::atomic<size_t> &_count, bool _colour = false)
+      {
+        size_t n = m_x.size();
+        m_distance.resize(n);
+        if(_colour)
+        {
+          m_r.resize(n);
+          m_g.resize(n);
+          m_b.resize(n);
+        }
+        _evaluator.evaluate(m_x.data(), m_y.data(), m_z.data(), n, m_distance.data(),
+                            _colour ? m_r.data() : nullptr, _colour ? m_g.data() : nullptr, _colour ? m_b.data() : nullptr);
+        _count += n;
+      }
+    };
+
+    Mesher::Mesher(std::shared_ptr<const Program> _program, ThreadPool &_pool) :
+      m_program(_program),
+      m_pool(_pool),
+      m_cellSize(0.f),
+      m_dims{0, 0, 0},
+      m_evaluations(0),
+      m_traversalMs(0.0)
+    {
+      for(unsigned int i = 0; i < m_pool.size(); ++i)
+      {
+        m_evaluators.emplace_back(new Evaluator(m_program));
+        m_intervalEvaluators.emplace_back(new IntervalEvaluator(m_program));
+      }
+    }
+
+    void Mesher::setTime(float _time)
+    {
+      for(auto &e : m_evaluators)
+        e->setTime(_time);
+      for(auto &e : m_intervalEvaluators)
+        e->setTime(_time);
+    }
+
+    glm::vec3 Mesher::corner(uint32_t _i, uint32_t _j, uint32_t _k) const
+    {
+      return m_settings.m_min + glm::vec3(_i, _j, _k) * m_cellSize;
+    }
+
+    bool Mesher::extract(const Settings &_settings, Mesh &_mesh, std::string &_error)
+    {
+      HSITHO_PROFILE_SCOPE("Mesher::extract");
+      glm::vec3 extent = _settings.m_max - _settings.m_min;
+      if(_settings.m_depth < 1 || _settings.m_depth > c_maxDepth)
+      {
+        _error = "The depth has to be between 1 and " + std::to_string(c_maxDepth);
+        return false;
+      }
+      if(!(extent.x > 0.f && extent.y > 0.f && extent.z > 0.f) || !(_settings.m_lipschitz >= 1.f))
+      {
+        _error = "Empty bounds or a Lipschitz bound below 1";
+        return false;
+      }
+
+      m_settings = _settings;
+      m_evaluations = 0;
+      m_cellsPerLevel.clear();
+      uint32_t cells = 1u << m_settings.m_depth;
+      m_cellSize = std::max(extent.x, std::max(extent.y, extent.z)) / cells;
+      for(int a = 0; a < 3; ++a)
+        m_dims[a] = std::min(cells, std::max(1u, static_cast<uint32_t>(std::ceil(extent[a] / m_cellSize))));
+
+      _mesh = Mesh();
+      std::vector<uint64_t> leaves;
+      auto start = std::chrono::steady_clock::now();
+      findSurfaceCells(leaves);
+      m_traversalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      if(m_settings.m_method == Method::DUAL_CONTOURING)
+        dualContouring(leaves, _mesh);
+      else
+        marchingTetrahedra(leaves, _mesh);
+
+      if(_mesh.m_positions.size() >= 0xffffffffu)
+      {
+        _error = "Too many vertices for 32-bit indices, lower the depth";
+        _mesh = Mesh();
+        return false;
+      }
+      colour(_mesh);
+      return true;
+    }
+
+    void Mesher::findSurfaceCells(std::vector<uint64_t> &_leaves)
+    {
+      HSITHO_PROFILE_SCOPE("Mesher::findSurfaceCells");
+      std::vector<uint64_t> level(1, pack(0, 0, 0));
+      for(unsigned int l = 0; l <= m_settings.m_depth; ++l)
+      {
+        m_cellsPerLevel.push_back(level.size());
+        // Side of a cell of this level in cells of the finest one
+        uint32_t scale = 1u << (m_settings.m_depth - l);
+        float size = m_cellSize * scale;
+        float bound = 0.5f * std::sqrt(3.f) * size * m_settings.m_lipschitz;
+        bool leaf = l == m_settings.m_depth;
+
+        size_t chunks = (level.size() + c_chunk - 1) / c_chunk;
+        std::vector<std::vector<uint64_t>> next(chunks);
+        m_pool.parallelFor(chunks, [&](size_t _chunk, unsigned int _worker) {
+          size_t first = _chunk * c_chunk;
+          size_t last = std::min(level.size(), first + c_chunk);
+          std::vector<bool> keep(last - first);
+          if(m_settings.m_pruning == Pruning::INTERVAL)
+          {
+            IntervalEvaluator &evaluator = *m_intervalEvaluators[_worker];
+            for(size_t c = first; c < last; ++c)
+            {
+              uint32_t i, j, k;
+              unpack(level[c], i, j, k);
+              glm::vec3 lo = m_settings.m_min + glm::vec3(i, j, k) * size;
+              keep[c - first] = evaluator.evaluate(lo, lo + glm::vec3(size)).contains(0.f);
+            }
+            m_evaluations += last - first;
+          }
+          else
+          {
+            Batch batch;
+            for(size_t c = first; c < last; ++c)
+            {
+              uint32_t i, j, k;
+              unpack(level[c], i, j, k);
+              batch.push(m_settings.m_min + (glm::vec3(i, j, k) + glm::vec3(0.5f)) * size);
+            }
+            batch.evaluate(*m_evaluators[_worker], m_evaluations);
+            for(size_t c = first; c < last; ++c)
+              keep[c - first] = std::fabs(batch.m_distance[c - first]) <= bound;
+          }
+
+          for(size_t c = first; c < last; ++c)
+          {
+            if(!keep[c - first])
+              continue;
+            if(leaf)
+            {
+              next[_chunk].push_back(level[c]);
+              continue;
+            }
+            uint32_t i, j, k;
+            unpack(level[c], i, j, k);
+            uint32_t half = scale / 2;
+            for(unsigned int child = 0; child < 8; ++child)
+            {
+              uint32_t ci = i * 2 + (child & 1), cj = j * 2 + ((child >> 1) & 1), ck = k * 2 + ((child >> 2) & 1);
+              // Children completely outside the bounds are never created
+              if(ci * half < m_dims[0] && cj * half < m_dims[1] && ck * half < m_dims[2])
+                next[_chunk].push_back(pack(ci, cj, ck));
+            }
+          }
+        });
+
+        level.clear();
+        size_t total = 0;
+        for(auto &n : next)
+          total += n.size();
+        level.reserve(total);
+        for(auto &n : next)
+          level.insert(level.end(), n.begin(), n.end());
+      }
+      m_cellsPerLevel.push_back(level.size());
+      std::sort(level.begin(), level.end());
+      _leaves.swap(level);
+    }
+
+    void Mesher::cornerValues(const std::vector<uint64_t> &_leaves, std::vector<float> &_values)
+    {
+      HSITHO_PROFILE_SCOPE("Mesher::cornerValues");
+      _values.resize(_leaves.size() * 8);
+      size_t chunks = (_leaves.size() + c_chunk - 1) / c_chunk;
+      m_pool.parallelFor(chunks, [&](size_t _chunk, unsigned int _worker) {
+        size_t first = _chunk * c_chunk;
+        size_t last = std::min(_leaves.size(), first + c_chunk);
+        Batch batch;
+        for(size_t c = first; c < last; ++c)
+        {
+          uint32_t i, j, k;
+          unpack(_leaves[c], i, j, k);
+          for(unsigned int v = 0; v < 8; ++v)
+            batch.push(corner(i + (v & 1), j + ((v >> 1) & 1), k + ((v >> 2) & 1)));
+        }
+        batch.evaluate(*m_evaluators[_worker], m_evaluations);
+        std::copy(batch.m_distance.begin(), batch.m_distance.end(), _values.begin() + first * 8);
+      });
+    }
+
+    void Mesher::dualContouring(const std::vector<uint64_t> &_leaves, Mesh &_mesh)
+    {
+      HSITHO_PROFILE_SCOPE("Mesher::dualContouring");
+      std::vector<float> values;
+      cornerValues(_leaves, values);
+
+      // Inside corners of every cell, one vertex per cell the surface crosses
+      std::vector<uint8_t> masks(_leaves.size());
+      std::vector<glm::vec3> vertices(_leaves.size());
+      float h = std::max(m_cellSize * 0.05f, 1e-4f);
+      const glm::vec3 tetrahedron[4] = {glm::vec3(h, -h, -h), glm::vec3(-h, -h, h), glm::vec3(-h, h, -h), glm::vec3(h, h, h)};
+
+      size_t chunks = (_leaves.size() + c_chunk - 1) / c_chunk;
+      m_pool.parallelFor(chunks, [&](size_t _chunk, unsigned int _worker) {
+        size_t first = _chunk * c_chunk;
+        size_t last = std::min(_leaves.size(), first + c_chunk);
+        std::vector<glm::vec3> points;
+        std::vector<uint8_t> pointCount;
+        for(size_t c = first; c < last; ++c)
+        {
+          const float *v = &values[c * 8];
+          uint8_t mask = 0;
+          for(unsigned int i = 0; i < 8; ++i)
+            mask |= (v[i] < 0.f ? 1 : 0) << i;
+          masks[c] = mask;
+          pointCount.push_back(0);
+          if(mask == 0 || mask == 0xff)
+            continue;
+
+          uint32_t i, j, k;
+          unpack(_leaves[c], i, j, k);
+          glm::vec3 base = corner(i, j, k);
+          for(unsigned int axis = 1; axis < 8; axis <<= 1)
+          {
+            for(unsigned int a = 0; a < 8; ++a)
+            {
+              unsigned int b = a | axis;
+              if((a & axis) || ((mask >> a) & 1) == ((mask >> b) & 1))
+                continue;
+              points.push_back(crossing(base + offset(a) * m_cellSize, base + offset(b) * m_cellSize, v[a], v[b]));
+              ++pointCount.back();
+            }
+          }
+        }
+
+        // The normals at the crossings from the same four samples calcNormal uses
+        Batch batch;
+        for(auto &p : points)
+          for(auto &o : tetrahedron)
+            batch.push(p + o);
+        batch.evaluate(*m_evaluators[_worker], m_evaluations);
+        std::vector<glm::vec3> normals(points.size());
+        for(size_t p = 0; p < points.size(); ++p)
+        {
+          glm::vec3 n(0.f);
+          for(size_t o = 0; o < 4; ++o)
+            n += tetrahedron[o] * batch.m_distance[p * 4 + o];
+          float length = glm::length(n);
+          normals[p] = length > 0.f ? n / length : glm::vec3(0.f);
+        }
+
+        size_t p = 0;
+        for(size_t c = first; c < last; ++c)
+        {
+          size_t count = pointCount[c - first];
+          if(count == 0)
+            continue;
+          uint32_t i, j, k;
+          unpack(_leaves[c], i, j, k);
+          glm::vec3 lo = corner(i, j, k);
+          glm::vec3 vertex = solveQef(&points[p], &normals[p], count);
+          // Keep the vertex in its cell, the QEF can run away where the planes are nearly parallel
+          vertices[c] = glm::clamp(vertex, lo, lo + glm::vec3(m_cellSize));
+          p += count;
+        }
+      });
+
+      std::vector<uint32_t> index(_leaves.size(), 0xffffffffu);
+      for(size_t c = 0; c < _leaves.size(); ++c)
+      {
+        if(masks[c] != 0 && masks[c] != 0xff)
+        {
+          index[c] = static_cast<uint32_t>(_mesh.m_positions.size());
+          _mesh.m_positions.push_back(vertices[c]);
+        }
+      }
+
+      // A quad around every edge the surface crosses, each cell takes the three edges leaving its first corner.
+      // The other cells around the edge are listed counter-clockwise around the axis so the quad faces along it
+      auto find = [&](int64_t _i, int64_t _j, int64_t _k) {
+        if(_i < 0 || _j < 0 || _k < 0)
+          return 0xffffffffu;
+        auto it = std::lower_bound(_leaves.begin(), _leaves.end(), pack(static_cast<uint32_t>(_i), static_cast<uint32_t>(_j), static_cast<uint32_t>(_k)));
+        if(it == _leaves.end() || *it != pack(static_cast<uint32_t>(_i), static_cast<uint32_t>(_j), static_cast<uint32_t>(_k)))
+          return 0xffffffffu;
+        return index[it - _leaves.begin()];
+      };
+      std::vector<std::vector<uint32_t>> triangles(chunks);
+      m_pool.parallelFor(chunks, [&](size_t _chunk, unsigned int) {
+        size_t first = _chunk * c_chunk;
+        size_t last = std::min(_leaves.size(), first + c_chunk);
+        for(size_t c = first; c < last; ++c)
+        {
+          uint8_t mask = masks[c];
+          if(mask == 0 || mask == 0xff)
+            continue;
+          uint32_t ui, uj, uk;
+          unpack(_leaves[c], ui, uj, uk);
+          int64_t i = ui, j = uj, k = uk;
+          for(unsigned int axis = 0; axis < 3; ++axis)
+          {
+            bool inside = mask & 1;
+            if(inside == static_cast<bool>((mask >> (1u << axis)) & 1))
+              continue;
+            uint32_t quad[4];
+            if(axis == 0)
+            {
+              quad[0] = index[c]; quad[1] = find(i, j - 1, k); quad[2] = find(i, j - 1, k - 1); quad[3] = find(i, j, k - 1);
+            }
+            else if(axis == 1)
+            {
+              quad[0] = index[c]; quad[1] = find(i, j, k - 1); quad[2] = find(i - 1, j, k - 1); quad[3] = find(i - 1, j, k);
+            }
+            else
+            {
+              quad[0] = index[c]; quad[1] = find(i - 1, j, k); quad[2] = find(i - 1, j - 1, k); quad[3] = find(i, j - 1, k);
+            }
+            // Edges on the border of the bounds are missing some of their cells
+            if(quad[1] == 0xffffffffu || quad[2] == 0xffffffffu || quad[3] == 0xffffffffu)
+              continue;
+            // The quad faces along the axis, which is outwards when the edge starts inside
+            if(!inside)
+              std::swap(quad[1], quad[3]);
+            std::vector<uint32_t> &t = triangles[_chunk];
+            t.insert(t.end(), {quad[0], quad[1], quad[2], quad[0], quad[2], quad[3]});
+          }
+        }
+      });
+      for(auto &t : triangles)
+        _mesh.m_indices.insert(_mesh.m_indices.end(), t.begin(), t.end());
+    }
+
+    void Mesher::marchingTetrahedra(const std::vector<uint64_t> &_leaves, Mesh &_mesh)
+    {
+      HSITHO_PROFILE_SCOPE("Mesher::marchingTetrahedra");
+      std::vector<float> values;
+      cornerValues(_leaves, values);
+
+      // Freudenthal split along the 0-7 diagonal, neighbouring cells split their shared faces the same way. The corners
+      // of each tetrahedron are nested bit sets, so every edge runs from a corner to one with more bits set
+      static const unsigned int tetrahedra[6][4] = {
+        {0, 1, 3, 7}, {0, 2, 3, 7}, {0, 2, 6, 7}, {0, 4, 6, 7}, {0, 4, 5, 7}, {0, 1, 5, 7}
+      };
+
+      struct EdgePoint
+      {
+        uint64_t m_key;
+        glm::vec3 m_position;
+      };
+      size_t chunks = (_leaves.size() + c_chunk - 1) / c_chunk;
+      std::vector<std::vector<EdgePoint>> points(chunks);
+      std::vector<std::vector<uint64_t>> keys(chunks);
+      m_pool.parallelFor(chunks, [&](size_t _chunk, unsigned int) {
+        size_t first = _chunk * c_chunk;
+        size_t last = std::min(_leaves.size(), first + c_chunk);
+        for(size_t c = first; c < last; ++c)
+        {
+          const float *v = &values[c * 8];
+          uint32_t i, j, k;
+          unpack(_leaves[c], i, j, k);
+          glm::vec3 base = corner(i, j, k);
+
+          // An edge is identified by its lower corner on the finest grid and the offset to the other one
+          auto edge = [&](unsigned int _a, unsigned int _b) {
+            if(_a > _b)
+              std::swap(_a, _b);
+            uint64_t key = (pack(i + (_a & 1), j + ((_a >> 1) & 1), k + ((_a >> 2) & 1)) << 3) | (_a ^ _b);
+            points[_chunk].push_back(EdgePoint{key, crossing(base + offset(_a) * m_cellSize, base + offset(_b) * m_cellSize, v[_a], v[_b])});
+            return points[_chunk].back();
+          };
+
+          for(auto &tet : tetrahedra)
+          {
+            unsigned int in[4], out[4], nIn = 0, nOut = 0;
+            for(unsigned int t = 0; t < 4; ++t)
+            {
+              if(v[tet[t]] < 0.f)
+                in[nIn++] = tet[t];
+              else
+                out[nOut++] = tet[t];
+            }
+            if(nIn == 0 || nOut == 0)
+              continue;
+
+            glm::vec3 inCentre(0.f), outCentre(0.f);
+            for(unsigned int t = 0; t < nIn; ++t)
+              inCentre += offset(in[t]) / static_cast<float>(nIn);
+            for(unsigned int t = 0; t < nOut; ++t)
+              outCentre += offset(out[t]) / static_cast<float>(nOut);
+
+            EdgePoint e[4];
+            unsigned int n;
+            if(nIn == 1 || nOut == 1)
+            {
+              unsigned int lone = nIn == 1 ? in[0] : out[0];
+              const unsigned int *others = nIn == 1 ? out : in;
+              for(unsigned int t = 0; t < 3; ++t)
+                e[t] = edge(lone, others[t]);
+              n = 3;
+            }
+            else
+            {
+              e[0] = edge(in[0], out[0]);
+              e[1] = edge(in[0], out[1]);
+              e[2] = edge(in[1], out[1]);
+              e[3] = edge(in[1], out[0]);
+              n = 4;
+            }
+
+            // Wind the polygon so it faces from the inside corners to the outside ones
+            glm::vec3 normal = glm::cross(e[1].m_position - e[0].m_position, e[2].m_position - e[0].m_position);
+            bool flip = glm::dot(normal, outCentre - inCentre) < 0.f;
+            std::vector<uint64_t> &t = keys[_chunk];
+            for(unsigned int f = 0; f + 2 < n; ++f)
+            {
+              if(flip)
+                t.insert(t.end(), {e[0].m_key, e[f + 2].m_key, e[f + 1].m_key});
+              else
+                t.insert(t.end(), {e[0].m_key, e[f + 1].m_key, e[f + 2].m_key});
+            }
+          }
+        }
+      });
+
+      // Every edge becomes one vertex however many cells and tetrahedra share it
+      std::vector<EdgePoint> all;
+      size_t total = 0;
+      for(auto &p : points)
+        total += p.size();
+      all.reserve(total);
+      for(auto &p : points)
+      {
+        all.insert(all.end(), p.begin(), p.end());
+        std::vector<EdgePoint>().swap(p);
+      }
+      std::sort(all.begin(), all.end(), [](const EdgePoint &_a, const EdgePoint &_b) { return _a.m_key < _b.m_key; });
+      all.erase(std::unique(all.begin(), all.end(), [](const EdgePoint &_a, const EdgePoint &_b) { return _a.m_key == _b.m_key; }), all.end());
+
+      std::vector<uint64_t> vertexKeys(all.size());
+      _mesh.m_positions.resize(all.size());
+      for(size_t i = 0; i < all.size(); ++i)
+      {
+        vertexKeys[i] = all[i].m_key;
+        _mesh.m_positions[i] = all[i].m_position;
+      }
+      std::vector<EdgePoint>().swap(all);
+
+      std::vector<size_t> offsets(chunks + 1, 0);
+      for(size_t c = 0; c < chunks; ++c)
+        offsets[c + 1] = offsets[c] + keys[c].size();
+      _mesh.m_indices.resize(offsets.back());
+      m_pool.parallelFor(chunks, [&](size_t _chunk, unsigned int) {
+        for(size_t t = 0; t < keys[_chunk].size(); ++t)
+        {
+          auto it = std::lower_bound(vertexKeys.begin(), vertexKeys.end(), keys[_chunk][t]);
+          _mesh.m_indices[offsets[_chunk] + t] = static_cast<uint32_t>(it - vertexKeys.begin());
+        }
+      });
+    }
+
+    size_t Mesher::boundaryEdges(const Mesh &_mesh)
+    {
+      std::vector<uint64_t> edges;
+      edges.reserve(_mesh.m_indices.size());
+      for(size_t t = 0; t + 2 < _mesh.m_indices.size(); t += 3)
+      {
+        for(size_t e = 0; e < 3; ++e)
+        {
+          uint64_t a = _mesh.m_indices[t + e], b = _mesh.m_indices[t + (e + 1) % 3];
+          edges.push_back(std::min(a, b) << 32 | std::max(a, b));
+        }
+      }
+      std::sort(edges.begin(), edges.end());
+      size_t boundary = 0;
+      for(size_t i = 0; i < edges.size();)
+      {
+        size_t j = i;
+        while(j < edges.size() && edges[j] == edges[i])
+          ++j;
+        boundary += j - i != 2;
+        i = j;
+      }
+      return boundary;
+    }
+
+    void Mesher::colour(Mesh &_mesh)
+    {
+      HSITHO_PROFILE_SCOPE("Mesher::colour");
+      _mesh.m_colors.resize(_mesh.m_positions.size());
+      size_t chunks = (_mesh.m_positions.size() + c_chunk - 1) / c_chunk;
+      m_pool.parallelFor(chunks, [&](size_t _chunk, unsigned int _worker) {
+        size_t first = _chunk * c_chunk;
+        size_t last = std::min(_mesh.m_positions.size(), first + c_chunk);
+        Batch batch;
+        for(size_t v = first; v < last; ++v)
+          batch.push(_mesh.m_positions[v]);
+        batch.evaluate(*m_evaluators[_worker], m_evaluations, true);
+        for(size_t v = first; v < last; ++v)
+          _mesh.m_colors[v] = glm::vec3(batch.m_r[v - first], batch.m_g[v - first], batch.m_b[v - first]);
+      });
+    }
+  }
+}
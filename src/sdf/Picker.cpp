@@ -0,0 +1,318 @@
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "sdf/Kernels.hpp"
+#include "sdf/Picker.hpp"
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    namespace
+    {
+      // castRay of shader.end, with more steps since a pick is a single ray
+      constexpr float c_tracePrecision = 0.01f;
+      constexpr size_t c_maxSteps = 512;
+      ///
+      /// \brief c_leafInstructions Tapes this short are traced rather than refined further, running them on intervals
+      ///        would cost more than it saves
+      ///
+      constexpr size_t c_leafInstructions = 32;
+
+      ///
+      /// \brief clip Narrows [_t0, _t1] to the part of the ray inside a box
+      ///
+      bool clip(const glm::vec3 &_origin, const glm::vec3 &_inverse, const glm::vec3 &_min, const glm::vec3 &_max, float &_t0, float &_t1)
+      {
+        for(int i = 0; i < 3; ++i)
+        {
+          float a = (_min[i] - _origin[i]) * _inverse[i];
+          float b = (_max[i] - _origin[i]) * _inverse[i];
+          if(b < a)
+            std::swap(a, b);
+          // A ray parallel to the slab and starting on its plane gives NaN, which leaves the range as it is
+          _t0 = std::max(_t0, a);
+          _t1 = std::min(_t1, b);
+        }
+        return _t0 < _t1;
+      }
+
+      void childBox(int _child, const glm::vec3 &_min, const glm::vec3 &_max, glm::vec3 &_lo, glm::vec3 &_hi)
+      {
+        glm::vec3 mid = 0.5f * (_min + _max);
+        for(int i = 0; i < 3; ++i)
+        {
+          bool upper = (_child >> i) & 1;
+          _lo[i] = upper ? mid[i] : _min[i];
+          _hi[i] = upper ? _max[i] : mid[i];
+        }
+      }
+    }
+
+    Picker::Picker(std::shared_ptr<const Program> _program, const Settings &_settings) :
+      m_program(_program),
+      m_settings(_settings),
+      m_time(0.f),
+      m_registers(_program->m_registerCount, 0.f),
+      m_intervals(_program->m_registerCount, Interval::point(0.f)),
+      m_live(_program->m_registerCount, 0),
+      m_origin(0.f),
+      m_direction(0.f, 0.f, 1.f),
+      m_inverse(1.f),
+      m_steps(0),
+      m_instructions(0)
+    {
+      setTime(0.f);
+    }
+
+    void Picker::setTime(float _time)
+    {
+      bool changed = _time != m_time && m_program->m_time != Program::c_none;
+      m_time = _time;
+      for(size_t i = 0; i < m_program->m_constants.size(); ++i)
+        m_registers[i] = m_program->m_constants[i];
+      if(m_program->m_time != Program::c_none)
+        m_registers[m_program->m_time] = _time;
+      for(auto &ins : m_program->m_uniformCode)
+        kernels::execute(ins, m_registers.data(), m_program->m_operands.data());
+      for(uint32_t i = 0; i < m_program->m_uniformCount; ++i)
+        m_intervals[i] = Interval::point(m_registers[i]);
+
+      // The shortened tapes only hold for the values the uniforms had when they were made
+      if(changed || m_cells.empty())
+        reset();
+    }
+
+    void Picker::reset()
+    {
+      m_tapes.clear();
+      m_cells.clear();
+      m_tapes.push_back(Tape{m_program->m_code, m_program->m_operands});
+      m_cells.push_back(Cell{Program::c_none, Program::c_none, false});
+    }
+
+    uint32_t Picker::shorten(uint32_t _tape, const glm::vec3 &_min, const glm::vec3 &_max, Interval &_range)
+    {
+      const Tape &tape = m_tapes[_tape];
+      Interval *r = m_intervals.data();
+      for(int i = 0; i < 3; ++i)
+      {
+        if(m_program->m_position[i] != Program::c_none)
+          r[m_program->m_position[i]] = Interval{_min[i], _max[i]};
+      }
+
+      // Which side every select and min or max takes over the whole box, if it's always the same one
+      m_choices.resize(tape.m_code.size());
+      for(size_t i = 0; i < tape.m_code.size(); ++i)
+      {
+        const Instruction &ins = tape.m_code[i];
+        const uint32_t *o = tape.m_operands.data() + ins.m_first;
+        int choice = -1;
+        switch(ins.m_op)
+        {
+          case Op::SELECT_LE:
+            if(r[o[0]].m_hi <= r[o[1]].m_lo)
+              choice = 2;
+            else if(r[o[1]].m_hi < r[o[0]].m_lo)
+              choice = 3;
+          break;
+          case Op::MIN:
+            if(r[o[0]].m_hi <= r[o[1]].m_lo)
+              choice = 0;
+            else if(r[o[1]].m_hi <= r[o[0]].m_lo)
+              choice = 1;
+          break;
+          case Op::MAX:
+            if(r[o[0]].m_hi <= r[o[1]].m_lo)
+              choice = 1;
+            else if(r[o[1]].m_hi <= r[o[0]].m_lo)
+              choice = 0;
+          break;
+          // Blends away from the other side clamp their weight to 0 or 1, which then mixes in only one side
+          case Op::CLAMP:
+            if(r[o[0]].m_hi <= r[o[1]].m_lo)
+              choice = 1;
+            else if(r[o[2]].m_hi <= r[o[0]].m_lo)
+              choice = 2;
+          break;
+          case Op::MIX:
+            if(r[o[2]].m_lo == 0.f && r[o[2]].m_hi == 0.f)
+              choice = 0;
+            else if(r[o[2]].m_lo == 1.f && r[o[2]].m_hi == 1.f)
+              choice = 1;
+          break;
+          default:
+          break;
+        }
+        m_choices[i] = choice;
+        kernels::execute(ins, r, tape.m_operands.data(), m_program.get());
+      }
+      m_instructions += tape.m_code.size();
+      _range = r[m_program->m_result[0]];
+
+      // Walk back from the distance and the id keeping only what they still read, the registers are reused within the
+      // program so liveness is tracked per register from the end
+      std::fill(m_live.begin(), m_live.end(), 0);
+      m_live[m_program->m_result[0]] = 1;
+      m_live[m_program->m_result[1]] = 1;
+      Tape shortened;
+      for(size_t i = tape.m_code.size(); i-- > 0;)
+      {
+        const Instruction &ins = tape.m_code[i];
+        const uint32_t *o = tape.m_operands.data() + ins.m_first;
+        if(!m_live[ins.m_dst])
+          continue;
+        m_live[ins.m_dst] = 0;
+        if(m_choices[i] >= 0)
+        {
+          uint32_t source = o[m_choices[i]];
+          m_live[source] = 1;
+          if(source != ins.m_dst)
+          {
+            shortened.m_code.push_back(Instruction{Op::COPY, ins.m_dst, static_cast<uint32_t>(shortened.m_operands.size())});
+            shortened.m_operands.push_back(source);
+          }
+          continue;
+        }
+        shortened.m_code.push_back(Instruction{ins.m_op, ins.m_dst, static_cast<uint32_t>(shortened.m_operands.size())});
+        for(unsigned int j = 0; j < operandCount(ins.m_op); ++j)
+        {
+          m_live[o[j]] = 1;
+          shortened.m_operands.push_back(o[j]);
+        }
+      }
+
+      // A tape of the same length may still have swapped selects for copies, but it's no cheaper and the parent's holds
+      if(shortened.m_code.size() >= tape.m_code.size())
+        return _tape;
+      std::reverse(shortened.m_code.begin(), shortened.m_code.end());
+      m_tapes.push_back(std::move(shortened));
+      return static_cast<uint32_t>(m_tapes.size() - 1);
+    }
+
+    bool Picker::traverse(uint32_t _cell, uint32_t _parentTape, const glm::vec3 &_min, const glm::vec3 &_max, unsigned int _depth, float _t0, float _t1, float &_t, Hit &_hit)
+    {
+      if(_t >= _t1)
+        return false;
+      // Cells are only run on intervals once a ray reaches them, most children of a cell are never visited
+      if(m_cells[_cell].m_tape == Program::c_none)
+      {
+        Interval range;
+        m_cells[_cell].m_tape = shorten(_parentTape, _min, _max, range);
+        m_cells[_cell].m_empty = range.m_lo > c_tracePrecision;
+      }
+      if(m_cells[_cell].m_empty)
+        return false;
+      uint32_t tape = m_cells[_cell].m_tape;
+      if(_depth == m_settings.m_depth || m_tapes[tape].m_code.size() <= c_leafInstructions)
+      {
+        _t = std::max(_t, _t0);
+        return march(tape, _t, _t1, _hit);
+      }
+
+      if(m_cells[_cell].m_children == Program::c_none)
+      {
+        m_cells[_cell].m_children = static_cast<uint32_t>(m_cells.size());
+        m_cells.resize(m_cells.size() + 8, Cell{Program::c_none, Program::c_none, false});
+      }
+      uint32_t first = m_cells[_cell].m_children;
+
+      // The children the ray passes through, in the order it enters them
+      std::pair<float, int> order[8];
+      float exits[8];
+      int count = 0;
+      for(int c = 0; c < 8; ++c)
+      {
+        glm::vec3 lo, hi;
+        childBox(c, _min, _max, lo, hi);
+        float t0 = _t0, t1 = _t1;
+        if(clip(m_origin, m_inverse, lo, hi, t0, t1))
+        {
+          order[count++] = std::make_pair(t0, c);
+          exits[c] = t1;
+        }
+      }
+      std::sort(order, order + count);
+      for(int k = 0; k < count; ++k)
+      {
+        int c = order[k].second;
+        glm::vec3 lo, hi;
+        childBox(c, _min, _max, lo, hi);
+        if(traverse(first + c, tape, lo, hi, _depth + 1, order[k].first, exits[c], _t, _hit))
+          return true;
+      }
+      return false;
+    }
+
+    bool Picker::march(uint32_t _tape, float &_t, float _t1, Hit &_hit)
+    {
+      const Tape &tape = m_tapes[_tape];
+      float *r = m_registers.data();
+      while(_t < _t1 && m_steps < c_maxSteps)
+      {
+        glm::vec3 p = m_origin + _t * m_direction;
+        for(int i = 0; i < 3; ++i)
+        {
+          if(m_program->m_position[i] != Program::c_none)
+            r[m_program->m_position[i]] = p[i];
+        }
+        for(auto &ins : tape.m_code)
+          kernels::execute(ins, r, tape.m_operands.data(), m_program.get());
+        ++m_steps;
+        m_instructions += tape.m_code.size();
+
+        float d = r[m_program->m_result[0]];
+        if(d <= c_tracePrecision)
+        {
+          float id = r[m_program->m_result[1]];
+          _hit.m_hit = true;
+          _hit.m_t = _t;
+          _hit.m_position = p;
+          _hit.m_primitive = id >= 0.f ? static_cast<uint32_t>(id + 0.5f) : Program::c_none;
+          return true;
+        }
+        _t += d;
+      }
+      return false;
+    }
+
+    Picker::Hit Picker::pick(const glm::vec3 &_origin, const glm::vec3 &_direction)
+    {
+      HSITHO_PROFILE_SCOPE("sdf::Picker::pick");
+      m_steps = 0;
+      m_instructions = 0;
+      if(m_cells.size() > c_maxCells)
+        reset();
+      m_origin = _origin;
+      m_direction = _direction;
+      m_inverse = 1.f / _direction;
+
+      Hit hit;
+      float t = c_tmin;
+      float t0 = c_tmin, t1 = c_tmax;
+      // Outside the bounds there are no cells, the whole program is traced there
+      if(clip(m_origin, m_inverse, m_settings.m_min, m_settings.m_max, t0, t1))
+      {
+        if(march(0, t, t0, hit) || traverse(0, 0, m_settings.m_min, m_settings.m_max, 0, t0, t1, t, hit))
+          return hit;
+        t = std::max(t, t1);
+      }
+      march(0, t, c_tmax, hit);
+      return hit;
+    }
+
+    glm::vec3 Picker::cameraRay(const glm::vec3 &_eye, const glm::vec3 &_up, float _x, float _y, int _w, int _h)
+    {
+      glm::vec3 direction = glm::normalize(-_eye);
+      glm::vec3 rayUp = glm::normalize(_up - direction * glm::dot(direction, _up));
+      glm::vec3 right = glm::cross(direction, rayUp);
+      float tanHalf = std::tan(90.f * 3.1415f / 180.f / 2.f);
+      float aspect = static_cast<float>(_w) / _h;
+      // The screen quad runs its x coordinate from right to left and y from bottom to top, see Raymarcher::renderTile
+      glm::vec2 uv = glm::vec2((_w - _x) / _w, (_h - _y) / _h) * 2.f - glm::vec2(1.f);
+      return glm::normalize(direction + tanHalf * right * uv.x + tanHalf / aspect * rayUp * uv.y);
+    }
+  }
+}
@@ -0,0 +1,401 @@
+#include <algorithm>
+#include <cmath>
+
+#include "nodeEditor/NodeDataModel.hpp"
+#include "nodes/LightDataModel.hpp"
+#include "sdf/Raymarcher.hpp"
+#include "sdf/SceneCompiler.hpp"
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    namespace
+    {
+      // Constants of shader.end
+      constexpr int c_tileSize = 16;
+      constexpr int c_marchSteps = 64;
+      constexpr int c_shadowSteps = 16;
+      constexpr float c_tracePrecision = 0.01f;
+      constexpr float c_tmax = 20.f;
+      constexpr float c_miss = 1e10f;
+      constexpr float c_normalOffset = 0.0005f;
+
+      glm::vec3 sky(const glm::vec3 &_dir)
+      {
+        glm::vec3 col = 0.9f * glm::vec3(0.4f, 0.65f, 1.0f) - _dir.y * glm::vec3(0.4f, 0.36f, 0.4f);
+        float sun = glm::clamp(glm::dot(glm::normalize(glm::vec3(2.0f, 2.5f, 2.0f)), _dir), 0.f, 1.f);
+        return col + 0.6f * glm::vec3(1.0f, 0.6f, 0.3f) * std::pow(sun, 32.f);
+      }
+
+      ///
+      /// \brief compileVec4 Evaluates four GLSL expressions, the parameters of the light nodes can be any expression
+      ///
+      bool compileVec4(const std::string &_x, const std::string &_y, const std::string &_z, const std::string &_w, float _time, glm::vec4 &_v, std::string &_error)
+      {
+        std::string source = "vec4 map(vec3 _position)\n{\n  return vec4(" + _x + ", " + _y + ", " + _z + ", " + _w + ");\n}\n";
+        std::shared_ptr<Program> program = SceneCompiler::compileMap(source, _error);
+        if(!program)
+          return false;
+        Evaluator evaluator(program);
+        evaluator.setTime(_time);
+        _v = evaluator.evaluate(glm::vec3(0.f));
+        return true;
+      }
+    }
+
+    ///
+    /// \brief Packet Scratch memory of a worker, everything is indexed by the ray's position in the tile except the
+    ///        coordinates gathered for the evaluator
+    ///
+    struct Raymarcher::Packet
+    {
+      std::vector<glm::vec3> m_dir;
+      std::vector<glm::vec2> m_screen;
+      std::vector<float> m_t;
+      std::vector<float> m_d;
+      std::vector<glm::vec3> m_albedo;
+      std::vector<glm::vec3> m_position;
+      std::vector<glm::vec3> m_normal;
+      std::vector<glm::vec3> m_reflection;
+      std::vector<float> m_occlusion;
+      std::vector<glm::vec3> m_shade;
+      std::vector<float> m_shadow;
+      std::vector<float> m_shadowT;
+      std::vector<uint32_t> m_rays;
+      std::vector<uint32_t> m_next;
+      std::vector<uint32_t> m_hits;
+      std::vector<float> m_x;
+      std::vector<float> m_y;
+      std::vector<float> m_z;
+      std::vector<float> m_distance;
+      std::vector<float> m_r;
+      std::vector<float> m_g;
+      std::vector<float> m_b;
+
+      void resize(size_t _rays)
+      {
+        for(auto v : {&m_dir, &m_albedo, &m_position, &m_normal, &m_reflection, &m_shade})
+          v->resize(_rays);
+        for(auto v : {&m_t, &m_d, &m_occlusion, &m_shadow, &m_shadowT})
+          v->resize(_rays);
+        m_screen.resize(_rays);
+        // Occlusion evaluates five points per ray at once
+        for(auto v : {&m_x, &m_y, &m_z, &m_distance, &m_r, &m_g, &m_b})
+          v->resize(_rays * 5);
+        m_rays.reserve(_rays);
+        m_next.reserve(_rays);
+        m_hits.reserve(_rays);
+      }
+
+      void gather(size_t _i, const glm::vec3 &_p)
+      {
+        m_x[_i] = _p.x;
+        m_y[_i] = _p.y;
+        m_z[_i] = _p.z;
+      }
+    };
+
+    Raymarcher::Raymarcher(std::shared_ptr<const Program> _program, ThreadPool &_pool) :
+      m_program(_program),
+      m_pool(_pool),
+      m_lights(defaultLights()),
+      m_eye(glm::vec3(0.f, 0.132164f, 0.991228f) * 15.f),
+      m_up(0.f, 1.f, 0.f),
+      m_evaluations(0)
+    {
+      for(unsigned int i = 0; i < m_pool.size(); ++i)
+      {
+        m_evaluators.emplace_back(new Evaluator(m_program));
+        m_packets.emplace_back(new Packet());
+        m_packets.back()->resize(c_tileSize * c_tileSize);
+      }
+    }
+
+    Raymarcher::~Raymarcher()
+    {
+    }
+
+    void Raymarcher::setTime(float _time)
+    {
+      for(auto &e : m_evaluators)
+        e->setTime(_time);
+    }
+
+    void Raymarcher::setLights(const std::vector<Light> &_lights)
+    {
+      m_lights = _lights.empty() ? defaultLights() : _lights;
+    }
+
+    std::vector<Light> Raymarcher::defaultLights()
+    {
+      // Lights[4] of shader.begin, only the sun has a specular highlight in the default rig
+      std::vector<Light> lights(4);
+      lights[0].m_position = glm::vec3(2.0f, 2.5f, 2.0f);
+      lights[0].m_diffuse = glm::vec3(1.0f, 0.8f, 0.55f);
+      lights[1].m_position = glm::vec3(-2.0f, 5.5f, -1.0f);
+      lights[1].m_diffuse = glm::vec3(0.78f, 0.88f, 1.0f);
+      lights[1].m_intensity = 0.5f;
+      lights[2].m_position = glm::vec3(-1.0f, 5.5f, 2.0f);
+      lights[2].m_diffuse = glm::vec3(1.0f, 0.88f, 0.78f);
+      lights[2].m_intensity = 0.5f;
+      lights[3].m_position = glm::vec3(0.0f, -5.5f, 0.0f);
+      lights[3].m_diffuse = glm::vec3(1.0f, 0.88f, 0.78f);
+      for(size_t i = 1; i < lights.size(); ++i)
+        lights[i].m_specular = glm::vec3(0.f);
+      return lights;
+    }
+
+    bool Raymarcher::sceneLights(const std::unordered_map<QUuid, std::shared_ptr<Node>> &_nodes, float _time, std::vector<Light> &_lights, std::string &_error)
+    {
+      // Sorted by id like ShaderGenerator::generateLights
+      std::vector<std::pair<QUuid, LightDataModel *>> nodes;
+      for(auto &node : _nodes)
+      {
+        if(node.second->nodeDataModel()->getNodeType() != DFNodeType::LIGHT)
+          continue;
+        LightDataModel *light = dynamic_cast<LightDataModel *>(node.second->nodeDataModel());
+        if(light && light->isEnabled())
+          nodes.push_back(std::make_pair(node.first, light));
+      }
+      std::sort(nodes.begin(), nodes.end(), [](const std::pair<QUuid, LightDataModel *> &_a, const std::pair<QUuid, LightDataModel *> &_b) { return _a.first < _b.first; });
+
+      _lights.clear();
+      for(auto &node : nodes)
+      {
+        const Vec4f &p = node.second->getPosition();
+        const Vec4f &c = node.second->getColor();
+        glm::vec4 position, color;
+        if(!compileVec4(p.m_x, p.m_y, p.m_z, node.second->getIntensity(), _time, position, _error) ||
+           !compileVec4(c.m_x, c.m_y, c.m_z, "0.0", _time, color, _error))
+        {
+          _error = "Couldn't evaluate the parameters of a light: " + _error;
+          return false;
+        }
+        Light light;
+        light.m_position = glm::vec3(position);
+        light.m_intensity = position.w;
+        light.m_diffuse = glm::vec3(color);
+        light.m_shadow = node.second->castsShadow();
+        _lights.push_back(light);
+      }
+      return true;
+    }
+
+    bool Raymarcher::render(int _w, int _h, std::vector<float> &_rgba)
+    {
+      if(_w <= 0 || _h <= 0)
+        return false;
+      HSITHO_PROFILE_SCOPE("Raymarcher::render");
+      _rgba.resize(static_cast<size_t>(_w) * _h * 4);
+      m_evaluations = 0;
+
+      int tilesX = (_w + c_tileSize - 1) / c_tileSize;
+      int tilesY = (_h + c_tileSize - 1) / c_tileSize;
+      float *rgba = _rgba.data();
+      m_pool.parallelFor(static_cast<size_t>(tilesX) * tilesY, [&](size_t _tile, unsigned int _worker) {
+        int x = static_cast<int>(_tile % tilesX) * c_tileSize;
+        int y = static_cast<int>(_tile / tilesX) * c_tileSize;
+        renderTile(x, y, std::min(c_tileSize, _w - x), std::min(c_tileSize, _h - y), _w, _h, rgba, _worker);
+      });
+      return true;
+    }
+
+    void Raymarcher::renderTile(int _x, int _y, int _w, int _h, int _imageW, int _imageH, float *_rgba, unsigned int _worker)
+    {
+      HSITHO_PROFILE_SCOPE("Raymarcher::renderTile");
+      Evaluator &evaluator = *m_evaluators[_worker];
+      Packet &p = *m_packets[_worker];
+      size_t evaluations = 0;
+      auto evaluate = [&](size_t _count, bool _colour) {
+        evaluator.evaluate(p.m_x.data(), p.m_y.data(), p.m_z.data(), _count, p.m_distance.data(),
+                           _colour ? p.m_r.data() : nullptr, _colour ? p.m_g.data() : nullptr, _colour ? p.m_b.data() : nullptr);
+        evaluations += _count;
+      };
+
+      // createRay with a 90 degree field of view looking at the origin
+      glm::vec3 direction = glm::normalize(-m_eye);
+      glm::vec3 rayUp = glm::normalize(m_up - direction * glm::dot(direction, m_up));
+      glm::vec3 right = glm::cross(direction, rayUp);
+      float tanHalf = std::tan(90.f * 3.1415f / 180.f / 2.f);
+      float aspect = static_cast<float>(_imageW) / _imageH;
+
+      size_t count = static_cast<size_t>(_w) * _h;
+      p.m_rays.clear();
+      for(size_t i = 0; i < count; ++i)
+      {
+        // The screen quad runs its x coordinate from right to left and y from bottom to top, see OffscreenRenderer::renderTile
+        int px = _x + static_cast<int>(i % _w);
+        int row = _y + static_cast<int>(i / _w);
+        glm::vec2 screen((_imageW - px - 0.5f) / _imageW, (_imageH - row - 0.5f) / _imageH);
+        glm::vec2 uv = screen * 2.f - glm::vec2(1.f);
+        p.m_screen[i] = screen;
+        p.m_dir[i] = glm::normalize(direction + tanHalf * right * uv.x + tanHalf / aspect * rayUp * uv.y);
+        p.m_t[i] = 1.f;
+        p.m_d[i] = c_miss;
+        p.m_albedo[i] = glm::vec3(0.f);
+        p.m_rays.push_back(static_cast<uint32_t>(i));
+      }
+
+      // castRay, every step evaluates the rays that are still marching together
+      for(int step = 0; step < c_marchSteps && !p.m_rays.empty(); ++step)
+      {
+        for(size_t k = 0; k < p.m_rays.size(); ++k)
+        {
+          uint32_t r = p.m_rays[k];
+          p.gather(k, m_eye + p.m_t[r] * p.m_dir[r]);
+        }
+        evaluate(p.m_rays.size(), true);
+        p.m_next.clear();
+        for(size_t k = 0; k < p.m_rays.size(); ++k)
+        {
+          uint32_t r = p.m_rays[k];
+          p.m_d[r] = p.m_distance[k];
+          p.m_albedo[r] = glm::vec3(p.m_r[k], p.m_g[k], p.m_b[k]);
+          if(p.m_d[r] <= c_tracePrecision || p.m_t[r] > c_tmax)
+            continue;
+          p.m_t[r] += p.m_d[r];
+          p.m_next.push_back(r);
+        }
+        p.m_rays.swap(p.m_next);
+      }
+
+      p.m_hits.clear();
+      for(size_t i = 0; i < count; ++i)
+      {
+        p.m_shade[i] = sky(p.m_dir[i]);
+        if(p.m_d[i] <= c_tracePrecision)
+        {
+          p.m_hits.push_back(static_cast<uint32_t>(i));
+          p.m_position[i] = m_eye + p.m_t[i] * p.m_dir[i];
+        }
+      }
+      size_t hits = p.m_hits.size();
+
+      if(hits)
+      {
+        // calcNormal, the tetrahedron of four samples around each hit
+        const glm::vec3 offsets[4] = {
+          glm::vec3(c_normalOffset, -c_normalOffset, -c_normalOffset),
+          glm::vec3(-c_normalOffset, -c_normalOffset, c_normalOffset),
+          glm::vec3(-c_normalOffset, c_normalOffset, -c_normalOffset),
+          glm::vec3(c_normalOffset, c_normalOffset, c_normalOffset)
+        };
+        for(size_t k = 0; k < hits; ++k)
+        {
+          for(size_t j = 0; j < 4; ++j)
+            p.gather(k * 4 + j, p.m_position[p.m_hits[k]] + offsets[j]);
+        }
+        evaluate(hits * 4, false);
+        for(size_t k = 0; k < hits; ++k)
+        {
+          uint32_t r = p.m_hits[k];
+          glm::vec3 n(0.f);
+          for(size_t j = 0; j < 4; ++j)
+            n += offsets[j] * p.m_distance[k * 4 + j];
+          p.m_normal[r] = glm::normalize(n);
+          p.m_reflection[r] = glm::reflect(p.m_dir[r], p.m_normal[r]);
+        }
+
+        // calcAO, five samples along the normal
+        for(size_t k = 0; k < hits; ++k)
+        {
+          uint32_t r = p.m_hits[k];
+          for(size_t j = 0; j < 5; ++j)
+            p.gather(k * 5 + j, p.m_normal[r] * (0.01f + 0.12f * j / 4.f) + p.m_position[r]);
+        }
+        evaluate(hits * 5, false);
+        for(size_t k = 0; k < hits; ++k)
+        {
+          float occ = 0.f;
+          float sca = 1.f;
+          for(size_t j = 0; j < 5; ++j)
+          {
+            float hr = 0.01f + 0.12f * j / 4.f;
+            occ += -(p.m_distance[k * 5 + j] - hr) * sca;
+            sca *= 0.95f;
+          }
+          p.m_occlusion[p.m_hits[k]] = glm::clamp(1.f - 3.f * occ, 0.f, 1.f);
+          p.m_shade[p.m_hits[k]] = glm::vec3(0.f);
+        }
+
+        float intensitySum = 0.f;
+        for(auto &light : m_lights)
+        {
+          // softshadow, marched towards normalize(light position) as the shader does. Points facing away from the light
+          // get no diffuse or specular light whatever the shadow is, so they aren't traced
+          glm::vec3 shadowDir = glm::normalize(light.m_position);
+          p.m_rays.clear();
+          for(size_t k = 0; k < hits; ++k)
+          {
+            uint32_t r = p.m_hits[k];
+            p.m_shadow[r] = 1.f;
+            p.m_shadowT[r] = 0.02f;
+            if(light.m_shadow && glm::dot(p.m_normal[r], light.m_position - p.m_position[r]) > 0.f)
+              p.m_rays.push_back(r);
+          }
+          for(int step = 0; step < c_shadowSteps && !p.m_rays.empty(); ++step)
+          {
+            for(size_t k = 0; k < p.m_rays.size(); ++k)
+            {
+              uint32_t r = p.m_rays[k];
+              p.gather(k, p.m_position[r] + shadowDir * p.m_shadowT[r]);
+            }
+            evaluate(p.m_rays.size(), false);
+            p.m_next.clear();
+            for(size_t k = 0; k < p.m_rays.size(); ++k)
+            {
+              uint32_t r = p.m_rays[k];
+              float h = p.m_distance[k];
+              p.m_shadow[r] = std::min(p.m_shadow[r], 8.f * h / p.m_shadowT[r]);
+              p.m_shadowT[r] += glm::clamp(h, 0.02f, 0.10f);
+              if(h < c_tracePrecision || p.m_shadowT[r] > 2.5f)
+                continue;
+              p.m_next.push_back(r);
+            }
+            p.m_rays.swap(p.m_next);
+          }
+
+          for(size_t k = 0; k < hits; ++k)
+          {
+            uint32_t r = p.m_hits[k];
+            const glm::vec3 &n = p.m_normal[r];
+            glm::vec3 lightDir = glm::normalize(light.m_position - p.m_position[r]);
+            float ambient = glm::clamp(0.5f + 0.5f * n.y, 0.f, 1.f);
+            float diffuse = glm::clamp(glm::dot(n, lightDir), 0.f, 1.f) * glm::clamp(p.m_shadow[r], 0.f, 1.f);
+            float specular = std::pow(glm::clamp(glm::dot(p.m_reflection[r], lightDir), 0.f, 1.f), 16.f);
+            glm::vec3 acc = 1.40f * diffuse * light.m_diffuse + 1.20f * ambient * light.m_ambient * p.m_occlusion[r] + 2.00f * specular * light.m_specular * diffuse;
+            p.m_shade[r] += p.m_albedo[r] * acc * light.m_intensity;
+          }
+          intensitySum += light.m_intensity;
+        }
+
+        for(size_t k = 0; k < hits; ++k)
+        {
+          uint32_t r = p.m_hits[k];
+          glm::vec3 col = p.m_shade[r] / std::max(intensitySum, 1e-4f);
+          // applyFog and the vignetting
+          float fogAmount = 1.f - std::exp(-p.m_t[r] / 150.f * 2.f);
+          col = glm::mix(col, glm::vec3(0.4f, 0.65f, 1.0f), fogAmount);
+          const glm::vec2 &q = p.m_screen[r];
+          col *= 0.5f + 0.5f * std::pow(16.f * q.x * q.y * (1.f - q.x) * (1.f - q.y), 0.25f);
+          p.m_shade[r] = col;
+        }
+      }
+
+      for(size_t i = 0; i < count; ++i)
+      {
+        int px = _x + static_cast<int>(i % _w);
+        int row = _y + static_cast<int>(i / _w);
+        float *pixel = _rgba + (static_cast<size_t>(row) * _imageW + px) * 4;
+        glm::vec3 col = glm::pow(glm::clamp(p.m_shade[i], 0.f, 1.f), glm::vec3(0.4545f));
+        pixel[0] = col.r;
+        pixel[1] = col.g;
+        pixel[2] = col.b;
+        pixel[3] = 1.f;
+      }
+      m_evaluations += evaluations;
+    }
+  }
+}
@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+#include "sdf/Scatter.hpp"
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    namespace
+    {
+      constexpr size_t c_chunk = 1024;
+      constexpr unsigned int c_bits = 20;
+      constexpr uint64_t c_mask = (uint64_t(1) << c_bits) - 1;
+      constexpr uint32_t c_none = 0xffffffff;
+
+      ///
+      /// \brief pack Key of a cell, sorting the keys sorts by z, then y, then x
+      ///
+      uint64_t pack(uint32_t _i, uint32_t _j, uint32_t _k)
+      {
+        return (uint64_t(_k) << (2 * c_bits)) | (uint64_t(_j) << c_bits) | _i;
+      }
+
+      void unpack(uint64_t _key, uint32_t &_i, uint32_t &_j, uint32_t &_k)
+      {
+        _i = static_cast<uint32_t>(_key & c_mask);
+        _j = static_cast<uint32_t>((_key >> c_bits) & c_mask);
+        _k = static_cast<uint32_t>(_key >> (2 * c_bits));
+      }
+
+      ///
+      /// \brief random Uniform float in [0, 1) from a counter, splitmix64 so every candidate has its own stream whatever
+      ///        order the cells are processed in
+      ///
+      float random(uint64_t _counter)
+      {
+        uint64_t z = _counter + 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        z ^= z >> 31;
+        return static_cast<float>(z >> 40) / static_cast<float>(uint64_t(1) << 24);
+      }
+
+      ///
+      /// \brief parity Which of the eight turns a cell throws its darts in
+      ///
+      unsigned int parity(uint64_t _key)
+      {
+        uint32_t i, j, k;
+        unpack(_key, i, j, k);
+        return (i & 1) | ((j & 1) << 1) | ((k & 1) << 2);
+      }
+    }
+
+    Scatter::Scatter(std::shared_ptr<const Program> _program, ThreadPool &_pool) :
+      m_query(_program, _pool, SceneQuery::Settings()),
+      m_pool(_pool),
+      m_dims{1, 1, 1},
+      m_surfaceCells(0),
+      m_candidates(0)
+    {
+    }
+
+    void Scatter::setTime(float _time)
+    {
+      m_query.setTime(_time);
+    }
+
+    bool Scatter::scatter(const Settings &_settings, std::vector<Point> &_points, std::string &_error)
+    {
+      HSITHO_PROFILE_SCOPE("sdf::Scatter::scatter");
+      _points.clear();
+      glm::vec3 extent = _settings.m_max - _settings.m_min;
+      if(!(extent.x > 0.f && extent.y > 0.f && extent.z > 0.f) || !(_settings.m_spacing > 0.f))
+      {
+        _error = "Empty bounds or a spacing that isn't positive";
+        return false;
+      }
+      if(!(_settings.m_lipschitz >= 1.f) || _settings.m_candidates == 0)
+      {
+        _error = "A Lipschitz bound below 1 or no candidates";
+        return false;
+      }
+      for(int a = 0; a < 3; ++a)
+      {
+        float cells = std::ceil(extent[a] / _settings.m_spacing);
+        if(cells > static_cast<float>(c_mask))
+        {
+          _error = "The spacing is too small for the bounds";
+          return false;
+        }
+        m_dims[a] = std::max(1u, static_cast<uint32_t>(cells));
+      }
+      m_settings = _settings;
+
+      std::vector<uint64_t> cells;
+      findSurfaceCells(cells);
+      m_surfaceCells = cells.size();
+      std::unordered_map<uint64_t, uint32_t> index;
+      index.reserve(cells.size());
+      for(size_t c = 0; c < cells.size(); ++c)
+        index[cells[c]] = static_cast<uint32_t>(c);
+
+      // Candidates spread uniformly over every cell, then pulled onto the surface
+      const float spacing = m_settings.m_spacing;
+      const unsigned int perCell = m_settings.m_candidates;
+      std::vector<float> positions(cells.size() * perCell * 3);
+      for(size_t c = 0; c < cells.size(); ++c)
+      {
+        uint32_t i, j, k;
+        unpack(cells[c], i, j, k);
+        uint64_t stream = (uint64_t(m_settings.m_seed) << 32) ^ (cells[c] * perCell * 3);
+        for(unsigned int n = 0; n < perCell; ++n)
+        {
+          float *p = &positions[(c * perCell + n) * 3];
+          for(int a = 0; a < 3; ++a)
+            p[a] = m_settings.m_min[a] + (glm::vec3(i, j, k)[a] + random(stream + n * 3 + a)) * spacing;
+        }
+      }
+      std::vector<float> distance, gradient;
+      project(positions, distance, gradient);
+
+      // Candidates that made it onto the surface are moved to the cell they ended up in, in the order they were started
+      const float tolerance = 0.05f * spacing;
+      std::vector<uint32_t> landed(distance.size(), c_none);
+      std::vector<uint32_t> first(cells.size() + 1, 0);
+      m_candidates = 0;
+      for(size_t n = 0; n < distance.size(); ++n)
+      {
+        glm::vec3 p(positions[n * 3], positions[n * 3 + 1], positions[n * 3 + 2]);
+        glm::vec3 g = (p - m_settings.m_min) / spacing;
+        if(!(std::fabs(distance[n]) <= tolerance) || glm::any(glm::lessThan(g, glm::vec3(0.f))))
+          continue;
+        glm::uvec3 cell(g);
+        if(cell.x >= m_dims[0] || cell.y >= m_dims[1] || cell.z >= m_dims[2])
+          continue;
+        auto found = index.find(pack(cell.x, cell.y, cell.z));
+        if(found == index.end())
+          continue;
+        landed[n] = found->second;
+        ++first[found->second + 1];
+        ++m_candidates;
+      }
+      for(size_t c = 0; c < cells.size(); ++c)
+        first[c + 1] += first[c];
+      std::vector<uint32_t> darts(m_candidates);
+      {
+        std::vector<uint32_t> fill(first.begin(), first.end() - 1);
+        for(size_t n = 0; n < landed.size(); ++n)
+        {
+          if(landed[n] != c_none)
+            darts[fill[landed[n]]++] = static_cast<uint32_t>(n);
+        }
+      }
+
+      // The cells around every cell, looked up once in parallel while the map is only read
+      std::vector<uint32_t> neighbours(cells.size() * 27, c_none);
+      size_t chunks = (cells.size() + c_chunk - 1) / c_chunk;
+      m_pool.parallelFor(chunks, [&](size_t _chunk, unsigned int) {
+        for(size_t c = _chunk * c_chunk; c < std::min(cells.size(), (_chunk + 1) * c_chunk); ++c)
+        {
+          uint32_t i, j, k;
+          unpack(cells[c], i, j, k);
+          for(int n = 0; n < 27; ++n)
+          {
+            int64_t ni = int64_t(i) + n % 3 - 1, nj = int64_t(j) + n / 3 % 3 - 1, nk = int64_t(k) + n / 9 - 1;
+            if(ni < 0 || nj < 0 || nk < 0)
+              continue;
+            auto found = index.find(pack(static_cast<uint32_t>(ni), static_cast<uint32_t>(nj), static_cast<uint32_t>(nk)));
+            if(found != index.end())
+              neighbours[c * 27 + n] = found->second;
+          }
+        }
+      });
+
+      std::vector<uint32_t> byParity[8];
+      uint32_t rounds = 0;
+      for(size_t c = 0; c < cells.size(); ++c)
+      {
+        byParity[parity(cells[c])].push_back(static_cast<uint32_t>(c));
+        rounds = std::max(rounds, first[c + 1] - first[c]);
+      }
+
+      // Every round each cell throws its next dart, the cells of one parity at a time so none of the cells a dart
+      // checks is being written to
+      const float spacing2 = spacing * spacing;
+      std::vector<std::vector<uint32_t>> accepted(cells.size());
+      for(uint32_t round = 0; round < rounds; ++round)
+      {
+        for(auto &group : byParity)
+        {
+          size_t groupChunks = (group.size() + c_chunk - 1) / c_chunk;
+          m_pool.parallelFor(groupChunks, [&](size_t _chunk, unsigned int) {
+            for(size_t g = _chunk * c_chunk; g < std::min(group.size(), (_chunk + 1) * c_chunk); ++g)
+            {
+              uint32_t c = group[g];
+              if(first[c] + round >= first[c + 1])
+                continue;
+              uint32_t dart = darts[first[c] + round];
+              const float *p = &positions[dart * 3];
+              bool free = true;
+              for(int n = 0; n < 27 && free; ++n)
+              {
+                uint32_t neighbour = neighbours[c * 27 + n];
+                if(neighbour == c_none)
+                  continue;
+                for(uint32_t other : accepted[neighbour])
+                {
+                  const float *q = &positions[other * 3];
+                  float dx = p[0] - q[0], dy = p[1] - q[1], dz = p[2] - q[2];
+                  if(dx * dx + dy * dy + dz * dz < spacing2)
+                  {
+                    free = false;
+                    break;
+                  }
+                }
+              }
+              if(free)
+                accepted[c].push_back(dart);
+            }
+          });
+        }
+      }
+
+      size_t total = 0;
+      for(auto &a : accepted)
+        total += a.size();
+      HSITHO_PROFILE_COUNTER("scatter points", total);
+      if(total > m_settings.m_maxPoints)
+      {
+        _error = "The surface needs " + std::to_string(total) + " points, more than the maximum of " + std::to_string(m_settings.m_maxPoints);
+        return false;
+      }
+      _points.reserve(total);
+      for(auto &a : accepted)
+      {
+        for(uint32_t dart : a)
+        {
+          glm::vec3 g(gradient[dart * 3], gradient[dart * 3 + 1], gradient[dart * 3 + 2]);
+          float length = glm::length(g);
+          Point point;
+          point.m_position = glm::vec3(positions[dart * 3], positions[dart * 3 + 1], positions[dart * 3 + 2]);
+          point.m_normal = length > 0.f ? g / length : glm::vec3(0.f, 1.f, 0.f);
+          _points.push_back(point);
+        }
+      }
+      return true;
+    }
+
+    void Scatter::findSurfaceCells(std::vector<uint64_t> &_cells)
+    {
+      HSITHO_PROFILE_SCOPE("sdf::Scatter::findSurfaceCells");
+      uint32_t longest = std::max(m_dims[0], std::max(m_dims[1], m_dims[2]));
+      unsigned int depth = 0;
+      while((1u << depth) < longest)
+        ++depth;
+
+      std::vector<uint64_t> level(1, pack(0, 0, 0));
+      std::vector<float> centres, distance;
+      for(unsigned int l = 0; l <= depth; ++l)
+      {
+        // Side of a cell of this level in cells of the finest one
+        uint32_t scale = 1u << (depth - l);
+        float size = m_settings.m_spacing * scale;
+        float bound = 0.5f * std::sqrt(3.f) * size * m_settings.m_lipschitz;
+        centres.resize(level.size() * 3);
+        distance.resize(level.size());
+        for(size_t c = 0; c < level.size(); ++c)
+        {
+          uint32_t i, j, k;
+          unpack(level[c], i, j, k);
+          glm::vec3 centre = m_settings.m_min + (glm::vec3(i, j, k) + glm::vec3(0.5f)) * size;
+          std::copy(&centre[0], &centre[0] + 3, &centres[c * 3]);
+        }
+        m_query.query(centres.data(), level.size(), distance.data(), nullptr, nullptr);
+
+        std::vector<uint64_t> next;
+        for(size_t c = 0; c < level.size(); ++c)
+        {
+          if(!(std::fabs(distance[c]) <= bound))
+            continue;
+          if(l == depth)
+          {
+            next.push_back(level[c]);
+            continue;
+          }
+          uint32_t i, j, k;
+          unpack(level[c], i, j, k);
+          uint32_t half = scale / 2;
+          for(unsigned int child = 0; child < 8; ++child)
+          {
+            uint32_t ci = i * 2 + (child & 1), cj = j * 2 + ((child >> 1) & 1), ck = k * 2 + ((child >> 2) & 1);
+            // Children completely outside the bounds are never created
+            if(ci * half < m_dims[0] && cj * half < m_dims[1] && ck * half < m_dims[2])
+              next.push_back(pack(ci, cj, ck));
+          }
+        }
+        level.swap(next);
+      }
+      std::sort(level.begin(), level.end());
+      _cells.swap(level);
+    }
+
+    void Scatter::project(std::vector<float> &_points, std::vector<float> &_distance, std::vector<float> &_gradient)
+    {
+      HSITHO_PROFILE_SCOPE("sdf::Scatter::project");
+      size_t count = _points.size() / 3;
+      _distance.resize(count);
+      _gradient.resize(count * 3);
+      for(unsigned int step = 0; step <= m_settings.m_steps; ++step)
+      {
+        m_query.query(_points.data(), count, _distance.data(), _gradient.data(), nullptr);
+        if(step == m_settings.m_steps)
+          break;
+        // p - d g / |g|^2 is where the surface would be if the field were linear, exact for a true distance
+        for(size_t n = 0; n < count; ++n)
+        {
+          float *g = &_gradient[n * 3];
+          float g2 = g[0] * g[0] + g[1] * g[1] + g[2] * g[2];
+          if(!(g2 > 1e-12f))
+            continue;
+          float t = _distance[n] / g2;
+          for(int a = 0; a < 3; ++a)
+            _points[n * 3 + a] -= t * g[a];
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,889 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <map>
+
+#include "sdf/Kernels.hpp"
+#include "sdf/SceneCompiler.hpp"
+#include "CompileArena.hpp"
+#include "Numeric.hpp"
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    namespace
+    {
+      enum class Kind : uint8_t
+      {
+        CONSTANT,
+        UNIFORM,
+        VARYING
+      };
+
+      struct Token
+      {
+        enum Type { NUMBER, IDENTIFIER, SYMBOL, END } m_type;
+        std::string m_text;
+        float m_value;
+      };
+
+      ///
+      /// \brief Value Components of a GLSL value, 1 for a float, 2 to 4 for vectors and 16 for a mat4
+      ///
+      typedef std::vector<uint32_t> Value;
+
+      struct Primitive
+      {
+        Op m_op;
+        std::vector<size_t> m_args;
+      };
+
+      const std::map<std::string, Primitive> &primitives()
+      {
+        // Argument sizes of the distance functions of shader.begin, all of them take a colour last
+        static const std::map<std::string, Primitive> table = {
+          {"sdSphere", {Op::SD_SPHERE, {3, 1}}},
+          {"sdBox", {Op::SD_BOX, {3, 3}}},
+          {"sdFastBox", {Op::SD_FAST_BOX, {3, 1}}},
+          {"sdTorus", {Op::SD_TORUS, {3, 2}}},
+          {"sdCylinder", {Op::SD_CYLINDER, {3, 3}}},
+          {"sdCone", {Op::SD_CONE, {3, 2}}},
+          {"sdPlane", {Op::SD_PLANE, {3, 4}}},
+          {"sdHexPrism", {Op::SD_HEX_PRISM, {3, 2}}},
+          {"sdTriPrism", {Op::SD_TRI_PRISM, {3, 2}}},
+          {"sdCapsule", {Op::SD_CAPSULE, {3, 3, 3, 1}}},
+          {"sdCappedCylinder", {Op::SD_CAPPED_CYLINDER, {3, 2}}},
+          {"sdCappedCone", {Op::SD_CAPPED_CONE, {3, 3}}},
+          {"sdEllipsoid", {Op::SD_ELLIPSOID, {3, 3}}},
+          {"udBox", {Op::UD_BOX, {3, 3}}},
+          {"udRoundBox", {Op::UD_ROUND_BOX, {3, 3, 1}}}
+        };
+        return table;
+      }
+
+      size_t typeSize(const std::string &_type)
+      {
+        if(_type == "float" || _type == "int")
+          return 1;
+        if(_type == "vec2")
+          return 2;
+        if(_type == "vec3")
+          return 3;
+        if(_type == "vec4")
+          return 4;
+        if(_type == "mat4" || _type == "mat4x4")
+          return 16;
+        return 0;
+      }
+
+      class Compiler
+      {
+      public:
+        Compiler(const std::string &_source, bool _primitiveIds, size_t _volumeCount, size_t _instanceCount) :
+          m_source(_source),
+          m_pos(0),
+          m_primitiveIds(_primitiveIds),
+          m_primitiveCount(0),
+          m_volumeCount(_volumeCount),
+          m_instanceCount(_instanceCount)
+        {}
+
+        bool run(Program &_program, std::string &_error);
+
+      private:
+        // Lexing
+        bool next();
+        bool accept(const char *_symbol);
+        bool expect(const char *_symbol);
+        bool fail(const std::string &_message);
+
+        // Parsing, every function returns false after recording the error
+        bool statement(bool &_returned, Value &_result);
+        bool expression(Value &_out);
+        bool term(Value &_out);
+        bool unary(Value &_out);
+        bool postfix(Value &_out);
+        bool primary(Value &_out);
+        bool call(const std::string &_name, std::vector<Value> &_args, Value &_out);
+        bool swizzle(const std::string &_fields, Value &_v);
+
+        // Code generation
+        uint32_t constant(float _value);
+        uint32_t newRegister(Kind _kind);
+        uint32_t emit(Op _op, std::initializer_list<uint32_t> _operands);
+        uint32_t emit(Op _op, const uint32_t *_operands);
+        bool binary(char _op, const Value &_a, const Value &_b, Value &_out);
+        bool componentWise(Op _op, const std::vector<Value> &_args, Value &_out);
+        bool construct(size_t _size, const std::vector<Value> &_args, Value &_out);
+        Value select(uint32_t _a, uint32_t _b, const Value &_t, const Value &_f);
+        bool isConstant(uint32_t _reg, float _value) const;
+
+        void finish(Program &_program);
+
+        const std::string &m_source;
+        size_t m_pos;
+        Token m_token;
+        std::string m_error;
+
+        std::unordered_map<std::string, Value> m_variables;
+        std::vector<Kind> m_kinds;
+        ///
+        /// \brief m_values Value of each constant register, unused for the others
+        ///
+        std::vector<float> m_values;
+        std::unordered_map<uint32_t, uint32_t> m_constantRegisters;
+        ///
+        /// \brief m_known Registers already computing an operation on the same operands
+        ///
+        std::map<std::vector<uint32_t>, uint32_t> m_known;
+        std::vector<Instruction> m_uniformCode;
+        std::vector<Instruction> m_code;
+        std::vector<uint32_t> m_operands;
+        uint32_t m_time;
+        Value m_position;
+        Value m_result;
+        ///
+        /// \brief m_primitiveIds Whether the primitives return their index as the colour
+        ///
+        bool m_primitiveIds;
+        uint32_t m_primitiveCount;
+        ///
+        /// \brief m_volumeCount Volumes of the program, the u_Volume uniforms are the constants 0 to m_volumeCount - 1
+        ///
+        size_t m_volumeCount;
+        ///
+        /// \brief m_instanceCount Instance sets of the program, called as the functions instances0 to instancesN - 1
+        ///
+        size_t m_instanceCount;
+      };
+
+      bool Compiler::fail(const std::string &_message)
+      {
+        if(m_error.empty())
+        {
+          size_t start = m_pos > 40 ? m_pos - 40 : 0;
+          m_error = _message + " near \"" + m_source.substr(start, m_pos - start) + "\"";
+        }
+        return false;
+      }
+
+      bool Compiler::next()
+      {
+        while(m_pos < m_source.size() && std::isspace(static_cast<unsigned char>(m_source[m_pos])))
+          ++m_pos;
+        m_token.m_text.clear();
+        if(m_pos >= m_source.size())
+        {
+          m_token.m_type = Token::END;
+          return true;
+        }
+
+        char c = m_source[m_pos];
+        if(std::isdigit(static_cast<unsigned char>(c)) || (c == '.' && m_pos + 1 < m_source.size() && std::isdigit(static_cast<unsigned char>(m_source[m_pos + 1]))))
+        {
+          size_t start = m_pos;
+          while(m_pos < m_source.size() && (std::isdigit(static_cast<unsigned char>(m_source[m_pos])) || m_source[m_pos] == '.'))
+            ++m_pos;
+          if(m_pos < m_source.size() && (m_source[m_pos] == 'e' || m_source[m_pos] == 'E'))
+          {
+            ++m_pos;
+            if(m_pos < m_source.size() && (m_source[m_pos] == '+' || m_source[m_pos] == '-'))
+              ++m_pos;
+            while(m_pos < m_source.size() && std::isdigit(static_cast<unsigned char>(m_source[m_pos])))
+              ++m_pos;
+          }
+          m_token.m_type = Token::NUMBER;
+          m_token.m_text = m_source.substr(start, m_pos - start);
+          // GLSL float suffix
+          if(m_pos < m_source.size() && (m_source[m_pos] == 'f' || m_source[m_pos] == 'F'))
+            ++m_pos;
+          if(!Numeric::parseFloat(m_token.m_text, m_token.m_value))
+            return fail("Invalid number " + m_token.m_text);
+          return true;
+        }
+        if(std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+        {
+          size_t start = m_pos;
+          while(m_pos < m_source.size() && (std::isalnum(static_cast<unsigned char>(m_source[m_pos])) || m_source[m_pos] == '_'))
+            ++m_pos;
+          m_token.m_type = Token::IDENTIFIER;
+          m_token.m_text = m_source.substr(start, m_pos - start);
+          return true;
+        }
+        m_token.m_type = Token::SYMBOL;
+        m_token.m_text = std::string(1, c);
+        ++m_pos;
+        return true;
+      }
+
+      bool Compiler::accept(const char *_symbol)
+      {
+        if(m_token.m_type == Token::SYMBOL && m_token.m_text == _symbol)
+          return next();
+        return false;
+      }
+
+      bool Compiler::expect(const char *_symbol)
+      {
+        if(m_token.m_type == Token::SYMBOL && m_token.m_text == _symbol)
+          return next();
+        return fail(std::string("Expected '") + _symbol + "'");
+      }
+
+      uint32_t Compiler::newRegister(Kind _kind)
+      {
+        m_kinds.push_back(_kind);
+        m_values.push_back(0.f);
+        return static_cast<uint32_t>(m_kinds.size() - 1);
+      }
+
+      uint32_t Compiler::constant(float _value)
+      {
+        uint32_t bits;
+        std::memcpy(&bits, &_value, sizeof(bits));
+        auto it = m_constantRegisters.find(bits);
+        if(it != m_constantRegisters.end())
+          return it->second;
+        uint32_t reg = newRegister(Kind::CONSTANT);
+        m_values[reg] = _value;
+        m_constantRegisters[bits] = reg;
+        return reg;
+      }
+
+      bool Compiler::isConstant(uint32_t _reg, float _value) const
+      {
+        return m_kinds[_reg] == Kind::CONSTANT && m_values[_reg] == _value;
+      }
+
+      uint32_t Compiler::emit(Op _op, std::initializer_list<uint32_t> _operands)
+      {
+        return emit(_op, _operands.begin());
+      }
+
+      uint32_t Compiler::emit(Op _op, const uint32_t *_operands)
+      {
+        unsigned int n = operandCount(_op);
+        Kind kind = Kind::CONSTANT;
+        for(unsigned int i = 0; i < n; ++i)
+          kind = std::max(kind, m_kinds[_operands[i]]);
+
+        // Volumes and instances are only there when the program runs, they're computed per point whatever the position is
+        if(_op == Op::SD_VOLUME || _op == Op::SD_INSTANCES)
+          kind = Kind::VARYING;
+
+        if(kind == Kind::CONSTANT)
+        {
+          // Run the operation right away on a scratch register file holding the operands and the result
+          float scratch[11];
+          uint32_t indices[10];
+          for(unsigned int i = 0; i < n; ++i)
+          {
+            scratch[i] = m_values[_operands[i]];
+            indices[i] = i;
+          }
+          kernels::execute(Instruction{_op, n, 0}, scratch, indices);
+          return constant(scratch[n]);
+        }
+
+        // The transforms are mostly identity, most of the products and sums with them disappear here
+        uint32_t a = _operands[0];
+        uint32_t b = n > 1 ? _operands[1] : 0;
+        switch(_op)
+        {
+          case Op::MUL:
+            if(isConstant(a, 1.f)) return b;
+            if(isConstant(b, 1.f)) return a;
+            if(isConstant(a, 0.f) || isConstant(b, 0.f)) return constant(0.f);
+          break;
+          case Op::ADD:
+            if(isConstant(a, 0.f)) return b;
+            if(isConstant(b, 0.f)) return a;
+          break;
+          case Op::SUB:
+            if(isConstant(b, 0.f)) return a;
+          break;
+          case Op::DIV:
+            if(isConstant(b, 1.f)) return a;
+          break;
+          default:
+          break;
+        }
+
+        std::vector<uint32_t> key(_operands, _operands + n);
+        key.push_back(static_cast<uint32_t>(_op));
+        auto known = m_known.find(key);
+        if(known != m_known.end())
+          return known->second;
+
+        uint32_t dst = newRegister(kind);
+        (kind == Kind::UNIFORM ? m_uniformCode : m_code).push_back(Instruction{_op, dst, static_cast<uint32_t>(m_operands.size())});
+        m_operands.insert(m_operands.end(), _operands, _operands + n);
+        m_known[key] = dst;
+        return dst;
+      }
+
+      Value Compiler::select(uint32_t _a, uint32_t _b, const Value &_t, const Value &_f)
+      {
+        Value out;
+        for(size_t i = 0; i < _t.size(); ++i)
+          out.push_back(emit(Op::SELECT_LE, {_a, _b, _t[i], _f[i]}));
+        return out;
+      }
+
+      bool Compiler::binary(char _op, const Value &_a, const Value &_b, Value &_out)
+      {
+        _out.clear();
+        if(_op == '*' && _a.size() == 16 && _b.size() == 4)
+        {
+          // GLSL matrices are column major, m[column][row]
+          for(size_t row = 0; row < 4; ++row)
+          {
+            uint32_t sum = emit(Op::MUL, {_a[row], _b[0]});
+            for(size_t column = 1; column < 4; ++column)
+              sum = emit(Op::ADD, {sum, emit(Op::MUL, {_a[column * 4 + row], _b[column]})});
+            _out.push_back(sum);
+          }
+          return true;
+        }
+        if((_a.size() == 16) != (_b.size() == 16) && _a.size() != 1 && _b.size() != 1)
+          return fail("Unsupported matrix operation");
+        if(_a.size() == 16 && _b.size() == 16 && _op == '*')
+          return fail("Matrix products aren't supported");
+        if(_a.size() != _b.size() && _a.size() != 1 && _b.size() != 1)
+          return fail("Mismatching sizes in an arithmetic operation");
+
+        Op op = _op == '+' ? Op::ADD : _op == '-' ? Op::SUB : _op == '*' ? Op::MUL : Op::DIV;
+        size_t n = std::max(_a.size(), _b.size());
+        for(size_t i = 0; i < n; ++i)
+          _out.push_back(emit(op, {_a[_a.size() == 1 ? 0 : i], _b[_b.size() == 1 ? 0 : i]}));
+        return true;
+      }
+
+      bool Compiler::componentWise(Op _op, const std::vector<Value> &_args, Value &_out)
+      {
+        unsigned int n = operandCount(_op);
+        if(_args.size() != n)
+          return fail("Wrong number of arguments");
+        // The first argument decides the size, the others can be scalars
+        size_t size = _args[0].size();
+        for(auto &a : _args)
+        {
+          if(a.size() != size && a.size() != 1)
+            return fail("Mismatching argument sizes");
+        }
+        _out.clear();
+        for(size_t i = 0; i < size; ++i)
+        {
+          uint32_t operands[3];
+          for(unsigned int j = 0; j < n; ++j)
+            operands[j] = _args[j][_args[j].size() == 1 ? 0 : i];
+          _out.push_back(emit(_op, operands));
+        }
+        return true;
+      }
+
+      bool Compiler::construct(size_t _size, const std::vector<Value> &_args, Value &_out)
+      {
+        _out.clear();
+        for(auto &a : _args)
+          _out.insert(_out.end(), a.begin(), a.end());
+        if(_out.size() == 1 && _size > 1)
+        {
+          if(_size == 16)
+          {
+            // mat4(x) puts x on the diagonal
+            uint32_t d = _out[0];
+            _out.assign(16, constant(0.f));
+            for(size_t i = 0; i < 4; ++i)
+              _out[i * 5] = d;
+          }
+          else
+            _out.assign(_size, _out[0]);
+          return true;
+        }
+        if(_args.size() == 1 && _out.size() > _size && _size < 16)
+        {
+          _out.resize(_size);
+          return true;
+        }
+        if(_out.size() != _size)
+          return fail("Wrong number of components in a constructor");
+        return true;
+      }
+
+      bool Compiler::swizzle(const std::string &_fields, Value &_v)
+      {
+        if(_fields.size() > 4 || _v.size() > 4)
+          return fail("Invalid swizzle ." + _fields);
+        Value out;
+        for(char c : _fields)
+        {
+          const char *sets[] = {"xyzw", "rgba", "stpq"};
+          size_t index = 4;
+          for(const char *s : sets)
+          {
+            const char *p = std::strchr(s, c);
+            if(p)
+              index = p - s;
+          }
+          if(index >= _v.size())
+            return fail("Invalid swizzle ." + _fields);
+          out.push_back(_v[index]);
+        }
+        _v.swap(out);
+        return true;
+      }
+
+      bool Compiler::call(const std::string &_name, std::vector<Value> &_args, Value &_out)
+      {
+        size_t size = typeSize(_name);
+        if(size)
+          return construct(size, _args, _out);
+
+        auto primitive = primitives().find(_name);
+        // instancesN(position, colour) runs the Nth instance set, the ShaderGenerator writes the function of the same name
+        unsigned int instances = 0;
+        if(_name.compare(0, 9, "instances") != 0 || !Numeric::parseUnsigned(_name.substr(9), instances))
+          instances = static_cast<unsigned int>(m_instanceCount);
+        if(primitive != primitives().end() || _name == "sdVolume" || instances < m_instanceCount)
+        {
+          std::vector<uint32_t> operands;
+          Op op = primitive != primitives().end() ? primitive->second.m_op : Op::SD_VOLUME;
+          if(instances < m_instanceCount)
+          {
+            if(_args.size() != 2 || _args[0].size() != 3 || _args[1].size() != 3)
+              return fail("Wrong arguments to " + _name);
+            operands = {_args[0][0], _args[0][1], _args[0][2], constant(static_cast<float>(instances)), m_time};
+            op = Op::SD_INSTANCES;
+          }
+          else if(_name == "sdVolume")
+          {
+            // sdVolume(position, u_VolumeN, min, max, scale, colour), the bounds and the scale are only there for the
+            // shader, the volume has them
+            if(_args.size() != 6 || _args[0].size() != 3 || _args[1].size() != 1 || _args.back().size() != 3)
+              return fail("Wrong arguments to " + _name);
+            uint32_t volume = _args[1][0];
+            if(m_kinds[volume] != Kind::CONSTANT || !(m_values[volume] >= 0.f && m_values[volume] < m_volumeCount))
+              return fail("Unknown volume in " + _name);
+            operands = {_args[0][0], _args[0][1], _args[0][2], volume};
+          }
+          else
+          {
+            const std::vector<size_t> &sizes = primitive->second.m_args;
+            if(_args.size() != sizes.size() + 1 || _args.back().size() != 3)
+              return fail("Wrong arguments to " + _name);
+            for(size_t i = 0; i < sizes.size(); ++i)
+            {
+              if(_args[i].size() != sizes[i])
+                return fail("Wrong arguments to " + _name);
+              operands.insert(operands.end(), _args[i].begin(), _args[i].end());
+            }
+          }
+          _out = Value{emit(op, operands.data())};
+          if(m_primitiveIds)
+          {
+            // Counted as they're parsed, which is the order the generator wrote them in
+            _out.push_back(constant(static_cast<float>(m_primitiveCount++)));
+            _out.push_back(constant(0.f));
+            _out.push_back(constant(0.f));
+          }
+          else
+            _out.insert(_out.end(), _args.back().begin(), _args.back().end());
+          return true;
+        }
+
+        if(_name == "opUnion" || _name == "opIntersection" || _name == "opSubtraction" || _name == "opBlend")
+        {
+          if(_args.size() != (_name == "opBlend" ? 3u : 2u) || _args[0].size() != 4 || _args[1].size() != 4 || (_name == "opBlend" && _args[2].size() != 1))
+            return fail("Wrong arguments to " + _name);
+          const Value &a = _args[0];
+          const Value &b = _args[1];
+          // The distances of the set operations are a min or max of both sides, the same as the select of the colour
+          // but bounded much tighter on intervals, where the select can only take the hull of both
+          if(_name == "opUnion")
+          {
+            _out = select(a[0], b[0], a, b);
+            _out[0] = emit(Op::MIN, {a[0], b[0]});
+          }
+          else if(_name == "opIntersection")
+          {
+            _out = select(b[0], a[0], a, b);
+            _out[0] = emit(Op::MAX, {a[0], b[0]});
+          }
+          else if(_name == "opSubtraction")
+          {
+            Value na = a;
+            na[0] = emit(Op::NEG, {a[0]});
+            _out = select(b[0], na[0], na, b);
+            _out[0] = emit(Op::MAX, {na[0], b[0]});
+          }
+          else
+          {
+            // h = clamp(0.5 + 0.5 * (b.x - a.x) / k, 0, 1), d = mix(b.x, a.x, h) - k * h * (1 - h), colour = lerp(a, b, h)
+            uint32_t k = _args[2][0];
+            uint32_t zero = constant(0.f), half = constant(0.5f), one = constant(1.f);
+            uint32_t h = emit(Op::CLAMP, {emit(Op::ADD, {half, emit(Op::DIV, {emit(Op::MUL, {half, emit(Op::SUB, {b[0], a[0]})}), k})}), zero, one});
+            uint32_t d = emit(Op::SUB, {emit(Op::MIX, {b[0], a[0], h}), emit(Op::MUL, {emit(Op::MUL, {k, h}), emit(Op::SUB, {one, h})})});
+            // g(a, b) = a + b + sqrt(a * a + b * b), w1 = g(b.x, h - 1) / (g(a.x, -h) + g(b.x, h - 1)), w2 = g(a.x, -h) / (...)
+            auto g = [&](uint32_t _x, uint32_t _y) {
+              return emit(Op::ADD, {emit(Op::ADD, {_x, _y}), emit(Op::SQRT, {emit(Op::ADD, {emit(Op::MUL, {_x, _x}), emit(Op::MUL, {_y, _y})})})});
+            };
+            uint32_t ga = g(a[0], emit(Op::NEG, {h}));
+            uint32_t gb = g(b[0], emit(Op::SUB, {h, one}));
+            uint32_t sum = emit(Op::ADD, {ga, gb});
+            uint32_t w1 = emit(Op::DIV, {gb, sum});
+            uint32_t w2 = emit(Op::DIV, {ga, sum});
+            _out = Value{d};
+            if(m_primitiveIds)
+            {
+              // Ids can't be blended, h >= 0.5 where a is the closer one
+              Value ids = select(half, h, Value(a.begin() + 1, a.end()), Value(b.begin() + 1, b.end()));
+              _out.insert(_out.end(), ids.begin(), ids.end());
+            }
+            else
+            {
+              for(size_t i = 1; i < 4; ++i)
+                _out.push_back(emit(Op::ADD, {emit(Op::MUL, {w1, a[i]}), emit(Op::MUL, {w2, b[i]})}));
+            }
+          }
+          return true;
+        }
+        if(_name == "opRepetition")
+        {
+          if(_args.size() != 2 || _args[0].size() != 3 || _args[1].size() != 3)
+            return fail("Wrong arguments to " + _name);
+          _out.clear();
+          for(size_t i = 0; i < 3; ++i)
+            _out.push_back(emit(Op::SUB, {emit(Op::MOD, {_args[0][i], _args[1][i]}), emit(Op::MUL, {constant(0.5f), _args[1][i]})}));
+          return true;
+        }
+
+        static const std::map<std::string, Op> builtins = {
+          {"sin", Op::SIN}, {"cos", Op::COS}, {"abs", Op::ABS}, {"sqrt", Op::SQRT}, {"floor", Op::FLOOR}, {"sign", Op::SIGN},
+          {"min", Op::MIN}, {"max", Op::MAX}, {"mod", Op::MOD}, {"clamp", Op::CLAMP}, {"mix", Op::MIX}
+        };
+        auto builtin = builtins.find(_name);
+        if(builtin != builtins.end())
+          return componentWise(builtin->second, _args, _out);
+
+        if(_name == "dot" || _name == "length")
+        {
+          if(_args.size() != (_name == "dot" ? 2u : 1u) || _args[0].size() > 4 || (_name == "dot" && _args[1].size() != _args[0].size()))
+            return fail("Wrong arguments to " + _name);
+          const Value &a = _args[0];
+          const Value &b = _name == "dot" ? _args[1] : _args[0];
+          uint32_t sum = emit(Op::MUL, {a[0], b[0]});
+          for(size_t i = 1; i < a.size(); ++i)
+            sum = emit(Op::ADD, {sum, emit(Op::MUL, {a[i], b[i]})});
+          _out = Value{_name == "dot" ? sum : emit(Op::SQRT, {sum})};
+          return true;
+        }
+        return fail("Unsupported function " + _name);
+      }
+
+      bool Compiler::primary(Value &_out)
+      {
+        if(m_token.m_type == Token::NUMBER)
+        {
+          _out = Value{constant(m_token.m_value)};
+          return next();
+        }
+        if(accept("("))
+          return expression(_out) && expect(")");
+        if(m_token.m_type != Token::IDENTIFIER)
+          return fail("Unexpected '" + m_token.m_text + "'");
+
+        std::string name = m_token.m_text;
+        if(!next())
+          return false;
+        if(accept("("))
+        {
+          std::vector<Value> args;
+          if(!accept(")"))
+          {
+            do
+            {
+              args.emplace_back();
+              if(!expression(args.back()))
+                return false;
+            } while(accept(","));
+            if(!expect(")"))
+              return false;
+          }
+          return call(name, args, _out);
+        }
+        auto variable = m_variables.find(name);
+        if(variable == m_variables.end())
+          return fail("Unknown identifier " + name);
+        _out = variable->second;
+        return true;
+      }
+
+      bool Compiler::postfix(Value &_out)
+      {
+        if(!primary(_out))
+          return false;
+        while(accept("."))
+        {
+          if(m_token.m_type != Token::IDENTIFIER)
+            return fail("Expected a swizzle");
+          std::string fields = m_token.m_text;
+          if(!next() || !swizzle(fields, _out))
+            return false;
+        }
+        return true;
+      }
+
+      bool Compiler::unary(Value &_out)
+      {
+        if(accept("-"))
+        {
+          if(!unary(_out))
+            return false;
+          for(auto &r : _out)
+            r = emit(Op::NEG, {r});
+          return true;
+        }
+        if(accept("+"))
+          return unary(_out);
+        return postfix(_out);
+      }
+
+      bool Compiler::term(Value &_out)
+      {
+        if(!unary(_out))
+          return false;
+        while(m_token.m_type == Token::SYMBOL && (m_token.m_text == "*" || m_token.m_text == "/"))
+        {
+          char op = m_token.m_text[0];
+          Value rhs, result;
+          if(!next() || !unary(rhs) || !binary(op, _out, rhs, result))
+            return false;
+          _out.swap(result);
+        }
+        return true;
+      }
+
+      bool Compiler::expression(Value &_out)
+      {
+        if(!term(_out))
+          return false;
+        while(m_token.m_type == Token::SYMBOL && (m_token.m_text == "+" || m_token.m_text == "-"))
+        {
+          char op = m_token.m_text[0];
+          Value rhs, result;
+          if(!next() || !term(rhs) || !binary(op, _out, rhs, result))
+            return false;
+          _out.swap(result);
+        }
+        return true;
+      }
+
+      bool Compiler::statement(bool &_returned, Value &_result)
+      {
+        if(m_token.m_type != Token::IDENTIFIER)
+          return fail("Expected a statement");
+
+        std::string first = m_token.m_text;
+        if(!next())
+          return false;
+        if(first == "return")
+        {
+          _returned = true;
+          return expression(_result) && expect(";");
+        }
+
+        // Either a declaration with a type or an assignment to an existing variable
+        std::string name = first;
+        size_t size = typeSize(first);
+        if(size)
+        {
+          if(m_token.m_type != Token::IDENTIFIER)
+            return fail("Expected a variable name");
+          name = m_token.m_text;
+          if(!next())
+            return false;
+        }
+        else
+        {
+          auto variable = m_variables.find(name);
+          if(variable == m_variables.end())
+            return fail("Unknown identifier " + name);
+          size = variable->second.size();
+        }
+
+        Value v;
+        if(!expect("=") || !expression(v) || !expect(";"))
+          return false;
+        if(v.size() != size)
+          return fail("Assigning a value of the wrong size to " + name);
+        m_variables[name] = v;
+        return true;
+      }
+
+      bool Compiler::run(Program &_program, std::string &_error)
+      {
+        m_time = newRegister(Kind::UNIFORM);
+        m_position = Value{newRegister(Kind::VARYING), newRegister(Kind::VARYING), newRegister(Kind::VARYING)};
+        m_variables["u_GlobalTime"] = Value{m_time};
+        m_variables["_position"] = m_position;
+        for(size_t i = 0; i < m_volumeCount; ++i)
+          m_variables["u_Volume" + std::to_string(i)] = Value{constant(static_cast<float>(i))};
+
+        // Skip the signature, the body is all that matters
+        size_t map = m_source.find("map(");
+        size_t body = map == std::string::npos ? std::string::npos : m_source.find('{', map);
+        if(body == std::string::npos)
+        {
+          _error = "No map function in the source";
+          return false;
+        }
+        m_pos = body + 1;
+
+        bool returned = false;
+        Value result;
+        bool ok = next();
+        while(ok && !returned && m_token.m_type != Token::END && !(m_token.m_type == Token::SYMBOL && m_token.m_text == "}"))
+          ok = statement(returned, result);
+        if(ok && !returned)
+          ok = fail("The map function doesn't return anything");
+        if(ok && result.size() != 4)
+          ok = fail("The map function has to return a vec4");
+        if(!ok)
+        {
+          _error = m_error;
+          return false;
+        }
+        m_result = result;
+        finish(_program);
+        return true;
+      }
+
+      void Compiler::finish(Program &_program)
+      {
+        // Drop whatever doesn't end up in the result, the code is in SSA form so walking it backwards once is enough
+        std::vector<bool> live(m_kinds.size(), false);
+        for(uint32_t r : m_result)
+          live[r] = true;
+        auto markOperands = [&](const std::vector<Instruction> &_code) {
+          for(auto it = _code.rbegin(); it != _code.rend(); ++it)
+          {
+            if(!live[it->m_dst])
+              continue;
+            for(unsigned int i = 0; i < operandCount(it->m_op); ++i)
+              live[m_operands[it->m_first + i]] = true;
+          }
+        };
+        markOperands(m_code);
+        markOperands(m_uniformCode);
+
+        // Constants and uniforms first, they keep their registers for the whole evaluation
+        std::vector<uint32_t> physical(m_kinds.size(), Program::c_none);
+        uint32_t uniforms = 0;
+        _program.m_constants.clear();
+        for(uint32_t r = 0; r < m_kinds.size(); ++r)
+        {
+          if(live[r] && m_kinds[r] != Kind::VARYING)
+          {
+            physical[r] = uniforms++;
+            _program.m_constants.push_back(m_values[r]);
+          }
+        }
+        _program.m_uniformCount = uniforms;
+        _program.m_time = physical[m_time];
+
+        // Per point registers are reused as soon as the last instruction reading them has run
+        std::vector<size_t> lastUse(m_kinds.size(), 0);
+        for(size_t i = 0; i < m_code.size(); ++i)
+        {
+          if(!live[m_code[i].m_dst])
+            continue;
+          for(unsigned int j = 0; j < operandCount(m_code[i].m_op); ++j)
+            lastUse[m_operands[m_code[i].m_first + j]] = i;
+        }
+        for(uint32_t r : m_result)
+          lastUse[r] = m_code.size();
+
+        std::vector<uint32_t> free;
+        uint32_t registers = uniforms;
+        auto allocate = [&]() {
+          if(free.empty())
+            return registers++;
+          uint32_t r = free.back();
+          free.pop_back();
+          return r;
+        };
+        for(uint32_t r : m_position)
+        {
+          if(live[r])
+            physical[r] = allocate();
+        }
+
+        _program.m_operands.clear();
+        _program.m_code.clear();
+        _program.m_uniformCode.clear();
+        for(auto &ins : m_uniformCode)
+        {
+          if(!live[ins.m_dst])
+            continue;
+          _program.m_uniformCode.push_back(Instruction{ins.m_op, physical[ins.m_dst], static_cast<uint32_t>(_program.m_operands.size())});
+          for(unsigned int j = 0; j < operandCount(ins.m_op); ++j)
+            _program.m_operands.push_back(physical[m_operands[ins.m_first + j]]);
+        }
+        for(size_t i = 0; i < m_code.size(); ++i)
+        {
+          const Instruction &ins = m_code[i];
+          if(!live[ins.m_dst])
+            continue;
+          uint32_t first = static_cast<uint32_t>(_program.m_operands.size());
+          for(unsigned int j = 0; j < operandCount(ins.m_op); ++j)
+          {
+            uint32_t operand = m_operands[ins.m_first + j];
+            _program.m_operands.push_back(physical[operand]);
+            // An operand read twice by the same instruction is only freed once
+            if(m_kinds[operand] == Kind::VARYING && lastUse[operand] == i && std::find(free.begin(), free.end(), physical[operand]) == free.end())
+              free.push_back(physical[operand]);
+          }
+          physical[ins.m_dst] = allocate();
+          _program.m_code.push_back(Instruction{ins.m_op, physical[ins.m_dst], first});
+        }
+
+        _program.m_registerCount = registers;
+        for(size_t i = 0; i < 3; ++i)
+          _program.m_position[i] = physical[m_position[i]];
+        for(size_t i = 0; i < 4; ++i)
+          _program.m_result[i] = physical[m_result[i]];
+      }
+    }
+
+    std::shared_ptr<Program> SceneCompiler::compile(ShaderGenerator &_generator, const std::unordered_map<QUuid, std::shared_ptr<Node>> &_nodes, std::string &_error, bool _primitiveIds)
+    {
+      std::string map;
+      {
+        CompileArena arena;
+        map = _generator.generateMap(_nodes);
+      }
+      if(map.empty())
+      {
+        _error = "Nothing is connected to the distance node";
+        return nullptr;
+      }
+      return compileMap(map, _error, _primitiveIds, _generator.volumes(), _generator.instanceSets());
+    }
+
+    std::shared_ptr<Program> SceneCompiler::compileMap(const std::string &_source, std::string &_error, bool _primitiveIds, const std::vector<std::shared_ptr<const DistanceVolume>> &_volumes,
+                                                       const std::vector<std::shared_ptr<const InstanceSet>> &_instances)
+    {
+      HSITHO_PROFILE_SCOPE("SceneCompiler::compileMap");
+      std::shared_ptr<Program> program = std::make_shared<Program>();
+      Compiler compiler(_source, _primitiveIds, _volumes.size(), _instances.size());
+      if(!compiler.run(*program, _error))
+        return nullptr;
+      program->m_volumes = _volumes;
+      program->m_instances = _instances;
+      return program;
+    }
+  }
+}
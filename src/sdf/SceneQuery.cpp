@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cmath>
+
+#include "sdf/SceneQuery.hpp"
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    SceneQuery::SceneQuery(std::shared_ptr<const Program> _program, ThreadPool &_pool, const Settings &_settings) :
+      m_program(_program),
+      m_pool(_pool),
+      m_settings(_settings),
+      m_scratch(_pool.size()),
+      m_evaluations(0)
+    {
+      m_settings.m_chunk = std::max<size_t>(m_settings.m_chunk, 1);
+      for(unsigned int i = 0; i < m_pool.size(); ++i)
+        m_evaluators.emplace_back(new Evaluator(m_program));
+    }
+
+    void SceneQuery::setTime(float _time)
+    {
+      for(auto &e : m_evaluators)
+        e->setTime(_time);
+    }
+
+    void SceneQuery::query(const float *_points, size_t _count, float *_distance, float *_gradient, uint32_t *_ids)
+    {
+      HSITHO_PROFILE_SCOPE("sdf::SceneQuery::query");
+      m_evaluations = 0;
+      size_t chunks = (_count + m_settings.m_chunk - 1) / m_settings.m_chunk;
+      m_pool.parallelFor(chunks, [&](size_t _chunk, unsigned int _worker) {
+        size_t first = _chunk * m_settings.m_chunk;
+        queryChunk(_points, first, std::min(m_settings.m_chunk, _count - first), _worker, _distance, _gradient, _ids);
+      });
+    }
+
+    void SceneQuery::queryChunk(const float *_points, size_t _first, size_t _count, unsigned int _worker, float *_distance, float *_gradient, uint32_t *_ids)
+    {
+      Evaluator &evaluator = *m_evaluators[_worker];
+      Scratch &s = m_scratch[_worker];
+      s.m_x.resize(_count);
+      s.m_y.resize(_count);
+      s.m_z.resize(_count);
+      s.m_distance.resize(_count);
+      s.m_id.resize(_count);
+
+      const float *p = _points + _first * 3;
+      size_t evaluations = 0;
+      if(_distance || _ids)
+      {
+        for(size_t i = 0; i < _count; ++i)
+        {
+          s.m_x[i] = p[i * 3];
+          s.m_y[i] = p[i * 3 + 1];
+          s.m_z[i] = p[i * 3 + 2];
+        }
+        evaluator.evaluate(s.m_x.data(), s.m_y.data(), s.m_z.data(), _count, s.m_distance.data(), _ids ? s.m_id.data() : nullptr);
+        evaluations += _count;
+        if(_distance)
+          std::copy(s.m_distance.begin(), s.m_distance.end(), _distance + _first);
+        if(_ids)
+        {
+          for(size_t i = 0; i < _count; ++i)
+            _ids[_first + i] = s.m_id[i] >= 0.f ? static_cast<uint32_t>(s.m_id[i] + 0.5f) : Program::c_none;
+        }
+      }
+
+      if(_gradient)
+      {
+        // The samples at the corners of a tetrahedron sum to 4 h^2 times the gradient, with the distance at the point itself
+        // cancelling out
+        const float h = m_settings.m_gradientStep;
+        const glm::vec3 offsets[4] = {glm::vec3(h, -h, -h), glm::vec3(-h, -h, h), glm::vec3(-h, h, -h), glm::vec3(h, h, h)};
+        float *g = _gradient + _first * 3;
+        std::fill(g, g + _count * 3, 0.f);
+        for(auto &o : offsets)
+        {
+          for(size_t i = 0; i < _count; ++i)
+          {
+            s.m_x[i] = p[i * 3] + o.x;
+            s.m_y[i] = p[i * 3 + 1] + o.y;
+            s.m_z[i] = p[i * 3 + 2] + o.z;
+          }
+          evaluator.evaluate(s.m_x.data(), s.m_y.data(), s.m_z.data(), _count, s.m_distance.data());
+          for(size_t i = 0; i < _count; ++i)
+          {
+            g[i * 3] += o.x * s.m_distance[i];
+            g[i * 3 + 1] += o.y * s.m_distance[i];
+            g[i * 3 + 2] += o.z * s.m_distance[i];
+          }
+        }
+        evaluations += _count * 4;
+        const float scale = 1.f / (4.f * h * h);
+        for(size_t i = 0; i < _count * 3; ++i)
+          g[i] *= scale;
+      }
+      m_evaluations += evaluations;
+    }
+  }
+}
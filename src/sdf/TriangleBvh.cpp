@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include <glm/gtc/constants.hpp>
+
+#include "sdf/TriangleBvh.hpp"
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    namespace
+    {
+      ///
+      /// \brief closestOnTriangle Closest point of a triangle, by the regions of its vertices and edges as in Ericson's
+      ///        Real-Time Collision Detection. Degenerate triangles fall back to their edges or their vertex
+      ///
+      glm::vec3 closestOnTriangle(const glm::vec3 &_p, const glm::vec3 &_a, const glm::vec3 &_b, const glm::vec3 &_c)
+      {
+        glm::vec3 ab = _b - _a;
+        glm::vec3 ac = _c - _a;
+        glm::vec3 ap = _p - _a;
+        float d1 = glm::dot(ab, ap);
+        float d2 = glm::dot(ac, ap);
+        if(d1 <= 0.f && d2 <= 0.f)
+          return _a;
+
+        glm::vec3 bp = _p - _b;
+        float d3 = glm::dot(ab, bp);
+        float d4 = glm::dot(ac, bp);
+        if(d3 >= 0.f && d4 <= d3)
+          return _b;
+
+        float vc = d1 * d4 - d3 * d2;
+        if(vc <= 0.f && d1 >= 0.f && d3 <= 0.f)
+          return _a + ab * (d1 / (d1 - d3));
+
+        glm::vec3 cp = _p - _c;
+        float d5 = glm::dot(ab, cp);
+        float d6 = glm::dot(ac, cp);
+        if(d6 >= 0.f && d5 <= d6)
+          return _c;
+
+        float vb = d5 * d2 - d1 * d6;
+        if(vb <= 0.f && d2 >= 0.f && d6 <= 0.f)
+          return _a + ac * (d2 / (d2 - d6));
+
+        float va = d3 * d6 - d5 * d4;
+        if(va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f)
+          return _b + (_c - _b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+        float denominator = va + vb + vc;
+        if(!(denominator > 0.f))
+          return _a;
+        return _a + ab * (vb / denominator) + ac * (vc / denominator);
+      }
+
+      ///
+      /// \brief solidAngle Signed solid angle of a triangle seen from the origin, van Oosterom and Strackee's formula,
+      ///        positive when the triangle is counter-clockwise seen from the origin's side of its back
+      ///
+      float solidAngle(const glm::vec3 &_a, const glm::vec3 &_b, const glm::vec3 &_c)
+      {
+        float la = glm::length(_a);
+        float lb = glm::length(_b);
+        float lc = glm::length(_c);
+        float numerator = glm::dot(_a, glm::cross(_b, _c));
+        float denominator = la * lb * lc + glm::dot(_a, _b) * lc + glm::dot(_b, _c) * la + glm::dot(_c, _a) * lb;
+        return 2.f * std::atan2(numerator, denominator);
+      }
+    }
+
+    TriangleBvh::TriangleBvh(const Mesh &_mesh) :
+      m_points(_mesh.m_indices.empty())
+    {
+      HSITHO_PROFILE_SCOPE("sdf::TriangleBvh::TriangleBvh");
+      size_t count = m_points ? _mesh.m_positions.size() : _mesh.m_indices.size() / 3;
+      m_vertices.resize(count * 3);
+      std::vector<glm::vec3> centroids(count);
+      for(size_t i = 0; i < count; ++i)
+      {
+        for(size_t v = 0; v < 3; ++v)
+          m_vertices[i * 3 + v] = _mesh.m_positions[m_points ? i : _mesh.m_indices[i * 3 + v]];
+        centroids[i] = (m_vertices[i * 3] + m_vertices[i * 3 + 1] + m_vertices[i * 3 + 2]) / 3.f;
+      }
+      m_original.resize(count);
+      std::iota(m_original.begin(), m_original.end(), 0u);
+
+      m_nodes.reserve(count / c_leafSize * 2 + 1);
+      m_nodes.emplace_back();
+      build(0, 0, static_cast<uint32_t>(count), centroids);
+
+      // Leaves index the triangles in the order the build left them in
+      std::vector<glm::vec3> ordered(m_vertices.size());
+      for(size_t i = 0; i < count; ++i)
+        std::copy_n(&m_vertices[m_original[i] * 3], 3, &ordered[i * 3]);
+      m_vertices.swap(ordered);
+    }
+
+    void TriangleBvh::build(uint32_t _node, uint32_t _first, uint32_t _count, const std::vector<glm::vec3> &_centroids)
+    {
+      if(_count <= c_leafSize)
+      {
+        Node node;
+        node.m_min = glm::vec3(std::numeric_limits<float>::max());
+        node.m_max = glm::vec3(-std::numeric_limits<float>::max());
+        node.m_centre = glm::vec3(0.f);
+        node.m_normal = glm::vec3(0.f);
+        node.m_first = _first;
+        node.m_count = _count;
+        node.m_area = 0.f;
+        for(uint32_t i = _first; i < _first + _count; ++i)
+        {
+          const glm::vec3 *v = &m_vertices[m_original[i] * 3];
+          for(int k = 0; k < 3; ++k)
+          {
+            node.m_min = glm::min(node.m_min, v[k]);
+            node.m_max = glm::max(node.m_max, v[k]);
+          }
+          glm::vec3 normal = 0.5f * glm::cross(v[1] - v[0], v[2] - v[0]);
+          float a = glm::length(normal);
+          node.m_normal += normal;
+          node.m_centre += a * _centroids[m_original[i]];
+          node.m_area += a;
+        }
+        node.m_centre = node.m_area > 0.f ? node.m_centre / node.m_area : 0.5f * (node.m_min + node.m_max);
+        node.m_radius = glm::length(glm::max(node.m_max - node.m_centre, node.m_centre - node.m_min));
+        m_nodes[_node] = node;
+        return;
+      }
+
+      glm::vec3 lo(std::numeric_limits<float>::max());
+      glm::vec3 hi(-std::numeric_limits<float>::max());
+      for(uint32_t i = _first; i < _first + _count; ++i)
+      {
+        lo = glm::min(lo, _centroids[m_original[i]]);
+        hi = glm::max(hi, _centroids[m_original[i]]);
+      }
+      glm::vec3 extent = hi - lo;
+      int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+      uint32_t half = _count / 2;
+      std::nth_element(m_original.begin() + _first, m_original.begin() + _first + half, m_original.begin() + _first + _count,
+                       [&](uint32_t _a, uint32_t _b) { return _centroids[_a][axis] < _centroids[_b][axis]; });
+
+      uint32_t children = static_cast<uint32_t>(m_nodes.size());
+      m_nodes.emplace_back();
+      m_nodes.emplace_back();
+      build(children, _first, half, _centroids);
+      build(children + 1, _first + half, _count - half, _centroids);
+
+      const Node &left = m_nodes[children];
+      const Node &right = m_nodes[children + 1];
+      Node node;
+      node.m_min = glm::min(left.m_min, right.m_min);
+      node.m_max = glm::max(left.m_max, right.m_max);
+      node.m_normal = left.m_normal + right.m_normal;
+      // The areas of the children weigh their centres, the sums of the normals are no use where the normals cancel out
+      node.m_area = left.m_area + right.m_area;
+      node.m_centre = node.m_area > 0.f ? (left.m_area * left.m_centre + right.m_area * right.m_centre) / node.m_area : 0.5f * (node.m_min + node.m_max);
+      node.m_radius = glm::length(glm::max(node.m_max - node.m_centre, node.m_centre - node.m_min));
+      node.m_first = children;
+      node.m_count = 0;
+      m_nodes[_node] = node;
+    }
+
+    float TriangleBvh::boxDistance(const Node &_node, const glm::vec3 &_p) const
+    {
+      glm::vec3 d = glm::max(glm::max(_node.m_min - _p, _p - _node.m_max), glm::vec3(0.f));
+      return glm::dot(d, d);
+    }
+
+    glm::vec3 TriangleBvh::closest(const glm::vec3 &_p, float &_bound, uint32_t &_triangle) const
+    {
+      glm::vec3 result(0.f);
+      if(m_vertices.empty())
+        return result;
+
+      // Nodes go on the stack with the distance to their bounds, which may have fallen behind the bound by the time
+      // they're popped
+      struct Entry
+      {
+        uint32_t m_node;
+        float m_distance;
+      };
+      Entry stack[64];
+      unsigned int top = 0;
+      stack[top++] = Entry{0, boxDistance(m_nodes[0], _p)};
+      while(top > 0)
+      {
+        Entry entry = stack[--top];
+        if(entry.m_distance >= _bound)
+          continue;
+        const Node &node = m_nodes[entry.m_node];
+        if(node.m_count > 0)
+        {
+          for(uint32_t i = node.m_first; i < node.m_first + node.m_count; ++i)
+          {
+            const glm::vec3 *v = &m_vertices[i * 3];
+            glm::vec3 q = closestOnTriangle(_p, v[0], v[1], v[2]);
+            glm::vec3 d = q - _p;
+            float distance = glm::dot(d, d);
+            if(distance < _bound)
+            {
+              _bound = distance;
+              _triangle = i;
+              result = q;
+            }
+          }
+          continue;
+        }
+        // The nearer child goes on top so it tightens the bound before the other one is tested
+        Entry left{node.m_first, boxDistance(m_nodes[node.m_first], _p)};
+        Entry right{node.m_first + 1, boxDistance(m_nodes[node.m_first + 1], _p)};
+        if(right.m_distance < left.m_distance)
+          std::swap(left, right);
+        if(right.m_distance < _bound)
+          stack[top++] = right;
+        if(left.m_distance < _bound)
+          stack[top++] = left;
+      }
+      return result;
+    }
+
+    float TriangleBvh::winding(const glm::vec3 &_p) const
+    {
+      if(m_vertices.empty())
+        return 0.f;
+
+      // Nodes this many times their radius away are far enough for their dipole to stand in for their triangles
+      const float beta = 2.f;
+      float sum = 0.f;
+      uint32_t stack[64];
+      unsigned int top = 0;
+      stack[top++] = 0;
+      while(top > 0)
+      {
+        const Node &node = m_nodes[stack[--top]];
+        glm::vec3 d = node.m_centre - _p;
+        float distance = glm::length(d);
+        if(distance > beta * node.m_radius)
+        {
+          sum += glm::dot(d, node.m_normal) / (distance * distance * distance);
+          continue;
+        }
+        if(node.m_count > 0)
+        {
+          for(uint32_t i = node.m_first; i < node.m_first + node.m_count; ++i)
+          {
+            const glm::vec3 *v = &m_vertices[i * 3];
+            sum += solidAngle(v[0] - _p, v[1] - _p, v[2] - _p);
+          }
+          continue;
+        }
+        stack[top++] = node.m_first;
+        stack[top++] = node.m_first + 1;
+      }
+      return sum / (4.f * glm::pi<float>());
+    }
+  }
+}
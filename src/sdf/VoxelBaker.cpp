@@ -0,0 +1,357 @@
+#include <algorithm>
+#include <cmath>
+
+#include "sdf/VoxelBaker.hpp"
+#include "Profiler.hpp"
+
+namespace hsitho
+{
+  namespace sdf
+  {
+    namespace
+    {
+      constexpr size_t c_chunk = 4096;
+      ///
+      /// \brief c_bricksPerTask Bricks evaluated by one task, 4096 points
+      ///
+      constexpr size_t c_bricksPerTask = 8;
+      constexpr unsigned int c_bits = 20;
+      constexpr uint64_t c_mask = (uint64_t(1) << c_bits) - 1;
+      constexpr uint32_t c_maxPoints = 1u << 22;
+      ///
+      /// \brief c_maxTiles Entries of the top table, 256MB of it at most
+      ///
+      constexpr size_t c_maxTiles = size_t(1) << 26;
+
+      ///
+      /// \brief pack Key of a brick or a cell, sorting the keys sorts by z, then y, then x
+      ///
+      uint64_t pack(uint32_t _i, uint32_t _j, uint32_t _k)
+      {
+        return (uint64_t(_k) << (2 * c_bits)) | (uint64_t(_j) << c_bits) | _i;
+      }
+
+      void unpack(uint64_t _key, uint32_t &_i, uint32_t &_j, uint32_t &_k)
+      {
+        _i = static_cast<uint32_t>(_key & c_mask);
+        _j = static_cast<uint32_t>((_key >> c_bits) & c_mask);
+        _k = static_cast<uint32_t>(_key >> (2 * c_bits));
+      }
+
+      int8_t quantise(float _d, float _band)
+      {
+        float q = std::round(std::min(std::max(_d / _band, -1.f), 1.f) * 127.f);
+        return static_cast<int8_t>(q);
+      }
+    }
+
+    VoxelBaker::VoxelBaker(std::shared_ptr<const Program> _program, ThreadPool &_pool) :
+      m_program(_program),
+      m_pool(_pool),
+      m_dims{0, 0, 0},
+      m_bricks{0, 0, 0},
+      m_depth(0),
+      m_evaluations(0)
+    {
+      for(unsigned int i = 0; i < m_pool.size(); ++i)
+      {
+        m_evaluators.emplace_back(new Evaluator(m_program));
+        m_intervalEvaluators.emplace_back(new IntervalEvaluator(m_program));
+      }
+    }
+
+    void VoxelBaker::setTime(float _time)
+    {
+      for(auto &e : m_evaluators)
+        e->setTime(_time);
+      for(auto &e : m_intervalEvaluators)
+        e->setTime(_time);
+    }
+
+    glm::vec3 VoxelBaker::point(uint32_t _i, uint32_t _j, uint32_t _k) const
+    {
+      return m_settings.m_min + glm::vec3(_i, _j, _k) * m_settings.m_voxelSize;
+    }
+
+    bool VoxelBaker::bake(const Settings &_settings, VoxelGrid &_grid, std::string &_error)
+    {
+      HSITHO_PROFILE_SCOPE("VoxelBaker::bake");
+      glm::vec3 extent = _settings.m_max - _settings.m_min;
+      if(!(extent.x > 0.f && extent.y > 0.f && extent.z > 0.f) || !(_settings.m_voxelSize > 0.f) ||
+         !(_settings.m_band > 0.f) || !(_settings.m_lipschitz >= 1.f))
+      {
+        _error = "Empty bounds, a voxel size or band that isn't positive or a Lipschitz bound below 1";
+        return false;
+      }
+      for(int a = 0; a < 3; ++a)
+      {
+        if(!(extent[a] / _settings.m_voxelSize < c_maxPoints))
+        {
+          _error = "Too many grid points, raise the voxel size";
+          return false;
+        }
+      }
+
+      m_settings = _settings;
+      m_evaluations = 0;
+      m_cellsPerLevel.clear();
+      uint32_t largest = 1;
+      for(int a = 0; a < 3; ++a)
+      {
+        m_dims[a] = static_cast<uint32_t>(std::floor(extent[a] / m_settings.m_voxelSize)) + 1;
+        m_bricks[a] = (m_dims[a] + VoxelGridView::c_brick - 1) / VoxelGridView::c_brick;
+        largest = std::max(largest, m_bricks[a]);
+      }
+      size_t tiles = 1;
+      for(int a = 0; a < 3; ++a)
+        tiles *= (m_bricks[a] + VoxelGridView::c_tile - 1) / VoxelGridView::c_tile;
+      if(tiles > c_maxTiles)
+      {
+        _error = "Too many tiles for the top table, raise the voxel size or shrink the bounds";
+        return false;
+      }
+      m_depth = 0;
+      while((1u << m_depth) < largest)
+        ++m_depth;
+
+      std::vector<uint64_t> bricks;
+      std::vector<Dropped> dropped;
+      findBandBricks(bricks, dropped);
+      std::vector<int8_t> values;
+      sampleBricks(bricks, values);
+
+      _grid = VoxelGrid();
+      assemble(bricks, values, dropped, _grid);
+      return true;
+    }
+
+    void VoxelBaker::findBandBricks(std::vector<uint64_t> &_bricks, std::vector<Dropped> &_dropped)
+    {
+      HSITHO_PROFILE_SCOPE("VoxelBaker::findBandBricks");
+      const float band = m_settings.m_band * m_settings.m_voxelSize;
+      std::vector<uint64_t> level(1, pack(0, 0, 0));
+      for(unsigned int l = 0; l <= m_depth; ++l)
+      {
+        m_cellsPerLevel.push_back(level.size());
+        // Side of a cell of this level in bricks, the box of a cell spans its first to its last grid point
+        uint32_t scale = 1u << (m_depth - l);
+        uint32_t points = scale * VoxelGridView::c_brick;
+        float size = (points - 1) * m_settings.m_voxelSize;
+        float bound = 0.5f * std::sqrt(3.f) * size * m_settings.m_lipschitz + band;
+        bool leaf = l == m_depth;
+
+        size_t chunks = (level.size() + c_chunk - 1) / c_chunk;
+        std::vector<std::vector<uint64_t>> next(chunks);
+        std::vector<std::vector<Dropped>> dropped(chunks);
+        m_pool.parallelFor(chunks, [&](size_t _chunk, unsigned int _worker) {
+          size_t first = _chunk * c_chunk;
+          size_t last = std::min(level.size(), first + c_chunk);
+          // 0 keeps the cell, otherwise which side of the band it's on
+          std::vector<int> side(last - first, 0);
+          if(m_settings.m_pruning == Mesher::Pruning::INTERVAL)
+          {
+            IntervalEvaluator &evaluator = *m_intervalEvaluators[_worker];
+            for(size_t c = first; c < last; ++c)
+            {
+              uint32_t i, j, k;
+              unpack(level[c], i, j, k);
+              glm::vec3 lo = point(i * points, j * points, k * points);
+              Interval r = evaluator.evaluate(lo, lo + glm::vec3(size));
+              side[c - first] = r.m_lo > band ? 1 : (r.m_hi < -band ? -1 : 0);
+            }
+            m_evaluations += last - first;
+          }
+          else
+          {
+            std::vector<float> x, y, z, d(last - first);
+            for(size_t c = first; c < last; ++c)
+            {
+              uint32_t i, j, k;
+              unpack(level[c], i, j, k);
+              glm::vec3 centre = point(i * points, j * points, k * points) + glm::vec3(0.5f * size);
+              x.push_back(centre.x);
+              y.push_back(centre.y);
+              z.push_back(centre.z);
+            }
+            m_evaluators[_worker]->evaluate(x.data(), y.data(), z.data(), d.size(), d.data());
+            m_evaluations += d.size();
+            for(size_t c = 0; c < d.size(); ++c)
+              side[c] = std::fabs(d[c]) <= bound ? 0 : (d[c] > 0.f ? 1 : -1);
+          }
+
+          for(size_t c = first; c < last; ++c)
+          {
+            if(side[c - first] != 0)
+            {
+              dropped[_chunk].push_back(Dropped{level[c], l, side[c - first] < 0});
+              continue;
+            }
+            if(leaf)
+            {
+              next[_chunk].push_back(level[c]);
+              continue;
+            }
+            uint32_t i, j, k;
+            unpack(level[c], i, j, k);
+            uint32_t half = scale / 2;
+            for(unsigned int child = 0; child < 8; ++child)
+            {
+              uint32_t ci = i * 2 + (child & 1), cj = j * 2 + ((child >> 1) & 1), ck = k * 2 + ((child >> 2) & 1);
+              // Children completely outside the grid are never created
+              if(ci * half < m_bricks[0] && cj * half < m_bricks[1] && ck * half < m_bricks[2])
+                next[_chunk].push_back(pack(ci, cj, ck));
+            }
+          }
+        });
+
+        level.clear();
+        for(auto &n : next)
+          level.insert(level.end(), n.begin(), n.end());
+        for(auto &d : dropped)
+          _dropped.insert(_dropped.end(), d.begin(), d.end());
+      }
+      m_cellsPerLevel.push_back(level.size());
+      std::sort(level.begin(), level.end());
+      _bricks.swap(level);
+    }
+
+    void VoxelBaker::sampleBricks(const std::vector<uint64_t> &_bricks, std::vector<int8_t> &_values)
+    {
+      HSITHO_PROFILE_SCOPE("VoxelBaker::sampleBricks");
+      const uint32_t n = VoxelGridView::c_brick;
+      const float band = m_settings.m_band * m_settings.m_voxelSize;
+      _values.resize(_bricks.size() * VoxelGridView::c_brickPoints);
+      size_t tasks = (_bricks.size() + c_bricksPerTask - 1) / c_bricksPerTask;
+      m_pool.parallelFor(tasks, [&](size_t _task, unsigned int _worker) {
+        size_t first = _task * c_bricksPerTask;
+        size_t last = std::min(_bricks.size(), first + c_bricksPerTask);
+        size_t count = (last - first) * VoxelGridView::c_brickPoints;
+        std::vector<float> x, y, z, d(count);
+        x.reserve(count);
+        y.reserve(count);
+        z.reserve(count);
+        for(size_t b = first; b < last; ++b)
+        {
+          uint32_t bi, bj, bk;
+          unpack(_bricks[b], bi, bj, bk);
+          // Points past the end of the grid are still evaluated so every brick is full
+          for(uint32_t k = 0; k < n; ++k)
+            for(uint32_t j = 0; j < n; ++j)
+              for(uint32_t i = 0; i < n; ++i)
+              {
+                glm::vec3 p = point(bi * n + i, bj * n + j, bk * n + k);
+                x.push_back(p.x);
+                y.push_back(p.y);
+                z.push_back(p.z);
+              }
+        }
+        m_evaluators[_worker]->evaluate(x.data(), y.data(), z.data(), count, d.data());
+        m_evaluations += count;
+        int8_t *out = _values.data() + first * VoxelGridView::c_brickPoints;
+        for(size_t i = 0; i < count; ++i)
+          out[i] = quantise(d[i], band);
+      });
+    }
+
+    void VoxelBaker::assemble(const std::vector<uint64_t> &_bricks, std::vector<int8_t> &_values, const std::vector<Dropped> &_dropped, VoxelGrid &_grid)
+    {
+      HSITHO_PROFILE_SCOPE("VoxelBaker::assemble");
+      const uint32_t tile = VoxelGridView::c_tile;
+      VoxelGridHeader &h = _grid.m_header;
+      std::copy_n("HSVG", 4, h.m_magic);
+      h.m_version = VoxelGridHeader::c_version;
+      h.m_byteOrder = VoxelGridHeader::c_byteOrder;
+      for(int a = 0; a < 3; ++a)
+      {
+        h.m_dims[a] = m_dims[a];
+        h.m_tiles[a] = (m_bricks[a] + tile - 1) / tile;
+        h.m_min[a] = m_settings.m_min[a];
+      }
+      h.m_voxelSize = m_settings.m_voxelSize;
+      h.m_band = m_settings.m_band * m_settings.m_voxelSize;
+      h.m_topOffset = h.m_nodesOffset = h.m_bricksOffset = h.m_size = 0;
+
+      _grid.m_top.assign(static_cast<size_t>(h.m_tiles[0]) * h.m_tiles[1] * h.m_tiles[2], VoxelGridView::c_outside);
+      std::vector<size_t> nodeTiles;
+      auto tileIndex = [&](uint32_t _i, uint32_t _j, uint32_t _k) { return (static_cast<size_t>(_k) * h.m_tiles[1] + _j) * h.m_tiles[0] + _i; };
+      // Entry of a brick in the node of its tile, the node is created the first time one of its bricks is set
+      auto brickEntry = [&](uint32_t _i, uint32_t _j, uint32_t _k) -> uint32_t & {
+        uint32_t &top = _grid.m_top[tileIndex(_i / tile, _j / tile, _k / tile)];
+        if(top >= VoxelGridView::c_inside)
+        {
+          top = static_cast<uint32_t>(nodeTiles.size());
+          nodeTiles.push_back(tileIndex(_i / tile, _j / tile, _k / tile));
+          _grid.m_nodes.resize(_grid.m_nodes.size() + VoxelGridView::c_nodeEntries, VoxelGridView::c_outside);
+        }
+        return _grid.m_nodes[static_cast<size_t>(top) * VoxelGridView::c_nodeEntries + ((_k % tile) * tile + (_j % tile)) * tile + (_i % tile)];
+      };
+
+      for(const Dropped &d : _dropped)
+      {
+        uint32_t side = d.m_inside ? VoxelGridView::c_inside : VoxelGridView::c_outside;
+        uint32_t scale = 1u << (m_depth - d.m_level);
+        uint32_t i, j, k;
+        unpack(d.m_key, i, j, k);
+        uint32_t lo[3] = {i * scale, j * scale, k * scale};
+        uint32_t hi[3];
+        for(int a = 0; a < 3; ++a)
+          hi[a] = std::min(lo[a] + scale, m_bricks[a]);
+        if(scale >= tile)
+        {
+          // Whole tiles, cells are aligned to their size so they never cover part of a tile
+          for(uint32_t tk = lo[2] / tile; tk * tile < hi[2]; ++tk)
+            for(uint32_t tj = lo[1] / tile; tj * tile < hi[1]; ++tj)
+              for(uint32_t ti = lo[0] / tile; ti * tile < hi[0]; ++ti)
+                _grid.m_top[tileIndex(ti, tj, tk)] = side;
+        }
+        else
+        {
+          for(uint32_t bk = lo[2]; bk < hi[2]; ++bk)
+            for(uint32_t bj = lo[1]; bj < hi[1]; ++bj)
+              for(uint32_t bi = lo[0]; bi < hi[0]; ++bi)
+                brickEntry(bi, bj, bk) = side;
+        }
+      }
+
+      // Bricks whose points all ended up clamped to the same side of the band are stored as that side
+      uint32_t kept = 0;
+      for(size_t b = 0; b < _bricks.size(); ++b)
+      {
+        const int8_t *v = _values.data() + b * VoxelGridView::c_brickPoints;
+        bool outside = std::all_of(v, v + VoxelGridView::c_brickPoints, [](int8_t _q) { return _q == 127; });
+        bool inside = std::all_of(v, v + VoxelGridView::c_brickPoints, [](int8_t _q) { return _q == -127; });
+        uint32_t i, j, k;
+        unpack(_bricks[b], i, j, k);
+        if(outside || inside)
+        {
+          brickEntry(i, j, k) = inside ? VoxelGridView::c_inside : VoxelGridView::c_outside;
+          continue;
+        }
+        if(kept != b)
+          std::copy_n(v, VoxelGridView::c_brickPoints, _values.data() + static_cast<size_t>(kept) * VoxelGridView::c_brickPoints);
+        brickEntry(i, j, k) = kept++;
+      }
+      _values.resize(static_cast<size_t>(kept) * VoxelGridView::c_brickPoints);
+      _grid.m_bricks.swap(_values);
+
+      // Nodes that only hold one side go back into the top table
+      uint32_t nodes = 0;
+      for(uint32_t n = 0; n < nodeTiles.size(); ++n)
+      {
+        const uint32_t *entries = _grid.m_nodes.data() + static_cast<size_t>(n) * VoxelGridView::c_nodeEntries;
+        uint32_t first = entries[0];
+        if(first >= VoxelGridView::c_inside && std::all_of(entries, entries + VoxelGridView::c_nodeEntries, [&](uint32_t _e) { return _e == first; }))
+        {
+          _grid.m_top[nodeTiles[n]] = first;
+          continue;
+        }
+        if(nodes != n)
+          std::copy_n(entries, VoxelGridView::c_nodeEntries, _grid.m_nodes.data() + static_cast<size_t>(nodes) * VoxelGridView::c_nodeEntries);
+        _grid.m_top[nodeTiles[n]] = nodes++;
+      }
+      _grid.m_nodes.resize(static_cast<size_t>(nodes) * VoxelGridView::c_nodeEntries);
+      h.m_nodeCount = nodes;
+      h.m_brickCount = kept;
+    }
+  }
+}
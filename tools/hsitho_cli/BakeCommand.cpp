@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+
+#include "sdf/Evaluator.hpp"
+#include "sdf/VoxelBaker.hpp"
+#include "CliScene.hpp"
+#include "Commands.hpp"
+#include "ThreadPool.hpp"
+#include "VoxelFile.hpp"
+
+namespace hsitho
+{
+  namespace cli
+  {
+    int bakeCommand(const QStringList &_args)
+    {
+      QCommandLineParser parser;
+      parser.setApplicationDescription("Bakes the distance field of a .flow file into a sparse narrow band voxel grid, runs on the CPU only.");
+      parser.addHelpOption();
+      addCommonOptions(parser);
+      parser.addOption(QCommandLineOption(QStringList() << "o" << "output", "Output grid.", "file", "grid.hsvg"));
+      parser.addOption(QCommandLineOption("min", "Lower corner of the bounds.", "x,y,z", "-5,-5,-5"));
+      parser.addOption(QCommandLineOption("max", "Upper corner of the bounds.", "x,y,z", "5,5,5"));
+      parser.addOption(QCommandLineOption("voxel-size", "Distance between grid points.", "size", "0.05"));
+      parser.addOption(QCommandLineOption("band", "Half width of the band around the surface in voxels.", "voxels", "3"));
+      parser.addOption(QCommandLineOption("pruning", "Drop octree cells by the distance at their centre or by interval bounds over them.", "distance|interval", "distance"));
+      parser.addOption(QCommandLineOption("lipschitz", "Bound on how fast the field changes, raise it for scenes with scaled primitives.", "value", "1"));
+      parser.addOption(QCommandLineOption("threads", "Threads, 0 for one per core.", "count", "0"));
+      parser.addOption(QCommandLineOption("verify", "Map the written file and compare this many random grid points with the distance field.", "count", "0"));
+      parser.process(_args);
+
+      CommonOptions options;
+      std::string error;
+      if(!readCommonOptions(parser, options, error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+      options.m_cpu = true;
+
+      sdf::VoxelBaker::Settings settings;
+      bool ok[5];
+      settings.m_voxelSize = parser.value("voxel-size").toFloat(&ok[0]);
+      settings.m_band = parser.value("band").toFloat(&ok[1]);
+      settings.m_lipschitz = parser.value("lipschitz").toFloat(&ok[2]);
+      unsigned int threads = parser.value("threads").toUInt(&ok[3]);
+      unsigned int verify = parser.value("verify").toUInt(&ok[4]);
+      QString pruning = parser.value("pruning");
+      if(!(ok[0] && ok[1] && ok[2] && ok[3] && ok[4]) || (pruning != "distance" && pruning != "interval") ||
+         !parseVec3(parser.value("min"), settings.m_min) || !parseVec3(parser.value("max"), settings.m_max))
+      {
+        std::cerr << "Invalid voxel size, band, pruning, Lipschitz bound, threads, verify count or bounds\n";
+        return EXIT_FAILURE;
+      }
+      settings.m_pruning = pruning == "distance" ? sdf::Mesher::Pruning::DISTANCE : sdf::Mesher::Pruning::INTERVAL;
+
+      QElapsedTimer timer;
+      timer.start();
+      options.m_threads = threads;
+      Scene scene(options);
+      if(!scene.load(error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+      qint64 loadMs = timer.restart();
+
+      ThreadPool &pool = scene.pool();
+      sdf::VoxelBaker baker(scene.program(), pool);
+      baker.setTime(options.m_time);
+      sdf::VoxelGrid grid;
+      if(!baker.bake(settings, grid, error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+      qint64 bakeMs = timer.restart();
+
+      std::string output = parser.value("output").toStdString();
+      if(!writeVoxelGrid(output, grid, error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+      qint64 writeMs = timer.restart();
+
+      const sdf::VoxelGridHeader &h = grid.m_header;
+      double dense = static_cast<double>(h.m_dims[0]) * h.m_dims[1] * h.m_dims[2];
+      double sparse = static_cast<double>(grid.m_top.size() + grid.m_nodes.size()) * sizeof(uint32_t) + grid.m_bricks.size();
+      std::cout << output << ": " << h.m_dims[0] << "x" << h.m_dims[1] << "x" << h.m_dims[2] << " points, " << h.m_nodeCount << " tile nodes, "
+                << h.m_brickCount << " bricks, " << sparse / (1 << 20) << " MB (" << dense / (1 << 20) << " MB dense)\n  cells per level";
+      for(size_t cells : baker.cellsPerLevel())
+        std::cout << " " << cells;
+      std::cout << "\n  load and compile " << loadMs << " ms, bake " << bakeMs << " ms with " << pool.size() << " threads, "
+                << baker.evaluations() << " evaluations, write " << writeMs << " ms\n";
+
+      if(verify > 0)
+      {
+        MappedVoxelGrid mapped;
+        if(!mapped.open(output, error))
+        {
+          std::cerr << error << "\n";
+          return EXIT_FAILURE;
+        }
+        // Every grid point is off by at most half a quantisation step from the clamped distance
+        sdf::Evaluator evaluator(scene.program());
+        evaluator.setTime(options.m_time);
+        std::mt19937 rng(1);
+        float worst = 0.f;
+        for(unsigned int n = 0; n < verify; ++n)
+        {
+          uint32_t p[3];
+          for(int a = 0; a < 3; ++a)
+            p[a] = std::uniform_int_distribution<uint32_t>(0, h.m_dims[a] - 1)(rng);
+          float d = evaluator.evaluate(settings.m_min + glm::vec3(p[0], p[1], p[2]) * settings.m_voxelSize).x;
+          float expected = std::min(std::max(d, -h.m_band), h.m_band);
+          worst = std::max(worst, std::fabs(mapped.view().value(p[0], p[1], p[2]) - expected));
+        }
+        float step = h.m_band / 127.f;
+        std::cout << "  verified " << verify << " points, largest error " << worst << " (quantisation step " << step << ")\n";
+        if(worst > 0.51f * step)
+        {
+          std::cerr << "The grid doesn't match the distance field\n";
+          return EXIT_FAILURE;
+        }
+      }
+      return EXIT_SUCCESS;
+    }
+  }
+}
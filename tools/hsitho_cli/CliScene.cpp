@@ -0,0 +1,166 @@
+#include <iostream>
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QUuid>
+
+#include "nodes/DistanceFieldOutputDataModel.hpp"
+#include "sdf/SceneCompiler.hpp"
+#include "AllocationTracker.hpp"
+#include "CompileArena.hpp"
+#include "CliScene.hpp"
+
+namespace hsitho
+{
+  namespace cli
+  {
+    void addCommonOptions(QCommandLineParser &_parser)
+    {
+      _parser.addPositionalArgument("scene", "The .flow file to render.");
+      _parser.addOption(QCommandLineOption("shaders", "Directory containing shader.begin, shader.end and screenQuad.vert.", "dir", "shaders"));
+      _parser.addOption(QCommandLineOption("camera", "Camera position, the camera looks at the origin.", "x,y,z", "0,1.98246,14.86842"));
+      _parser.addOption(QCommandLineOption("up", "Camera up vector.", "x,y,z", "0,1,0"));
+      _parser.addOption(QCommandLineOption("time", "Value of u_GlobalTime.", "seconds", "0"));
+      _parser.addOption(QCommandLineOption("analytic-normals", "Use the dual-number map for the normals."));
+      _parser.addOption(QCommandLineOption("trace", "Write the profiler zones as a Chrome trace on exit, needs a CONFIG+=hsitho_profile build.", "file"));
+    }
+
+    bool parseVec3(const QString &_text, glm::vec3 &_v)
+    {
+      QStringList parts = _text.split(',');
+      if(parts.size() != 3)
+        return false;
+
+      bool ok = true;
+      for(int i = 0; i < 3 && ok; ++i)
+        _v[i] = parts[i].trimmed().toFloat(&ok);
+      return ok;
+    }
+
+    bool readCommonOptions(const QCommandLineParser &_parser, CommonOptions &_options, std::string &_error)
+    {
+      QStringList positional = _parser.positionalArguments();
+      // The first positional argument is the name of the command
+      if(positional.size() < 2)
+      {
+        _error = "No scene given";
+        return false;
+      }
+      _options.m_scene = positional[1].toStdString();
+      _options.m_shaderDir = _parser.value("shaders").toStdString();
+      _options.m_analyticNormals = _parser.isSet("analytic-normals");
+
+      bool ok;
+      _options.m_time = _parser.value("time").toFloat(&ok);
+      if(!ok)
+      {
+        _error = "Invalid --time";
+        return false;
+      }
+      if(!parseVec3(_parser.value("camera"), _options.m_eye))
+      {
+        _error = "Invalid --camera, expected x,y,z";
+        return false;
+      }
+      if(!parseVec3(_parser.value("up"), _options.m_up))
+      {
+        _error = "Invalid --up, expected x,y,z";
+        return false;
+      }
+      return true;
+    }
+
+    Scene::Scene(const CommonOptions &_options) :
+      m_options(_options),
+      m_flowScene(new FlowScene(nullptr)),
+      m_pool(_options.m_threads),
+      m_generator(m_pool, _options.m_shaderDir),
+      m_renderer(_options.m_shaderDir),
+      m_initialised(false),
+      m_generateMs(0.f),
+      m_compileMs(0.f)
+    {
+      // Same static distance node the editor creates, the saved connections refer to its id
+      m_outputNode = m_flowScene->createNode(std::make_unique<DistanceFieldOutputDataModel>(), false, QUuid("ffffffff-ffff-ffff-ffff-ffffffffffff"));
+    }
+
+    bool Scene::load(std::string &_error)
+    {
+      if(!m_generator.isValid())
+      {
+        _error = "Couldn't read shader.begin and shader.end from " + m_options.m_shaderDir;
+        return false;
+      }
+      AllocationTracker::beginCompile();
+      if(!QFileInfo::exists(QString::fromStdString(m_options.m_scene)) || !m_flowScene->load(QString::fromStdString(m_options.m_scene)))
+      {
+        _error = "Couldn't load " + m_options.m_scene;
+        return false;
+      }
+
+      bool compiled = compile(_error);
+      if(AllocationTracker::compiledIn())
+        AllocationTracker::report(std::cerr);
+      return compiled;
+    }
+
+    bool Scene::compile(std::string &_error)
+    {
+      if(!m_generator.isValid())
+      {
+        _error = "Couldn't read shader.begin and shader.end from " + m_options.m_shaderDir;
+        return false;
+      }
+
+      CompileArena arena;
+      QElapsedTimer timer;
+      timer.start();
+      m_generator.setAnalyticNormals(m_options.m_analyticNormals);
+      m_fragmentShader = m_generator.generate(m_flowScene->getNodes());
+      m_generateMs = timer.nsecsElapsed() / 1e6f;
+      if(m_fragmentShader == "")
+      {
+        _error = "Nothing is connected to the distance node in " + (m_options.m_scene.empty() ? std::string("the scene") : m_options.m_scene);
+        return false;
+      }
+
+      // The CPU backend doesn't need a GL context at all
+      if(m_options.m_cpu)
+      {
+        timer.restart();
+        std::string map = m_generator.generateMap(m_flowScene->getNodes());
+        m_program = sdf::SceneCompiler::compileMap(map, _error, false, m_generator.volumes(), m_generator.instanceSets());
+        if(!m_program)
+        {
+          _error = "Couldn't compile the scene for the CPU: " + _error;
+          return false;
+        }
+        m_compileMs = timer.nsecsElapsed() / 1e6f;
+        return sdf::Raymarcher::sceneLights(m_flowScene->getNodes(), m_options.m_time, m_lights, _error);
+      }
+
+      if(!m_initialised)
+      {
+        if(!m_renderer.initialise(_error))
+          return false;
+        m_initialised = true;
+      }
+
+      std::string log;
+      timer.restart();
+      bool compiled = m_renderer.setFragmentShader(m_fragmentShader, log);
+      m_compileMs = timer.nsecsElapsed() / 1e6f;
+      if(!compiled)
+      {
+        _error = "Couldn't compile the scene shader:\n" + log;
+        return false;
+      }
+
+      m_renderer.setVolumes(m_generator.volumes());
+      m_renderer.setInstances(m_generator.instanceSets());
+      m_renderer.setCamera(m_options.m_eye, m_options.m_up);
+      m_renderer.setTime(m_options.m_time);
+      return true;
+    }
+  }
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <QCommandLineParser>
+
+#include <glm/glm.hpp>
+
+#include "nodeEditor/FlowScene.hpp"
+#include "sdf/Program.hpp"
+#include "sdf/Raymarcher.hpp"
+#include "OffscreenRenderer.hpp"
+#include "ShaderGenerator.hpp"
+#include "ThreadPool.hpp"
+
+/// \file CliScene.hpp
+/// \brief Common parts of the subcommands: the options shared by all of them, loading of a .flow file
+///        and setting up the offscreen renderer with the generated shader
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace cli
+  {
+    struct CommonOptions
+    {
+      std::string m_scene;
+      std::string m_shaderDir = "shaders";
+      glm::vec3 m_eye = glm::vec3(0.f, 0.132164f, 0.991228f) * 15.f;
+      glm::vec3 m_up = glm::vec3(0.f, 1.f, 0.f);
+      float m_time = 0.f;
+      bool m_analyticNormals = false;
+      ///
+      /// \brief m_cpu Compile the scene for the CPU raymarcher instead of setting up the GL renderer
+      ///
+      bool m_cpu = false;
+      ///
+      /// \brief m_threads Workers of the thread pool of the scene, 0 for one per core
+      ///
+      unsigned int m_threads = 0;
+    };
+
+    ///
+    /// \brief addCommonOptions Adds the scene, shader directory, camera and time options to a parser
+    /// \param _parser Parser of a subcommand
+    ///
+    void addCommonOptions(QCommandLineParser &_parser);
+    ///
+    /// \brief readCommonOptions Reads the common options after the arguments have been parsed
+    /// \param _parser Parser of a subcommand
+    /// \param _options Options read from the parser
+    /// \param _error Reason of the failure
+    /// \return False if an option is missing or malformed
+    ///
+    bool readCommonOptions(const QCommandLineParser &_parser, CommonOptions &_options, std::string &_error);
+    ///
+    /// \brief parseVec3 Parses a vector given as x,y,z
+    /// \param _text Text to parse
+    /// \param _v The vector
+    /// \return False if the text isn't three comma separated numbers
+    ///
+    bool parseVec3(const QString &_text, glm::vec3 &_v);
+
+    class Scene
+    {
+    public:
+      Scene(const CommonOptions &_options);
+
+      ///
+      /// \brief load Loads the .flow file, generates the shader and sets up the renderer with it
+      /// \param _error Reason of the failure
+      /// \return False if any of the steps failed
+      ///
+      bool load(std::string &_error);
+      ///
+      /// \brief compile Generates the shader from the nodes currently in the scene and sets up the renderer with it,
+      ///        or compiles the distance field and the lights for the CPU with m_cpu,
+      ///        used directly when the scene is built in code instead of loaded from a file
+      /// \param _error Reason of the failure
+      /// \return False if nothing is connected or the shader didn't compile
+      ///
+      bool compile(std::string &_error);
+
+      FlowScene &flowScene() { return *m_flowScene; }
+      std::shared_ptr<Node> outputNode() { return m_outputNode; }
+      ShaderGenerator &generator() { return m_generator; }
+      ///
+      /// \brief pool Threads meshes are baked and copies scattered on while generating, for the command's own CPU work too
+      ///
+      ThreadPool &pool() { return m_pool; }
+      OffscreenRenderer &renderer() { return m_renderer; }
+      const std::string &fragmentShader() const { return m_fragmentShader; }
+      ///
+      /// \brief program The distance field compiled for the CPU, only with m_cpu
+      ///
+      std::shared_ptr<const sdf::Program> program() const { return m_program; }
+      ///
+      /// \brief lights The light nodes evaluated at the time of the scene, empty for the default rig, only with m_cpu
+      ///
+      const std::vector<sdf::Light> &lights() const { return m_lights; }
+      ///
+      /// \brief generateTime Time the last compile spent generating the shader source in milliseconds
+      ///
+      float generateTime() const { return m_generateMs; }
+      ///
+      /// \brief compileTime Time the last compile spent compiling and linking the shader in milliseconds
+      ///
+      float compileTime() const { return m_compileMs; }
+
+    private:
+      CommonOptions m_options;
+      std::unique_ptr<FlowScene> m_flowScene;
+      std::shared_ptr<Node> m_outputNode;
+      ThreadPool m_pool;
+      ShaderGenerator m_generator;
+      OffscreenRenderer m_renderer;
+      std::string m_fragmentShader;
+      std::shared_ptr<const sdf::Program> m_program;
+      std::vector<sdf::Light> m_lights;
+      bool m_initialised;
+      float m_generateMs;
+      float m_compileMs;
+    };
+  }
+}
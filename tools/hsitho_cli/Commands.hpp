@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QStringList>
+
+/// \file Commands.hpp
+/// \brief Subcommands of the command line tool, each one parses its own arguments and returns the exit code
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace cli
+  {
+    ///
+    /// \brief renderCommand Renders a single image of a .flow file
+    /// \param _args Arguments, the first one being the name of the command
+    /// \return Exit code
+    ///
+    int renderCommand(const QStringList &_args);
+    ///
+    /// \brief sequenceCommand Renders an animation of a .flow file, frames are read back asynchronously and encoded in parallel
+    /// \param _args Arguments, the first one being the name of the command
+    /// \return Exit code
+    ///
+    int sequenceCommand(const QStringList &_args);
+    ///
+    /// \brief posterCommand Renders an image larger than a framebuffer in tiles, streaming the rows to disk
+    /// \param _args Arguments, the first one being the name of the command
+    /// \return Exit code
+    ///
+    int posterCommand(const QStringList &_args);
+    ///
+    /// \brief validateCommand Compares the distance field evaluated on the CPU with the shader over a grid of points
+    /// \param _args Arguments, the first one being the name of the command
+    /// \return Exit code
+    ///
+    int validateCommand(const QStringList &_args);
+    ///
+    /// \brief meshCommand Extracts a mesh of the distance field and writes it as OBJ or PLY
+    /// \param _args Arguments, the first one being the name of the command
+    /// \return Exit code
+    ///
+    int meshCommand(const QStringList &_args);
+    ///
+    /// \brief bakeCommand Bakes the distance field into a sparse voxel grid file
+    /// \param _args Arguments, the first one being the name of the command
+    /// \return Exit code
+    ///
+    int bakeCommand(const QStringList &_args);
+    ///
+    /// \brief queryCommand Evaluates the distance field at the points of a binary file
+    /// \param _args Arguments, the first one being the name of the command
+    /// \return Exit code
+    ///
+    int queryCommand(const QStringList &_args);
+  }
+}
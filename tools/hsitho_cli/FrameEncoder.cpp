@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include <QImage>
+
+#include "ImageWriter.hpp"
+#include "FrameEncoder.hpp"
+
+namespace hsitho
+{
+  namespace cli
+  {
+    FrameEncoder::FrameEncoder(unsigned int _threads, unsigned int _maxQueued) :
+      m_maxQueued(std::max(_maxQueued, 1u)),
+      m_busy(0),
+      m_failed(0),
+      m_stop(false),
+      m_blockedMs(0.0)
+    {
+      for(unsigned int i = 0; i < std::max(_threads, 1u); ++i)
+        m_threads.emplace_back(&FrameEncoder::run, this);
+    }
+
+    FrameEncoder::~FrameEncoder()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+      }
+      m_hasWork.notify_all();
+      for(auto &thread : m_threads)
+        thread.join();
+    }
+
+    void FrameEncoder::push(EncodeJob &&_job)
+    {
+      auto start = std::chrono::steady_clock::now();
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_hasSpace.wait(lock, [this] { return m_queue.size() < m_maxQueued; });
+      m_blockedMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      m_queue.push_back(std::move(_job));
+      lock.unlock();
+      m_hasWork.notify_one();
+    }
+
+    unsigned int FrameEncoder::finish()
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_hasSpace.wait(lock, [this] { return m_queue.empty() && m_busy == 0; });
+      return m_failed;
+    }
+
+    void FrameEncoder::run()
+    {
+      for(;;)
+      {
+        EncodeJob job;
+        {
+          std::unique_lock<std::mutex> lock(m_mutex);
+          m_hasWork.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+          if(m_queue.empty())
+            return;
+          job = std::move(m_queue.front());
+          m_queue.pop_front();
+          ++m_busy;
+        }
+        m_hasSpace.notify_all();
+
+        bool success = encode(job);
+
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          --m_busy;
+          if(!success)
+            ++m_failed;
+        }
+        m_hasSpace.notify_all();
+      }
+    }
+
+    bool FrameEncoder::encode(EncodeJob &_job)
+    {
+      if(_job.m_float)
+      {
+        // Flip to top row first while copying out of the raw bytes
+        std::vector<float> rgba(static_cast<size_t>(_job.m_width) * _job.m_height * 4);
+        size_t row = static_cast<size_t>(_job.m_width) * 4;
+        const float *src = reinterpret_cast<const float *>(_job.m_data.data());
+        for(int y = 0; y < _job.m_height; ++y)
+          std::copy(src + (_job.m_height - 1 - y) * row, src + (_job.m_height - y) * row, rgba.begin() + y * row);
+
+        std::string error;
+        if(!writeImage(_job.m_path, _job.m_width, _job.m_height, rgba, error))
+        {
+          std::cerr << error << "\n";
+          return false;
+        }
+        return true;
+      }
+
+      QImage image(_job.m_data.data(), _job.m_width, _job.m_height, QImage::Format_RGBA8888);
+      if(!image.mirrored().save(QString::fromStdString(_job.m_path)))
+      {
+        std::cerr << "Couldn't write " << _job.m_path << "\n";
+        return false;
+      }
+      return true;
+    }
+  }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// \file FrameEncoder.hpp
+/// \brief Pool of threads compressing read back frames to disk while the GPU keeps rendering,
+///        the queue is bounded so that a slow disk can't make the frames pile up in memory
+/// \authors Teemu Lindborg & Phil Gifford
+/// \version 1.0
+/// \date 19/10/26 Initial version
+
+namespace hsitho
+{
+  namespace cli
+  {
+    struct EncodeJob
+    {
+      std::string m_path;
+      int m_width = 0;
+      int m_height = 0;
+      ///
+      /// \brief m_float Whether the data is RGBA floats or RGBA bytes
+      ///
+      bool m_float = false;
+      ///
+      /// \brief m_data Pixels bottom row first, as read back from GL
+      ///
+      std::vector<unsigned char> m_data;
+    };
+
+    class FrameEncoder
+    {
+    public:
+      ///
+      /// \brief FrameEncoder Starts the encoder threads
+      /// \param _threads Number of threads
+      /// \param _maxQueued Number of frames waiting to be encoded before push blocks
+      ///
+      FrameEncoder(unsigned int _threads, unsigned int _maxQueued);
+      ///
+      /// \brief ~FrameEncoder Finishes the queued frames and joins the threads
+      ///
+      ~FrameEncoder();
+
+      ///
+      /// \brief push Queues a frame, blocks while the queue is full
+      /// \param _job The frame, moved into the queue
+      ///
+      void push(EncodeJob &&_job);
+      ///
+      /// \brief finish Waits until every queued frame has been written
+      /// \return Number of frames that couldn't be written
+      ///
+      unsigned int finish();
+      ///
+      /// \brief blockedMs Time push has spent waiting for the encoders
+      ///
+      double blockedMs() const { return m_blockedMs; }
+
+    private:
+      void run();
+      static bool encode(EncodeJob &_job);
+
+      std::vector<std::thread> m_threads;
+      std::deque<EncodeJob> m_queue;
+      std::mutex m_mutex;
+      std::condition_variable m_hasWork;
+      std::condition_variable m_hasSpace;
+      unsigned int m_maxQueued;
+      unsigned int m_busy;
+      unsigned int m_failed;
+      bool m_stop;
+      double m_blockedMs;
+    };
+  }
+}
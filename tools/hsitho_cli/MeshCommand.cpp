@@ -0,0 +1,95 @@
+#include <iostream>
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+
+#include "sdf/Mesher.hpp"
+#include "CliScene.hpp"
+#include "Commands.hpp"
+#include "MeshWriter.hpp"
+#include "ThreadPool.hpp"
+
+namespace hsitho
+{
+  namespace cli
+  {
+    int meshCommand(const QStringList &_args)
+    {
+      QCommandLineParser parser;
+      parser.setApplicationDescription("Extracts a triangle mesh from the distance field of a .flow file, runs on the CPU only.");
+      parser.addHelpOption();
+      addCommonOptions(parser);
+      parser.addOption(QCommandLineOption(QStringList() << "o" << "output", "Output mesh, .obj or .ply.", "file", "mesh.ply"));
+      parser.addOption(QCommandLineOption("min", "Lower corner of the bounds.", "x,y,z", "-5,-5,-5"));
+      parser.addOption(QCommandLineOption("max", "Upper corner of the bounds.", "x,y,z", "5,5,5"));
+      parser.addOption(QCommandLineOption("depth", "Octree levels, the longest side of the bounds gets 2^depth cells.", "levels", "8"));
+      parser.addOption(QCommandLineOption("method", "Dual contouring (dc) or marching tetrahedra (mt).", "dc|mt", "dc"));
+      parser.addOption(QCommandLineOption("lipschitz", "Bound on how fast the field changes, raise it for scenes with scaled primitives.", "value", "1"));
+      parser.addOption(QCommandLineOption("pruning", "Drop octree cells by the distance at their centre or by interval bounds over them.", "distance|interval", "distance"));
+      parser.addOption(QCommandLineOption("threads", "Threads, 0 for one per core.", "count", "0"));
+      parser.process(_args);
+
+      CommonOptions options;
+      std::string error;
+      if(!readCommonOptions(parser, options, error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+      options.m_cpu = true;
+
+      sdf::Mesher::Settings settings;
+      bool ok[3];
+      settings.m_depth = parser.value("depth").toUInt(&ok[0]);
+      settings.m_lipschitz = parser.value("lipschitz").toFloat(&ok[1]);
+      unsigned int threads = parser.value("threads").toUInt(&ok[2]);
+      QString method = parser.value("method");
+      QString pruning = parser.value("pruning");
+      if(!(ok[0] && ok[1] && ok[2]) || (method != "dc" && method != "mt") || (pruning != "distance" && pruning != "interval") ||
+         !parseVec3(parser.value("min"), settings.m_min) || !parseVec3(parser.value("max"), settings.m_max))
+      {
+        std::cerr << "Invalid depth, method, pruning, Lipschitz bound, threads or bounds\n";
+        return EXIT_FAILURE;
+      }
+      settings.m_method = method == "dc" ? sdf::Mesher::Method::DUAL_CONTOURING : sdf::Mesher::Method::MARCHING_TETRAHEDRA;
+      settings.m_pruning = pruning == "distance" ? sdf::Mesher::Pruning::DISTANCE : sdf::Mesher::Pruning::INTERVAL;
+
+      QElapsedTimer timer;
+      timer.start();
+      options.m_threads = threads;
+      Scene scene(options);
+      if(!scene.load(error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+      qint64 loadMs = timer.restart();
+
+      ThreadPool &pool = scene.pool();
+      sdf::Mesher mesher(scene.program(), pool);
+      mesher.setTime(options.m_time);
+      sdf::Mesh mesh;
+      if(!mesher.extract(settings, mesh, error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+      qint64 extractMs = timer.restart();
+
+      std::string output = parser.value("output").toStdString();
+      if(!writeMesh(output, mesh, error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+
+      std::cout << output << ": " << mesh.m_positions.size() << " vertices, " << mesh.m_indices.size() / 3 << " triangles, "
+                << sdf::Mesher::boundaryEdges(mesh) << " open edges\n  cells per level";
+      for(size_t cells : mesher.cellsPerLevel())
+        std::cout << " " << cells;
+      std::cout << "\n  load and compile " << loadMs << " ms, extract " << extractMs << " ms (octree " << mesher.traversalTime() << " ms) with " << pool.size() << " threads, "
+                << mesher.evaluations() << " evaluations, write " << timer.elapsed() << " ms\n";
+      return EXIT_SUCCESS;
+    }
+  }
+}
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <iostream>
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+
+#include "CliScene.hpp"
+#include "Commands.hpp"
+#include "ImageWriter.hpp"
+
+namespace hsitho
+{
+  namespace cli
+  {
+    int posterCommand(const QStringList &_args)
+    {
+      QCommandLineParser parser;
+      parser.setApplicationDescription("Renders an image of any size in tiles, streaming finished rows of tiles to disk.");
+      parser.addHelpOption();
+      addCommonOptions(parser);
+      parser.addOption(QCommandLineOption(QStringList() << "o" << "output", "Output image, .exr or .ppm.", "file", "poster.exr"));
+      parser.addOption(QCommandLineOption("width", "Width of the image.", "pixels", "16384"));
+      parser.addOption(QCommandLineOption("height", "Height of the image.", "pixels", "16384"));
+      parser.addOption(QCommandLineOption("tile", "Size of the tiles before supersampling.", "pixels", "1024"));
+      parser.addOption(QCommandLineOption("supersample", "Samples per pixel along each axis.", "count", "1"));
+      parser.addOption(QCommandLineOption("resume", "Continue a partially written image instead of starting over."));
+      parser.process(_args);
+
+      CommonOptions options;
+      std::string error;
+      if(!readCommonOptions(parser, options, error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+
+      bool ok[4];
+      int w = parser.value("width").toInt(&ok[0]);
+      int h = parser.value("height").toInt(&ok[1]);
+      int tile = parser.value("tile").toInt(&ok[2]);
+      int ss = parser.value("supersample").toInt(&ok[3]);
+      if(!(ok[0] && ok[1] && ok[2] && ok[3]) || w <= 0 || h <= 0 || tile <= 0 || ss <= 0)
+      {
+        std::cerr << "Invalid size, tile size or supersampling\n";
+        return EXIT_FAILURE;
+      }
+
+      std::string output = parser.value("output").toStdString();
+      std::unique_ptr<ScanlineWriter> writer = createScanlineWriter(output);
+      if(!writer)
+      {
+        std::cerr << "Posters can only be written as .exr or .ppm\n";
+        return EXIT_FAILURE;
+      }
+
+      Scene scene(options);
+      if(!scene.load(error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+      OffscreenRenderer &renderer = scene.renderer();
+
+      // The supersampled tile has to fit into a single framebuffer
+      tile = std::min(tile, renderer.maxSize() / ss);
+      if(tile <= 0)
+      {
+        std::cerr << "Supersampling larger than the largest supported framebuffer (" << renderer.maxSize() << ")\n";
+        return EXIT_FAILURE;
+      }
+
+      int rowsDone;
+      if(!writer->open(output, w, h, parser.isSet("resume"), rowsDone))
+      {
+        std::cerr << "Couldn't open " << output << (parser.isSet("resume") ? ", or it's from a different image" : "") << "\n";
+        return EXIT_FAILURE;
+      }
+
+      // A partially written row of tiles is simply rendered again, the rows are written to the same offsets
+      int firstTileRow = rowsDone / tile;
+      int tileRows = (h + tile - 1) / tile;
+      if(rowsDone > 0)
+        std::cout << "Resuming from row " << firstTileRow * tile << "\n";
+
+      QElapsedTimer timer;
+      timer.start();
+
+      // Only a single row of tiles is ever kept in memory
+      std::vector<float> row;
+      std::vector<float> pixels;
+      for(int ty = firstTileRow; ty < tileRows; ++ty)
+      {
+        int y = ty * tile;
+        int th = std::min(tile, h - y);
+        row.assign(static_cast<size_t>(w) * th * 4, 0.f);
+
+        for(int x = 0; x < w; x += tile)
+        {
+          int tw = std::min(tile, w - x);
+          if(!renderer.renderTile(x, y, tw, th, w, h, ss, pixels))
+          {
+            std::cerr << "Rendering the tile at " << x << "," << y << " failed\n";
+            return EXIT_FAILURE;
+          }
+          for(int ly = 0; ly < th; ++ly)
+            std::copy(pixels.begin() + static_cast<size_t>(ly) * tw * 4, pixels.begin() + static_cast<size_t>(ly + 1) * tw * 4,
+                      row.begin() + (static_cast<size_t>(ly) * w + x) * 4);
+        }
+
+        if(!writer->writeRows(y, th, row.data()))
+        {
+          std::cerr << "Couldn't write rows " << y << "-" << y + th << " of " << output << "\n";
+          return EXIT_FAILURE;
+        }
+        std::cout << "Rows " << y + th << "/" << h << ", " << timer.elapsed() / 1000.0 << " s\n";
+      }
+
+      if(!writer->close())
+      {
+        std::cerr << "Couldn't finish writing " << output << "\n";
+        return EXIT_FAILURE;
+      }
+      std::cout << output << ": " << w << "x" << h << " in " << tile << " pixel tiles, " << ss * ss << " samples per pixel, " << timer.elapsed() / 1000.0 << " s\n";
+      return EXIT_SUCCESS;
+    }
+  }
+}
@@ -0,0 +1,201 @@
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+
+#include "sdf/SceneCompiler.hpp"
+#include "sdf/SceneQuery.hpp"
+#include "CliScene.hpp"
+#include "Commands.hpp"
+#include "ThreadPool.hpp"
+
+namespace hsitho
+{
+  namespace cli
+  {
+    namespace
+    {
+      ///
+      /// \brief MappedArray A raw binary file mapped in memory, so millions of points are neither read nor written in
+      ///        one go and only the pages a chunk touches are resident
+      ///
+      class MappedArray
+      {
+      public:
+        MappedArray() : m_data(nullptr), m_size(0) {}
+        ~MappedArray()
+        {
+          if(m_data)
+            m_file->unmap(m_data);
+        }
+
+        ///
+        /// \brief openInput Maps an existing file for reading
+        ///
+        bool openInput(const std::string &_path, std::string &_error)
+        {
+          m_file.reset(new QFile(QString::fromStdString(_path)));
+          if(!m_file->open(QIODevice::ReadOnly))
+          {
+            _error = "Couldn't open " + _path;
+            return false;
+          }
+          return map(_path, _error);
+        }
+        ///
+        /// \brief openOutput Creates or truncates a file of the given size and maps it for writing
+        ///
+        bool openOutput(const std::string &_path, qint64 _size, std::string &_error)
+        {
+          m_file.reset(new QFile(QString::fromStdString(_path)));
+          if(!m_file->open(QIODevice::ReadWrite | QIODevice::Truncate) || !m_file->resize(_size))
+          {
+            _error = "Couldn't create " + _path;
+            return false;
+          }
+          return map(_path, _error);
+        }
+
+        template <typename T>
+        T* data() const { return reinterpret_cast<T *>(m_data); }
+        qint64 size() const { return m_size; }
+
+      private:
+        bool map(const std::string &_path, std::string &_error)
+        {
+          m_size = m_file->size();
+          // Mapping an empty file fails, an empty array has nothing to map
+          if(m_size == 0)
+            return true;
+          m_data = m_file->map(0, m_size);
+          if(!m_data)
+          {
+            _error = "Couldn't map " + _path;
+            return false;
+          }
+          return true;
+        }
+
+        std::unique_ptr<QFile> m_file;
+        uchar *m_data;
+        qint64 m_size;
+      };
+    }
+
+    int queryCommand(const QStringList &_args)
+    {
+      QCommandLineParser parser;
+      parser.setApplicationDescription("Evaluates the distance, gradient and primitive of a .flow file at the points of a binary file, runs on the CPU only.\n"
+                                       "Points are x, y and z as 32-bit floats in the byte order of the machine, the outputs are raw arrays\n"
+                                       "of one float, three floats or one 32-bit unsigned integer per point.");
+      parser.addHelpOption();
+      addCommonOptions(parser);
+      parser.addOption(QCommandLineOption("points", "Input points.", "file"));
+      parser.addOption(QCommandLineOption("distance", "Output distances.", "file"));
+      parser.addOption(QCommandLineOption("gradient", "Output gradients, unnormalised.", "file"));
+      parser.addOption(QCommandLineOption("ids", "Output primitive ids, 4294967295 for none.", "file"));
+      parser.addOption(QCommandLineOption("id-table", "Output text file with the id of the node of every primitive id, one per line.", "file"));
+      parser.addOption(QCommandLineOption("gradient-step", "Offset of the gradient samples.", "size", "0.001"));
+      parser.addOption(QCommandLineOption("threads", "Threads, 0 for one per core.", "count", "0"));
+      parser.process(_args);
+
+      CommonOptions options;
+      std::string error;
+      if(!readCommonOptions(parser, options, error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+      options.m_cpu = true;
+
+      sdf::SceneQuery::Settings settings;
+      bool ok[2];
+      settings.m_gradientStep = parser.value("gradient-step").toFloat(&ok[0]);
+      unsigned int threads = parser.value("threads").toUInt(&ok[1]);
+      if(!(ok[0] && ok[1]) || !(settings.m_gradientStep > 0.f))
+      {
+        std::cerr << "Invalid gradient step or threads\n";
+        return EXIT_FAILURE;
+      }
+      if(!parser.isSet("points") || !(parser.isSet("distance") || parser.isSet("gradient") || parser.isSet("ids")))
+      {
+        std::cerr << "Give the points and at least one of --distance, --gradient or --ids\n";
+        return EXIT_FAILURE;
+      }
+
+      QElapsedTimer timer;
+      timer.start();
+      MappedArray points;
+      if(!points.openInput(parser.value("points").toStdString(), error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+      if(points.size() % (3 * sizeof(float)) != 0)
+      {
+        std::cerr << parser.value("points").toStdString() << " isn't a whole number of points\n";
+        return EXIT_FAILURE;
+      }
+      size_t count = static_cast<size_t>(points.size()) / (3 * sizeof(float));
+
+      options.m_threads = threads;
+      Scene scene(options);
+      if(!scene.load(error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+      // The ids need their own program, its distance is the same so it answers everything else as well
+      bool ids = parser.isSet("ids") || parser.isSet("id-table");
+      std::shared_ptr<const sdf::Program> program = scene.program();
+      if(ids)
+      {
+        program = sdf::SceneCompiler::compile(scene.generator(), scene.flowScene().getNodes(), error, true);
+        if(!program)
+        {
+          std::cerr << error << "\n";
+          return EXIT_FAILURE;
+        }
+      }
+      if(parser.isSet("id-table"))
+      {
+        std::ofstream table(parser.value("id-table").toStdString());
+        for(auto &id : scene.generator().primitives())
+          table << id.toString().toStdString() << "\n";
+        if(!table.good())
+        {
+          std::cerr << "Couldn't write " << parser.value("id-table").toStdString() << "\n";
+          return EXIT_FAILURE;
+        }
+      }
+      qint64 loadMs = timer.restart();
+
+      MappedArray distance, gradient, primitives;
+      qint64 n = static_cast<qint64>(count);
+      if((parser.isSet("distance") && !distance.openOutput(parser.value("distance").toStdString(), n * sizeof(float), error)) ||
+         (parser.isSet("gradient") && !gradient.openOutput(parser.value("gradient").toStdString(), n * 3 * sizeof(float), error)) ||
+         (parser.isSet("ids") && !primitives.openOutput(parser.value("ids").toStdString(), n * sizeof(uint32_t), error)))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+
+      ThreadPool &pool = scene.pool();
+      sdf::SceneQuery query(program, pool, settings);
+      query.setTime(options.m_time);
+      timer.restart();
+      query.query(points.data<float>(), count, distance.data<float>(), gradient.data<float>(), primitives.data<uint32_t>());
+      qint64 queryNs = timer.nsecsElapsed();
+
+      double seconds = queryNs / 1e9;
+      std::cout << count << " points in " << queryNs / 1e6 << " ms with " << pool.size() << " threads, "
+                << (seconds > 0.0 ? count / seconds / 1e6 : 0.0) << " million points per second ("
+                << (seconds > 0.0 ? query.evaluations() / seconds / 1e6 : 0.0) << " million evaluations per second)\n"
+                << "  load and compile " << loadMs << " ms\n";
+      return EXIT_SUCCESS;
+    }
+  }
+}
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+
+#include "CliScene.hpp"
+#include "Commands.hpp"
+#include "ImageWriter.hpp"
+#include "ThreadPool.hpp"
+
+namespace hsitho
+{
+  namespace cli
+  {
+    int renderCommand(const QStringList &_args)
+    {
+      QCommandLineParser parser;
+      parser.setApplicationDescription("Renders a single image of a .flow file.");
+      parser.addHelpOption();
+      addCommonOptions(parser);
+      parser.addOption(QCommandLineOption(QStringList() << "o" << "output", "Output image, .png, .exr or .ppm.", "file", "render.png"));
+      parser.addOption(QCommandLineOption("width", "Width of the image.", "pixels", "1280"));
+      parser.addOption(QCommandLineOption("height", "Height of the image.", "pixels", "720"));
+      parser.addOption(QCommandLineOption("backend", "Render with the shader on the GPU (gl) or with the raymarcher on the CPU (cpu).", "gl|cpu", "gl"));
+      parser.addOption(QCommandLineOption("threads", "Threads of the CPU backend, 0 for one per core.", "count", "0"));
+      parser.process(_args);
+
+      CommonOptions options;
+      std::string error;
+      if(!readCommonOptions(parser, options, error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+
+      bool wOk, hOk;
+      int w = parser.value("width").toInt(&wOk);
+      int h = parser.value("height").toInt(&hOk);
+      if(!wOk || !hOk || w <= 0 || h <= 0)
+      {
+        std::cerr << "Invalid image size\n";
+        return EXIT_FAILURE;
+      }
+
+      QString backend = parser.value("backend");
+      bool threadsOk;
+      unsigned int threads = parser.value("threads").toUInt(&threadsOk);
+      if((backend != "gl" && backend != "cpu") || !threadsOk)
+      {
+        std::cerr << "Invalid --backend or --threads\n";
+        return EXIT_FAILURE;
+      }
+      options.m_cpu = backend == "cpu";
+
+      QElapsedTimer timer;
+      timer.start();
+      options.m_threads = threads;
+      Scene scene(options);
+      if(!scene.load(error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+      qint64 loadMs = timer.restart();
+
+      std::vector<float> pixels;
+      std::ostringstream cpuStats;
+      if(options.m_cpu)
+      {
+        ThreadPool &pool = scene.pool();
+        sdf::Raymarcher marcher(scene.program(), pool);
+        marcher.setCamera(options.m_eye, options.m_up);
+        marcher.setTime(options.m_time);
+        marcher.setLights(scene.lights());
+        timer.restart();
+        marcher.render(w, h, pixels);
+        double seconds = std::max(timer.nsecsElapsed() / 1e9, 1e-9);
+        cpuStats << ", " << pool.size() << " threads, " << w * static_cast<double>(h) / seconds / 1e6 << " Mrays/s, "
+                 << marcher.evaluations() / seconds / 1e6 << " M evaluations/s";
+      }
+      else
+      {
+        if(w > scene.renderer().maxSize() || h > scene.renderer().maxSize())
+        {
+          std::cerr << "Image larger than the largest supported framebuffer (" << scene.renderer().maxSize() << "), use the poster command\n";
+          return EXIT_FAILURE;
+        }
+
+        if(!scene.renderer().render(w, h, pixels))
+        {
+          std::cerr << "Rendering failed\n";
+          return EXIT_FAILURE;
+        }
+      }
+      qint64 renderMs = timer.restart();
+
+      std::string output = parser.value("output").toStdString();
+      if(!writeImage(output, w, h, pixels, error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+
+      std::cout << output << ": " << w << "x" << h << ", load and compile " << loadMs << " ms, render " << renderMs << " ms, write " << timer.elapsed() << " ms" << cpuStats.str() << "\n";
+      return EXIT_SUCCESS;
+    }
+  }
+}
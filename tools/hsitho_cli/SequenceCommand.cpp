@@ -0,0 +1,221 @@
+#include <cctype>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "CliScene.hpp"
+#include "Commands.hpp"
+#include "FrameEncoder.hpp"
+#include "ImageWriter.hpp"
+
+namespace hsitho
+{
+  namespace cli
+  {
+    namespace
+    {
+      ///
+      /// \brief FramePattern The --output pattern split around its frame number, the number is written here rather than
+      ///        passing the user's text to printf as a format
+      ///
+      struct FramePattern
+      {
+        std::string m_prefix;
+        std::string m_suffix;
+        size_t m_width = 0;
+        bool m_zeros = false;
+
+        ///
+        /// \brief parse Splits a pattern with exactly one %d, optionally with a 0 flag and a width, %% is a literal %
+        /// \return False if there's no frame number, more than one or any other conversion
+        ///
+        bool parse(const std::string &_pattern, std::string &_error)
+        {
+          static const size_t c_maxWidth = 16;
+          bool found = false;
+          std::string *text = &m_prefix;
+          for(size_t i = 0; i < _pattern.size(); ++i)
+          {
+            if(_pattern[i] != '%')
+            {
+              *text += _pattern[i];
+              continue;
+            }
+            if(i + 1 < _pattern.size() && _pattern[i + 1] == '%')
+            {
+              *text += '%';
+              ++i;
+              continue;
+            }
+            size_t j = i + 1;
+            m_zeros = j < _pattern.size() && _pattern[j] == '0';
+            if(m_zeros)
+              ++j;
+            size_t digits = j;
+            while(j < _pattern.size() && std::isdigit(static_cast<unsigned char>(_pattern[j])))
+              ++j;
+            if(found || j >= _pattern.size() || _pattern[j] != 'd' || j - digits > 2)
+            {
+              _error = "The output pattern " + _pattern + " needs exactly one frame number like %d or %04d and %% for a literal %";
+              return false;
+            }
+            m_width = j > digits ? std::stoul(_pattern.substr(digits, j - digits)) : 0;
+            if(m_width > c_maxWidth)
+            {
+              _error = "The frame number of the output pattern is wider than " + std::to_string(c_maxWidth) + " digits";
+              return false;
+            }
+            found = true;
+            text = &m_suffix;
+            i = j;
+          }
+          if(!found)
+          {
+            _error = "The output pattern " + _pattern + " has no frame number, every frame would be written to the same file";
+            return false;
+          }
+          return true;
+        }
+
+        ///
+        /// \brief path File name of a frame
+        ///
+        std::string path(int _frame) const
+        {
+          std::string number = std::to_string(_frame);
+          if(number.size() < m_width)
+            number.insert(0, m_width - number.size(), m_zeros ? '0' : ' ');
+          return m_prefix + number + m_suffix;
+        }
+      };
+    }
+
+    int sequenceCommand(const QStringList &_args)
+    {
+      QCommandLineParser parser;
+      parser.setApplicationDescription("Renders an animation at fixed u_GlobalTime steps, reading frames back asynchronously and encoding them on a thread pool.");
+      parser.addHelpOption();
+      addCommonOptions(parser);
+      parser.addOption(QCommandLineOption(QStringList() << "o" << "output", "Output file pattern with a printf style frame number, .png or .exr.", "pattern", "frame_%04d.png"));
+      parser.addOption(QCommandLineOption("width", "Width of the frames.", "pixels", "1280"));
+      parser.addOption(QCommandLineOption("height", "Height of the frames.", "pixels", "720"));
+      parser.addOption(QCommandLineOption("frames", "Number of frames.", "count", "100"));
+      parser.addOption(QCommandLineOption("fps", "Frames per second of u_GlobalTime, the time of frame i is --time + i / fps.", "fps", "24"));
+      parser.addOption(QCommandLineOption("turntable", "Orbit the camera once around the up axis over the sequence."));
+      parser.addOption(QCommandLineOption("threads", "Encoder threads.", "count", QString::number(std::max(QThread::idealThreadCount() - 1, 1))));
+      parser.addOption(QCommandLineOption("slots", "Pixel buffers in flight.", "count", "3"));
+      parser.process(_args);
+
+      CommonOptions options;
+      std::string error;
+      if(!readCommonOptions(parser, options, error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+
+      bool ok[6];
+      int w = parser.value("width").toInt(&ok[0]);
+      int h = parser.value("height").toInt(&ok[1]);
+      int frames = parser.value("frames").toInt(&ok[2]);
+      float fps = parser.value("fps").toFloat(&ok[3]);
+      int threads = parser.value("threads").toInt(&ok[4]);
+      int slots = parser.value("slots").toInt(&ok[5]);
+      if(!(ok[0] && ok[1] && ok[2] && ok[3] && ok[4] && ok[5]) || w <= 0 || h <= 0 || frames <= 0 || fps <= 0.f || threads <= 0 || slots <= 0)
+      {
+        std::cerr << "Invalid size, frame count, fps, thread count or slot count\n";
+        return EXIT_FAILURE;
+      }
+
+      std::string pattern = parser.value("output").toStdString();
+      bool exr = isExr(pattern);
+      FramePattern framePattern;
+      if(!framePattern.parse(pattern, error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+
+      Scene scene(options);
+      if(!scene.load(error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+      OffscreenRenderer &renderer = scene.renderer();
+      if(w > renderer.maxSize() || h > renderer.maxSize())
+      {
+        std::cerr << "Frame larger than the largest supported framebuffer (" << renderer.maxSize() << ")\n";
+        return EXIT_FAILURE;
+      }
+      renderer.setReadbackSlots(slots);
+
+      // Enough queued frames to keep every encoder busy, but not so many that memory grows with the sequence length
+      FrameEncoder encoder(threads, threads * 2);
+
+      QElapsedTimer timer;
+      timer.start();
+      double collectMs = 0.0;
+
+      // Frame i is queued into slot i % slots and collected once slots - 1 newer frames have been queued after it
+      for(int i = 0; i < frames + slots - 1; ++i)
+      {
+        if(i < frames)
+        {
+          float time = options.m_time + i / fps;
+          renderer.setTime(time);
+          if(parser.isSet("turntable"))
+          {
+            glm::mat4 rot = glm::rotate(glm::mat4(1.f), 2.f * static_cast<float>(M_PI) * i / frames, options.m_up);
+            renderer.setCamera(glm::vec3(rot * glm::vec4(options.m_eye, 1.f)), options.m_up);
+          }
+          if(!renderer.queueFrame(i % slots, w, h, exr))
+          {
+            std::cerr << "Rendering frame " << i << " failed\n";
+            return EXIT_FAILURE;
+          }
+        }
+
+        int done = i - (slots - 1);
+        if(done >= 0)
+        {
+          QElapsedTimer collect;
+          collect.start();
+
+          EncodeJob job;
+          job.m_width = w;
+          job.m_height = h;
+          job.m_float = exr;
+          job.m_path = framePattern.path(done);
+          if(!renderer.collectFrame(done % slots, job.m_data))
+          {
+            std::cerr << "Reading frame " << done << " failed\n";
+            return EXIT_FAILURE;
+          }
+          collectMs += collect.nsecsElapsed() / 1000000.0;
+          encoder.push(std::move(job));
+        }
+      }
+      double renderMs = timer.nsecsElapsed() / 1000000.0;
+      unsigned int failed = encoder.finish();
+      double totalMs = timer.nsecsElapsed() / 1000000.0;
+
+      std::cout << frames << " frames " << w << "x" << h << " in " << totalMs / 1000.0 << " s, " << frames / (totalMs / 1000.0) << " fps\n"
+                << "  render and readback " << renderMs << " ms (" << frames / (renderMs / 1000.0) << " fps), waiting on readback " << collectMs
+                << " ms, waiting on encoders " << encoder.blockedMs() << " ms, " << threads << " encoder threads\n";
+
+      if(failed > 0)
+      {
+        std::cerr << failed << " frames couldn't be written\n";
+        return EXIT_FAILURE;
+      }
+      return EXIT_SUCCESS;
+    }
+  }
+}
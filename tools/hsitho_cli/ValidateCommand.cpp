@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+
+#include "sdf/Evaluator.hpp"
+#include "sdf/Raymarcher.hpp"
+#include "sdf/SceneCompiler.hpp"
+#include "CliScene.hpp"
+#include "Commands.hpp"
+#include "CompileArena.hpp"
+#include "Numeric.hpp"
+#include "ThreadPool.hpp"
+
+namespace hsitho
+{
+  namespace cli
+  {
+    namespace
+    {
+      ///
+      /// \brief gridShader Fragment shader writing map at the points of a grid, one pixel per point. The image is _n wide
+      ///        and _n * _n high, x runs along the rows and the slices in z are stacked on top of each other
+      ///
+      std::string gridShader(const std::string &_start, const std::string &_map, int _n, const glm::vec3 &_min, const glm::vec3 &_max)
+      {
+        auto vec3 = [](const glm::vec3 &_v) {
+          return "vec3(" + Numeric::toString(_v.x) + ", " + Numeric::toString(_v.y) + ", " + Numeric::toString(_v.z) + ")";
+        };
+        std::string n = Numeric::toString(_n);
+        std::string shader = _start + _map;
+        shader += "void main()\n{\n";
+        shader += "  ivec2 pixel = ivec2(gl_FragCoord.xy);\n";
+        shader += "  vec3 cell = vec3(pixel.x, pixel.y % " + n + ", pixel.y / " + n + ");\n";
+        shader += "  vec3 p = " + vec3(_min) + " + (" + vec3(_max) + " - " + vec3(_min) + ") * cell / " + Numeric::toString(static_cast<float>(_n - 1)) + ";\n";
+        shader += "  o_FragColor = map(p);\n}\n";
+        return shader;
+      }
+    }
+
+    int validateCommand(const QStringList &_args)
+    {
+      QCommandLineParser parser;
+      parser.setApplicationDescription("Evaluates the distance field of a .flow file on the CPU and on the GPU over a grid and compares them.");
+      parser.addHelpOption();
+      addCommonOptions(parser);
+      parser.addOption(QCommandLineOption("resolution", "Points along each axis of the grid.", "count", "32"));
+      parser.addOption(QCommandLineOption("min", "Lower corner of the grid.", "x,y,z", "-5,-5,-5"));
+      parser.addOption(QCommandLineOption("max", "Upper corner of the grid.", "x,y,z", "5,5,5"));
+      parser.addOption(QCommandLineOption("tolerance", "Largest difference allowed in the distance or the colour.", "value", "0.001"));
+      parser.addOption(QCommandLineOption("image", "Also render an image with the shader and with the CPU raymarcher and compare the pixels."));
+      parser.addOption(QCommandLineOption("width", "Width of the compared image.", "pixels", "320"));
+      parser.addOption(QCommandLineOption("height", "Height of the compared image.", "pixels", "180"));
+      parser.process(_args);
+
+      CommonOptions options;
+      std::string error;
+      if(!readCommonOptions(parser, options, error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+
+      bool ok[4];
+      int n = parser.value("resolution").toInt(&ok[0]);
+      float tolerance = parser.value("tolerance").toFloat(&ok[1]);
+      int w = parser.value("width").toInt(&ok[2]);
+      int h = parser.value("height").toInt(&ok[3]);
+      glm::vec3 lo, hi;
+      if(!(ok[0] && ok[1] && ok[2] && ok[3]) || n < 2 || tolerance < 0.f || w <= 0 || h <= 0 || !parseVec3(parser.value("min"), lo) || !parseVec3(parser.value("max"), hi))
+      {
+        std::cerr << "Invalid resolution, tolerance, image size or grid bounds\n";
+        return EXIT_FAILURE;
+      }
+
+      Scene scene(options);
+      if(!scene.load(error))
+      {
+        std::cerr << error << "\n";
+        return EXIT_FAILURE;
+      }
+      if(n * n > scene.renderer().maxSize())
+      {
+        std::cerr << "Resolution too high for a single framebuffer (" << scene.renderer().maxSize() << " rows)\n";
+        return EXIT_FAILURE;
+      }
+
+      // Both sides get the same map function, the GPU runs it as it is and the CPU compiles it
+      std::string map;
+      {
+        CompileArena arena;
+        map = scene.generator().generateMap(scene.flowScene().getNodes());
+      }
+      QElapsedTimer timer;
+      timer.start();
+      std::shared_ptr<sdf::Program> program = sdf::SceneCompiler::compileMap(map, error, false, scene.generator().volumes(), scene.generator().instanceSets());
+      if(!program)
+      {
+        std::cerr << "Couldn't compile the scene for the CPU: " << error << "\n";
+        return EXIT_FAILURE;
+      }
+      float compileMs = timer.nsecsElapsed() / 1e6f;
+
+      std::string log;
+      if(!scene.renderer().setFragmentShader(gridShader(scene.generator().shaderStart(), map, n, lo, hi), log))
+      {
+        std::cerr << "Couldn't compile the grid shader:\n" << log << "\n";
+        return EXIT_FAILURE;
+      }
+      std::vector<float> gpu;
+      if(!scene.renderer().render(n, n * n, gpu))
+      {
+        std::cerr << "Rendering failed\n";
+        return EXIT_FAILURE;
+      }
+
+      size_t count = static_cast<size_t>(n) * n * n;
+      std::vector<float> x(count), y(count), z(count);
+      for(size_t i = 0; i < count; ++i)
+      {
+        glm::vec3 cell(i % n, (i / n) % n, i / (static_cast<size_t>(n) * n));
+        glm::vec3 p = lo + (hi - lo) * cell / static_cast<float>(n - 1);
+        x[i] = p.x;
+        y[i] = p.y;
+        z[i] = p.z;
+      }
+
+      sdf::Evaluator evaluator(program);
+      evaluator.setTime(options.m_time);
+      std::vector<float> cpu[4] = {std::vector<float>(count), std::vector<float>(count), std::vector<float>(count), std::vector<float>(count)};
+      timer.restart();
+      evaluator.evaluate(x.data(), y.data(), z.data(), count, cpu[0].data(), cpu[1].data(), cpu[2].data(), cpu[3].data());
+      float evaluateMs = timer.nsecsElapsed() / 1e6f;
+
+      // The rows come back top first, the first row of the grid is the bottom one
+      float maxDistance = 0.f, maxColour = 0.f;
+      size_t failed = 0;
+      for(size_t i = 0; i < count; ++i)
+      {
+        size_t row = static_cast<size_t>(n) * n - 1 - i / n;
+        const float *pixel = &gpu[(row * n + i % n) * 4];
+        float distance = std::fabs(pixel[0] - cpu[0][i]);
+        float colour = std::max({std::fabs(pixel[1] - cpu[1][i]), std::fabs(pixel[2] - cpu[2][i]), std::fabs(pixel[3] - cpu[3][i])});
+        maxDistance = std::max(maxDistance, distance);
+        maxColour = std::max(maxColour, colour);
+        if(!(distance <= tolerance && colour <= tolerance))
+          ++failed;
+      }
+
+      const sdf::Program &p = evaluator.program();
+      std::cout << options.m_scene << ": " << count << " points, " << p.m_code.size() << " instructions per point, "
+                << p.m_registerCount << " registers\n"
+                << "  max difference distance " << maxDistance << ", colour " << maxColour << ", " << failed << " points over " << tolerance << "\n"
+                << "  cpu compile " << compileMs << " ms, evaluate " << evaluateMs << " ms, "
+                << static_cast<size_t>(count / std::max(evaluateMs / 1000.f, 1e-6f)) << " points/s with " << sdf::Lanes::c_width << " lanes\n";
+
+      if(parser.isSet("image"))
+      {
+        // The pixels only agree up to the precision of the marching, the GPU intersects plain unions of simple primitives
+        // exactly where the CPU keeps marching, so this is reported rather than checked
+        std::vector<sdf::Light> lights;
+        if(!sdf::Raymarcher::sceneLights(scene.flowScene().getNodes(), options.m_time, lights, error))
+        {
+          std::cerr << error << "\n";
+          return EXIT_FAILURE;
+        }
+        std::vector<float> glImage, cpuImage;
+        if(!scene.renderer().setFragmentShader(scene.fragmentShader(), log) || !scene.renderer().render(w, h, glImage))
+        {
+          std::cerr << "Rendering the scene shader failed\n" << log << "\n";
+          return EXIT_FAILURE;
+        }
+        ThreadPool pool;
+        sdf::Raymarcher marcher(program, pool);
+        marcher.setCamera(options.m_eye, options.m_up);
+        marcher.setTime(options.m_time);
+        marcher.setLights(lights);
+        timer.restart();
+        marcher.render(w, h, cpuImage);
+        float renderMs = timer.nsecsElapsed() / 1e6f;
+
+        float maxPixel = 0.f;
+        double sum = 0.0;
+        size_t differing = 0;
+        for(size_t i = 0; i < glImage.size(); i += 4)
+        {
+          float d = std::max({std::fabs(glImage[i] - cpuImage[i]), std::fabs(glImage[i + 1] - cpuImage[i + 1]), std::fabs(glImage[i + 2] - cpuImage[i + 2])});
+          maxPixel = std::max(maxPixel, d);
+          sum += d;
+          if(d > 2.f / 255.f)
+            ++differing;
+        }
+        size_t pixels = glImage.size() / 4;
+        std::cout << "  image " << w << "x" << h << ": max difference " << maxPixel << ", mean " << sum / pixels << ", "
+                  << 100.0 * differing / pixels << "% of the pixels differ by more than 2/255\n"
+                  << "  cpu render " << renderMs << " ms, " << pixels / std::max(renderMs / 1000.f, 1e-6f) / 1e6f << " Mrays/s with " << pool.size() << " threads\n";
+      }
+      return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+  }
+}
@@ -0,0 +1,25 @@
+# Headless command line tool, renders .flow files without the editor
+# Run with QT_QPA_PLATFORM=offscreen (set by default) on machines without a display
+TARGET = hsitho_cli
+DESTDIR = $$PWD/../..
+CONFIG += console thread
+CONFIG -= app_bundle
+
+include(../../hsitho.pri)
+
+SOURCES += main.cpp \
+           BakeCommand.cpp \
+           CliScene.cpp \
+           FrameEncoder.cpp \
+           MeshCommand.cpp \
+           PosterCommand.cpp \
+           QueryCommand.cpp \
+           RenderCommand.cpp \
+           SequenceCommand.cpp \
+           ValidateCommand.cpp
+HEADERS += CliScene.hpp \
+           Commands.hpp \
+           FrameEncoder.hpp
+
+OBJECTS_DIR = ./obj
+MOC_DIR = ./moc
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <locale>
+
+#include <QApplication>
+
+#include "Commands.hpp"
+#include "NodeModels.hpp"
+#include "Profiler.hpp"
+
+namespace
+{
+  void usage()
+  {
+    std::cerr << "Usage: hsitho_cli <command> [options] <scene.flow>\n"
+                 "Commands:\n"
+                 "  render    Render a single image\n"
+                 "  sequence  Render an animation\n"
+                 "  poster    Render a large image in tiles\n"
+                 "  validate  Compare the CPU evaluation of the distance field with the shader\n"
+                 "  mesh      Export the distance field as a triangle mesh\n"
+                 "  bake      Bake the distance field into a sparse voxel grid\n"
+                 "  query     Evaluate the distance field at the points of a binary file\n"
+                 "Run hsitho_cli <command> --help for the options of a command\n";
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  // The node models still create their widgets, they just never get shown
+  if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  QApplication app(argc, argv);
+  HSITHO_PROFILE_THREAD("main");
+  QApplication::setApplicationName("hsitho_cli");
+  std::locale::global(std::locale::classic());
+
+  hsitho::registerNodeModels();
+
+  QStringList args = app.arguments();
+  if(args.size() < 2)
+  {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  // --trace is declared with the common options so the commands accept it, it's handled here around them
+  QString trace;
+  for(int i = 2; i < args.size(); ++i)
+  {
+    if(args[i] == "--trace" && i + 1 < args.size())
+      trace = args[i + 1];
+    else if(args[i].startsWith("--trace="))
+      trace = args[i].mid(8);
+  }
+  hsitho::Profiler::instance().setEnabled(!trace.isEmpty());
+
+  // The commands get all the arguments, the command name stays as their first positional argument
+  QString command = args[1];
+  int result;
+  if(command == "render")
+    result = hsitho::cli::renderCommand(args);
+  else if(command == "sequence")
+    result = hsitho::cli::sequenceCommand(args);
+  else if(command == "poster")
+    result = hsitho::cli::posterCommand(args);
+  else if(command == "validate")
+    result = hsitho::cli::validateCommand(args);
+  else if(command == "mesh")
+    result = hsitho::cli::meshCommand(args);
+  else if(command == "bake")
+    result = hsitho::cli::bakeCommand(args);
+  else if(command == "query")
+    result = hsitho::cli::queryCommand(args);
+  else
+  {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  if(!trace.isEmpty() && !hsitho::Profiler::instance().writeChromeTrace(trace.toStdString()))
+  {
+    std::cerr << "Couldn't write the trace to " << trace.toStdString() << "\n";
+    return EXIT_FAILURE;
+  }
+  return result;
+}